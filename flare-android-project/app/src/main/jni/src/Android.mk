@@ -30,9 +30,11 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
 	../../../../../../src/EffectManager.cpp \
 	../../../../../../src/Enemy.cpp \
 	../../../../../../src/EnemyBehavior.cpp \
+	../../../../../../src/EnemyGrid.cpp \
 	../../../../../../src/EnemyGroupManager.cpp \
 	../../../../../../src/EnemyManager.cpp \
 	../../../../../../src/EngineSettings.cpp \
+	../../../../../../src/EventIndex.cpp \
 	../../../../../../src/EventManager.cpp \
 	../../../../../../src/FileParser.cpp \
 	../../../../../../src/FontEngine.cpp \
@@ -50,6 +52,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
 	../../../../../../src/Hazard.cpp \
 	../../../../../../src/HazardManager.cpp \
 	../../../../../../src/IconManager.cpp \
+	../../../../../../src/InputScript.cpp \
 	../../../../../../src/InputState.cpp \
 	../../../../../../src/ItemManager.cpp \
 	../../../../../../src/ItemStorage.cpp \
@@ -57,7 +60,12 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
 	../../../../../../src/LootManager.cpp \
 	../../../../../../src/Map.cpp \
 	../../../../../../src/MapParallax.cpp \
+	../../../../../../src/MapChunkCache.cpp \
 	../../../../../../src/MapCollision.cpp \
+	../../../../../../src/MapCompiler.cpp \
+	../../../../../../src/MapFlowField.cpp \
+	../../../../../../src/MapPathHierarchy.cpp \
+	../../../../../../src/MapPreloader.cpp \
 	../../../../../../src/MapRenderer.cpp \
 	../../../../../../src/Menu.cpp \
 	../../../../../../src/MenuActionBar.cpp \
@@ -82,13 +90,21 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
 	../../../../../../src/MenuTouchControls.cpp \
 	../../../../../../src/MenuVendor.cpp \
 	../../../../../../src/MessageEngine.cpp \
+	../../../../../../src/ModIndex.cpp \
 	../../../../../../src/ModManager.cpp \
 	../../../../../../src/NPC.cpp \
 	../../../../../../src/NPCManager.cpp \
+	../../../../../../src/NullRenderDevice.cpp \
+	../../../../../../src/NullSoundManager.cpp \
 	../../../../../../src/PowerManager.cpp \
+	../../../../../../src/Profiler.cpp \
+	../../../../../../src/ProfilerOverlay.cpp \
 	../../../../../../src/QuestLog.cpp \
 	../../../../../../src/RenderDevice.cpp \
+	../../../../../../src/SaveFile.cpp \
 	../../../../../../src/SaveLoad.cpp \
+	../../../../../../src/SaveSummary.cpp \
+	../../../../../../src/ScriptedInputState.cpp \
 	../../../../../../src/SDLInputState.cpp \
 	../../../../../../src/SDLHardwareRenderDevice.cpp \
 	../../../../../../src/SDLSoftwareRenderDevice.cpp \
@@ -17,53 +17,93 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 */
 
 #include "AStarContainer.h"
-#include <cstring>
 #include <cfloat>
 
-AStarContainer::AStarContainer(unsigned int _map_width, unsigned int _map_height, unsigned int _node_limit)
-	: size(0)
-	, node_limit(_node_limit)
-	, map_width(_map_width)
-	, map_height(_map_height)
+AStarIndex::AStarIndex()
+	: map_width(0)
+	, generation(0)
 {
-	nodes.resize(node_limit, NULL);
+}
+
+void AStarIndex::resize(unsigned int _map_width, unsigned int _map_height) {
+	map_width = _map_width;
+	map_pos.assign(_map_width * _map_height, -1);
+	map_gen.assign(_map_width * _map_height, 0);
+	generation = 0;
+}
 
-	//initialise the map array. A -1 value will mean there is no node at that position
-	map_pos.resize(map_width);
-	for (unsigned i=0; i<map_width; ++i) {
-		map_pos[i].resize(map_height, -1);
+void AStarIndex::nextGeneration() {
+	generation++;
+
+	// on wrap-around, old stamps could be mistaken for current ones
+	if (generation == 0) {
+		map_gen.assign(map_gen.size(), 0);
+		generation = 1;
 	}
 }
 
+int AStarIndex::get(int x, int y) const {
+	const unsigned int i = x + y * map_width;
+	if (map_gen[i] != generation)
+		return -1;
+	return map_pos[i];
+}
+
+void AStarIndex::set(int x, int y, int value) {
+	const unsigned int i = x + y * map_width;
+	map_pos[i] = value;
+	map_gen[i] = generation;
+}
+
+AStarContainer::AStarContainer()
+	: size(0)
+	, node_limit(0)
+{
+}
+
 AStarContainer::~AStarContainer() {
-	for(unsigned int i=0; i<size; i++)
-		delete nodes[i];
-	nodes.clear();
+}
+
+void AStarContainer::resize(unsigned int _map_width, unsigned int _map_height) {
+	map_pos.resize(_map_width, _map_height);
+	size = 0;
+}
+
+void AStarContainer::reset(unsigned int _node_limit) {
+	node_limit = _node_limit;
+	if (nodes.size() < node_limit)
+		nodes.resize(node_limit);
+
+	size = 0;
+	map_pos.nextGeneration();
 }
 
 int AStarContainer::getSize() {
 	return size;
 }
 
-void AStarContainer::add(AStarNode* node) {
+void AStarContainer::swapNodes(unsigned int a, unsigned int b) {
+	AStarNode temp = nodes[a];
+	nodes[a] = nodes[b];
+	map_pos.set(nodes[a].getX(), nodes[a].getY(), a);
+	nodes[b] = temp;
+	map_pos.set(nodes[b].getX(), nodes[b].getY(), b);
+}
+
+void AStarContainer::add(const AStarNode& node) {
 	if (size >= node_limit) return;
 
 	//add the new node at the end and update its index
 	nodes[size] = node;
-	map_pos[node->getX()][node->getY()] = static_cast<short>(size);
+	map_pos.set(node.getX(), node.getY(), size);
 
 	//reorder the heap based on f ordering, staring with thenewly added node and working up the tree from there
-	int m = size;
+	unsigned int m = size;
 
-	AStarNode* temp = NULL;
 	while(m != 0) {
 		//if the current nodes f value is shorter than its parent, they need to be swapped
-		if(nodes[m]->getFinalCost() <= nodes[m/2]->getFinalCost()) {
-			temp = nodes[m/2];
-			nodes[m/2] = nodes[m];
-			map_pos[nodes[m/2]->getX()][nodes[m/2]->getY()] = static_cast<short>(m/2);
-			nodes[m] = temp;
-			map_pos[nodes[m]->getX()][nodes[m]->getY()] = static_cast<short>(m);
+		if(nodes[m].getFinalCost() <= nodes[m/2].getFinalCost()) {
+			swapNodes(m/2, m);
 			m=m/2;
 		}
 		else
@@ -72,22 +112,22 @@ void AStarContainer::add(AStarNode* node) {
 	size++;
 }
 
-AStarNode* AStarContainer::get_shortest_f() {
+const AStarNode& AStarContainer::get_shortest_f() {
 	return nodes[0];
 }
 
-void AStarContainer::remove(AStarNode* node) {
+void AStarContainer::remove(const Point& pos) {
 
-	unsigned int heap_indexv = map_pos[node->getX()][node->getY()] + 1;
+	unsigned int heap_indexv = map_pos.get(pos.x, pos.y) + 1;
 
 	//swap the last node in the list with the node being deleted
 	nodes[heap_indexv-1] = nodes[size-1];
-	map_pos[nodes[heap_indexv-1]->getX()][nodes[heap_indexv-1]->getY()] = static_cast<short>(heap_indexv-1);
+	map_pos.set(nodes[heap_indexv-1].getX(), nodes[heap_indexv-1].getY(), heap_indexv-1);
 
 	size--;
 
 	if(size == 0) {
-		map_pos[node->getX()][node->getY()] = -1;
+		map_pos.set(pos.x, pos.y, -1);
 		return;
 	}
 
@@ -98,20 +138,16 @@ void AStarContainer::remove(AStarNode* node) {
 		unsigned int heap_indexu = heap_indexv;
 		if(2*heap_indexu+1 <= size) { //if both children exist
 			//Select the lowest of the two children.
-			if(nodes[heap_indexu-1]->getFinalCost() >= nodes[2*heap_indexu-1]->getFinalCost()) heap_indexv = 2*heap_indexu;
-			if(nodes[heap_indexv-1]->getFinalCost() >= nodes[2*heap_indexu]->getFinalCost()) heap_indexv = 2*heap_indexu+1;
+			if(nodes[heap_indexu-1].getFinalCost() >= nodes[2*heap_indexu-1].getFinalCost()) heap_indexv = 2*heap_indexu;
+			if(nodes[heap_indexv-1].getFinalCost() >= nodes[2*heap_indexu].getFinalCost()) heap_indexv = 2*heap_indexu+1;
 		}
 		else if (2*heap_indexu <= size) { //if only child #1 exists
 			//Check if the F cost is greater than the child
-			if(nodes[heap_indexu-1]->getFinalCost() >= nodes[2*heap_indexu-1]->getFinalCost()) heap_indexv = 2*heap_indexu;
+			if(nodes[heap_indexu-1].getFinalCost() >= nodes[2*heap_indexu-1].getFinalCost()) heap_indexv = 2*heap_indexu;
 		}
 
 		if(heap_indexu != heap_indexv) { //If parent's F > one or both of its children, swap them
-			AStarNode* temp = nodes[heap_indexu-1];
-			nodes[heap_indexu-1] = nodes[heap_indexv-1];
-			map_pos[nodes[heap_indexu-1]->getX()][nodes[heap_indexu-1]->getY()] = static_cast<short>(heap_indexu-1);
-			nodes[heap_indexv-1] = temp;
-			map_pos[nodes[heap_indexv-1]->getX()][nodes[heap_indexv-1]->getY()] = static_cast<short>(heap_indexv-1);
+			swapNodes(heap_indexu-1, heap_indexv-1);
 		}
 		else {
 			break;//if item <= both children, exit loop
@@ -119,15 +155,15 @@ void AStarContainer::remove(AStarNode* node) {
 	}//Repeat forever
 
 	//remove the node from the map pos index
-	map_pos[node->getX()][node->getY()] = -1;
+	map_pos.set(pos.x, pos.y, -1);
 }
 
 bool AStarContainer::exists(const Point& pos) {
-	return map_pos[pos.x][pos.y] != -1;
+	return map_pos.get(pos.x, pos.y) != -1;
 }
 
 AStarNode* AStarContainer::get(int x, int y) {
-	return nodes[map_pos[x][y]];
+	return &nodes[map_pos.get(x, y)];
 }
 
 bool AStarContainer::isEmpty() {
@@ -139,16 +175,11 @@ void AStarContainer::updateParent(const Point& pos, const Point& parent_pos, flo
 	get(pos.x, pos.y)->setActualCost(score);
 
 	//reorder the heap based on the new f value of this node. starting at the updated node and working up the tree
-	int m = map_pos[pos.x][pos.y];
-	AStarNode* temp = NULL;
+	unsigned int m = map_pos.get(pos.x, pos.y);
 	while(m != 0) {
 		//if the current node has a lower f value than its parent in the heap, swap them
-		if(nodes[m]->getFinalCost() <= nodes[m/2]->getFinalCost()) {
-			temp = nodes[m/2];
-			nodes[m/2] = nodes[m];
-			map_pos[nodes[m/2]->getX()][nodes[m/2]->getY()] = static_cast<short>(m/2);
-			nodes[m] = temp;
-			map_pos[nodes[m]->getX()][nodes[m]->getY()] = static_cast<short>(m);
+		if(nodes[m].getFinalCost() <= nodes[m/2].getFinalCost()) {
+			swapNodes(m/2, m);
 			m=m/2;
 		}
 		else
@@ -156,54 +187,56 @@ void AStarContainer::updateParent(const Point& pos, const Point& parent_pos, flo
 	}
 }
 
-AStarCloseContainer::AStarCloseContainer(unsigned int _map_width, unsigned int _map_height, unsigned int _node_limit)
+AStarCloseContainer::AStarCloseContainer()
 	: size(0)
-	, node_limit(_node_limit)
-	, map_width(_map_width)
-	, map_height(_map_height)
+	, node_limit(0)
 {
-	nodes.resize(node_limit, NULL);
-
-	//initialise the map array. A -1 value will mean there is no node at that position
-	map_pos.resize(map_width);
-	for (unsigned i=0; i<map_width; ++i) {
-		map_pos[i].resize(map_height, -1);
-	}
 }
 
 AStarCloseContainer::~AStarCloseContainer() {
-	for(unsigned int i=0; i<size; i++)
-		delete nodes[i];
-	nodes.clear();
+}
+
+void AStarCloseContainer::resize(unsigned int _map_width, unsigned int _map_height) {
+	map_pos.resize(_map_width, _map_height);
+	size = 0;
+}
+
+void AStarCloseContainer::reset(unsigned int _node_limit) {
+	node_limit = _node_limit;
+	if (nodes.size() < node_limit)
+		nodes.resize(node_limit);
+
+	size = 0;
+	map_pos.nextGeneration();
 }
 
 int AStarCloseContainer::getSize() {
 	return size;
 }
 
-void AStarCloseContainer::add(AStarNode* node) {
+void AStarCloseContainer::add(const AStarNode& node) {
 	if (size >= node_limit) return;
 
 	nodes[size] = node;
-	map_pos[node->getX()][node->getY()] = static_cast<short>(size);
+	map_pos.set(node.getX(), node.getY(), size);
 	size++;
 }
 
 bool AStarCloseContainer::exists(const Point& pos) {
-	return map_pos[pos.x][pos.y] != -1;
+	return map_pos.get(pos.x, pos.y) != -1;
 }
 
 AStarNode* AStarCloseContainer::get(int x, int y) {
-	return nodes[map_pos[x][y]];
+	return &nodes[map_pos.get(x, y)];
 }
 
 AStarNode* AStarCloseContainer::get_shortest_h() {
 	AStarNode *current = NULL;
 	float lowest_score = FLT_MAX;
 	for(unsigned int i = 0; i < size; i++) {
-		if(nodes[i]->getH() < lowest_score) {
-			lowest_score = nodes[i]->getH();
-			current = nodes[i];
+		if(nodes[i].getH() < lowest_score) {
+			lowest_score = nodes[i].getH();
+			current = &nodes[i];
 		}
 	}
 	return current;
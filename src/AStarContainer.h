@@ -22,7 +22,27 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include "AStarNode.h"
 
-typedef std::vector< std::vector<short> > AStar_Grid;
+/* Both containers are meant to live as long as the map they search and to be reused for every path query.
+*  Call resize() when the map size changes and reset() before each search.
+*  Node storage is allocated up front (and only grows when a larger node limit is requested), so a search does not touch the heap.
+*
+*  The position index is a flat [map_width * map_height] array. Instead of clearing it before each search, every entry is stamped with
+*  the generation (search number) that wrote it. Entries with an older stamp are treated as empty.
+*/
+class AStarIndex {
+public:
+	AStarIndex();
+	void resize(unsigned int _map_width, unsigned int _map_height);
+	void nextGeneration();
+	int get(int x, int y) const;
+	void set(int x, int y, int value);
+
+private:
+	unsigned int map_width;
+	unsigned int generation;
+	std::vector<int> map_pos;
+	std::vector<unsigned int> map_gen;
+};
 
 /* Designed to be used for the Open nodes.
 *  Unsuitable for Closed nodes but a close node conatiner is declared below
@@ -31,17 +51,19 @@ typedef std::vector< std::vector<short> > AStar_Grid;
 */
 class AStarContainer {
 public:
-	AStarContainer(unsigned int _map_width, unsigned int _map_height, unsigned int _node_limit);
-	AStarContainer(const AStarContainer&); // copy constructor not yet implemented
-
+	AStarContainer();
 	~AStarContainer();
+
+	void resize(unsigned int _map_width, unsigned int _map_height);
+	void reset(unsigned int _node_limit);
+
 	int getSize();
 	//assumes that the node is not already in the collection
-	void add(AStarNode* node);
+	void add(const AStarNode& node);
 	//assumes that there is at least 1 node in the collection
-	AStarNode* get_shortest_f();
+	const AStarNode& get_shortest_f();
 	//assumes that the node exists in the collection
-	void remove(AStarNode* node);
+	void remove(const Point& pos);
 	bool exists(const Point& pos);
 	//assumes that the node exists in the collection
 	AStarNode* get(int x, int y);
@@ -49,13 +71,13 @@ public:
 	void updateParent(const Point& pos, const Point& parent_pos, float score);
 
 private:
+	void swapNodes(unsigned int a, unsigned int b);
+
 	unsigned int size;
 	unsigned int node_limit;
-	unsigned int map_width;
-	unsigned int map_height;
 
-	/* This is an array of AStarNode pointers. This is the main data for this collection.
-	*  The size of the array is based on the node limit.
+	/* This is an array of AStarNodes. This is the main data for this collection.
+	*  The size of the array is based on the largest node limit seen so far.
 	*
 	*  The nodes in this array are ordered based on their f value and the node with the lowest f value is always at position 0.
 	*  The ordering is not linear, so after positon 0, we cannot assume that position 1 has the second shortest f value.
@@ -72,16 +94,15 @@ private:
 	*  Also note that the code within the article is based on arrays with starting position 1, whereas we use 0 based arrays.
 	*  http://www.policyalmanac.org/games/binaryHeaps.htm
 	*/
-	std::vector<AStarNode*> nodes;
+	std::vector<AStarNode> nodes;
 
-	/* This is a 2d array of shorts ([map_width][map_height]) which acts as an index for the main node array.
-	*  Elements can be accessed using cartesian coordinates e.g. map_pos[x][y]
-	*  To access an AStarNode based on map position use: nodes[map_pos[x][y]]
+	/* This is an index for the main node array.
+	*  To access an AStarNode based on map position use: nodes[map_pos.get(x, y)]
 	*
-	*  The data in this array is initialised as -1, which indicates hat there is no corresponding node for that position
+	*  A -1 value indicates that there is no corresponding node for that position
 	*  This must be maintained when nodes are added, removed and re-ordered in the node array
 	*/
-	AStar_Grid map_pos;
+	AStarIndex map_pos;
 };
 
 /* This class is used to store the closed list of a* nodes
@@ -89,12 +110,14 @@ private:
 */
 class AStarCloseContainer {
 public:
-	AStarCloseContainer(unsigned int _map_width, unsigned int _map_height, unsigned int _node_limit);
-	AStarCloseContainer(const AStarCloseContainer&); // copy constructor not yet implemented
+	AStarCloseContainer();
 	~AStarCloseContainer();
 
+	void resize(unsigned int _map_width, unsigned int _map_height);
+	void reset(unsigned int _node_limit);
+
 	int getSize();
-	void add(AStarNode* node);
+	void add(const AStarNode& node);
 	bool exists(const Point& pos);
 	AStarNode* get(int x, int y);
 	AStarNode* get_shortest_h();
@@ -102,10 +125,8 @@ public:
 private:
 	unsigned int size;
 	unsigned int node_limit;
-	unsigned int map_width;
-	unsigned int map_height;
-	std::vector<AStarNode*> nodes;
-	AStar_Grid map_pos;
+	std::vector<AStarNode> nodes;
+	AStarIndex map_pos;
 
 };
 
@@ -56,51 +56,35 @@ void AStarNode::setParent(const Point& p) {
 	this->parent = p;
 }
 
-std::list<Point> AStarNode::getNeighbours(int limitX, int limitY) const {
-	Point toAdd;
-	std::list<Point> res;
-	if (x>node_stride && y>node_stride) {
-		toAdd.x = x-node_stride;
-		toAdd.y = y-node_stride;
-		res.push_back(toAdd);
-	}
-	if (x>node_stride && (limitY==0 || y<limitY-node_stride)) {
-		toAdd.x = x-node_stride;
-		toAdd.y = y+node_stride;
-		res.push_back(toAdd);
-	}
-	if (y>node_stride && (limitX==0 || x<limitX-node_stride)) {
-		toAdd.x = x+node_stride;
-		toAdd.y = y-node_stride;
-		res.push_back(toAdd);
-	}
-	if ((limitX==0 || x<limitX-node_stride) && (limitY==0 || y<limitY-node_stride)) {
-		toAdd.x = x+node_stride;
-		toAdd.y = y+node_stride;
-		res.push_back(toAdd);
-	}
-	if (x>node_stride) {
-		toAdd.x = x-node_stride;
-		toAdd.y = y;
-		res.push_back(toAdd);
-	}
-	if (y>node_stride) {
-		toAdd.x = x;
-		toAdd.y = y-node_stride;
-		res.push_back(toAdd);
-	}
-	if (limitX==0 || x<limitX-node_stride) {
-		toAdd.x = x+node_stride;
-		toAdd.y = y;
-		res.push_back(toAdd);
-	}
-	if (limitY==0 || y<limitY-node_stride) {
-		toAdd.x = x;
-		toAdd.y = y+node_stride;
-		res.push_back(toAdd);
+int AStarNode::getNeighbours(Point* neighbours, int limitX, int limitY) const {
+	// diagonals first, then straight lines; the order is kept stable so that ties resolve the same way every search
+	static const int offsets[node_max_neighbours][2] = {
+		{-node_stride, -node_stride},
+		{-node_stride, node_stride},
+		{node_stride, -node_stride},
+		{node_stride, node_stride},
+		{-node_stride, 0},
+		{0, -node_stride},
+		{node_stride, 0},
+		{0, node_stride}
+	};
+
+	int count = 0;
+	for (int i = 0; i < node_max_neighbours; ++i) {
+		const int dx = offsets[i][0];
+		const int dy = offsets[i][1];
+
+		if (dx < 0 && x <= node_stride) continue;
+		if (dy < 0 && y <= node_stride) continue;
+		if (dx > 0 && limitX != 0 && x >= limitX-node_stride) continue;
+		if (dy > 0 && limitY != 0 && y >= limitY-node_stride) continue;
+
+		neighbours[count].x = x + dx;
+		neighbours[count].y = y + dy;
+		++count;
 	}
 
-	return res;
+	return count;
 }
 
 
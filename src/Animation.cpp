@@ -31,8 +31,9 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "Animation.h"
 #include "RenderDevice.h"
 
-Animation::Animation(const std::string &_name, const std::string &_type, Image *_sprite, uint8_t _blend_mode, uint8_t _alpha_mod, Color _color_mod)
+Animation::Definition::Definition(const std::string &_name, const std::string &_type, Image *_sprite, uint8_t _blend_mode, uint8_t _alpha_mod, Color _color_mod)
 	: name(_name)
+	, name_id(Utils::internString(_name))
 	, type(	_type == "play_once" ? ANIMTYPE_PLAY_ONCE :
 			_type == "back_forth" ? ANIMTYPE_BACK_FORTH :
 			_type == "looped" ? ANIMTYPE_LOOPED :
@@ -42,28 +43,95 @@ Animation::Animation(const std::string &_name, const std::string &_type, Image *
 	, alpha_mod(_alpha_mod)
 	, color_mod(_color_mod)
 	, number_frames(0)
+	, max_kinds(0)
+	, gfx()
+	, render_offset()
+	, frames()
+	, active_frames()
+	, frame_count(0)
+	, ref_count(1) {
+}
+
+Animation::Animation(const std::string &_name, const std::string &_type, Image *_sprite, uint8_t _blend_mode, uint8_t _alpha_mod, Color _color_mod)
+	: def(new Definition(_name, _type, _sprite, _blend_mode, _alpha_mod, _color_mod))
 	, cur_frame(0)
 	, cur_frame_index(0)
 	, cur_frame_duration(0)
 	, cur_frame_index_f(0)
-	, max_kinds(0)
 	, additional_data(0)
 	, times_played(0)
-	, gfx()
-	, render_offset()
-	, frames()
-	, active_frames()
 	, active_frame_triggered(false)
 	, elapsed_frames(0)
-	, frame_count(0)
 	, speed(1.0f) {
-	if (type == ANIMTYPE_NONE)
+	if (def->type == ANIMTYPE_NONE)
 		Utils::logError("Animation: Type %s is unknown", _type.c_str());
 }
 
+Animation::Animation(const Animation &other)
+	: def(other.def)
+	, cur_frame(other.cur_frame)
+	, cur_frame_index(other.cur_frame_index)
+	, cur_frame_duration(other.cur_frame_duration)
+	, cur_frame_index_f(other.cur_frame_index_f)
+	, additional_data(other.additional_data)
+	, times_played(other.times_played)
+	, active_frame_triggered(other.active_frame_triggered)
+	, elapsed_frames(other.elapsed_frames)
+	, speed(other.speed) {
+	def->ref_count++;
+}
+
+Animation& Animation::operator=(const Animation &other) {
+	if (this == &other)
+		return *this;
+
+	other.def->ref_count++;
+	releaseDefinition();
+	def = other.def;
+
+	cur_frame = other.cur_frame;
+	cur_frame_index = other.cur_frame_index;
+	cur_frame_duration = other.cur_frame_duration;
+	cur_frame_index_f = other.cur_frame_index_f;
+	additional_data = other.additional_data;
+	times_played = other.times_played;
+	active_frame_triggered = other.active_frame_triggered;
+	elapsed_frames = other.elapsed_frames;
+	speed = other.speed;
+
+	return *this;
+}
+
+Animation::~Animation() {
+	releaseDefinition();
+}
+
+void Animation::releaseDefinition() {
+	if (def && --def->ref_count == 0)
+		delete def;
+	def = NULL;
+}
+
+/**
+ * The frame data may only be changed by the Animation that uses it.
+ * If it is shared, this Animation gets its own copy first.
+ */
+Animation::Definition* Animation::getMutableDefinition() {
+	if (def->ref_count > 1) {
+		def->ref_count--;
+		def = new Definition(*def);
+		def->ref_count = 1;
+	}
+	return def;
+}
+
 void Animation::setupUncompressed(const Point& _render_size, const Point& _render_offset, unsigned short _position, unsigned short _frames, unsigned short _duration, unsigned short _maxkinds) {
 	setup(_frames, _duration, _maxkinds);
 
+	const unsigned short max_kinds = def->max_kinds;
+	std::vector<Rect>& gfx = def->gfx;
+	std::vector<Point>& render_offset = def->render_offset;
+
 	for (unsigned short i = 0 ; i < _frames; i++) {
 		int base_index = max_kinds*i;
 		for (unsigned short kind = 0 ; kind < max_kinds; kind++) {
@@ -78,16 +146,18 @@ void Animation::setupUncompressed(const Point& _render_size, const Point& _rende
 }
 
 void Animation::setup(unsigned short _frames, unsigned short _duration, unsigned short _maxkinds) {
-	frame_count = _frames;
+	Definition* d = getMutableDefinition();
 
-	frames.clear();
+	d->frame_count = _frames;
+
+	d->frames.clear();
 
 	if (_frames > 0 && _duration % _frames == 0) {
 		// if we can evenly space frames among the duration, do it
 		const unsigned short divided = _duration/_frames;
 		for (unsigned short i = 0; i < _frames; ++i) {
 			for (unsigned j = 0; j < divided; ++j) {
-				frames.push_back(i);
+				d->frames.push_back(i);
 			}
 		}
 	}
@@ -104,7 +174,7 @@ void Animation::setup(unsigned short _frames, unsigned short _duration, unsigned
 
 		int D = 2*dy - dx;
 
-		frames.push_back(y0);
+		d->frames.push_back(y0);
 
 		int x = x0+1;
 		unsigned short y = y0;
@@ -112,70 +182,71 @@ void Animation::setup(unsigned short _frames, unsigned short _duration, unsigned
 		while (x<=x1) {
 			if (D > 0) {
 				y++;
-				frames.push_back(y);
+				d->frames.push_back(y);
 				D = D + ((2*dy)-(2*dx));
 			}
 			else {
-				frames.push_back(y);
+				d->frames.push_back(y);
 				D = D + (2*dy);
 			}
 			x++;
 		}
 	}
 
-	if (!frames.empty()) number_frames = static_cast<unsigned short>(frames.back()+1);
+	if (!d->frames.empty()) d->number_frames = static_cast<unsigned short>(d->frames.back()+1);
 
-	if (type == ANIMTYPE_PLAY_ONCE) {
+	if (d->type == ANIMTYPE_PLAY_ONCE) {
 		additional_data = 0;
 	}
-	else if (type == ANIMTYPE_LOOPED) {
+	else if (d->type == ANIMTYPE_LOOPED) {
 		additional_data = 0;
 	}
-	else if (type == ANIMTYPE_BACK_FORTH) {
-		number_frames = static_cast<unsigned short>(2 * number_frames);
+	else if (d->type == ANIMTYPE_BACK_FORTH) {
+		d->number_frames = static_cast<unsigned short>(2 * d->number_frames);
 		additional_data = 1;
 	}
 	cur_frame = 0;
 	cur_frame_index = 0;
 	cur_frame_index_f = 0;
-	max_kinds = _maxkinds;
+	d->max_kinds = _maxkinds;
 	times_played = 0;
 
-	active_frames.push_back(static_cast<unsigned short>(number_frames-1)/2);
+	d->active_frames.push_back(static_cast<unsigned short>(d->number_frames-1)/2);
 
-	unsigned i = max_kinds*_frames;
-	gfx.resize(i);
-	render_offset.resize(i);
+	unsigned i = d->max_kinds*_frames;
+	d->gfx.resize(i);
+	d->render_offset.resize(i);
 }
 
 void Animation::addFrame(unsigned short index, unsigned short kind, const Rect& rect, const Point& _render_offset) {
+	Definition* d = getMutableDefinition();
 
-	if (index >= gfx.size()/max_kinds) {
+	if (index >= d->gfx.size()/d->max_kinds) {
 		Utils::logError("Animation: Animation(%s) adding rect(%d, %d, %d, %d) to frame index(%u) out of bounds. must be in [0, %d]",
-				name.c_str(), rect.x, rect.y, rect.w, rect.h, index, static_cast<int>(gfx.size())/max_kinds);
+				d->name.c_str(), rect.x, rect.y, rect.w, rect.h, index, static_cast<int>(d->gfx.size())/d->max_kinds);
 		return;
 	}
-	if (kind > max_kinds-1) {
+	if (kind > d->max_kinds-1) {
 		Utils::logError("Animation: Animation(%s) adding rect(%d, %d, %d, %d) to frame(%u) kind(%u) out of bounds. must be in [0, %d]",
-				name.c_str(), rect.x, rect.y, rect.w, rect.h, index, kind, max_kinds-1);
+				d->name.c_str(), rect.x, rect.y, rect.w, rect.h, index, kind, d->max_kinds-1);
 		return;
 	}
 
-	unsigned i = max_kinds*index+kind;
-	gfx[i] = rect;
-	render_offset[i] = _render_offset;
+	unsigned i = d->max_kinds*index+kind;
+	d->gfx[i] = rect;
+	d->render_offset[i] = _render_offset;
 }
 
 void Animation::advanceFrame() {
-	if (frames.empty()) {
+	if (def->frames.empty()) {
 		cur_frame_index = 0;
 		cur_frame_index_f = 0;
 		times_played++;
 		return;
 	}
 
-	unsigned short last_base_index = static_cast<unsigned short>(frames.size()-1);
-	switch(type) {
+	unsigned short last_base_index = static_cast<unsigned short>(def->frames.size()-1);
+	switch(def->type) {
 		case ANIMTYPE_PLAY_ONCE:
 
 			if (cur_frame_index < last_base_index) {
@@ -226,24 +297,24 @@ void Animation::advanceFrame() {
 	cur_frame_index = std::max<short>(0, cur_frame_index);
 	cur_frame_index = (cur_frame_index > last_base_index ? last_base_index : cur_frame_index);
 
-	if (cur_frame != frames[cur_frame_index]) elapsed_frames++;
-	cur_frame = frames[cur_frame_index];
+	if (cur_frame != def->frames[cur_frame_index]) elapsed_frames++;
+	cur_frame = def->frames[cur_frame_index];
 }
 
 Renderable Animation::getCurrentFrame(int kind) {
 	Renderable r;
-	if (!frames.empty()) {
-		const int index = (max_kinds*frames[cur_frame_index]) + kind;
-		r.src.x = gfx[index].x;
-		r.src.y = gfx[index].y;
-		r.src.w = gfx[index].w;
-		r.src.h = gfx[index].h;
-		r.offset.x = render_offset[index].x;
-		r.offset.y = render_offset[index].y;
-		r.image = sprite;
-		r.blend_mode = blend_mode;
-		r.color_mod = color_mod;
-		r.alpha_mod = alpha_mod;
+	if (!def->frames.empty()) {
+		const int index = (def->max_kinds*def->frames[cur_frame_index]) + kind;
+		r.src.x = def->gfx[index].x;
+		r.src.y = def->gfx[index].y;
+		r.src.w = def->gfx[index].w;
+		r.src.h = def->gfx[index].h;
+		r.offset.x = def->render_offset[index].x;
+		r.offset.y = def->render_offset[index].y;
+		r.image = def->sprite;
+		r.blend_mode = def->blend_mode;
+		r.color_mod = def->color_mod;
+		r.alpha_mod = def->alpha_mod;
 	}
 	return r;
 }
@@ -266,16 +337,16 @@ bool Animation::syncTo(const Animation *other) {
 	additional_data = other->additional_data;
 	elapsed_frames = other->elapsed_frames;
 
-	if (cur_frame_index >= frames.size()) {
-		if (frames.empty()) {
-			Utils::logError("Animation: '%s' animation has no frames, but current frame index is greater than 0.", name.c_str());
+	if (cur_frame_index >= def->frames.size()) {
+		if (def->frames.empty()) {
+			Utils::logError("Animation: '%s' animation has no frames, but current frame index is greater than 0.", def->name.c_str());
 			cur_frame_index = 0;
 			cur_frame_index_f = 0;
 			return false;
 		}
 		else {
-			Utils::logError("Animation: Current frame index (%d) was larger than the last frame index (%d) when syncing '%s' animation.", cur_frame_index, frames.size()-1, name.c_str());
-			cur_frame_index = static_cast<unsigned short>(frames.size()-1);
+			Utils::logError("Animation: Current frame index (%d) was larger than the last frame index (%d) when syncing '%s' animation.", cur_frame_index, def->frames.size()-1, def->name.c_str());
+			cur_frame_index = static_cast<unsigned short>(def->frames.size()-1);
 			cur_frame_index_f = cur_frame_index;
 			return false;
 		}
@@ -285,25 +356,27 @@ bool Animation::syncTo(const Animation *other) {
 }
 
 void Animation::setActiveFrames(const std::vector<short> &_active_frames) {
+	Definition* d = getMutableDefinition();
+
 	if (_active_frames.size() == 1 && _active_frames[0] == -1) {
-		active_frames.clear();
-		for (unsigned short i = 0; i < number_frames; ++i)
-			active_frames.push_back(i);
+		d->active_frames.clear();
+		for (unsigned short i = 0; i < d->number_frames; ++i)
+			d->active_frames.push_back(i);
 	}
 	else {
-		active_frames = std::vector<short>(_active_frames);
+		d->active_frames = std::vector<short>(_active_frames);
 	}
 
 	// verify that each active frame is not out of bounds
 	// this works under the assumption that frames are not dropped from the middle of animations
 	// if an animation has too many frames to display in a specified duration, they are dropped from the end of the frame list
-	bool have_last_frame = std::find(active_frames.begin(), active_frames.end(), number_frames-1) != active_frames.end();
-	for (unsigned i=0; i<active_frames.size(); ++i) {
-		if (active_frames[i] >= number_frames) {
+	bool have_last_frame = std::find(d->active_frames.begin(), d->active_frames.end(), d->number_frames-1) != d->active_frames.end();
+	for (unsigned i=0; i<d->active_frames.size(); ++i) {
+		if (d->active_frames[i] >= d->number_frames) {
 			if (have_last_frame)
-				active_frames.erase(active_frames.begin()+i);
+				d->active_frames.erase(d->active_frames.begin()+i);
 			else {
-				active_frames[i] = static_cast<short>(number_frames-1);
+				d->active_frames[i] = static_cast<short>(d->number_frames-1);
 				have_last_frame = true;
 			}
 		}
@@ -315,67 +388,79 @@ bool Animation::isFirstFrame() {
 }
 
 bool Animation::isLastFrame() {
-	return cur_frame_index == static_cast<short>(getLastFrameIndex(static_cast<short>(number_frames-1)));
+	return cur_frame_index == static_cast<short>(getLastFrameIndex(static_cast<short>(def->number_frames-1)));
 }
 
 bool Animation::isSecondLastFrame() {
-	return cur_frame_index == static_cast<short>(getLastFrameIndex(static_cast<short>(number_frames-2)));
+	return cur_frame_index == static_cast<short>(getLastFrameIndex(static_cast<short>(def->number_frames-2)));
 }
 
 bool Animation::isActiveFrame() {
-	if (type == ANIMTYPE_BACK_FORTH) {
-		if (std::find(active_frames.begin(), active_frames.end(), elapsed_frames) != active_frames.end())
+	if (def->type == ANIMTYPE_BACK_FORTH) {
+		if (std::find(def->active_frames.begin(), def->active_frames.end(), elapsed_frames) != def->active_frames.end())
 			return cur_frame_index == getLastFrameIndex(cur_frame);
 	}
 	else {
-		if (std::find(active_frames.begin(), active_frames.end(), cur_frame) != active_frames.end()) {
+		if (std::find(def->active_frames.begin(), def->active_frames.end(), cur_frame) != def->active_frames.end()) {
 			if (cur_frame_index == getLastFrameIndex(cur_frame)) {
-				if (type == ANIMTYPE_PLAY_ONCE)
+				if (def->type == ANIMTYPE_PLAY_ONCE)
 					active_frame_triggered = true;
 
 				return true;
 			}
 		}
 	}
-	return (isLastFrame() && type == ANIMTYPE_PLAY_ONCE && !active_frame_triggered && !active_frames.empty());
+	return (isLastFrame() && def->type == ANIMTYPE_PLAY_ONCE && !active_frame_triggered && !def->active_frames.empty());
 }
 
 int Animation::getTimesPlayed() {
 	return times_played;
 }
 
-std::string Animation::getName() {
-	return name;
+const std::string& Animation::getName() const {
+	return def->name;
+}
+
+StringID Animation::getNameID() const {
+	return def->name_id;
 }
 
 int Animation::getDuration() {
-	return static_cast<int>(static_cast<float>(frames.size()) / speed);
+	return static_cast<int>(static_cast<float>(def->frames.size()) / speed);
 }
 
 bool Animation::isCompleted() {
-	return (type == ANIMTYPE_PLAY_ONCE && times_played > 0);
+	return (def->type == ANIMTYPE_PLAY_ONCE && times_played > 0);
 }
 
 unsigned short Animation::getLastFrameIndex(const short &frame) {
-	if (frames.empty() || frame < 0) return 0;
+	if (def->frames.empty() || frame < 0) return 0;
 
-	if (type == ANIMTYPE_BACK_FORTH && additional_data == -1) {
+	if (def->type == ANIMTYPE_BACK_FORTH && additional_data == -1) {
 		// since the animation is advancing backwards here, the first frame index is actually the last
-		for (unsigned short i=0; i<frames.size(); i++) {
-			if (frames[i] == frame) return i;
+		for (unsigned short i=0; i<def->frames.size(); i++) {
+			if (def->frames[i] == frame) return i;
 		}
 		return 0;
 	}
 	else {
 		// normal animation
-		for (size_t i=frames.size(); i>0; i--) {
-			if (frames[i-1] == frame)
+		for (size_t i=def->frames.size(); i>0; i--) {
+			if (def->frames[i-1] == frame)
 				return static_cast<unsigned short>(i-1);
 		}
-		return static_cast<unsigned short>(frames.size()-1);
+		return static_cast<unsigned short>(def->frames.size()-1);
 	}
 }
 
 void Animation::setSpeed(float val) {
 	speed = val / 100.0f;
 }
+
+size_t Animation::getDefinitionSize() const {
+	return sizeof(Definition) + def->name.capacity()
+		+ def->gfx.capacity() * sizeof(Rect)
+		+ def->render_offset.capacity() * sizeof(Point)
+		+ def->frames.capacity() * sizeof(unsigned short)
+		+ def->active_frames.capacity() * sizeof(short);
+}
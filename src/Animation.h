@@ -26,6 +26,9 @@ FLARE.  If not, see http://www.gnu.org/licenses/
  *
  * The intention with the class is to keep it as flexible as possible so that the animations
  * can be used not only for character animations but any animated in-game objects.
+ *
+ * The frame data is kept in a reference counted Definition, so copying an Animation only
+ * copies its playback state.
  */
 
 #ifndef ANIMATION_H
@@ -36,24 +39,57 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 class Animation {
 protected:
+	enum {
+		ANIMTYPE_NONE       = 0,
+		ANIMTYPE_PLAY_ONCE  = 1, // just iterates over the images one time. it holds the final image when finished.
+		ANIMTYPE_LOOPED     = 2, // going over the images again and again.
+		ANIMTYPE_BACK_FORTH = 3  // iterate from index=0 to maxframe and back again. keeps holding the first image afterwards.
+	};
+
+	// The parts of an animation that don't change while it is playing.
+	// Copies of an Animation share one Definition, so that each entity only carries its playback state.
+	class Definition {
+	public:
+		Definition(const std::string &_name, const std::string &_type, Image *_sprite, uint8_t _blend_mode, uint8_t _alpha_mod, Color _color_mod);
+
+		const std::string name;
+		const StringID name_id;
+		const int type;
+		Image *sprite;
+		uint8_t blend_mode;
+		uint8_t alpha_mod;
+		Color color_mod;
+
+		unsigned short number_frames; // how many ticks this animation lasts.
+		unsigned short max_kinds;
+
+		// Frame data, all vectors must have the same length:
+		// These are indexed as 8*cur_frame_index + direction.
+		std::vector<Rect> gfx; // position on the spritesheet to be used.
+		std::vector<Point> render_offset; // "virtual point on the floor"
+		std::vector<unsigned short> frames; // a list of frames to play on each tick
+
+		std::vector<short> active_frames;	// which of the visible diffferent frames are active?
+		// This should contain indexes of the gfx vector.
+		// Assume it is sorted, one index occurs at max once.
+
+		unsigned frame_count; // the frame count as it appears in the data files (i.e. not converted to engine frames)
+
+		unsigned ref_count; // number of Animations using this definition
+	};
+
 	unsigned short getLastFrameIndex(const short &frame); // given a frame, gets the last index of frames that matches
+	Definition* getMutableDefinition();
+	void releaseDefinition();
 
-	const std::string name;
-	const int type;
-	Image *sprite;
-	uint8_t blend_mode;
-	uint8_t alpha_mod;
-	Color color_mod;
+	Definition* def;
 
-	unsigned short number_frames; // how many ticks this animation lasts.
 	unsigned short cur_frame;     // counts up until reaching number_frames.
 
 	unsigned short cur_frame_index; // which frame in this animation is currently being displayed? range: 0..gfx.size()-1
 	unsigned short cur_frame_duration;  // how many ticks is the current image being displayed yet? range: 0..duration[cur_frame]-1
 	float cur_frame_index_f; // more granular control over cur_frame_index
 
-	unsigned short max_kinds;
-
 	short additional_data;  // additional state depending on type:
 	// if type == BACK_FORTH then it is 1 for advancing, and -1 for going back, 0 at the end
 	// if type == LOOPED, then it is the number of loops to be played.
@@ -61,32 +97,17 @@ protected:
 
 	short times_played; // how often this animation was played (loop counter for type LOOPED)
 
-	// Frame data, all vectors must have the same length:
-	// These are indexed as 8*cur_frame_index + direction.
-	std::vector<Rect> gfx; // position on the spritesheet to be used.
-	std::vector<Point> render_offset; // "virtual point on the floor"
-	std::vector<unsigned short> frames; // a list of frames to play on each tick
-
-	std::vector<short> active_frames;	// which of the visible diffferent frames are active?
-	// This should contain indexes of the gfx vector.
-	// Assume it is sorted, one index occurs at max once.
 	bool active_frame_triggered;
 
 	unsigned short elapsed_frames; // counts the total number of frames for back-forth animations
 
-	unsigned frame_count; // the frame count as it appears in the data files (i.e. not converted to engine frames)
-
 	float speed; // how fast the animation plays
 
-	enum {
-		ANIMTYPE_NONE       = 0,
-		ANIMTYPE_PLAY_ONCE  = 1, // just iterates over the images one time. it holds the final image when finished.
-		ANIMTYPE_LOOPED     = 2, // going over the images again and again.
-		ANIMTYPE_BACK_FORTH = 3  // iterate from index=0 to maxframe and back again. keeps holding the first image afterwards.
-	};
-
 public:
 	Animation(const std::string &_name, const std::string &_type, Image *_sprite, uint8_t _blend_mode, uint8_t _alpha_mod, Color _color_mod);
+	Animation(const Animation &other);
+	Animation& operator=(const Animation &other);
+	~Animation();
 
 	// Traditional way to create an animation.
 	// The frames are stored in a grid like fashion, so the individual frame
@@ -127,7 +148,8 @@ public:
 	// resets to beginning of the animation
 	void reset();
 
-	std::string getName();
+	const std::string& getName() const;
+	StringID getNameID() const;
 	int getDuration();
 
 	// a vector of indexes of gfx passed into.
@@ -136,9 +158,12 @@ public:
 
 	bool isCompleted();
 
-	unsigned getFrameCount() { return frame_count; }
+	unsigned getFrameCount() { return def->frame_count; }
 
 	void setSpeed(float val);
+
+	// memory used by the frame data, which is shared by all copies of this animation
+	size_t getDefinitionSize() const;
 };
 
 #endif
@@ -30,15 +30,25 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include <cassert>
 
+Animation *AnimationSet::findAnimation(StringID _name) {
+	std::map<StringID, size_t>::const_iterator it = animation_ids.find(_name);
+	if (it == animation_ids.end())
+		return NULL;
+	return animations[it->second];
+}
+
 Animation *AnimationSet::getAnimation(const std::string &_name) {
+	return getAnimation(Utils::internString(_name));
+}
+
+Animation *AnimationSet::getAnimation(StringID _name) {
 	if (!loaded)
 		load();
 
-	if (!_name.empty()) {
-		for (size_t i = 0; i < animations.size(); i++) {
-			if (animations[i]->getName() == _name)
-				return new Animation(*animations[i]);
-		}
+	if (_name != 0) {
+		Animation *a = findAnimation(_name);
+		if (a)
+			return new Animation(*a);
 	}
 
 	return new Animation(*defaultAnimation);
@@ -47,9 +57,10 @@ Animation *AnimationSet::getAnimation(const std::string &_name) {
 unsigned AnimationSet::getAnimationFrames(const std::string &_name) {
 	if (!loaded)
 		load();
-	for (size_t i = 0; i < animations.size(); i++)
-		if (animations[i]->getName() == _name)
-			return animations[i]->getFrameCount();
+
+	Animation *a = findAnimation(Utils::internString(_name));
+	if (a)
+		return a->getFrameCount();
 	return 0;
 }
 
@@ -238,6 +249,11 @@ void AnimationSet::load() {
 		animations.push_back(a);
 	}
 
+	// if an animation is defined more than once, the first one is used
+	for (size_t i = animations.size(); i > 0; --i) {
+		animation_ids[animations[i-1]->getNameID()] = i-1;
+	}
+
 	if (starting_animation != "") {
 		Animation *a = getAnimation(starting_animation);
 		delete defaultAnimation;
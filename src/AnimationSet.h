@@ -21,6 +21,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #define ANIMATION_SET_H
 
 #include "CommonIncludes.h"
+#include "Utils.h"
 
 class Animation;
 
@@ -37,8 +38,10 @@ private:
 	Animation *defaultAnimation; // has always a non-null animation, in case of successfull load it contains the first animation in the animation file.
 	bool loaded;
 	AnimationSet *parent;
+	std::map<StringID, size_t> animation_ids; // animation name -> index in animations
 
 	void load();
+	Animation *findAnimation(StringID _name);
 	unsigned getAnimationFrames(const std::string &_name);
 
 public:
@@ -55,8 +58,10 @@ public:
 	 * callee is responsible to free the returned animation.
 	 * Returns the animation specified by \a name. If that animation is not found
 	 * a default animation is returned.
+	 * The returned animation shares its frame data with this set, so it is cheap to create.
 	 */
 	Animation *getAnimation(const std::string &name);
+	Animation *getAnimation(StringID name);
 
 	const std::string &getName() {
 		return name;
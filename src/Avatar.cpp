@@ -58,6 +58,7 @@ Avatar::Avatar()
 	: Entity()
 	, attack_cursor(false)
 	, mm_key(settings->mouse_move_swap ? Input::MAIN2 : Input::MAIN1)
+	, attack_anim(0)
 	, hero_stats(NULL)
 	, charmed_stats(NULL)
 	, act_target()
@@ -240,8 +241,8 @@ void Avatar::loadGraphics(std::vector<Layer_gfx> _img_gfx) {
 			anim->increaseCount(name);
 			animsets.push_back(anim->getAnimationSet(name));
 			animsets.back()->setParent(animationSet);
-			anims.push_back(animsets.back()->getAnimation(activeAnimation->getName()));
-			setAnimation("stance");
+			anims.push_back(animsets.back()->getAnimation(activeAnimation->getNameID()));
+			setAnimation(ANIM_STANCE);
 			if(!anims.back()->syncTo(activeAnimation)) {
 				Utils::logError("Avatar: Error syncing animation in '%s' to 'animations/hero.txt'.", animsets.back()->getName().c_str());
 			}
@@ -344,6 +345,8 @@ void Avatar::set_direction() {
  * @param npc True if the player is talking to an NPC. Can limit ability to move/attack in certain conditions
  */
 void Avatar::logic(std::vector<ActionData> &action_queue, bool restrict_power_use) {
+	stats.prev_pos = stats.pos;
+
 	// clear current space to allow correct movement
 	mapr->collider.unblock(stats.pos.x, stats.pos.y);
 
@@ -441,7 +444,7 @@ void Avatar::logic(std::vector<ActionData> &action_queue, bool restrict_power_us
 		switch(stats.cur_state) {
 			case StatBlock::AVATAR_STANCE:
 
-				setAnimation("stance");
+				setAnimation(ANIM_STANCE);
 
 				// allowed to move or use powers?
 				if (settings->mouse_move) {
@@ -481,7 +484,7 @@ void Avatar::logic(std::vector<ActionData> &action_queue, bool restrict_power_us
 
 			case StatBlock::AVATAR_RUN:
 
-				setAnimation("run");
+				setAnimation(ANIM_RUN);
 
 				if (!sound_steps.empty()) {
 					int stepfx = rand() % static_cast<int>(sound_steps.size());
@@ -508,7 +511,7 @@ void Avatar::logic(std::vector<ActionData> &action_queue, bool restrict_power_us
 					break;
 				}
 
-				if (activeAnimation->getName() != "run")
+				if (activeAnimation->getNameID() != ANIM_RUN)
 					stats.cur_state = StatBlock::AVATAR_STANCE;
 
 				if (settings->mouse_move && settings->mouse_move_attack && cursor_enemy && mm_can_use_power && powers->checkCombatRange(mm_attack_id, &stats, cursor_enemy->stats.pos)) {
@@ -547,7 +550,7 @@ void Avatar::logic(std::vector<ActionData> &action_queue, bool restrict_power_us
 				}
 
 				// animation is done, switch back to normal stance
-				if ((activeAnimation->isLastFrame() && stats.state_timer.isEnd()) || activeAnimation->getName() != attack_anim) {
+				if ((activeAnimation->isLastFrame() && stats.state_timer.isEnd()) || activeAnimation->getNameID() != attack_anim) {
 					stats.cur_state = StatBlock::AVATAR_STANCE;
 					stats.cooldown.reset(Timer::BEGIN);
 					allowed_to_use_power = false;
@@ -565,7 +568,7 @@ void Avatar::logic(std::vector<ActionData> &action_queue, bool restrict_power_us
 
 			case StatBlock::AVATAR_BLOCK:
 
-				setAnimation("block");
+				setAnimation(ANIM_BLOCK);
 
 				stats.blocking = false;
 
@@ -573,7 +576,7 @@ void Avatar::logic(std::vector<ActionData> &action_queue, bool restrict_power_us
 
 			case StatBlock::AVATAR_HIT:
 
-				setAnimation("hit");
+				setAnimation(ANIM_HIT);
 
 				if (activeAnimation->isFirstFrame()) {
 					stats.effects.triggered_hit = true;
@@ -584,7 +587,7 @@ void Avatar::logic(std::vector<ActionData> &action_queue, bool restrict_power_us
 					}
 				}
 
-				if (activeAnimation->getTimesPlayed() >= 1 || activeAnimation->getName() != "hit") {
+				if (activeAnimation->getTimesPlayed() >= 1 || activeAnimation->getNameID() != ANIM_HIT) {
 					stats.cur_state = StatBlock::AVATAR_STANCE;
 					if (settings->mouse_move) {
 						drag_walking = true;
@@ -603,7 +606,7 @@ void Avatar::logic(std::vector<ActionData> &action_queue, bool restrict_power_us
 					untransform();
 				}
 
-				setAnimation("die");
+				setAnimation(ANIM_DIE);
 
 				if (!stats.corpse && activeAnimation->isFirstFrame() && activeAnimation->getTimesPlayed() < 1) {
 					stats.effects.clearEffects();
@@ -639,7 +642,7 @@ void Avatar::logic(std::vector<ActionData> &action_queue, bool restrict_power_us
 						inpt->lock[Input::MAIN1] = true;
 				}
 
-				if (activeAnimation->getTimesPlayed() >= 1 || activeAnimation->getName() != "die") {
+				if (activeAnimation->getTimesPlayed() >= 1 || activeAnimation->getNameID() != ANIM_DIE) {
 					stats.corpse = true;
 				}
 
@@ -921,7 +924,7 @@ void Avatar::untransform() {
 
 	// This is a bit of a hack.
 	// In order to switch to the stance animation, we can't already be in a stance animation
-	setAnimation("run");
+	setAnimation(ANIM_RUN);
 
 	for (int i=0; i<Stats::COUNT; ++i) {
 		stats.starting[i] = hero_stats->starting[i];
@@ -951,8 +954,8 @@ void Avatar::checkTransform() {
 		untransform();
 }
 
-void Avatar::setAnimation(std::string name) {
-	if (name == activeAnimation->getName())
+void Avatar::setAnimation(StringID name) {
+	if (name == activeAnimation->getNameID())
 		return;
 
 	Entity::setAnimation(name);
@@ -978,7 +981,7 @@ void Avatar::addRenders(std::vector<Renderable> &r) {
 			unsigned index = layer_def[stats.direction][i];
 			if (anims[index]) {
 				Renderable ren = anims[index]->getCurrentFrame(stats.direction);
-				ren.map_pos = stats.pos;
+				ren.map_pos = Utils::interpolate(stats.prev_pos, stats.pos);
 				ren.prio = i+1;
 				stats.effects.getCurrentColor(ren.color_mod);
 				stats.effects.getCurrentAlpha(ren.alpha_mod);
@@ -991,7 +994,7 @@ void Avatar::addRenders(std::vector<Renderable> &r) {
 	}
 	else {
 		Renderable ren = activeAnimation->getCurrentFrame(stats.direction);
-		ren.map_pos = stats.pos;
+		ren.map_pos = Utils::interpolate(stats.prev_pos, stats.pos);
 		stats.effects.getCurrentColor(ren.color_mod);
 		stats.effects.getCurrentAlpha(ren.alpha_mod);
 		if (stats.hp > 0) {
@@ -1003,7 +1006,7 @@ void Avatar::addRenders(std::vector<Renderable> &r) {
 	for (unsigned i = 0; i < stats.effects.effect_list.size(); ++i) {
 		if (stats.effects.effect_list[i].animation && !stats.effects.effect_list[i].animation->isCompleted()) {
 			Renderable ren = stats.effects.effect_list[i].animation->getCurrentFrame(0);
-			ren.map_pos = stats.pos;
+			ren.map_pos = Utils::interpolate(stats.prev_pos, stats.pos);
 			if (stats.effects.effect_list[i].render_above) ren.prio = layer_def[stats.direction].size()+1;
 			else ren.prio = 0;
 			r.push_back(ren);
@@ -63,7 +63,7 @@ private:
 	void set_direction();
 	void transform();
 	void untransform();
-	void setAnimation(std::string name);
+	void setAnimation(StringID name);
 
 
 	std::vector<Step_sfx> step_def;
@@ -122,7 +122,7 @@ public:
 
 	std::queue<std::pair<std::string, int> > log_msg;
 
-	std::string attack_anim;
+	StringID attack_anim;
 	bool setPowers;
 	bool revertPowers;
 	int untransform_power;
@@ -361,8 +361,17 @@ void BehaviorStandard::checkMove() {
 		turn_timer.tick();
 		if (turn_timer.isEnd()) {
 
+			bool has_movement = mapr->collider.lineOfMovement(e->stats.pos.x, e->stats.pos.y, pursue_pos.x, pursue_pos.y, e->stats.movement_type);
+			bool pursuing_hero = e->stats.in_combat && !fleeing && pursue_pos.x == pc->stats.pos.x && pursue_pos.y == pc->stats.pos.y;
+			FPoint flow_step;
+
+			// if blocked while chasing the hero, follow the shared flow field instead of searching for a path
+			if (!has_movement && pursuing_hero && mapr->collider.flow_field.getNextStep(e->stats.pos, e->stats.movement_type, flow_step)) {
+				path.clear();
+				pursue_pos = flow_step;
+			}
 			// if blocked, face in pathfinder direction instead
-			if (!mapr->collider.lineOfMovement(e->stats.pos.x, e->stats.pos.y, pursue_pos.x, pursue_pos.y, e->stats.movement_type)) {
+			else if (!has_movement) {
 
 				// if a path is returned, target first waypoint
 
@@ -562,12 +571,12 @@ void BehaviorStandard::updateState() {
 
 		case StatBlock::ENEMY_STANCE:
 
-			e->setAnimation("stance");
+			e->setAnimation(Entity::ANIM_STANCE);
 			break;
 
 		case StatBlock::ENEMY_MOVE:
 
-			e->setAnimation("run");
+			e->setAnimation(Entity::ANIM_RUN);
 			break;
 
 		case StatBlock::ENEMY_POWER:
@@ -627,7 +636,7 @@ void BehaviorStandard::updateState() {
 
 			// animation is finished
 			if ((e->activeAnimation->isLastFrame() && e->stats.state_timer.isEnd()) ||
-			    (power_state == Power::STATE_ATTACK && e->activeAnimation->getName() != powers->powers[power_id].attack_anim) ||
+			    (power_state == Power::STATE_ATTACK && e->activeAnimation->getNameID() != powers->powers[power_id].attack_anim) ||
 			    e->instant_power)
 			{
 				if (!e->instant_power)
@@ -643,32 +652,32 @@ void BehaviorStandard::updateState() {
 
 		case StatBlock::ENEMY_SPAWN:
 
-			e->setAnimation("spawn");
+			e->setAnimation(Entity::ANIM_SPAWN);
 			//the second check is needed in case the entity does not have a spawn animation
-			if (e->activeAnimation->isLastFrame() || e->activeAnimation->getName() != "spawn") {
+			if (e->activeAnimation->isLastFrame() || e->activeAnimation->getNameID() != Entity::ANIM_SPAWN) {
 				e->stats.cur_state = StatBlock::ENEMY_STANCE;
 			}
 			break;
 
 		case StatBlock::ENEMY_BLOCK:
 
-			e->setAnimation("block");
+			e->setAnimation(Entity::ANIM_BLOCK);
 			break;
 
 		case StatBlock::ENEMY_HIT:
 
-			e->setAnimation("hit");
+			e->setAnimation(Entity::ANIM_HIT);
 			if (e->activeAnimation->isFirstFrame()) {
 				e->stats.effects.triggered_hit = true;
 			}
-			if (e->activeAnimation->isLastFrame() || e->activeAnimation->getName() != "hit")
+			if (e->activeAnimation->isLastFrame() || e->activeAnimation->getNameID() != Entity::ANIM_HIT)
 				e->stats.cur_state = StatBlock::ENEMY_STANCE;
 			break;
 
 		case StatBlock::ENEMY_DEAD:
 			if (e->stats.effects.triggered_death) break;
 
-			e->setAnimation("die");
+			e->setAnimation(Entity::ANIM_DIE);
 			if (e->activeAnimation->isFirstFrame()) {
 				e->playSound(Entity::SOUND_DIE);
 				e->stats.corpse_timer.setDuration(eset->misc.corpse_timeout);
@@ -680,7 +689,7 @@ void BehaviorStandard::updateState() {
 
 				e->stats.effects.clearEffects();
 			}
-			if (e->activeAnimation->isLastFrame() || e->activeAnimation->getName() != "die") {
+			if (e->activeAnimation->isLastFrame() || e->activeAnimation->getNameID() != Entity::ANIM_DIE) {
 				// puts renderable under object layer
 				e->stats.corpse = true;
 
@@ -700,7 +709,7 @@ void BehaviorStandard::updateState() {
 
 		case StatBlock::ENEMY_CRITDEAD:
 
-			e->setAnimation("critdie");
+			e->setAnimation(Entity::ANIM_CRITDIE);
 			if (e->activeAnimation->isFirstFrame()) {
 				e->playSound(Entity::SOUND_CRITDIE);
 				e->stats.corpse_timer.setDuration(eset->misc.corpse_timeout);
@@ -712,7 +721,7 @@ void BehaviorStandard::updateState() {
 
 				e->stats.effects.clearEffects();
 			}
-			if (e->activeAnimation->isLastFrame() || e->activeAnimation->getName() != "critdie") {
+			if (e->activeAnimation->isLastFrame() || e->activeAnimation->getNameID() != Entity::ANIM_CRITDIE) {
 				// puts renderable under object layer
 				e->stats.corpse = true;
 
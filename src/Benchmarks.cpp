@@ -0,0 +1,984 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class Benchmarks
+ */
+
+#include "Animation.h"
+#include "AnimationSet.h"
+#include "Avatar.h"
+#include "Benchmarks.h"
+#include "Enemy.h"
+#include "EnemyManager.h"
+#include "EngineSettings.h"
+#include "FontEngine.h"
+#include "Hazard.h"
+#include "HazardManager.h"
+#include "MapCompiler.h"
+#include "MapRenderer.h"
+#include "Menu.h"
+#include "MenuInventory.h"
+#include "MenuManager.h"
+#include "MessageEngine.h"
+#include "ModManager.h"
+#include "PowerManager.h"
+#include "RenderDevice.h"
+#include "Settings.h"
+#include "SharedGameResources.h"
+#include "SharedResources.h"
+#include "UtilsFileSystem.h"
+#include "UtilsMath.h"
+#include "UtilsParsing.h"
+#include "Widget.h"
+#include "WidgetLog.h"
+#include "WidgetTooltip.h"
+
+#include <new>
+#include <stdlib.h>
+
+namespace {
+// allocations made so far by any thread, so a count is only exact while other threads are idle
+unsigned long allocation_count = 0;
+}
+
+/**
+ * The global operator new is replaced to count allocations. This is one reason why the benchmarks
+ * are not part of normal builds.
+ */
+void* operator new(size_t size) throw(std::bad_alloc) {
+	allocation_count++;
+	void* ptr = malloc(size > 0 ? size : 1);
+	if (!ptr)
+		abort();
+	return ptr;
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc) {
+	return operator new(size);
+}
+
+void operator delete(void* ptr) throw() {
+	free(ptr);
+}
+
+void operator delete[](void* ptr) throw() {
+	free(ptr);
+}
+
+Benchmarks::Stopwatch::Stopwatch()
+	: start_ticks(SDL_GetPerformanceCounter())
+	, start_allocations(allocation_count)
+{
+}
+
+void Benchmarks::Stopwatch::restart() {
+	start_ticks = SDL_GetPerformanceCounter();
+	start_allocations = allocation_count;
+}
+
+float Benchmarks::Stopwatch::getSeconds() const {
+	return static_cast<float>(SDL_GetPerformanceCounter() - start_ticks) / static_cast<float>(SDL_GetPerformanceFrequency());
+}
+
+unsigned long Benchmarks::Stopwatch::getAllocations() const {
+	return allocation_count - start_allocations;
+}
+
+Benchmarks::Benchmarks(WidgetLog* _log)
+	: log(_log)
+{
+}
+
+void Benchmarks::addHelp() {
+	log->add("bench_effects - " + msg->get("runs the effect logic of a crowd of entities with 10 effects each, adding the effects that run out again"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_ids - " + msg->get("looks up effects and animations of a crowd of enemies by interned id and by name"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_hazards - " + msg->get("keeps a number of missiles flying for a number of frames and reports the hazard updates per second"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_stats - " + msg->get("updates the stats of a crowd of enemies with effects, with a full and an incremental calculation"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_anim - " + msg->get("plays and switches the player and enemy animations for a crowd of entities and reports the memory used"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_text - " + msg->get("creates combat text and item tooltip images with and without the glyph atlas"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_mods - " + msg->get("repeats all file lookups made since startup with and without the mod file index"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_map_load - " + msg->get("loads every map as text and as compiled map (see --compile-maps) and compares the load times"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_chunks - " + msg->get("renders the current map for a number of frames with and without pre-rendered map chunks"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_render - " + msg->get("renders the current map for a number of frames with and without sprite batching"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_collision - " + msg->get("times random line of sight and position checks and a pass over every map layer"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_pursuit - " + msg->get("compares individual path searches and the shared flow field for enemies chasing the player"), WidgetLog::MSG_UNIQUE);
+	log->add("bench_path - " + msg->get("runs a number of random path searches on the current map and compares the plain and hierarchical search rates"), WidgetLog::MSG_UNIQUE);
+}
+
+/**
+ * Returns false if the command isn't a benchmark
+ */
+bool Benchmarks::execute(const std::vector<std::string>& args) {
+	if (args.empty())
+		return false;
+
+	if (args[0] == "bench_effects")
+		benchEffects(getCount(args, 500));
+	else if (args[0] == "bench_ids")
+		benchIDs(getCount(args, 300));
+	else if (args[0] == "bench_hazards")
+		benchHazards(getCount(args, 2000));
+	else if (args[0] == "bench_stats")
+		benchStats(getCount(args, 300));
+	else if (args[0] == "bench_anim")
+		benchAnim(getCount(args, 500));
+	else if (args[0] == "bench_text")
+		benchText(getCount(args, 10));
+	else if (args[0] == "bench_mods")
+		benchMods(getCount(args, 5));
+	else if (args[0] == "bench_map_load")
+		benchMapLoad(getCount(args, 5));
+	else if (args[0] == "bench_chunks")
+		benchChunks(getCount(args, 100));
+	else if (args[0] == "bench_render")
+		benchRender(getCount(args, 100));
+	else if (args[0] == "bench_collision")
+		benchCollision(getCount(args, 10000));
+	else if (args[0] == "bench_pursuit")
+		benchPursuit(getCount(args, 200));
+	else if (args[0] == "bench_path")
+		benchPath(getCount(args, 1000));
+	else
+		return false;
+
+	return true;
+}
+
+/**
+ * The optional first argument of a benchmark: the number of queries, entities or frames
+ */
+int Benchmarks::getCount(const std::vector<std::string>& args, int default_count) {
+	return (args.size() > 1) ? Parse::toInt(args[1]) : default_count;
+}
+
+/**
+ * Milliseconds per run, for seconds measured over count runs
+ */
+std::string Benchmarks::getMS(float seconds, int count) {
+	return Utils::floatToString(seconds * 1000.f / static_cast<float>(std::max(count, 1)), 3) + " ms";
+}
+
+void Benchmarks::print(const std::stringstream& ss) {
+	log->add(ss.str(), WidgetLog::MSG_NORMAL);
+	Utils::logInfo("%s", ss.str().c_str());
+}
+
+void Benchmarks::benchPath(int count) {
+	MapCollision& collider = mapr->collider;
+	if (count <= 0 || collider.map_size.x <= 0 || collider.map_size.y <= 0)
+		return;
+
+	// gather the start/end points first so that only the searches are timed
+	std::vector<FPoint> points;
+	int attempts = count * 100;
+	while (static_cast<int>(points.size()) < count * 2 && attempts > 0) {
+		FPoint p(static_cast<float>(rand() % collider.map_size.x) + 0.5f, static_cast<float>(rand() % collider.map_size.y) + 0.5f);
+		if (collider.isValidPosition(p.x, p.y, MapCollision::MOVE_NORMAL, MapCollision::COLLIDE_NORMAL))
+			points.push_back(p);
+		attempts--;
+	}
+
+	if (points.size() < 2)
+		return;
+
+	// run the same queries with both the plain and the hierarchical search
+	bool prev_hierarchical = collider.isHierarchicalPathfinding();
+
+	for (int mode = 0; mode < 2; ++mode) {
+		Stopwatch build_stopwatch;
+		collider.setHierarchicalPathfinding(mode == 1);
+		float build_seconds = build_stopwatch.getSeconds();
+
+		std::vector<FPoint> path;
+		int queries = 0;
+		int found = 0;
+		size_t path_nodes = 0;
+
+		Stopwatch stopwatch;
+		for (size_t i = 0; i+1 < points.size(); i += 2) {
+			if (collider.computePath(points[i], points[i+1], path, MapCollision::MOVE_NORMAL, MapCollision::DEFAULT_PATH_LIMIT))
+				found++;
+			path_nodes += path.size();
+			queries++;
+		}
+		float seconds = stopwatch.getSeconds();
+		unsigned long allocations = stopwatch.getAllocations();
+
+		std::stringstream ss;
+		ss << "bench_path (" << (mode == 1 ? "hierarchical" : "a*") << "): " << queries << " queries, " << found << " paths, ";
+		ss << getMS(seconds);
+		if (seconds > 0)
+			ss << " (" << static_cast<int>(static_cast<float>(queries) / seconds) << " queries/sec)";
+		ss << ", " << Utils::floatToString(static_cast<float>(path_nodes) / static_cast<float>(queries), 1) << " nodes/path";
+		ss << ", " << Utils::floatToString(static_cast<float>(allocations) / static_cast<float>(queries), 1) << " allocations/query";
+		if (mode == 1)
+			ss << ", build " << getMS(build_seconds);
+		print(ss);
+	}
+
+	collider.setHierarchicalPathfinding(prev_hierarchical);
+}
+
+void Benchmarks::benchPursuit(int count) {
+	MapCollision& collider = mapr->collider;
+	if (count <= 0)
+		return;
+
+	// place the pursuers on random free tiles around the player
+	std::vector<FPoint> points;
+	int attempts = count * 100;
+	while (static_cast<int>(points.size()) < count && attempts > 0) {
+		FPoint p(pc->stats.pos.x + static_cast<float>(Math::randBetween(-MapFlowField::RADIUS, MapFlowField::RADIUS)),
+				 pc->stats.pos.y + static_cast<float>(Math::randBetween(-MapFlowField::RADIUS, MapFlowField::RADIUS)));
+		if (collider.isValidPosition(p.x, p.y, MapCollision::MOVE_NORMAL, MapCollision::COLLIDE_NORMAL))
+			points.push_back(p);
+		attempts--;
+	}
+
+	if (points.empty())
+		return;
+
+	std::vector<FPoint> path;
+	Stopwatch stopwatch;
+	for (size_t i = 0; i < points.size(); ++i) {
+		collider.computePath(points[i], pc->stats.pos, path, MapCollision::MOVE_NORMAL, MapCollision::DEFAULT_PATH_LIMIT);
+	}
+	float path_seconds = stopwatch.getSeconds();
+
+	// force a rebuild, so that its cost is included
+	collider.flow_field.invalidate();
+	int steps = 0;
+	FPoint next_step;
+	stopwatch.restart();
+	for (size_t i = 0; i < points.size(); ++i) {
+		if (collider.flow_field.getNextStep(points[i], MapCollision::MOVE_NORMAL, next_step))
+			steps++;
+	}
+	float flow_seconds = stopwatch.getSeconds();
+
+	std::stringstream ss;
+	ss << "bench_pursuit: " << points.size() << " pursuers, a* " << getMS(path_seconds) << ", ";
+	ss << "flow field " << getMS(flow_seconds) << " (" << steps << " steps found)";
+	print(ss);
+}
+
+void Benchmarks::benchCollision(int count) {
+	MapCollision& collider = mapr->collider;
+	if (count <= 0 || collider.map_size.x <= 0 || collider.map_size.y <= 0)
+		return;
+
+	std::vector<FPoint> points;
+	points.reserve(count * 2);
+	for (int i = 0; i < count * 2; ++i) {
+		points.push_back(FPoint(static_cast<float>(rand() % collider.map_size.x) + 0.5f, static_cast<float>(rand() % collider.map_size.y) + 0.5f));
+	}
+
+	int in_sight = 0;
+	Stopwatch stopwatch;
+	for (size_t i = 0; i+1 < points.size(); i += 2) {
+		if (collider.lineOfSight(points[i].x, points[i].y, points[i+1].x, points[i+1].y))
+			in_sight++;
+	}
+	float sight_seconds = stopwatch.getSeconds();
+
+	int valid = 0;
+	stopwatch.restart();
+	for (size_t i = 0; i < points.size(); ++i) {
+		if (collider.isValidPosition(points[i].x, points[i].y, MapCollision::MOVE_NORMAL, MapCollision::COLLIDE_NORMAL))
+			valid++;
+	}
+	float position_seconds = stopwatch.getSeconds();
+
+	// walk every tile of every layer in isometric draw order (diagonal lines), like MapRenderer::renderIsoLayer()
+	int tiles = 0;
+	stopwatch.restart();
+	for (size_t l = 0; l < mapr->layers.size(); ++l) {
+		const Map_Layer& layer = mapr->layers[l];
+		const int layer_w = layer.getWidth();
+		const int layer_h = layer.getHeight();
+		for (int line = 0; line < layer_w + layer_h - 1; ++line) {
+			for (int x = std::max(0, line - layer_h + 1); x < layer_w && x <= line; ++x) {
+				if (layer.get(x, line - x))
+					tiles++;
+			}
+		}
+	}
+	float layer_seconds = stopwatch.getSeconds();
+
+	std::stringstream ss;
+	ss << "bench_collision: " << count << " lineOfSight " << getMS(sight_seconds) << " (" << in_sight << " visible), ";
+	ss << points.size() << " isValidPosition " << getMS(position_seconds) << " (" << valid << " valid), ";
+	ss << mapr->layers.size() << " layers " << getMS(layer_seconds) << " (" << tiles << " tiles)";
+	print(ss);
+}
+
+/**
+ * Renders only the map for a number of frames, with and without sprite batching
+ * For a headless run, start the game with SDL_VIDEODRIVER=dummy and vsync disabled
+ */
+void Benchmarks::benchRender(int frames) {
+	if (frames <= 0)
+		return;
+
+	std::vector<Renderable> r;
+	std::vector<Renderable> r_dead;
+	const bool prev_batching = render_device->isBatching();
+
+	for (int mode = 0; mode < 2; ++mode) {
+		render_device->setBatching(mode == 1);
+
+		int draw_calls = 0;
+		Stopwatch stopwatch;
+		for (int i = 0; i < frames; ++i) {
+			render_device->blankScreen();
+			mapr->render(r, r_dead);
+			render_device->commitFrame();
+			draw_calls += render_device->getDrawCalls();
+		}
+		float seconds = stopwatch.getSeconds();
+
+		std::stringstream ss;
+		ss << "bench_render (" << (mode == 1 ? "batched" : "unbatched") << "): " << frames << " frames at " << settings->view_w << "x" << settings->view_h << ", ";
+		ss << getMS(seconds, frames) << "/frame, ";
+		ss << draw_calls / frames << " draw calls/frame";
+		print(ss);
+	}
+
+	render_device->setBatching(prev_batching);
+}
+
+void Benchmarks::benchChunks(int frames) {
+	if (frames <= 0)
+		return;
+
+	std::vector<Renderable> r;
+	std::vector<Renderable> r_dead;
+	const bool prev_chunk_cache = settings->map_chunk_cache;
+
+	for (int mode = 0; mode < 2; ++mode) {
+		settings->map_chunk_cache = (mode == 1);
+
+		// chunk images are only created for a few chunks per frame, so give them time to build first
+		if (settings->map_chunk_cache) {
+			for (int i = 0; i < 16; ++i) {
+				render_device->blankScreen();
+				mapr->render(r, r_dead);
+				render_device->commitFrame();
+			}
+		}
+
+		int draw_calls = 0;
+		Stopwatch stopwatch;
+		for (int i = 0; i < frames; ++i) {
+			render_device->blankScreen();
+			mapr->render(r, r_dead);
+			render_device->commitFrame();
+			draw_calls += render_device->getDrawCalls();
+		}
+		float seconds = stopwatch.getSeconds();
+
+		std::stringstream ss;
+		ss << "bench_chunks (" << (mode == 1 ? "chunk cache" : "tiles") << "): " << frames << " frames, ";
+		ss << getMS(seconds, frames) << "/frame, ";
+		ss << draw_calls / frames << " draw calls/frame";
+		if (mode == 1)
+			ss << ", " << Utils::floatToString(static_cast<float>(mapr->chunk_cache.getMemoryUsed()) / (1024.f * 1024.f), 1) << " MB of chunk images";
+		print(ss);
+	}
+
+	settings->map_chunk_cache = prev_chunk_cache;
+}
+
+void Benchmarks::benchMapLoad(int count) {
+	if (count <= 0)
+		return;
+
+	std::vector<std::string> map_files = mods->list("maps", !ModManager::LIST_FULL_PATHS);
+
+	int map_count = 0;
+	int compiled_count = 0;
+	float seconds[2] = {0, 0};
+	std::string largest_map;
+	int largest_size = 0;
+	float largest_seconds[2] = {0, 0};
+
+	for (size_t i = 0; i < map_files.size(); ++i) {
+		if (map_files[i].length() < 4 || map_files[i].compare(map_files[i].length() - 4, 4, ".txt") != 0)
+			continue;
+
+		map_count++;
+		if (Filesystem::fileExists(mods->locate(MapCompiler::getCompiledFilename(map_files[i]))))
+			compiled_count++;
+
+		float map_seconds[2] = {0, 0};
+		int map_size = 0;
+
+		for (int mode = 0; mode < 2; ++mode) {
+			Stopwatch stopwatch;
+			for (int j = 0; j < count; ++j) {
+				Map* temp_map = new Map();
+				temp_map->load(map_files[i], mode == 1);
+				map_size = temp_map->w * temp_map->h;
+				delete temp_map;
+			}
+			map_seconds[mode] = stopwatch.getSeconds();
+			seconds[mode] += map_seconds[mode];
+		}
+
+		if (map_size > largest_size) {
+			largest_size = map_size;
+			largest_map = map_files[i];
+			largest_seconds[0] = map_seconds[0];
+			largest_seconds[1] = map_seconds[1];
+		}
+	}
+
+	if (map_count == 0)
+		return;
+
+	std::stringstream ss;
+	ss << "bench_map_load: " << map_count << " maps (" << compiled_count << " compiled), " << count << " loads each, ";
+	ss << "text " << getMS(seconds[0], count) << ", ";
+	ss << "compiled " << getMS(seconds[1], count);
+	print(ss);
+
+	ss.str("");
+	ss << "bench_map_load: largest map " << largest_map << ", ";
+	ss << "text " << getMS(largest_seconds[0], count) << ", ";
+	ss << "compiled " << getMS(largest_seconds[1], count);
+	print(ss);
+}
+
+/**
+ * Replays every file lookup made since the game started, as if starting the game again
+ */
+void Benchmarks::benchMods(int count) {
+	if (count <= 0)
+		return;
+
+	std::vector<std::string> files;
+	mods->getLocatedFiles(files);
+	if (files.empty())
+		return;
+
+	const bool prev_index_enabled = mods->isIndexEnabled();
+	const bool prev_index_cache = settings->mod_index_cache;
+	const bool had_cache_file = Filesystem::fileExists(mods->getIndexCacheFilename());
+
+	// 0 = no index, 1 = index built from the mod directories, 2 = index loaded from the cache file
+	float seconds[3] = {0, 0, 0};
+
+	for (int mode = 0; mode < 3; ++mode) {
+		settings->mod_index_cache = (mode == 2);
+
+		if (mode == 2) {
+			// make sure the cache file is up to date
+			mods->setIndexEnabled(true);
+			mods->locate(files[0]);
+		}
+
+		Stopwatch stopwatch;
+		for (int i = 0; i < count; ++i) {
+			mods->setIndexEnabled(mode != 0);
+			for (size_t j = 0; j < files.size(); ++j) {
+				mods->locate(files[j]);
+				mods->list(files[j], ModManager::LIST_FULL_PATHS);
+			}
+		}
+		seconds[mode] = stopwatch.getSeconds();
+	}
+
+	settings->mod_index_cache = prev_index_cache;
+	mods->setIndexEnabled(prev_index_enabled);
+
+	if (!had_cache_file && !prev_index_cache)
+		Filesystem::removeFile(mods->getIndexCacheFilename());
+
+	std::stringstream ss;
+	ss << "bench_mods: " << files.size() << " files, " << count << " runs, ";
+	ss << "no index " << getMS(seconds[0], count) << ", ";
+	ss << "index " << getMS(seconds[1], count) << ", ";
+	ss << "cached index " << getMS(seconds[2], count);
+	print(ss);
+}
+
+/**
+ * Creates text images like a fight full of combat text and a full inventory of tooltips would,
+ * with and without the glyph atlas
+ */
+void Benchmarks::benchText(int count) {
+	if (count <= 0)
+		return;
+
+	const int combat_text_count = 100;
+
+	std::vector<TooltipData> tips;
+	for (int i = 0; i < 2; ++i) {
+		MenuItemStorage& storage = menu->inv->inventory[i];
+		for (int j = 0; j < storage.getSlotNumber(); ++j) {
+			if (!storage[j].empty())
+				tips.push_back(items->getTooltip(storage[j], &pc->stats, ItemManager::PLAYER_INV));
+		}
+	}
+
+	// fill the rest of the carried slots with defined items, e.g. for a new character
+	for (size_t i = 1; i < items->items.size() && tips.size() < static_cast<size_t>(menu->inv->inventory[MenuInventory::CARRIED].getSlotNumber()); ++i) {
+		if (!items->items[i].has_name)
+			continue;
+
+		ItemStack stack;
+		stack.item = static_cast<int>(i);
+		stack.quantity = 1;
+		tips.push_back(items->getTooltip(stack, &pc->stats, ItemManager::PLAYER_INV));
+	}
+
+	const bool prev_font_atlas = settings->font_atlas;
+	const Color combat_color = font->getColor(FontEngine::COLOR_COMBAT_GIVEDMG);
+
+	// 0 = whole strings with SDL_ttf, 1 = glyph atlas
+	float combat_seconds[2] = {0, 0};
+	float tooltip_seconds[2] = {0, 0};
+
+	for (int mode = 0; mode < 2; ++mode) {
+		settings->font_atlas = (mode == 1);
+
+		// the first pass fills the glyph atlas and isn't counted
+		for (int pass = 0; pass < 2; ++pass) {
+			Stopwatch stopwatch;
+			for (int i = 0; i < count; ++i) {
+				// same steps as WidgetLabel::recacheTextSprite()
+				font->setFont("font_regular");
+				for (int j = 0; j < combat_text_count; ++j) {
+					std::stringstream ss;
+					ss << (j * 37 + i) % 1000;
+
+					Image *image = render_device->createImage(font->calc_width(ss.str()), font->getFontHeight());
+					if (!image)
+						continue;
+
+					font->renderShadowed(ss.str(), 0, 0, FontEngine::JUSTIFY_LEFT, image, 0, combat_color);
+					image->unref();
+				}
+			}
+			combat_seconds[mode] = stopwatch.getSeconds();
+
+			stopwatch.restart();
+			for (int i = 0; i < count; ++i) {
+				for (size_t j = 0; j < tips.size(); ++j) {
+					WidgetTooltip tooltip;
+					tooltip.createBuffer(tips[j]);
+				}
+			}
+			tooltip_seconds[mode] = stopwatch.getSeconds();
+		}
+	}
+
+	settings->font_atlas = prev_font_atlas;
+
+	std::stringstream ss;
+	ss << "bench_text: " << combat_text_count << " combat text labels, " << count << " frames, ";
+	ss << "ttf " << getMS(combat_seconds[0], count) << ", ";
+	ss << "atlas " << getMS(combat_seconds[1], count) << " per frame";
+	print(ss);
+
+	ss.str("");
+	ss << "bench_text: " << tips.size() << " item tooltips, " << count << " frames, ";
+	ss << "ttf " << getMS(tooltip_seconds[0], count) << ", ";
+	ss << "atlas " << getMS(tooltip_seconds[1], count) << " per frame";
+	print(ss);
+}
+
+/**
+ * Plays the animations of the player and the enemies on the current map for a crowd of entities,
+ * switching animations the way a large battle would
+ */
+void Benchmarks::benchAnim(int count) {
+	if (count <= 0)
+		return;
+
+	const int frames = 100;
+	const int switch_interval = 10;
+
+	std::vector<AnimationSet*> sets;
+	sets.push_back(pc->animationSet);
+	for (size_t i = 0; i < enemym->enemies.size(); ++i) {
+		if (enemym->enemies[i]->animationSet && std::find(sets.begin(), sets.end(), enemym->enemies[i]->animationSet) == sets.end())
+			sets.push_back(enemym->enemies[i]->animationSet);
+	}
+
+	const char* anim_names[] = {"stance", "run", "swing", "shoot", "cast", "hit", "block", "die"};
+	const size_t anim_name_count = sizeof(anim_names) / sizeof(anim_names[0]);
+
+	std::vector<Animation*> anims(count, static_cast<Animation*>(NULL));
+	for (int i = 0; i < count; ++i) {
+		anims[i] = sets[i % sets.size()]->getAnimation(anim_names[0]);
+	}
+
+	int switches = 0;
+	Stopwatch stopwatch;
+	for (int frame = 0; frame < frames; ++frame) {
+		for (int i = 0; i < count; ++i) {
+			// same steps as Entity::setAnimation(), spread over the frames
+			if ((frame + i) % switch_interval == 0) {
+				const char* anim_name = anim_names[(frame / switch_interval + i) % anim_name_count];
+				if (anims[i]->getName() != anim_name) {
+					delete anims[i];
+					anims[i] = sets[i % sets.size()]->getAnimation(anim_name);
+					switches++;
+				}
+			}
+
+			anims[i]->advanceFrame();
+			anims[i]->getCurrentFrame(i % 8);
+		}
+	}
+	const float seconds = stopwatch.getSeconds();
+
+	// frame data is shared by the animation set, so only count it once per animation
+	size_t shared_bytes = 0;
+	size_t copied_bytes = 0;
+	for (size_t i = 0; i < sets.size(); ++i) {
+		for (size_t j = 0; j < sets[i]->animations.size(); ++j) {
+			shared_bytes += sets[i]->animations[j]->getDefinitionSize();
+		}
+	}
+	for (int i = 0; i < count; ++i) {
+		copied_bytes += sizeof(Animation) + anims[i]->getDefinitionSize();
+		delete anims[i];
+	}
+
+	std::stringstream ss;
+	ss << "bench_anim: " << count << " entities, " << sets.size() << " animation sets, " << frames << " frames, ";
+	ss << getMS(seconds, frames) << " per frame, ";
+	ss << Utils::floatToString(static_cast<float>(switches) / static_cast<float>(frames), 1) << " animation changes per frame (1 allocation each)";
+	print(ss);
+
+	ss.str("");
+	ss << "bench_anim: " << (static_cast<size_t>(count) * sizeof(Animation) + shared_bytes) / 1024 << " KiB of animation state and frame data, ";
+	ss << copied_bytes / 1024 << " KiB if every entity had its own copy of the frame data";
+	print(ss);
+}
+
+/**
+ * Runs the per-frame stat update for a crowd of enemies that carry a few stat effects each,
+ * with a full calculation and with the incremental update
+ */
+void Benchmarks::benchStats(int count) {
+	if (count <= 0)
+		return;
+
+	const int frames = 600;
+	const int effects_per_enemy = 3;
+
+	std::vector<StatBlock*> sources;
+	for (size_t i = 0; i < enemym->enemies.size(); ++i) {
+		sources.push_back(&enemym->enemies[i]->stats);
+	}
+	if (sources.empty())
+		sources.push_back(&pc->stats);
+
+	// effect types that change stats: the core stats and the primary stats
+	std::vector<std::string> effect_types;
+	for (int i = 0; i < Stats::COUNT; ++i) {
+		effect_types.push_back(Stats::KEY[i]);
+	}
+	for (size_t i = 0; i < eset->primary_stats.list.size(); ++i) {
+		effect_types.push_back(eset->primary_stats.list[i].id);
+	}
+
+	// 0 = applyEffects() every frame, 1 = updateStats()
+	float seconds[2] = {0, 0};
+	int mismatches = 0;
+	std::vector< std::vector<int> > results[2];
+
+	for (int mode = 0; mode < 2; ++mode) {
+		std::vector<StatBlock*> blocks;
+		for (int i = 0; i < count; ++i) {
+			StatBlock* block = new StatBlock(*sources[i % sources.size()]);
+
+			// copies must not change the summons of the original
+			block->summons.clear();
+			block->summoner = NULL;
+
+			for (int j = 0; j < effects_per_enemy; ++j) {
+				EffectDef ed;
+				ed.id = ed.type = effect_types[(i * effects_per_enemy + j) % effect_types.size()];
+
+				// some effects run out during the benchmark, others are permanent
+				const int duration = (j == 0) ? 0 : ((i * 37 + j * 101) % (frames * 2)) + 1;
+				block->effects.addEffect(ed, duration, (i + j) % 5 + 1, Power::SOURCE_TYPE_ENEMY, EffectManager::NO_POWER);
+			}
+
+			block->applyEffects();
+			blocks.push_back(block);
+		}
+
+		Stopwatch stopwatch;
+		for (int frame = 0; frame < frames; ++frame) {
+			for (size_t i = 0; i < blocks.size(); ++i) {
+				blocks[i]->effects.logic();
+				if (mode == 0)
+					blocks[i]->applyEffects();
+				else
+					blocks[i]->updateStats();
+			}
+		}
+		seconds[mode] = stopwatch.getSeconds();
+
+		for (size_t i = 0; i < blocks.size(); ++i) {
+			results[mode].push_back(blocks[i]->current);
+			delete blocks[i];
+		}
+	}
+
+	for (size_t i = 0; i < results[0].size(); ++i) {
+		if (results[0][i] != results[1][i])
+			mismatches++;
+	}
+
+	std::stringstream ss;
+	ss << "bench_stats: " << count << " enemies, " << effects_per_enemy << " effects each, " << frames << " frames, ";
+	ss << "full " << getMS(seconds[0], frames) << ", ";
+	ss << "incremental " << getMS(seconds[1], frames) << " per frame, ";
+	ss << mismatches << " mismatches";
+	print(ss);
+}
+
+/**
+ * Keeps a number of missiles flying around the player for a number of frames.
+ * The missiles can't hit anything, so that the benchmark doesn't change the game.
+ */
+void Benchmarks::benchHazards(int count) {
+	if (count <= 0)
+		return;
+
+	const int frames = 300;
+
+	// every other missile bounces off walls, the rest are removed when they hit a wall
+	Power bench_powers[2];
+	for (int i = 0; i < 2; ++i) {
+		bench_powers[i].radius = 0.5f;
+		bench_powers[i].wall_reflect = (i == 1);
+	}
+
+	HazardManager bench_hazards;
+	int created = 0;
+	int removed = 0;
+
+	Stopwatch stopwatch;
+	for (int frame = 0; frame < frames; ++frame) {
+		// replace the missiles that were removed on the last frame
+		while (bench_hazards.h.size() + powers->hazards.size() < static_cast<size_t>(count)) {
+			Hazard* haz = new Hazard(&mapr->collider);
+			haz->power = &bench_powers[created % 2];
+			haz->src_stats = &pc->stats;
+			haz->source_type = Power::SOURCE_TYPE_NEUTRAL;
+			haz->active = false;
+			haz->pos = pc->stats.pos;
+			haz->base_speed = 0.25f;
+			haz->lifespan = 30 + (created * 7) % 90;
+			haz->setAngle(static_cast<float>(created) * 0.61f);
+			powers->hazards.push(haz);
+			created++;
+		}
+
+		const size_t prev_count = bench_hazards.h.size() + powers->hazards.size();
+		bench_hazards.logic();
+		removed += static_cast<int>(prev_count - bench_hazards.h.size());
+	}
+	const float seconds = stopwatch.getSeconds();
+
+	std::stringstream ss;
+	ss << "bench_hazards: " << count << " missiles, " << frames << " frames, " << created << " created, " << removed << " removed, ";
+	ss << getMS(seconds, frames) << " per frame, ";
+	ss << Utils::floatToString(static_cast<float>(frames) / std::max(seconds, 0.000001f), 0) << " ticks/sec";
+	print(ss);
+}
+
+/**
+ * Looks up effects and animations by name for a crowd of enemies with many effects,
+ * the way entities do on every frame. This is done once with interned ids, and once
+ * with string comparisons, which is how the names were compared before they were interned.
+ */
+void Benchmarks::benchIDs(int count) {
+	if (count <= 0)
+		return;
+
+	const int frames = 600;
+	const char* effect_names[] = {"bench_bleed", "bench_burn", "bench_chill", "bench_curse", "bench_haste", "bench_regen", "bench_shield", "bench_slow"};
+	const size_t effects_per_enemy = sizeof(effect_names) / sizeof(effect_names[0]);
+
+	std::vector<std::string> names;
+	std::vector<StringID> ids;
+	for (size_t i = 0; i < effects_per_enemy; ++i) {
+		names.push_back(effect_names[i]);
+		ids.push_back(Utils::internString(names.back()));
+	}
+	const std::string anim_name = "swing";
+	const StringID anim_id = Utils::internString(anim_name);
+
+	std::vector<EffectManager*> crowd;
+	for (int i = 0; i < count; ++i) {
+		crowd.push_back(new EffectManager());
+
+		for (size_t j = 0; j < effects_per_enemy; ++j) {
+			EffectDef ed;
+			ed.id = names[j];
+			ed.type = "attack_speed";
+			ed.attack_speed_anim = (j % 2 == 0) ? anim_id : 0;
+			crowd.back()->addEffect(ed, 0, 100 + static_cast<int>(j), Power::SOURCE_TYPE_ENEMY, EffectManager::NO_POWER);
+		}
+	}
+
+	// 0 = interned ids, 1 = strings
+	float seconds[2] = {0, 0};
+	float results[2] = {0, 0};
+
+	for (int mode = 0; mode < 2; ++mode) {
+		Stopwatch stopwatch;
+
+		for (int frame = 0; frame < frames; ++frame) {
+			for (size_t i = 0; i < crowd.size(); ++i) {
+				const std::vector<Effect>& effect_list = crowd[i]->effect_list;
+
+				if (mode == 0) {
+					for (size_t j = 0; j < ids.size(); ++j) {
+						if (crowd[i]->hasEffect(ids[j], 1))
+							results[mode]++;
+					}
+					results[mode] += crowd[i]->getAttackSpeed(anim_id);
+					if (pc->activeAnimation->getNameID() == Entity::ANIM_RUN)
+						results[mode]++;
+				}
+				else {
+					for (size_t j = 0; j < names.size(); ++j) {
+						for (size_t k = effect_list.size(); k > 0; k--) {
+							if (Utils::getInternedString(effect_list[k-1].id) == names[j]) {
+								results[mode]++;
+								break;
+							}
+						}
+					}
+					float attack_speed = 100;
+					for (size_t k = 0; k < effect_list.size(); ++k) {
+						const std::string& speed_anim = Utils::getInternedString(effect_list[k].attack_speed_anim);
+						if (effect_list[k].type == Effect::ATTACK_SPEED && (speed_anim.empty() || speed_anim == anim_name))
+							attack_speed = (static_cast<float>(effect_list[k].magnitude) * attack_speed) / 100.0f;
+					}
+					results[mode] += attack_speed;
+					if (pc->activeAnimation->getName() == "run")
+						results[mode]++;
+				}
+			}
+		}
+
+		seconds[mode] = stopwatch.getSeconds();
+	}
+
+	for (size_t i = 0; i < crowd.size(); ++i) {
+		delete crowd[i];
+	}
+
+	std::stringstream ss;
+	ss << "bench_ids: " << count << " enemies, " << effects_per_enemy << " effects each, " << frames << " frames, ";
+	ss << "ids " << getMS(seconds[0], frames) << ", ";
+	ss << "strings " << getMS(seconds[1], frames) << " per frame";
+	if (results[0] != results[1])
+		ss << ", results differ";
+	print(ss);
+}
+
+/**
+ * Runs the effect logic for a crowd of entities that carry a number of effects each.
+ * Effects that run out are added again, so the crowd keeps the same number of effects.
+ */
+void Benchmarks::benchEffects(int count) {
+	if (count <= 0)
+		return;
+
+	const int frames = 600;
+	const size_t effects_per_entity = 10;
+
+	// use the effects of the loaded mods, which may have animations
+	std::vector<EffectDef> defs;
+	for (size_t i = 0; i < powers->effects.size(); ++i) {
+		if (!powers->effects[i].type.empty())
+			defs.push_back(powers->effects[i]);
+	}
+	if (defs.empty()) {
+		const char* effect_types[] = {"damage", "hpot", "mpot", "speed", "attack_speed", "stun", "fear", "immunity_knockback"};
+		for (size_t i = 0; i < sizeof(effect_types) / sizeof(effect_types[0]); ++i) {
+			defs.resize(defs.size() + 1);
+			defs.back().id = std::string("bench_") + effect_types[i];
+			defs.back().type = effect_types[i];
+		}
+		for (int i = 0; i < Stats::COUNT && i < 2; ++i) {
+			defs.resize(defs.size() + 1);
+			defs.back().id = std::string("bench_") + Stats::KEY[i];
+			defs.back().type = Stats::KEY[i];
+		}
+	}
+
+	size_t next_effect = 0;
+	int added = 0;
+	int expired = 0;
+
+	std::vector<EffectManager*> crowd;
+	for (int i = 0; i < count; ++i) {
+		crowd.push_back(new EffectManager());
+	}
+
+	// 0 = EffectManager::logic(), 1 = adding the effects that ran out
+	float seconds[2] = {0, 0};
+
+	for (int frame = 0; frame <= frames; ++frame) {
+		Stopwatch stopwatch;
+		if (frame > 0) {
+			for (size_t i = 0; i < crowd.size(); ++i) {
+				const size_t prev_count = crowd[i]->effect_list.size();
+				crowd[i]->logic();
+				expired += static_cast<int>(prev_count - crowd[i]->effect_list.size());
+			}
+			seconds[0] += stopwatch.getSeconds();
+		}
+
+		stopwatch.restart();
+		for (size_t i = 0; i < crowd.size(); ++i) {
+			// effects may be rejected (e.g. by an immunity), so only try as many times as there are effects
+			for (size_t j = 0; j < effects_per_entity && crowd[i]->effect_list.size() < effects_per_entity; ++j) {
+				const int duration = static_cast<int>((next_effect * 37) % static_cast<size_t>(frames)) + 1;
+				crowd[i]->addEffect(defs[next_effect % defs.size()], duration, 100, Power::SOURCE_TYPE_ENEMY, EffectManager::NO_POWER);
+				next_effect++;
+				added++;
+			}
+		}
+		if (frame > 0)
+			seconds[1] += stopwatch.getSeconds();
+	}
+
+	for (size_t i = 0; i < crowd.size(); ++i) {
+		delete crowd[i];
+	}
+
+	std::stringstream ss;
+	ss << "bench_effects: " << count << " entities, " << effects_per_entity << " effects each, " << frames << " frames, ";
+	ss << "logic " << getMS(seconds[0], frames) << ", ";
+	ss << "adding " << getMS(seconds[1], frames) << " per frame, ";
+	ss << expired << " expired, " << added << " added";
+	print(ss);
+}
@@ -0,0 +1,75 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class Benchmarks
+ *
+ * Developer benchmarks for the engine's subsystems, run on the game that is currently loaded.
+ * They are only built with the BENCHMARKS CMake option (which defines FLARE_BENCHMARKS), and are
+ * then run from the developer console, e.g. "bench_path 1000". Results are printed to the console
+ * and to the log. Such builds count every allocation (see Stopwatch::getAllocations()).
+ */
+
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include "CommonIncludes.h"
+
+class WidgetLog;
+
+class Benchmarks {
+private:
+	class Stopwatch {
+	public:
+		Stopwatch();
+		void restart();
+		float getSeconds() const;
+		unsigned long getAllocations() const;
+
+	private:
+		uint64_t start_ticks;
+		unsigned long start_allocations;
+	};
+
+	static int getCount(const std::vector<std::string>& args, int default_count);
+	static std::string getMS(float seconds, int count = 1);
+	void print(const std::stringstream& ss);
+
+	void benchPath(int count);
+	void benchPursuit(int count);
+	void benchCollision(int count);
+	void benchRender(int frames);
+	void benchChunks(int frames);
+	void benchMapLoad(int count);
+	void benchMods(int count);
+	void benchText(int count);
+	void benchAnim(int count);
+	void benchStats(int count);
+	void benchHazards(int count);
+	void benchIDs(int count);
+	void benchEffects(int count);
+
+	WidgetLog* log;
+
+public:
+	explicit Benchmarks(WidgetLog* _log);
+
+	void addHelp();
+	bool execute(const std::vector<std::string>& args);
+};
+
+#endif
@@ -121,18 +121,10 @@ void CombatText::addInt(int num, const FPoint& location, int displaytype) {
 	}
 }
 
-void CombatText::logic(const FPoint& _cam) {
-	cam = _cam;
-
+void CombatText::logic() {
 	for(std::vector<Combat_Text_Item>::iterator it = combat_text.begin(); it != combat_text.end(); ++it) {
 		it->lifespan--;
 		it->floating_offset += speed;
-
-		Point scr_pos;
-		scr_pos = Utils::mapToScreen(it->pos.x, it->pos.y, cam.x, cam.y);
-		scr_pos.y -= static_cast<int>(it->floating_offset);
-
-		it->label->setPos(scr_pos.x, scr_pos.y);
 	}
 
 	// delete expired messages
@@ -142,12 +134,24 @@ void CombatText::logic(const FPoint& _cam) {
 	}
 }
 
-void CombatText::render() {
+/**
+ * The labels are placed here rather than in logic(), so that they move along
+ * with the camera when frames are drawn between logic frames
+ */
+void CombatText::render(const FPoint& cam) {
 	if (!settings->show_hud) return;
 
+	// the text has floated up by one step for the latest logic frame
+	const float float_back = speed * (1 - std::min(settings->render_interpolation, 1.0f));
+
 	for(std::vector<Combat_Text_Item>::iterator it = combat_text.begin(); it != combat_text.end(); ++it) {
-		if (it->lifespan > 0)
+		if (it->lifespan > 0) {
+			Point scr_pos = Utils::mapToScreen(it->pos.x, it->pos.y, cam.x, cam.y);
+			scr_pos.y -= static_cast<int>(it->floating_offset - float_back);
+
+			it->label->setPos(scr_pos.x, scr_pos.y);
 			it->label->render();
+		}
 	}
 }
 
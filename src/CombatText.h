@@ -51,8 +51,8 @@ public:
 	CombatText();
 	~CombatText();
 
-	void logic(const FPoint& _cam);
-	void render();
+	void logic();
+	void render(const FPoint& cam);
 	void addString(const std::string& message, const FPoint& location, int displaytype);
 	void addInt(int num, const FPoint& location, int displaytype);
 	void clear();
@@ -65,7 +65,6 @@ public:
 		MSG_BUFF = 4
 	};
 private:
-	FPoint cam;
 	std::vector<Combat_Text_Item> combat_text;
 
 	Color msg_color[5];
@@ -25,16 +25,20 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include "SDLSoftwareRenderDevice.h"
 #include "SDLHardwareRenderDevice.h"
+#include "NullRenderDevice.h"
 
 #include "SDLFontEngine.h"
 #include "SDLSoundManager.h"
 #include "SDLInputState.h"
+#include "NullSoundManager.h"
+#include "ScriptedInputState.h"
 
 RenderDevice* getRenderDevice(const std::string& name) {
 	// "sdl" is the default
 	if (name != "") {
 		if (name == "sdl") return new SDLSoftwareRenderDevice();
 		else if (name == "sdl_hardware") return new SDLHardwareRenderDevice();
+		else if (name == "null") return new NullRenderDevice();
 		else {
 			Utils::logError("DeviceList: Render device '%s' not found. Falling back to the default.", name.c_str());
 			return new SDLHardwareRenderDevice();
@@ -70,3 +74,14 @@ SoundManager* getSoundManager() {
 InputState* getInputManager() {
 	return new SDLInputState();
 }
+
+/**
+ * Devices used with the --headless command line option. "null" is the matching render device.
+ */
+SoundManager* getHeadlessSoundManager() {
+	return new NullSoundManager();
+}
+
+InputState* getHeadlessInputManager(const std::string& script_filename) {
+	return new ScriptedInputState(script_filename);
+}
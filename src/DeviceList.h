@@ -33,4 +33,7 @@ FontEngine* getFontEngine();
 SoundManager* getSoundManager();
 InputState* getInputManager();
 
+SoundManager* getHeadlessSoundManager();
+InputState* getHeadlessInputManager(const std::string& script_filename);
+
 #endif
@@ -43,11 +43,11 @@ EffectDef::EffectDef()
 	, render_above(false)
 	, color_mod(255, 255, 255)
 	, alpha_mod(255)
-	, attack_speed_anim("") {
+	, attack_speed_anim(0) {
 }
 
 Effect::Effect()
-	: id("")
+	: id(0)
 	, name("")
 	, icon(-1)
 	, ticks(0)
@@ -65,7 +65,7 @@ Effect::Effect()
 	, group_stack(false)
 	, color_mod(255, 255, 255)
 	, alpha_mod(255)
-	, attack_speed_anim("") {
+	, attack_speed_anim(0) {
 }
 
 Effect::Effect(const Effect& other) {
@@ -106,6 +106,31 @@ Effect::~Effect() {
 	unloadAnimation();
 }
 
+/**
+ * Exchange all values with another effect. Unlike a copy, this keeps the loaded animations.
+ */
+void Effect::swap(Effect& other) {
+	std::swap(id, other.id);
+	name.swap(other.name);
+	std::swap(icon, other.icon);
+	std::swap(ticks, other.ticks);
+	std::swap(duration, other.duration);
+	std::swap(type, other.type);
+	std::swap(magnitude, other.magnitude);
+	std::swap(magnitude_max, other.magnitude_max);
+	animation_name.swap(other.animation_name);
+	std::swap(animation, other.animation);
+	std::swap(item, other.item);
+	std::swap(trigger, other.trigger);
+	std::swap(render_above, other.render_above);
+	std::swap(passive_id, other.passive_id);
+	std::swap(source_type, other.source_type);
+	std::swap(group_stack, other.group_stack);
+	std::swap(color_mod, other.color_mod);
+	std::swap(alpha_mod, other.alpha_mod);
+	std::swap(attack_speed_anim, other.attack_speed_anim);
+}
+
 void Effect::loadAnimation(const std::string &s) {
 	if (!s.empty()) {
 		animation_name = s;
@@ -128,6 +153,8 @@ EffectManager::EffectManager()
 	: bonus(std::vector<int>(Stats::COUNT + eset->damage_types.count, 0))
 	, bonus_resist(std::vector<int>(eset->elements.list.size(), 0))
 	, bonus_primary(std::vector<int>(eset->primary_stats.list.size(), 0))
+	, bonus_outdated(false)
+	, changed_bonus()
 	, triggered_others(false)
 	, triggered_block(false)
 	, triggered_hit(false)
@@ -163,137 +190,176 @@ void EffectManager::clearStatus() {
 	death_sentence = false;
 	fear = false;
 	knockback_speed = 0;
+}
 
-	for (unsigned i=0; i<Stats::COUNT + eset->damage_types.count; i++) {
-		bonus[i] = 0;
-	}
+bool EffectManager::isStatType(int type) {
+	return type >= Effect::TYPE_COUNT;
+}
+
+void EffectManager::setBonus(std::vector<int>& values, size_t index, int value, size_t stat_offset) {
+	if (values[index] == value)
+		return;
+
+	values[index] = value;
+	changed_bonus.push_back(stat_offset + index);
+}
+
+/**
+ * Total the stat bonuses of all active effects
+ */
+void EffectManager::calcBonus() {
+	const size_t resist_offset = bonus.size();
+	const size_t primary_offset = resist_offset + bonus_resist.size();
+
+	std::vector<int> total(primary_offset + bonus_primary.size(), 0);
 
-	for (unsigned i=0; i<bonus_resist.size(); i++) {
-		bonus_resist[i] = 0;
+	for (size_t i = 0; i < effect_list.size(); ++i) {
+		if (effect_list[i].duration < 0 || !isStatType(effect_list[i].type))
+			continue;
+
+		const size_t index = static_cast<size_t>(effect_list[i].type - Effect::TYPE_COUNT);
+		if (index < total.size())
+			total[index] += effect_list[i].magnitude;
 	}
 
-	for (unsigned i=0; i<bonus_primary.size(); i++) {
-		bonus_primary[i] = 0;
+	for (size_t i = 0; i < bonus.size(); ++i) {
+		setBonus(bonus, i, total[i], 0);
+	}
+	for (size_t i = 0; i < bonus_resist.size(); ++i) {
+		setBonus(bonus_resist, i, total[resist_offset + i], resist_offset);
 	}
+	for (size_t i = 0; i < bonus_primary.size(); ++i) {
+		setBonus(bonus_primary, i, total[primary_offset + i], primary_offset);
+	}
+
+	bonus_outdated = false;
 }
 
 void EffectManager::logic() {
 	clearStatus();
 
-	for (unsigned i=0; i<effect_list.size(); i++) {
+	const int fps = settings->max_frames_per_sec;
+
+	// effects that are kept are moved to the front of the list, in the same order
+	// expired effects end up after them, and are removed together after the loop
+	size_t kept = 0;
+
+	for (size_t i = 0; i < effect_list.size(); ++i) {
+		Effect& e = effect_list[i];
+		bool expired = false;
+
 		// @CLASS EffectManager|Description of "type" in powers/effects.txt
 		// expire timed effects and total up magnitudes of active effects
-		if (effect_list[i].duration >= 0) {
-			if (effect_list[i].duration > 0) {
-				if (effect_list[i].ticks > 0) effect_list[i].ticks--;
-				if (effect_list[i].ticks == 0) {
+		if (e.duration >= 0) {
+			if (e.duration > 0) {
+				if (e.ticks > 0) e.ticks--;
+				if (e.ticks == 0) {
 					//death sentence is only applied at the end of the timer
 					// @TYPE death_sentence|Causes sudden death at the end of the effect duration.
-					if (effect_list[i].type == Effect::DEATH_SENTENCE) death_sentence = true;
-					removeEffect(i);
-					i--;
-					continue;
+					if (e.type == Effect::DEATH_SENTENCE) death_sentence = true;
+					expired = true;
 				}
 			}
 
-			// @TYPE damage|Damage per second
-			if (effect_list[i].type == Effect::DAMAGE && effect_list[i].ticks % settings->max_frames_per_sec == 1) damage += effect_list[i].magnitude;
-			// @TYPE damage_percent|Damage per second (percentage of max HP)
-			else if (effect_list[i].type == Effect::DAMAGE_PERCENT && effect_list[i].ticks % settings->max_frames_per_sec == 1) damage_percent += effect_list[i].magnitude;
-			// @TYPE hpot|HP restored per second
-			else if (effect_list[i].type == Effect::HPOT && effect_list[i].ticks % settings->max_frames_per_sec == 1) hpot += effect_list[i].magnitude;
-			// @TYPE hpot_percent|HP restored per second (percentage of max HP)
-			else if (effect_list[i].type == Effect::HPOT_PERCENT && effect_list[i].ticks % settings->max_frames_per_sec == 1) hpot_percent += effect_list[i].magnitude;
-			// @TYPE mpot|MP restored per second
-			else if (effect_list[i].type == Effect::MPOT && effect_list[i].ticks % settings->max_frames_per_sec == 1) mpot += effect_list[i].magnitude;
-			// @TYPE mpot_percent|MP restored per second (percentage of max MP)
-			else if (effect_list[i].type == Effect::MPOT_PERCENT && effect_list[i].ticks % settings->max_frames_per_sec == 1) mpot_percent += effect_list[i].magnitude;
-			// @TYPE speed|Changes movement speed. A magnitude of 100 is 100% speed (aka normal speed).
-			else if (effect_list[i].type == Effect::SPEED) speed = (static_cast<float>(effect_list[i].magnitude) * speed) / 100.f;
-			// @TYPE attack_speed|Changes attack speed. A magnitude of 100 is 100% speed (aka normal speed).
-			// attack speed is calculated when getAttackSpeed() is called
-
-			// @TYPE immunity|Applies all immunity effects. Magnitude is ignored.
-			else if (effect_list[i].type == Effect::IMMUNITY) {
-				immunity_damage = true;
-				immunity_slow = true;
-				immunity_stun = true;
-				immunity_hp_steal = true;
-				immunity_mp_steal = true;
-				immunity_knockback = true;
-				immunity_damage_reflect = true;
-				immunity_stat_debuff = true;
-			}
-			// @TYPE immunity_damage|Removes and prevents damage over time. Magnitude is ignored.
-			else if (effect_list[i].type == Effect::IMMUNITY_DAMAGE) immunity_damage = true;
-			// @TYPE immunity_slow|Removes and prevents slow effects. Magnitude is ignored.
-			else if (effect_list[i].type == Effect::IMMUNITY_SLOW) immunity_slow = true;
-			// @TYPE immunity_stun|Removes and prevents stun effects. Magnitude is ignored.
-			else if (effect_list[i].type == Effect::IMMUNITY_STUN) immunity_stun = true;
-			// @TYPE immunity_hp_steal|Prevents HP stealing. Magnitude is ignored.
-			else if (effect_list[i].type == Effect::IMMUNITY_HP_STEAL) immunity_hp_steal = true;
-			// @TYPE immunity_mp_steal|Prevents MP stealing. Magnitude is ignored.
-			else if (effect_list[i].type == Effect::IMMUNITY_MP_STEAL) immunity_mp_steal = true;
-			// @TYPE immunity_knockback|Removes and prevents knockback effects. Magnitude is ignored.
-			else if (effect_list[i].type == Effect::IMMUNITY_KNOCKBACK) immunity_knockback = true;
-			// @TYPE immunity_damage_reflect|Prevents damage reflection. Magnitude is ignored.
-			else if (effect_list[i].type == Effect::IMMUNITY_DAMAGE_REFLECT) immunity_damage_reflect = true;
-			// @TYPE immunity_stat_debuff|Prevents stat value altering effects that have a magnitude less than 0. Magnitude is ignored.
-			else if (effect_list[i].type == Effect::IMMUNITY_STAT_DEBUFF) immunity_stat_debuff = true;
-
-			// @TYPE stun|Can't move or attack. Being attacked breaks stun.
-			else if (effect_list[i].type == Effect::STUN) stun = true;
-			// @TYPE revive|Revives the player. Typically attached to a power that triggers when the player dies.
-			else if (effect_list[i].type == Effect::REVIVE) revive = true;
-			// @TYPE convert|Causes an enemy or an ally to switch allegiance
-			else if (effect_list[i].type == Effect::CONVERT) convert = true;
-			// @TYPE fear|Causes enemies to run away
-			else if (effect_list[i].type == Effect::FEAR) fear = true;
-			// @TYPE knockback|Pushes the target away from the source caster. Speed is the given value divided by the framerate cap.
-			else if (effect_list[i].type == Effect::KNOCKBACK) knockback_speed = static_cast<float>(effect_list[i].magnitude)/static_cast<float>(settings->max_frames_per_sec);
-
-			// @TYPE ${STATNAME}|Increases ${STATNAME}, where ${STATNAME} is any of the base stats. Examples: hp, avoidance, xp_gain
-			// @TYPE ${DAMAGE_TYPE}|Increases a damage min or max, where ${DAMAGE_TYPE} is any 'min' or 'max' value found in engine/damage_types.txt. Example: dmg_melee_min
-			else if (effect_list[i].type >= Effect::TYPE_COUNT && effect_list[i].type < Effect::TYPE_COUNT + Stats::COUNT + static_cast<int>(eset->damage_types.count)) {
-				bonus[effect_list[i].type - Effect::TYPE_COUNT] += effect_list[i].magnitude;
-			}
-			// else if (effect_list[i].type >= Effect::TYPE_COUNT + Stats::COUNT && effect_list[i].type < Effect::TYPE_COUNT + Stats::COUNT + static_cast<int>(eset->damage_types.count)) {
-			// 	bonus[effect_list[i].type - Effect::TYPE_COUNT] += effect_list[i].magnitude;
-			// }
-			// @TYPE ${ELEMENT}_resist|Increase Resistance % to ${ELEMENT}, where ${ELEMENT} is any found in engine/elements.txt. Example: fire_resist
-			else if (effect_list[i].type >= Effect::TYPE_COUNT + Stats::COUNT + static_cast<int>(eset->damage_types.count) && effect_list[i].type < Effect::TYPE_COUNT + Stats::COUNT + static_cast<int>(eset->damage_types.count) + static_cast<int>(eset->elements.list.size())) {
-				bonus_resist[effect_list[i].type - Effect::TYPE_COUNT - Stats::COUNT - eset->damage_types.count] += effect_list[i].magnitude;
-			}
-			// @TYPE ${PRIMARYSTAT}|Increases ${PRIMARYSTAT}, where ${PRIMARYSTAT} is any of the primary stats defined in engine/primary_stats.txt. Example: physical
-			else if (effect_list[i].type >= Effect::TYPE_COUNT) {
-				bonus_primary[effect_list[i].type - Effect::TYPE_COUNT - Stats::COUNT - eset->damage_types.count - eset->elements.list.size()] += effect_list[i].magnitude;
+			if (!expired) {
+				switch (e.type) {
+					// @TYPE damage|Damage per second
+					case Effect::DAMAGE: if (e.ticks % fps == 1) damage += e.magnitude; break;
+					// @TYPE damage_percent|Damage per second (percentage of max HP)
+					case Effect::DAMAGE_PERCENT: if (e.ticks % fps == 1) damage_percent += e.magnitude; break;
+					// @TYPE hpot|HP restored per second
+					case Effect::HPOT: if (e.ticks % fps == 1) hpot += e.magnitude; break;
+					// @TYPE hpot_percent|HP restored per second (percentage of max HP)
+					case Effect::HPOT_PERCENT: if (e.ticks % fps == 1) hpot_percent += e.magnitude; break;
+					// @TYPE mpot|MP restored per second
+					case Effect::MPOT: if (e.ticks % fps == 1) mpot += e.magnitude; break;
+					// @TYPE mpot_percent|MP restored per second (percentage of max MP)
+					case Effect::MPOT_PERCENT: if (e.ticks % fps == 1) mpot_percent += e.magnitude; break;
+					// @TYPE speed|Changes movement speed. A magnitude of 100 is 100% speed (aka normal speed).
+					case Effect::SPEED: speed = (static_cast<float>(e.magnitude) * speed) / 100.f; break;
+					// @TYPE attack_speed|Changes attack speed. A magnitude of 100 is 100% speed (aka normal speed).
+					// attack speed is calculated when getAttackSpeed() is called
+
+					// @TYPE immunity|Applies all immunity effects. Magnitude is ignored.
+					case Effect::IMMUNITY:
+						immunity_damage = true;
+						immunity_slow = true;
+						immunity_stun = true;
+						immunity_hp_steal = true;
+						immunity_mp_steal = true;
+						immunity_knockback = true;
+						immunity_damage_reflect = true;
+						immunity_stat_debuff = true;
+						break;
+					// @TYPE immunity_damage|Removes and prevents damage over time. Magnitude is ignored.
+					case Effect::IMMUNITY_DAMAGE: immunity_damage = true; break;
+					// @TYPE immunity_slow|Removes and prevents slow effects. Magnitude is ignored.
+					case Effect::IMMUNITY_SLOW: immunity_slow = true; break;
+					// @TYPE immunity_stun|Removes and prevents stun effects. Magnitude is ignored.
+					case Effect::IMMUNITY_STUN: immunity_stun = true; break;
+					// @TYPE immunity_hp_steal|Prevents HP stealing. Magnitude is ignored.
+					case Effect::IMMUNITY_HP_STEAL: immunity_hp_steal = true; break;
+					// @TYPE immunity_mp_steal|Prevents MP stealing. Magnitude is ignored.
+					case Effect::IMMUNITY_MP_STEAL: immunity_mp_steal = true; break;
+					// @TYPE immunity_knockback|Removes and prevents knockback effects. Magnitude is ignored.
+					case Effect::IMMUNITY_KNOCKBACK: immunity_knockback = true; break;
+					// @TYPE immunity_damage_reflect|Prevents damage reflection. Magnitude is ignored.
+					case Effect::IMMUNITY_DAMAGE_REFLECT: immunity_damage_reflect = true; break;
+					// @TYPE immunity_stat_debuff|Prevents stat value altering effects that have a magnitude less than 0. Magnitude is ignored.
+					case Effect::IMMUNITY_STAT_DEBUFF: immunity_stat_debuff = true; break;
+
+					// @TYPE stun|Can't move or attack. Being attacked breaks stun.
+					case Effect::STUN: stun = true; break;
+					// @TYPE revive|Revives the player. Typically attached to a power that triggers when the player dies.
+					case Effect::REVIVE: revive = true; break;
+					// @TYPE convert|Causes an enemy or an ally to switch allegiance
+					case Effect::CONVERT: convert = true; break;
+					// @TYPE fear|Causes enemies to run away
+					case Effect::FEAR: fear = true; break;
+					// @TYPE knockback|Pushes the target away from the source caster. Speed is the given value divided by the framerate cap.
+					case Effect::KNOCKBACK: knockback_speed = static_cast<float>(e.magnitude)/static_cast<float>(fps); break;
+
+					// @TYPE ${STATNAME}|Increases ${STATNAME}, where ${STATNAME} is any of the base stats. Examples: hp, avoidance, xp_gain
+					// @TYPE ${DAMAGE_TYPE}|Increases a damage min or max, where ${DAMAGE_TYPE} is any 'min' or 'max' value found in engine/damage_types.txt. Example: dmg_melee_min
+					// @TYPE ${ELEMENT}_resist|Increase Resistance % to ${ELEMENT}, where ${ELEMENT} is any found in engine/elements.txt. Example: fire_resist
+					// @TYPE ${PRIMARYSTAT}|Increases ${PRIMARYSTAT}, where ${PRIMARYSTAT} is any of the primary stats defined in engine/primary_stats.txt. Example: physical
+					// stat bonuses are totaled by calcBonus()
+					default: break;
+				}
 			}
 		}
+
 		// expire shield effects
-		if (effect_list[i].magnitude_max > 0 && effect_list[i].magnitude == 0) {
-			// @TYPE shield|Create a damage absorbing barrier based on Mental damage stat. Duration is ignored.
-			if (effect_list[i].type == Effect::SHIELD) {
-				removeEffect(i);
-				i--;
-				continue;
-			}
-		}
+		// @TYPE shield|Create a damage absorbing barrier based on Mental damage stat. Duration is ignored.
+		if (e.type == Effect::SHIELD && e.magnitude_max > 0 && e.magnitude == 0)
+			expired = true;
+
 		// expire effects based on animations
-		if ((effect_list[i].animation && effect_list[i].animation->isLastFrame()) || !effect_list[i].animation) {
-			// @TYPE heal|Restore HP based on Mental damage stat.
-			if (effect_list[i].type == Effect::HEAL) {
-				removeEffect(i);
-				i--;
-				continue;
-			}
+		// @TYPE heal|Restore HP based on Mental damage stat.
+		if (e.type == Effect::HEAL && (!e.animation || e.animation->isLastFrame()))
+			expired = true;
+
+		if (expired) {
+			onRemoveEffect(e);
+			continue;
 		}
 
 		// animate
-		if (effect_list[i].animation) {
-			if (!effect_list[i].animation->isCompleted())
-				effect_list[i].animation->advanceFrame();
+		if (e.animation) {
+			if (!e.animation->isCompleted())
+				e.animation->advanceFrame();
 		}
+
+		if (kept != i)
+			effect_list[kept].swap(e);
+		kept++;
 	}
+
+	if (kept < effect_list.size())
+		effect_list.erase(effect_list.begin() + kept, effect_list.end());
+
+	if (bonus_outdated)
+		calcBonus();
 }
 
 void EffectManager::addEffect(EffectDef &effect, int duration, int magnitude, int source_type, size_t power_id) {
@@ -335,9 +401,10 @@ void EffectManager::addEffectInternal(EffectDef &effect, int duration, int magni
 	size_t insert_pos;
 	int trigger = power_id > 0 ? powers->powers[power_id].passive_trigger : -1;
 	size_t passive_id = (power_id > 0 && powers->powers[power_id].passive) ? power_id : 0;
+	const StringID effect_id = Utils::internString(effect.id);
 
 	for (size_t i=effect_list.size(); i>0; i--) {
-		if (effect_list[i-1].id == effect.id) {
+		if (effect_list[i-1].id == effect_id) {
 			if (trigger > -1 && effect_list[i-1].trigger == trigger)
 				return; // trigger effects can only be cast once per trigger
 
@@ -385,7 +452,7 @@ void EffectManager::addEffectInternal(EffectDef &effect, int duration, int magni
 
 	Effect e;
 
-	e.id = effect.id;
+	e.id = effect_id;
 	e.name = effect.name;
 	e.icon = effect.icon;
 	e.type = effect_type;
@@ -414,14 +481,54 @@ void EffectManager::addEffectInternal(EffectDef &effect, int duration, int magni
 		insert_pos--;
 	}
 
-	if (insert_effect)
-		effect_list.insert(effect_list.begin() + insert_pos, e);
-	else
-		effect_list.push_back(e);
+	if (isStatType(e.type) && e.duration >= 0)
+		bonus_outdated = true;
+
+	appendEffect().swap(e);
+
+	// move the new effect into place by swapping it with each effect after insert_pos
+	if (insert_effect) {
+		for (size_t i = effect_list.size() - 1; i > insert_pos; --i) {
+			effect_list[i].swap(effect_list[i-1]);
+		}
+	}
+}
+
+/**
+ * Add an empty effect to the end of the list.
+ * When the list has to grow, the effects are swapped into the larger list instead of being copied.
+ */
+Effect& EffectManager::appendEffect() {
+	if (effect_list.size() == effect_list.capacity()) {
+		std::vector<Effect> larger;
+		larger.reserve(std::max<size_t>(4, effect_list.capacity() * 2));
+		larger.resize(effect_list.size());
+		for (size_t i = 0; i < effect_list.size(); ++i) {
+			larger[i].swap(effect_list[i]);
+		}
+		effect_list.swap(larger);
+	}
+
+	effect_list.resize(effect_list.size() + 1);
+	return effect_list.back();
 }
 
+/**
+ * Remove one effect, keeping the order of the others
+ */
 void EffectManager::removeEffect(size_t id) {
-	effect_list.erase(effect_list.begin()+id);
+	onRemoveEffect(effect_list[id]);
+
+	for (size_t i = id + 1; i < effect_list.size(); ++i) {
+		effect_list[i-1].swap(effect_list[i]);
+	}
+	effect_list.pop_back();
+}
+
+void EffectManager::onRemoveEffect(const Effect& e) {
+	if (isStatType(e.type) && e.duration >= 0)
+		bonus_outdated = true;
+
 	refresh_stats = true;
 }
 
@@ -437,7 +544,7 @@ void EffectManager::removeEffectPassive(size_t id) {
 	}
 }
 
-void EffectManager::removeEffectID(const std::vector< std::pair<std::string, int> >& remove_effects) {
+void EffectManager::removeEffectID(const std::vector< std::pair<StringID, int> >& remove_effects) {
 	for (size_t i = 0; i < remove_effects.size(); i++) {
 		int count = remove_effects[i].second;
 		bool remove_all = (count == 0 ? true : false);
@@ -455,11 +562,13 @@ void EffectManager::removeEffectID(const std::vector< std::pair<std::string, int
 }
 
 void EffectManager::clearEffects() {
-	for (size_t i=effect_list.size(); i > 0; i--) {
-		removeEffect(i-1);
+	for (size_t i = 0; i < effect_list.size(); ++i) {
+		onRemoveEffect(effect_list[i]);
 	}
+	effect_list.clear();
 
 	clearStatus();
+	calcBonus();
 
 	// clear triggers
 	triggered_others = triggered_block = triggered_hit = triggered_halfdeath = triggered_joincombat = triggered_death = false;
@@ -616,7 +725,7 @@ void EffectManager::getCurrentAlpha(uint8_t& alpha_mod) {
 	}
 }
 
-bool EffectManager::hasEffect(const std::string& id, int req_count) {
+bool EffectManager::hasEffect(StringID id, int req_count) {
 	if (req_count <= 0)
 		return false;
 
@@ -630,14 +739,14 @@ bool EffectManager::hasEffect(const std::string& id, int req_count) {
 	return count >= req_count;
 }
 
-float EffectManager::getAttackSpeed(const std::string& anim_name) {
+float EffectManager::getAttackSpeed(StringID anim_name) {
 	float attack_speed = 100;
 
 	for (size_t i = 0; i < effect_list.size(); ++i) {
 		if (effect_list[i].type != Effect::ATTACK_SPEED)
 			continue;
 
-		if (effect_list[i].attack_speed_anim.empty() || effect_list[i].attack_speed_anim == anim_name) {
+		if (effect_list[i].attack_speed_anim == 0 || effect_list[i].attack_speed_anim == anim_name) {
 			attack_speed = (static_cast<float>(effect_list[i].magnitude) * attack_speed) / 100.0f;
 		}
 	}
@@ -67,10 +67,11 @@ public:
 	Effect& operator=(const Effect& other);
 	~Effect();
 
+	void swap(Effect& other);
 	void loadAnimation(const std::string &s);
 	void unloadAnimation();
 
-	std::string id;
+	StringID id; // EffectDef::id, see Utils::internString()
 	std::string name;
 	int icon;
 	int ticks;
@@ -88,7 +89,7 @@ public:
 	bool group_stack;
 	Color color_mod;
 	uint8_t alpha_mod;
-	std::string attack_speed_anim;
+	StringID attack_speed_anim;
 };
 
 class EffectDef {
@@ -106,13 +107,18 @@ public:
 	bool render_above;
 	Color color_mod;
 	uint8_t alpha_mod;
-	std::string attack_speed_anim;
+	StringID attack_speed_anim;
 };
 
 class EffectManager {
 private:
+	Effect& appendEffect();
 	void removeEffect(size_t id);
+	void onRemoveEffect(const Effect& e);
 	void clearStatus();
+	void calcBonus();
+	void setBonus(std::vector<int>& values, size_t index, int value, size_t stat_offset);
+	bool isStatType(int type);
 	int getType(const std::string& type);
 	void addEffectInternal(EffectDef &effect, int duration, int magnitude, int source_type, bool item, size_t power_id);
 
@@ -124,7 +130,7 @@ public:
 	void addItemEffect(EffectDef &effect, int duration, int magnitude);
 	void removeEffectType(const int type);
 	void removeEffectPassive(size_t id);
-	void removeEffectID(const std::vector< std::pair<std::string, int> >& remove_effects);
+	void removeEffectID(const std::vector< std::pair<StringID, int> >& remove_effects);
 	void clearEffects();
 	void clearNegativeEffects(int type = -1);
 	void clearItemEffects();
@@ -133,9 +139,11 @@ public:
 	bool isDebuffed();
 	void getCurrentColor(Color& color_mod);
 	void getCurrentAlpha(uint8_t& alpha_mod);
-	bool hasEffect(const std::string& id, int req_count);
-	float getAttackSpeed(const std::string& anim_name);
+	bool hasEffect(StringID id, int req_count);
+	float getAttackSpeed(StringID anim_name);
 
+	// effects are never copied inside the list, since copying an effect reloads its animation
+	// they are swapped instead, see Effect::swap()
 	std::vector<Effect> effect_list;
 
 	int damage;
@@ -164,6 +172,13 @@ public:
 	std::vector<int> bonus_resist;
 	std::vector<int> bonus_primary;
 
+	// the stat bonuses are only totaled again when an effect that changes stats is added or removed
+	bool bonus_outdated;
+
+	// bonuses that changed since StatBlock last applied them
+	// each value is an effect type minus Effect::TYPE_COUNT, i.e. an index into bonus, followed by bonus_resist and bonus_primary
+	std::vector<size_t> changed_bonus;
+
 	bool triggered_others;
 	bool triggered_block;
 	bool triggered_hit;
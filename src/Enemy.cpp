@@ -31,6 +31,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "Settings.h"
 #include "SharedGameResources.h"
 #include "SharedResources.h"
+#include "Utils.h"
 #include "UtilsMath.h"
 
 #include <math.h>
@@ -175,8 +176,7 @@ void Enemy::doRewards(int source_type) {
  */
 Renderable Enemy::getRender() {
 	Renderable r = activeAnimation->getCurrentFrame(stats.direction);
-	r.map_pos.x = stats.pos.x;
-	r.map_pos.y = stats.pos.y;
+	r.map_pos = Utils::interpolate(stats.prev_pos, stats.pos);
 	if (stats.hp > 0) {
 		if (stats.hero_ally)
 			r.type = Renderable::TYPE_ALLY;
@@ -0,0 +1,252 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class EnemyGrid
+ */
+
+#include "Enemy.h"
+#include "EnemyGrid.h"
+#include "StatBlock.h"
+
+#include <cfloat>
+#include <math.h>
+
+namespace {
+	// keeps the grid small even if an entity ends up far outside of the map
+	const int MAX_BUCKETS = 1024;
+
+	int toBucket(float pos) {
+		return static_cast<int>(floorf(pos / static_cast<float>(EnemyGrid::BUCKET_SIZE)));
+	}
+}
+
+EnemyGrid::EnemyGrid()
+	: origin(0, 0)
+	, size(0, 0)
+{
+}
+
+EnemyGrid::~EnemyGrid() {
+}
+
+/**
+ * Sort all enemies into buckets. Called once per logic tick.
+ */
+void EnemyGrid::build(const std::vector<Enemy*>& enemies) {
+	entities = enemies;
+	bucket_ids.resize(entities.size());
+
+	if (entities.empty()) {
+		origin = Point(0, 0);
+		size = Point(0, 0);
+		bucket_start.assign(1, 0);
+		return;
+	}
+
+	Point bmin(toBucket(entities[0]->stats.pos.x), toBucket(entities[0]->stats.pos.y));
+	Point bmax(bmin);
+	for (size_t i = 1; i < entities.size(); ++i) {
+		const int bx = toBucket(entities[i]->stats.pos.x);
+		const int by = toBucket(entities[i]->stats.pos.y);
+		bmin.x = std::min(bmin.x, bx);
+		bmin.y = std::min(bmin.y, by);
+		bmax.x = std::max(bmax.x, bx);
+		bmax.y = std::max(bmax.y, by);
+	}
+
+	origin = bmin;
+	size.x = std::min(bmax.x - bmin.x + 1, MAX_BUCKETS);
+	size.y = std::min(bmax.y - bmin.y + 1, MAX_BUCKETS);
+
+	// counting sort: count the entities in each bucket, then turn the counts into offsets
+	bucket_start.assign(size.x * size.y + 1, 0);
+	scratch.resize(entities.size());
+	for (size_t i = 0; i < entities.size(); ++i) {
+		const int bx = std::min(toBucket(entities[i]->stats.pos.x) - origin.x, size.x - 1);
+		const int by = std::min(toBucket(entities[i]->stats.pos.y) - origin.y, size.y - 1);
+		scratch[i] = static_cast<unsigned>(by * size.x + bx);
+		bucket_start[scratch[i] + 1]++;
+	}
+	for (size_t i = 1; i < bucket_start.size(); ++i) {
+		bucket_start[i] += bucket_start[i-1];
+	}
+
+	// ids are inserted in ascending order, so each bucket stays sorted
+	std::vector<unsigned> fill(bucket_start.begin(), bucket_start.end() - 1);
+	for (size_t i = 0; i < entities.size(); ++i) {
+		bucket_ids[fill[scratch[i]]++] = static_cast<unsigned>(i);
+	}
+}
+
+void EnemyGrid::clear() {
+	entities.clear();
+	bucket_ids.clear();
+	bucket_start.assign(1, 0);
+	origin = Point(0, 0);
+	size = Point(0, 0);
+}
+
+/**
+ * Converts a tile area to an inclusive range of buckets, clamped to the grid
+ */
+void EnemyGrid::getBucketRange(const FPoint& min, const FPoint& max, Point& bucket_min, Point& bucket_max) const {
+	bucket_min.x = std::max(toBucket(min.x) - origin.x, 0);
+	bucket_min.y = std::max(toBucket(min.y) - origin.y, 0);
+	bucket_max.x = std::min(toBucket(max.x) - origin.x, size.x - 1);
+	bucket_max.y = std::min(toBucket(max.y) - origin.y, size.y - 1);
+}
+
+void EnemyGrid::collect(const Point& bucket_min, const Point& bucket_max, std::vector<unsigned>& ids) const {
+	for (int by = bucket_min.y; by <= bucket_max.y; ++by) {
+		for (int bx = bucket_min.x; bx <= bucket_max.x; ++bx) {
+			const unsigned bucket = static_cast<unsigned>(by * size.x + bx);
+			ids.insert(ids.end(), bucket_ids.begin() + bucket_start[bucket], bucket_ids.begin() + bucket_start[bucket + 1]);
+		}
+	}
+}
+
+/**
+ * Returns the matching enemies in the order of EnemyManager::enemies
+ */
+void EnemyGrid::sortResult(std::vector<unsigned>& ids, std::vector<Enemy*>& result) const {
+	std::sort(ids.begin(), ids.end());
+	for (size_t i = 0; i < ids.size(); ++i) {
+		result.push_back(entities[ids[i]]);
+	}
+}
+
+bool EnemyGrid::isAccepted(const Enemy* e, int filter) const {
+	if (filter == FILTER_ALIVE)
+		return !(e->stats.cur_state == StatBlock::ENEMY_DEAD || e->stats.cur_state == StatBlock::ENEMY_CRITDEAD);
+	else if (filter == FILTER_CORPSE)
+		return e->stats.corpse;
+	return true;
+}
+
+/**
+ * Get all enemies that pass Utils::isWithinRadius()
+ */
+void EnemyGrid::getInRadius(const FPoint& center, float radius, std::vector<Enemy*>& result) const {
+	result.clear();
+	if (entities.empty())
+		return;
+
+	Point bucket_min, bucket_max;
+	getBucketRange(FPoint(center.x - radius, center.y - radius), FPoint(center.x + radius, center.y + radius), bucket_min, bucket_max);
+
+	scratch.clear();
+	collect(bucket_min, bucket_max, scratch);
+
+	size_t count = 0;
+	for (size_t i = 0; i < scratch.size(); ++i) {
+		if (Utils::isWithinRadius(center, radius, entities[scratch[i]]->stats.pos))
+			scratch[count++] = scratch[i];
+	}
+	scratch.resize(count);
+
+	sortResult(scratch, result);
+}
+
+/**
+ * Get all enemies with min <= pos < max
+ */
+void EnemyGrid::getInRect(const FPoint& min, const FPoint& max, std::vector<Enemy*>& result) const {
+	result.clear();
+	if (entities.empty())
+		return;
+
+	Point bucket_min, bucket_max;
+	getBucketRange(min, max, bucket_min, bucket_max);
+
+	scratch.clear();
+	collect(bucket_min, bucket_max, scratch);
+
+	size_t count = 0;
+	for (size_t i = 0; i < scratch.size(); ++i) {
+		const FPoint& pos = entities[scratch[i]]->stats.pos;
+		if (pos.x >= min.x && pos.y >= min.y && pos.x < max.x && pos.y < max.y)
+			scratch[count++] = scratch[i];
+	}
+	scratch.resize(count);
+
+	sortResult(scratch, result);
+}
+
+/**
+ * Get up to 'count' enemies that are closest to pos and no further away than max_range, nearest first.
+ * Enemies at the same distance are ordered like EnemyManager::enemies.
+ * Buckets are searched in growing rings around pos until no closer enemy can be found.
+ */
+void EnemyGrid::getNearest(const FPoint& pos, size_t count, float max_range, int filter, std::vector<Enemy*>& result, std::vector<float>* distances) const {
+	result.clear();
+	if (distances)
+		distances->clear();
+	if (entities.empty() || count == 0)
+		return;
+
+	const Point center(std::max(0, std::min(toBucket(pos.x) - origin.x, size.x - 1)),
+					   std::max(0, std::min(toBucket(pos.y) - origin.y, size.y - 1)));
+	const int max_ring = std::max(std::max(center.x, size.x - 1 - center.x), std::max(center.y, size.y - 1 - center.y));
+
+	scratch_nearest.clear();
+	float kth_best = FLT_MAX;
+
+	for (int ring = 0; ring <= max_ring; ++ring) {
+		// anything in this ring is at least this far away
+		const float ring_dist = static_cast<float>(std::max(ring - 1, 0) * BUCKET_SIZE);
+		if (ring_dist > max_range || ring_dist > kth_best)
+			break;
+
+		for (int by = center.y - ring; by <= center.y + ring; ++by) {
+			if (by < 0 || by >= size.y)
+				continue;
+
+			// only the outer edge of the ring
+			const int step = (by == center.y - ring || by == center.y + ring) ? 1 : ring * 2;
+
+			for (int bx = center.x - ring; bx <= center.x + ring; bx += step) {
+				if (bx < 0 || bx >= size.x)
+					continue;
+
+				const unsigned bucket = static_cast<unsigned>(by * size.x + bx);
+				for (unsigned i = bucket_start[bucket]; i < bucket_start[bucket + 1]; ++i) {
+					const unsigned id = bucket_ids[i];
+					if (!isAccepted(entities[id], filter))
+						continue;
+
+					const float dist = Utils::calcDist(pos, entities[id]->stats.pos);
+					if (dist <= max_range)
+						scratch_nearest.push_back(std::pair<float, unsigned>(dist, id));
+				}
+			}
+		}
+
+		if (scratch_nearest.size() >= count) {
+			std::sort(scratch_nearest.begin(), scratch_nearest.end());
+			scratch_nearest.resize(count);
+			kth_best = scratch_nearest.back().first;
+		}
+	}
+
+	std::sort(scratch_nearest.begin(), scratch_nearest.end());
+	for (size_t i = 0; i < scratch_nearest.size() && i < count; ++i) {
+		result.push_back(entities[scratch_nearest[i].second]);
+		if (distances)
+			distances->push_back(scratch_nearest[i].first);
+	}
+}
@@ -0,0 +1,77 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class EnemyGrid
+ *
+ * Spatial index of the positions of all enemies (and allies) on the map.
+ * Enemies are sorted into square buckets of tiles, so area queries only need to look at
+ * the buckets that overlap the area instead of every enemy.
+ *
+ * The grid is a snapshot and is rebuilt once per logic tick by EnemyManager. Distance checks
+ * use the current position of each enemy. Area queries return enemies in the same order as
+ * EnemyManager::enemies, so switching from a linear scan doesn't change which enemy is
+ * processed first.
+ */
+
+#ifndef ENEMY_GRID_H
+#define ENEMY_GRID_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+class Enemy;
+
+class EnemyGrid {
+private:
+	void getBucketRange(const FPoint& min, const FPoint& max, Point& bucket_min, Point& bucket_max) const;
+	void collect(const Point& bucket_min, const Point& bucket_max, std::vector<unsigned>& ids) const;
+	void sortResult(std::vector<unsigned>& ids, std::vector<Enemy*>& result) const;
+	bool isAccepted(const Enemy* e, int filter) const;
+
+	Point origin; // tile position of the first bucket
+	Point size; // number of buckets in each direction
+
+	std::vector<Enemy*> entities; // copy of EnemyManager::enemies at build time
+	std::vector<unsigned> bucket_start; // [size.x * size.y + 1] offsets into bucket_ids
+	std::vector<unsigned> bucket_ids; // entity ids, grouped by bucket
+
+	// kept between queries to avoid reallocating
+	mutable std::vector<unsigned> scratch;
+	mutable std::vector< std::pair<float, unsigned> > scratch_nearest;
+
+public:
+	static const int BUCKET_SIZE = 4; // in tiles
+
+	enum {
+		FILTER_NONE = 0,
+		FILTER_ALIVE = 1, // not in a dead state
+		FILTER_CORPSE = 2
+	};
+
+	EnemyGrid();
+	~EnemyGrid();
+
+	void build(const std::vector<Enemy*>& enemies);
+	void clear();
+
+	void getInRadius(const FPoint& center, float radius, std::vector<Enemy*>& result) const;
+	void getInRect(const FPoint& min, const FPoint& max, std::vector<Enemy*>& result) const;
+	void getNearest(const FPoint& pos, size_t count, float max_range, int filter, std::vector<Enemy*>& result, std::vector<float>* distances) const;
+};
+
+#endif
@@ -35,6 +35,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "MapRenderer.h"
 #include "MenuActionBar.h"
 #include "PowerManager.h"
+#include "Profiler.h"
 #include "RenderDevice.h"
 #include "Settings.h"
 #include "SharedGameResources.h"
@@ -47,6 +48,7 @@ EnemyManager::EnemyManager()
 	, hero_stealth(0)
 	, player_blocked(false)
 	, player_blocked_timer(settings->max_frames_per_sec / 6) {
+	profile_id = profiler->addSection("enemym");
 	handleNewMap();
 }
 
@@ -137,6 +139,7 @@ void EnemyManager::handleNewMap () {
 		prototypes[i].unloadSounds();
 	}
 	prototypes.clear();
+	sprite_bounds = Rect();
 
 	// load new enemies
 	while (!mapr->enemies.empty()) {
@@ -197,6 +200,8 @@ void EnemyManager::handleNewMap () {
 		mapr->collider.block(e->stats.pos.x, e->stats.pos.y, MapCollision::IS_ALLY);
 	}
 
+	grid.build(enemies);
+
 	// load enemies that can be spawn by avatar's powers
 	for (size_t i = 0; i < pc->stats.powers_list.size(); i++) {
 		int power_index = pc->stats.powers_list[i];
@@ -384,6 +389,7 @@ bool EnemyManager::checkPartyMembers() {
  * perform logic() for all enemies
  */
 void EnemyManager::logic() {
+	ProfilerScope profile(profile_id);
 
 	if (player_blocked) {
 		player_blocked_timer.tick();
@@ -393,63 +399,91 @@ void EnemyManager::logic() {
 
 	handleSpawn();
 
+	// enemies chasing the hero will step along this field
+	if (pc->stats.alive)
+		mapr->collider.flow_field.setTarget(pc->stats.pos);
+
 	std::vector<Enemy*>::iterator it;
 	for (it = enemies.begin(); it != enemies.end(); ++it) {
 		// new actions this round
 		(*it)->stats.hero_stealth = hero_stealth;
+		(*it)->stats.prev_pos = (*it)->stats.pos;
 		(*it)->logic();
 	}
+
+	grid.build(enemies);
 }
 
+/**
+ * Find the first enemy whose sprite is under the mouse cursor.
+ * Only the enemies whose position is close enough to the cursor for any sprite seen on this map
+ * to reach it are checked. A new enemy with a larger sprite can be missed until it is first drawn.
+ */
 Enemy* EnemyManager::enemyFocus(const Point& mouse, const FPoint& cam, bool alive_only) {
+	if (sprite_bounds.w <= 0 || sprite_bounds.h <= 0)
+		return NULL;
+
+	// screen area that an enemy position must be in; its map area is the bounding box of the corners
+	const int left = mouse.x - sprite_bounds.x - sprite_bounds.w;
+	const int right = mouse.x - sprite_bounds.x;
+	const int top = mouse.y - sprite_bounds.y - sprite_bounds.h;
+	const int bottom = mouse.y - sprite_bounds.y;
+
+	FPoint corners[4];
+	corners[0] = Utils::screenToMap(left, top, cam.x, cam.y);
+	corners[1] = Utils::screenToMap(right, top, cam.x, cam.y);
+	corners[2] = Utils::screenToMap(left, bottom, cam.x, cam.y);
+	corners[3] = Utils::screenToMap(right, bottom, cam.x, cam.y);
+
+	// mapToScreen() rounds, so the area is grown by a tile
+	FPoint area_min(corners[0].x - 1, corners[0].y - 1);
+	FPoint area_max(corners[0].x + 1, corners[0].y + 1);
+	for (int i = 1; i < 4; ++i) {
+		area_min.x = std::min(area_min.x, corners[i].x - 1);
+		area_min.y = std::min(area_min.y, corners[i].y - 1);
+		area_max.x = std::max(area_max.x, corners[i].x + 1);
+		area_max.y = std::max(area_max.y, corners[i].y + 1);
+	}
+
+	grid.getInRect(area_min, area_max, focus_result);
+
 	Point p;
 	Rect r;
-	for(unsigned int i = 0; i < enemies.size(); i++) {
-		if(alive_only && (enemies[i]->stats.cur_state == StatBlock::ENEMY_DEAD || enemies[i]->stats.cur_state == StatBlock::ENEMY_CRITDEAD)) {
+	for(unsigned int i = 0; i < focus_result.size(); i++) {
+		if(alive_only && (focus_result[i]->stats.cur_state == StatBlock::ENEMY_DEAD || focus_result[i]->stats.cur_state == StatBlock::ENEMY_CRITDEAD)) {
 			continue;
 		}
-		p = Utils::mapToScreen(enemies[i]->stats.pos.x, enemies[i]->stats.pos.y, cam.x, cam.y);
+		p = Utils::mapToScreen(focus_result[i]->stats.pos.x, focus_result[i]->stats.pos.y, cam.x, cam.y);
 
-		Renderable ren = enemies[i]->getRender();
+		Renderable ren = focus_result[i]->getRender();
 		r.w = ren.src.w;
 		r.h = ren.src.h;
 		r.x = p.x - ren.offset.x;
 		r.y = p.y - ren.offset.y;
 
 		if (Utils::isWithinRect(r, mouse)) {
-			Enemy *enemy = enemies[i];
+			Enemy *enemy = focus_result[i];
 			return enemy;
 		}
 	}
 	return NULL;
 }
 
+/**
+ * Find the closest living enemy (or corpse) to pos
+ * If saved_distance is given, the range is unlimited and the distance is stored there
+ */
 Enemy* EnemyManager::getNearestEnemy(const FPoint& pos, bool get_corpse, float *saved_distance, float max_range) {
-	Enemy* nearest = NULL;
-	float best_distance = std::numeric_limits<float>::max();
+	const float range = saved_distance ? std::numeric_limits<float>::max() : max_range;
+	grid.getNearest(pos, 1, range, (get_corpse ? EnemyGrid::FILTER_CORPSE : EnemyGrid::FILTER_ALIVE), nearest_result, &nearest_distance);
 
-	for (unsigned i=0; i<enemies.size(); i++) {
-		if(!get_corpse && (enemies[i]->stats.cur_state == StatBlock::ENEMY_DEAD || enemies[i]->stats.cur_state == StatBlock::ENEMY_CRITDEAD)) {
-			continue;
-		}
-		if (get_corpse && !enemies[i]->stats.corpse) {
-			continue;
-		}
-
-		float distance = Utils::calcDist(pos, enemies[i]->stats.pos);
-		if (distance < best_distance) {
-			best_distance = distance;
-			nearest = enemies[i];
-		}
-	}
-
-	if (nearest && saved_distance)
-		*saved_distance = best_distance;
+	if (nearest_result.empty())
+		return NULL;
 
-	if (!saved_distance && best_distance > max_range)
-		nearest = NULL;
+	if (saved_distance)
+		*saved_distance = nearest_distance[0];
 
-	return nearest;
+	return nearest_result[0];
 }
 
 /**
@@ -501,6 +535,28 @@ void EnemyManager::spawn(const std::string& enemy_type, const Point& target) {
 	powers->map_enemies.push(espawn);
 }
 
+/**
+ * Grow sprite_bounds to cover the area of a sprite around its enemy's position
+ */
+void EnemyManager::addSpriteBounds(const Renderable& re) {
+	const int x0 = -re.offset.x;
+	const int y0 = -re.offset.y;
+	const int x1 = x0 + re.src.w;
+	const int y1 = y0 + re.src.h;
+
+	if (sprite_bounds.w <= 0 || sprite_bounds.h <= 0) {
+		sprite_bounds = Rect(x0, y0, re.src.w, re.src.h);
+		return;
+	}
+
+	const int min_x = std::min(sprite_bounds.x, x0);
+	const int min_y = std::min(sprite_bounds.y, y0);
+	sprite_bounds.w = std::max(sprite_bounds.x + sprite_bounds.w, x1) - min_x;
+	sprite_bounds.h = std::max(sprite_bounds.y + sprite_bounds.h, y1) - min_y;
+	sprite_bounds.x = min_x;
+	sprite_bounds.y = min_y;
+}
+
 /**
  * addRenders()
  * Map objects need to be drawn in Z order, so we allow a parent object (GameEngine)
@@ -513,6 +569,7 @@ void EnemyManager::addRenders(std::vector<Renderable> &r, std::vector<Renderable
 		if (!dead || !(*it)->stats.corpse_timer.isEnd()) {
 			Renderable re = (*it)->getRender();
 			re.prio = 1;
+			addSpriteBounds(re);
 			(*it)->stats.effects.getCurrentColor(re.color_mod);
 			(*it)->stats.effects.getCurrentAlpha(re.alpha_mod);
 
@@ -529,7 +586,7 @@ void EnemyManager::addRenders(std::vector<Renderable> &r, std::vector<Renderable
 			for (unsigned i = 0; i < (*it)->stats.effects.effect_list.size(); ++i) {
 				if ((*it)->stats.effects.effect_list[i].animation) {
 					Renderable ren = (*it)->stats.effects.effect_list[i].animation->getCurrentFrame(0);
-					ren.map_pos = (*it)->stats.pos;
+					ren.map_pos = Utils::interpolate((*it)->stats.prev_pos, (*it)->stats.pos);
 					if ((*it)->stats.effects.effect_list[i].render_above) ren.prio = 2;
 					else ren.prio = 0;
 					r.push_back(ren);
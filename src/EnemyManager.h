@@ -27,6 +27,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #define ENEMY_MANAGER_H
 
 #include "CommonIncludes.h"
+#include "EnemyGrid.h"
 #include "Utils.h"
 
 class Animation;
@@ -36,6 +37,7 @@ class EnemyManager {
 private:
 
 	void loadAnimations(Enemy *e);
+	void addSpriteBounds(const Renderable& re);
 
 	std::vector<std::string> anim_prefixes;
 	std::vector<std::vector<Animation*> > anim_entities;
@@ -48,6 +50,16 @@ private:
 
 	std::vector<Enemy> prototypes;
 
+	// results of getNearestEnemy(), kept to avoid reallocating
+	std::vector<Enemy*> nearest_result;
+	std::vector<float> nearest_distance;
+
+	// area that any enemy sprite drawn on this map covered, relative to the enemy position (see enemyFocus())
+	Rect sprite_bounds;
+	std::vector<Enemy*> focus_result;
+
+	size_t profile_id;
+
 public:
 	EnemyManager();
 	~EnemyManager();
@@ -66,6 +78,9 @@ public:
 	std::vector<Enemy*> enemies;
 	int hero_stealth;
 
+	// positions of all enemies, rebuilt every logic tick
+	EnemyGrid grid;
+
 	bool player_blocked;
 	Timer player_blocked_timer;
 
@@ -52,6 +52,14 @@ const int directionDeltaX[8] =   {-1, -1, -1,  0,  1,  1,  1,  0};
 const int directionDeltaY[8] =   { 1,  0, -1, -1, -1,  0,  1,  1};
 const float speedMultiplyer[8] = { static_cast<float>(1.0/M_SQRT2), 1.0f, static_cast<float>(1.0/M_SQRT2), 1.0f, static_cast<float>(1.0/M_SQRT2), 1.0f, static_cast<float>(1.0/M_SQRT2), 1.0f};
 
+const StringID Entity::ANIM_STANCE = Utils::internString("stance");
+const StringID Entity::ANIM_RUN = Utils::internString("run");
+const StringID Entity::ANIM_BLOCK = Utils::internString("block");
+const StringID Entity::ANIM_HIT = Utils::internString("hit");
+const StringID Entity::ANIM_DIE = Utils::internString("die");
+const StringID Entity::ANIM_CRITDIE = Utils::internString("critdie");
+const StringID Entity::ANIM_SPAWN = Utils::internString("spawn");
+
 Entity::Entity()
 	: sprites(NULL)
 	, sound_attack()
@@ -96,9 +104,8 @@ void Entity::loadSoundsFromStatBlock(StatBlock *src_stats) {
 	if (!src_stats) src_stats = &stats;
 
 	for (size_t i = 0; i < src_stats->sfx_attack.size(); ++i) {
-		std::string anim_name = src_stats->sfx_attack[i].first;
-		sound_attack.push_back(std::pair<std::string, std::vector<SoundID> >());
-		sound_attack.back().first = anim_name;
+		sound_attack.push_back(std::pair<StringID, std::vector<SoundID> >());
+		sound_attack.back().first = Utils::internString(src_stats->sfx_attack[i].first);
 		for (size_t j = 0; j  < src_stats->sfx_attack[i].second.size(); ++j) {
 			SoundID sid = snd->load(src_stats->sfx_attack[i].second[j], "Entity attack");
 			sound_attack.back().second.push_back(sid);
@@ -145,7 +152,7 @@ void Entity::unloadSounds() {
 	snd->unload(sound_levelup);
 }
 
-void Entity::playAttackSound(const std::string& attack_name) {
+void Entity::playAttackSound(StringID attack_name) {
 	for (size_t i = 0; i < sound_attack.size(); ++i) {
 		if (!sound_attack[i].second.empty() && sound_attack[i].first == attack_name) {
 			size_t rand_index = rand() % sound_attack[i].second.size();
@@ -381,7 +388,7 @@ bool Entity::takeHit(Hazard &h) {
 		// reset the hazard ticks
 		h.lifespan = h.power->lifespan;
 
-		if (activeAnimation->getName() == "block") {
+		if (activeAnimation->getNameID() == ANIM_BLOCK) {
 			playSound(Entity::SOUND_BLOCK);
 		}
 
@@ -468,7 +475,7 @@ bool Entity::takeHit(Hazard &h) {
 				else {
 					if (eset->combat.max_resist < 100) dmg = 1;
 				}
-				if (activeAnimation->getName() == "block") {
+				if (activeAnimation->getNameID() == ANIM_BLOCK) {
 					playSound(Entity::SOUND_BLOCK);
 					resetActiveAnimation();
 				}
@@ -655,17 +662,17 @@ void Entity::resetActiveAnimation() {
 /**
  * Set the entity's current animation by name
  */
-bool Entity::setAnimation(const std::string& animationName) {
+bool Entity::setAnimation(StringID animationName) {
 
 	// if the animation is already the requested one do nothing
-	if (activeAnimation != NULL && activeAnimation->getName() == animationName)
+	if (activeAnimation != NULL && activeAnimation->getNameID() == animationName)
 		return true;
 
 	delete activeAnimation;
 	activeAnimation = animationSet->getAnimation(animationName);
 
 	if (activeAnimation == NULL)
-		Utils::logError("Entity::setAnimation(%s): not found", animationName.c_str());
+		Utils::logError("Entity::setAnimation(%s): not found", Utils::getInternedString(animationName).c_str());
 
 	return activeAnimation == NULL;
 }
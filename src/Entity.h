@@ -49,6 +49,15 @@ public:
 		SOUND_BLOCK = 3
 	};
 
+	// names of the animations that every entity uses, see Utils::internString()
+	static const StringID ANIM_STANCE;
+	static const StringID ANIM_RUN;
+	static const StringID ANIM_BLOCK;
+	static const StringID ANIM_HIT;
+	static const StringID ANIM_DIE;
+	static const StringID ANIM_CRITDIE;
+	static const StringID ANIM_SPAWN;
+
 	Entity();
 	Entity(const Entity& e);
 	Entity& operator=(const Entity& e);
@@ -57,21 +66,21 @@ public:
 	void loadSounds();
 	void loadSoundsFromStatBlock(StatBlock *src_stats);
 	void unloadSounds();
-	void playAttackSound(const std::string& attack_name);
+	void playAttackSound(StringID attack_name);
 	void playSound(int sound_type);
 	bool move();
 	bool takeHit(Hazard &h);
 	virtual void doRewards(int) {}
 
 	// sound effects
-	std::vector<std::pair<std::string, std::vector<SoundID> > > sound_attack;
+	std::vector<std::pair<StringID, std::vector<SoundID> > > sound_attack;
 	std::vector<SoundID> sound_hit;
 	std::vector<SoundID> sound_die;
 	std::vector<SoundID> sound_critdie;
 	std::vector<SoundID> sound_block;
 	SoundID sound_levelup;
 
-	bool setAnimation(const std::string& animation);
+	bool setAnimation(StringID animation);
 	Animation *activeAnimation;
 	AnimationSet *animationSet;
 
@@ -0,0 +1,214 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class EventIndex
+ */
+
+#include "EventIndex.h"
+#include "EventManager.h"
+
+#include <math.h>
+
+EventIndex::Grid::Grid()
+	: cell_size(1)
+	, size(0, 0)
+{
+}
+
+/**
+ * Rounds towards negative infinity, so that areas left of or above the grid don't end up in the first cell
+ */
+int EventIndex::Grid::toCell(int pos) const {
+	if (pos >= 0)
+		return pos / cell_size;
+	return -((cell_size - 1 - pos) / cell_size);
+}
+
+/**
+ * Converts an area to an inclusive range of cells, clamped to the grid
+ */
+void EventIndex::Grid::getCellRange(const Rect& area, Point& cell_min, Point& cell_max) const {
+	cell_min.x = std::max(toCell(area.x), 0);
+	cell_min.y = std::max(toCell(area.y), 0);
+	cell_max.x = std::min(toCell(area.x + area.w - 1), size.x - 1);
+	cell_max.y = std::min(toCell(area.y + area.h - 1), size.y - 1);
+}
+
+/**
+ * Sort every area into the cells that it overlaps. Empty areas are left out.
+ */
+void EventIndex::Grid::build(const std::vector<Rect>& areas, int width, int height, int _cell_size) {
+	cell_size = std::max(_cell_size, 1);
+	size.x = std::max((width + cell_size - 1) / cell_size, 1);
+	size.y = std::max((height + cell_size - 1) / cell_size, 1);
+
+	// counting sort: count the areas in each cell, then turn the counts into offsets
+	cell_start.assign(size.x * size.y + 1, 0);
+
+	Point cell_min, cell_max;
+	for (size_t i = 0; i < areas.size(); ++i) {
+		if (areas[i].w <= 0 || areas[i].h <= 0)
+			continue;
+
+		getCellRange(areas[i], cell_min, cell_max);
+		for (int cy = cell_min.y; cy <= cell_max.y; ++cy) {
+			for (int cx = cell_min.x; cx <= cell_max.x; ++cx) {
+				cell_start[cy * size.x + cx + 1]++;
+			}
+		}
+	}
+	for (size_t i = 1; i < cell_start.size(); ++i) {
+		cell_start[i] += cell_start[i-1];
+	}
+
+	// ids are inserted in ascending order, so each cell stays sorted
+	cell_ids.resize(cell_start.back());
+	std::vector<unsigned> fill(cell_start.begin(), cell_start.end() - 1);
+	for (size_t i = 0; i < areas.size(); ++i) {
+		if (areas[i].w <= 0 || areas[i].h <= 0)
+			continue;
+
+		getCellRange(areas[i], cell_min, cell_max);
+		for (int cy = cell_min.y; cy <= cell_max.y; ++cy) {
+			for (int cx = cell_min.x; cx <= cell_max.x; ++cx) {
+				cell_ids[fill[cy * size.x + cx]++] = static_cast<unsigned>(i);
+			}
+		}
+	}
+}
+
+void EventIndex::Grid::clear() {
+	size = Point(0, 0);
+	cell_start.assign(1, 0);
+	cell_ids.clear();
+}
+
+/**
+ * Add the ids of all areas in the cells that overlap area. May contain duplicates.
+ */
+void EventIndex::Grid::get(const Rect& area, std::vector<size_t>& result) const {
+	if (size.x == 0 || size.y == 0)
+		return;
+
+	Point cell_min, cell_max;
+	getCellRange(area, cell_min, cell_max);
+
+	for (int cy = cell_min.y; cy <= cell_max.y; ++cy) {
+		for (int cx = cell_min.x; cx <= cell_max.x; ++cx) {
+			const unsigned cell = static_cast<unsigned>(cy * size.x + cx);
+			result.insert(result.end(), cell_ids.begin() + cell_start[cell], cell_ids.begin() + cell_start[cell + 1]);
+		}
+	}
+}
+
+EventIndex::EventIndex()
+	: event_count(0)
+{
+}
+
+EventIndex::~EventIndex() {
+}
+
+/**
+ * Index the trigger areas and hotspot centers of the map events
+ */
+void EventIndex::build(const std::vector<Event>& events, int map_w, int map_h) {
+	event_count = events.size();
+	always_checked.clear();
+
+	scratch_areas.assign(events.size(), Rect());
+	for (size_t i = 0; i < events.size(); ++i) {
+		const Event& ev = events[i];
+		if (ev.activate_type == Event::ACTIVATE_STATIC || ev.activate_type == Event::ACTIVATE_ON_CLEAR || ev.activate_type == Event::ACTIVATE_ON_LEAVE)
+			always_checked.push_back(i);
+		else if (ev.activate_type == -1 || ev.activate_type == Event::ACTIVATE_ON_TRIGGER)
+			scratch_areas[i] = ev.location;
+	}
+	triggers.build(scratch_areas, map_w, map_h, BUCKET_SIZE);
+
+	scratch_areas.assign(events.size(), Rect());
+	for (size_t i = 0; i < events.size(); ++i) {
+		const Event& ev = events[i];
+		if (ev.hotspot.h != 0)
+			scratch_areas[i] = Rect(static_cast<int>(floorf(ev.center.x)), static_cast<int>(floorf(ev.center.y)), 1, 1);
+	}
+	hotspots.build(scratch_areas, map_w, map_h, BUCKET_SIZE);
+
+	screen.clear();
+}
+
+/**
+ * Index the screen areas of the hotspots, given in the same order as the events
+ */
+void EventIndex::buildScreen(const std::vector<Rect>& screen_areas, int view_w, int view_h) {
+	screen.build(screen_areas, view_w, view_h, SCREEN_CELL_SIZE);
+}
+
+void EventIndex::clear() {
+	triggers.clear();
+	hotspots.clear();
+	screen.clear();
+	always_checked.clear();
+	event_count = 0;
+}
+
+/**
+ * Number of events when the index was built
+ */
+size_t EventIndex::getEventCount() const {
+	return event_count;
+}
+
+void EventIndex::sortResult(std::vector<size_t>& result) {
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+/**
+ * Get the events that checkEvents() needs to look at when the hero stands on tile:
+ * events whose area contains the tile, plus static, on_clear and on_leave events.
+ */
+void EventIndex::getTriggerEvents(const Point& tile, std::vector<size_t>& result) const {
+	result = always_checked;
+	triggers.get(Rect(tile.x, tile.y, 1, 1), result);
+	sortResult(result);
+}
+
+/**
+ * Get the events with a hotspot whose center may be within range of pos (in both directions).
+ * Callers still need to check the exact distance.
+ */
+void EventIndex::getHotspotEvents(const FPoint& pos, float range, std::vector<size_t>& result) const {
+	result.clear();
+
+	const int min_x = static_cast<int>(floorf(pos.x - range));
+	const int min_y = static_cast<int>(floorf(pos.y - range));
+	const int max_x = static_cast<int>(floorf(pos.x + range));
+	const int max_y = static_cast<int>(floorf(pos.y + range));
+	hotspots.get(Rect(min_x, min_y, max_x - min_x + 1, max_y - min_y + 1), result);
+	sortResult(result);
+}
+
+/**
+ * Get the events whose hotspot may cover the screen position pos
+ */
+void EventIndex::getScreenHotspots(const Point& pos, std::vector<size_t>& result) const {
+	result.clear();
+	screen.get(Rect(pos.x, pos.y, 1, 1), result);
+	sortResult(result);
+}
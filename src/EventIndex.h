@@ -0,0 +1,84 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class EventIndex
+ *
+ * Spatial index of the map events, used by MapRenderer to find the events near the hero or under the mouse.
+ * The map space part sorts the trigger areas and hotspot centers into square buckets of tiles, and is
+ * rebuilt when events are added or removed. The screen space part sorts the on-screen area of each
+ * hotspot into square cells of pixels, and is rebuilt when the camera moves.
+ *
+ * Events are referred to by their index in MapRenderer::events. All queries return indices in
+ * ascending order, so callers can process them in reverse and still erase events while doing so.
+ */
+
+#ifndef EVENT_INDEX_H
+#define EVENT_INDEX_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+class Event;
+
+class EventIndex {
+private:
+	class Grid {
+	private:
+		int toCell(int pos) const;
+		void getCellRange(const Rect& area, Point& cell_min, Point& cell_max) const;
+
+		int cell_size;
+		Point size; // number of cells in each direction
+		std::vector<unsigned> cell_start; // [size.x * size.y + 1] offsets into cell_ids
+		std::vector<unsigned> cell_ids; // area ids, grouped by cell
+
+	public:
+		Grid();
+		void build(const std::vector<Rect>& areas, int width, int height, int _cell_size);
+		void clear();
+		void get(const Rect& area, std::vector<size_t>& result) const;
+	};
+
+	static void sortResult(std::vector<size_t>& result);
+
+	Grid triggers; // areas of events that run when the hero enters them
+	Grid hotspots; // centers of events that have a hotspot
+	Grid screen; // screen areas of hotspots
+
+	std::vector<size_t> always_checked; // events that checkEvents() looks at wherever the hero is
+	std::vector<Rect> scratch_areas;
+	size_t event_count;
+
+public:
+	static const int BUCKET_SIZE = 4; // in tiles
+	static const int SCREEN_CELL_SIZE = 64; // in pixels
+
+	EventIndex();
+	~EventIndex();
+
+	void build(const std::vector<Event>& events, int map_w, int map_h);
+	void buildScreen(const std::vector<Rect>& screen_areas, int view_w, int view_h);
+	void clear();
+	size_t getEventCount() const;
+
+	void getTriggerEvents(const Point& tile, std::vector<size_t>& result) const;
+	void getHotspotEvents(const FPoint& pos, float range, std::vector<size_t>& result) const;
+	void getScreenHotspots(const Point& pos, std::vector<size_t>& result) const;
+};
+
+#endif
@@ -81,6 +81,8 @@ void Event::deleteAllComponents(const int _type) {
 /**
  * Class: EventManager
  */
+std::map<std::string, std::vector<Event> > EventManager::script_cache;
+
 EventManager::EventManager() {
 }
 
@@ -747,7 +749,7 @@ bool EventManager::executeEventInternal(Event &ev, bool skip_delay) {
 		else if (ec->type == EventComponent::MAPMOD) {
 			if (ec->s == "collision") {
 				if (ec->x >= 0 && ec->x < mapr->w && ec->y >= 0 && ec->y < mapr->h) {
-					mapr->collider.colmap[ec->x][ec->y] = static_cast<unsigned short>(ec->z);
+					mapr->collider.setTile(ec->x, ec->y, static_cast<unsigned short>(ec->z));
 					mapr->map_change = true;
 				}
 				else
@@ -759,10 +761,10 @@ bool EventManager::executeEventInternal(Event &ev, bool skip_delay) {
 					Utils::logError("EventManager: Mapmod at position (%d, %d) contains invalid tile id (%d).", ec->x, ec->y, ec->z);
 				else if (index >= mapr->layers.size())
 					Utils::logError("EventManager: Mapmod at position (%d, %d) is on an invalid layer.", ec->x, ec->y);
-				else if (ec->x >= 0 && ec->x < mapr->w && ec->y >= 0 && ec->y < mapr->h)
-					mapr->layers[index][ec->x][ec->y] = static_cast<unsigned short>(ec->z);
-				else
+				else if (!mapr->layers[index].setChecked(ec->x, ec->y, static_cast<unsigned short>(ec->z)))
 					Utils::logError("EventManager: Mapmod at position (%d, %d) is out of bounds 0-255.", ec->x, ec->y);
+				else
+					mapr->chunk_cache.invalidate(index, ec->x, ec->y);
 			}
 		}
 		else if (ec->type == EventComponent::SOUNDFX) {
@@ -985,22 +987,53 @@ bool EventManager::isActive(const Event &e) {
 	return true;
 }
 
+/**
+ * Script files are only parsed the first time they are executed (see clearScriptCache())
+ */
 void EventManager::executeScript(const std::string& filename, float x, float y) {
+	std::map<std::string, std::vector<Event> >::iterator it = script_cache.find(filename);
+	if (it == script_cache.end()) {
+		// scripts that can't be opened are cached too, so that the error is only logged once
+		it = script_cache.insert(std::make_pair(filename, std::vector<Event>())).first;
+		loadScript(filename, it->second);
+	}
+
+	// executing an event may load other scripts, but adding to the map keeps this reference valid
+	const std::vector<Event>& script_evnt = it->second;
+
+	for (size_t i = 0; i < script_evnt.size(); ++i) {
+		Event evnt = script_evnt[i];
+		evnt.location.x = evnt.hotspot.x = static_cast<int>(x);
+		evnt.location.y = evnt.hotspot.y = static_cast<int>(y);
+		evnt.center.x = static_cast<float>(evnt.location.x) + 0.5f;
+		evnt.center.y = static_cast<float>(evnt.location.y) + 0.5f;
+
+		// create StatBlocks if we need them
+		EventComponent *ec_power = evnt.getComponent(EventComponent::POWER);
+		if (ec_power) {
+			ec_power->y = mapr->addEventStatBlock(evnt);
+		}
+
+		if (isActive(evnt)) {
+			executeEvent(evnt);
+		}
+	}
+}
+
+/**
+ * Parse the events of a script file. Their location is set by executeScript().
+ */
+void EventManager::loadScript(const std::string& filename, std::vector<Event>& script_evnt) {
 	FileParser script_file;
-	std::queue<Event> script_evnt;
 
 	if (script_file.open(filename, FileParser::MOD_FILE, FileParser::ERROR_NORMAL)) {
 		while (script_file.next()) {
 			if (script_file.new_section && script_file.section == "event") {
 				Event tmp_evnt;
-				tmp_evnt.location.x = tmp_evnt.hotspot.x = static_cast<int>(x);
-				tmp_evnt.location.y = tmp_evnt.hotspot.y = static_cast<int>(y);
 				tmp_evnt.location.w = tmp_evnt.hotspot.w = 1;
 				tmp_evnt.location.h = tmp_evnt.hotspot.h = 1;
-				tmp_evnt.center.x = static_cast<float>(tmp_evnt.location.x) + 0.5f;
-				tmp_evnt.center.y = static_cast<float>(tmp_evnt.location.y) + 0.5f;
 
-				script_evnt.push(tmp_evnt);
+				script_evnt.push_back(tmp_evnt);
 			}
 
 			if (script_evnt.empty())
@@ -1014,22 +1047,17 @@ void EventManager::executeScript(const std::string& filename, float x, float y)
 			loadEventComponent(script_file, &script_evnt.back(), NULL);
 		}
 		script_file.close();
-
-		while (!script_evnt.empty()) {
-			// create StatBlocks if we need them
-			EventComponent *ec_power = script_evnt.front().getComponent(EventComponent::POWER);
-			if (ec_power) {
-				ec_power->y = mapr->addEventStatBlock(script_evnt.front());
-			}
-
-			if (isActive(script_evnt.front())) {
-				executeEvent(script_evnt.front());
-			}
-			script_evnt.pop();
-		}
 	}
 }
 
+/**
+ * Parsed scripts refer to campaign statuses and items, so they are discarded
+ * when a new game is started or the mods change.
+ */
+void EventManager::clearScriptCache() {
+	script_cache.clear();
+}
+
 EventComponent EventManager::getRandomMapFromFile(const std::string& fname) {
 	// map pool is the same, so pick the next one in the "playlist"
 	if (fname == mapr->intermap_random_filename && !mapr->intermap_random_queue.empty()) {
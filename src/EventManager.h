@@ -156,11 +156,16 @@ public:
 	static bool executeDelayedEvent(Event &e);
 	static bool isActive(const Event &e);
 	static void executeScript(const std::string& filename, float x, float y);
+	static void clearScriptCache();
 
 private:
 	static const bool SKIP_DELAY = true;
 	static bool executeEventInternal(Event &e, bool skip_delay);
 	static EventComponent getRandomMapFromFile(const std::string& fname);
+	static void loadScript(const std::string& filename, std::vector<Event>& script_evnt);
+
+	// parsed event scripts, keyed by filename. The events still need a location before being executed.
+	static std::map<std::string, std::vector<Event> > script_cache;
 
 };
 
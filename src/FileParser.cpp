@@ -42,6 +42,7 @@ bool FileParser::open(const std::string& _filename, bool _is_mod_file, int _erro
 	error_mode = _error_mode;
 
 	filenames.clear();
+	included_files.clear();
 	if (is_mod_file) {
 		filenames = mods->list(_filename, ModManager::LIST_FULL_PATHS);
 	}
@@ -103,6 +104,7 @@ bool FileParser::open(const std::string& _filename, bool _is_mod_file, int _erro
 
 void FileParser::close() {
 	if (include_fp) {
+		included_files.insert(included_files.end(), include_fp->included_files.begin(), include_fp->included_files.end());
 		include_fp->close();
 		delete include_fp;
 		include_fp = NULL;
@@ -113,6 +115,19 @@ void FileParser::close() {
 	infile.clear();
 }
 
+/**
+ * For key pairs that are not read from a file, but set directly by the caller (e.g. from a compiled map).
+ * Error messages will refer to the given filename.
+ */
+void FileParser::setSource(const std::string& filename) {
+	close();
+
+	filenames.assign(1, filename);
+	current_index = 0;
+	line_number = 0;
+	is_mod_file = false;
+}
+
 /**
  * Advance to the next key pair
  * Take note if a new section header is encountered
@@ -135,6 +150,7 @@ bool FileParser::next() {
 					return true;
 				}
 				else {
+					included_files.insert(included_files.end(), include_fp->included_files.begin(), include_fp->included_files.end());
 					include_fp->close();
 					delete include_fp;
 					include_fp = NULL;
@@ -173,6 +189,7 @@ bool FileParser::next() {
 
 				if (directive == "INCLUDE") {
 					std::string tmp = line.substr(first_space+1);
+					included_files.push_back(tmp);
 
 					include_fp = new FileParser();
 					if (!include_fp || !include_fp->open(tmp, is_mod_file, error_mode)) {
@@ -249,6 +266,13 @@ void FileParser::errorBuf(const char* buffer) {
 	}
 }
 
+/**
+ * Every file that was read with INCLUDE so far, including nested ones
+ */
+const std::vector<std::string>& FileParser::getIncludedFiles() const {
+	return included_files;
+}
+
 void FileParser::incrementLineNum() {
 	line_number++;
 }
@@ -42,6 +42,7 @@ private:
 	unsigned line_number;
 
 	FileParser* include_fp;
+	std::vector<std::string> included_files;
 
 public:
 	enum {
@@ -71,10 +72,12 @@ public:
 	bool open(const std::string& filename, bool _is_mod_file, int _error_mode);
 
 	void close();
+	void setSource(const std::string& filename);
 	bool next();
 	std::string getRawLine();
 	void error(const char* format, ...);
 	void incrementLineNum();
+	const std::vector<std::string>& getIncludedFiles() const;
 
 	/**
 	 * @brief new_section is set to true whenever a new [section] starts. If opening
@@ -90,6 +90,9 @@ public:
 	virtual int calc_width(const std::string& text) = 0;
 	virtual std::string trimTextToWidth(const std::string& text, const int width, const bool use_ellipsis, size_t left_pos) = 0;
 
+	// must be called when the render device context is recreated
+	virtual void clearGlyphCache() = 0;
+
 	int cursor_y;
 
 protected:
@@ -31,6 +31,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "CommonIncludes.h"
 #include "DeviceList.h"
 #include "EngineSettings.h"
+#include "EventManager.h"
 #include "FileParser.h"
 #include "FontEngine.h"
 #include "GameStateConfigBase.h"
@@ -589,6 +590,7 @@ void GameStateConfigBase::logicAccept() {
 		reload_backgrounds = true;
 		delete mods;
 		mods = new ModManager(NULL);
+		EventManager::clearScriptCache();
 		settings->prev_save_slot = -1;
 	}
 	delete msg;
@@ -619,6 +621,8 @@ void GameStateConfigBase::logicAccept() {
 		settings->soft_reset = true;
 	}
 
+	// the glyph atlas has to be freed before the textures of the old context are destroyed
+	font->clearGlyphCache();
 	render_device->createContext();
 	tooltipm = new TooltipManager();
 	settings->saveSettings();
@@ -35,7 +35,9 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "MessageEngine.h"
 #include "ModManager.h"
 #include "RenderDevice.h"
+#include "SaveFile.h"
 #include "SaveLoad.h"
+#include "SaveSummary.h"
 #include "SharedGameResources.h"
 #include "SharedResources.h"
 #include "Settings.h"
@@ -55,12 +57,14 @@ bool compareSaveDirs(const std::string& dir1, const std::string& dir2) {
 GameSlot::GameSlot()
 	: id(0)
 	, time_played(0)
+	, preview(NULL)
 	, preview_turn_timer(settings->max_frames_per_sec/2)
 {
 	preview_turn_timer.reset(Timer::BEGIN);
 }
 
 GameSlot::~GameSlot() {
+	delete preview;
 }
 
 GameStateLoad::GameStateLoad() : GameState()
@@ -277,9 +281,10 @@ void GameStateLoad::loadPortrait(int slot) {
 
 }
 
+/**
+ * Only the summary of each save is read here. Previews are created later by loadVisiblePreviews().
+ */
 void GameStateLoad::readGameSlots() {
-	FileParser infile;
-	std::stringstream filename;
 	std::vector<std::string> save_dirs;
 
 	Filesystem::getDirList(settings->path_user + "saves/" + eset->misc.save_prefix, save_dirs);
@@ -295,12 +300,19 @@ void GameStateLoad::readGameSlots() {
 
 	visible_slots = (game_slot_max > static_cast<int>(game_slots.size()) ? static_cast<int>(game_slots.size()) : game_slot_max);
 
-	for (size_t i=0; i<save_dirs.size(); ++i){
-		// save data is stored in slot#/avatar.txt
-		filename.str("");
-		filename << settings->path_user << "saves/" << eset->misc.save_prefix << "/" << save_dirs[i] << "/avatar.txt";
+	const std::string mod_list = SaveSummary::getModList();
 
-		if (!infile.open(filename.str(), !FileParser::MOD_FILE, FileParser::ERROR_NORMAL)) continue;
+	for (size_t i=0; i<save_dirs.size(); ++i){
+		// save data is stored in slot#/avatar.dat, or slot#/avatar.txt for older saves
+		const std::string slot_path = settings->path_user + "saves/" + eset->misc.save_prefix + "/" + save_dirs[i] + "/";
+
+		// the summary is rebuilt if the save or the enabled mods have changed since the summary was written
+		SaveSummary summary;
+		if (!summary.read(slot_path + "summary.txt") || summary.avatar_mtime != SaveFile::getModifiedTime(slot_path + "avatar.dat", slot_path + "avatar.txt") || summary.mod_list != mod_list) {
+			summary = SaveSummary();
+			if (!summary.readFromSave(slot_path)) continue;
+			summary.write(slot_path + "summary.txt");
+		}
 
 		game_slots[i] = new GameSlot();
 		game_slots[i]->id = Parse::toInt(save_dirs[i]);
@@ -311,87 +323,43 @@ void GameStateLoad::readGameSlots() {
 		game_slots[i]->label_map.setFromLabelInfo(map_pos);
 		game_slots[i]->label_slot_number.setFromLabelInfo(slot_number_pos);
 
-		while (infile.next()) {
-
-			// load (key=value) pairs
-			if (infile.key == "name")
-				game_slots[i]->stats.name = infile.val;
-			else if (infile.key == "class") {
-				game_slots[i]->stats.character_class = Parse::popFirstString(infile.val);
-				game_slots[i]->stats.character_subclass = Parse::popFirstString(infile.val);
-			}
-			else if (infile.key == "xp")
-				game_slots[i]->stats.xp = Parse::toInt(infile.val);
-			else if (infile.key == "build") {
-				for (size_t j = 0; j < eset->primary_stats.list.size(); ++j) {
-					game_slots[i]->stats.primary[j] = Parse::popFirstInt(infile.val);
-				}
-			}
-			else if (infile.key == "equipped") {
-				std::string repeat_val = Parse::popFirstString(infile.val);
-				while (repeat_val != "") {
-					game_slots[i]->equipped.push_back(Parse::toInt(repeat_val));
-					repeat_val = Parse::popFirstString(infile.val);
-				}
-			}
-			else if (infile.key == "option") {
-				game_slots[i]->stats.gfx_base = Parse::popFirstString(infile.val);
-				game_slots[i]->stats.gfx_head = Parse::popFirstString(infile.val);
-				game_slots[i]->stats.gfx_portrait = Parse::popFirstString(infile.val);
-			}
-			else if (infile.key == "spawn") {
-				game_slots[i]->current_map = getMapName(Parse::popFirstString(infile.val));
-			}
-			else if (infile.key == "permadeath") {
-				game_slots[i]->stats.permadeath = Parse::toBool(infile.val);
-			}
-			else if (infile.key == "time_played") {
-				game_slots[i]->time_played = Parse::toUnsignedLong(infile.val);
-			}
-		}
-		infile.close();
-
-		game_slots[i]->stats.recalc();
+		game_slots[i]->stats.name = summary.name;
+		game_slots[i]->stats.permadeath = summary.permadeath;
+		game_slots[i]->stats.level = summary.level;
+		game_slots[i]->stats.character_class = summary.character_class;
+		game_slots[i]->stats.character_subclass = summary.character_subclass;
+		game_slots[i]->stats.gfx_base = summary.gfx_base;
+		game_slots[i]->stats.gfx_head = summary.gfx_head;
+		game_slots[i]->stats.gfx_portrait = summary.gfx_portrait;
 		game_slots[i]->stats.direction = 6;
-		game_slots[i]->preview.setStatBlock(&(game_slots[i]->stats));
-
-		loadPreview(game_slots[i]);
-	}
-}
-
-std::string GameStateLoad::getMapName(const std::string& map_filename) {
-	FileParser infile;
-	if (!infile.open(map_filename, FileParser::MOD_FILE, FileParser::ERROR_NONE))
-		return "";
-
-	std::string map_name = "";
-
-	while (map_name == "" && infile.next()) {
-		if (infile.key == "title")
-			map_name = msg->get(infile.val);
+		game_slots[i]->current_map = summary.map_title;
+		game_slots[i]->time_played = summary.time_played;
+		game_slots[i]->equipped = summary.equipped;
 	}
-
-	infile.close();
-	return map_name;
 }
 
 void GameStateLoad::loadPreview(GameSlot* slot) {
-	if (!slot) return;
+	if (!slot || slot->preview) return;
 
-	std::vector<std::string> img_gfx;
-	std::vector<std::string> &preview_layer = slot->preview.layer_reference_order;
+	slot->preview = new GameSlotPreview();
+	slot->preview->setStatBlock(&(slot->stats));
+
+	std::vector<std::string> &preview_layer = slot->preview->layer_reference_order;
 
 	// fall back to default if it exists
-	for (unsigned int i=0; i<preview_layer.size(); i++) {
-		bool exists = Filesystem::fileExists(mods->locate("animations/avatar/" + slot->stats.gfx_base + "/default_" + preview_layer[i] + ".txt"));
-		if (exists) {
-			img_gfx.push_back("default_" + preview_layer[i]);
-		}
-		else if (preview_layer[i] == "head") {
-			img_gfx.push_back(slot->stats.gfx_head);
+	std::map<std::string, std::vector<std::string> >::iterator default_it = preview_default_layers.find(slot->stats.gfx_base);
+	if (default_it == preview_default_layers.end()) {
+		default_it = preview_default_layers.insert(std::make_pair(slot->stats.gfx_base, std::vector<std::string>())).first;
+		for (unsigned int i=0; i<preview_layer.size(); i++) {
+			bool exists = Filesystem::fileExists(mods->locate("animations/avatar/" + slot->stats.gfx_base + "/default_" + preview_layer[i] + ".txt"));
+			default_it->second.push_back(exists ? "default_" + preview_layer[i] : "");
 		}
-		else {
-			img_gfx.push_back("");
+	}
+
+	std::vector<std::string> img_gfx = default_it->second;
+	for (unsigned int i=0; i<preview_layer.size() && i<img_gfx.size(); i++) {
+		if (img_gfx[i].empty() && preview_layer[i] == "head") {
+			img_gfx[i] = slot->stats.gfx_head;
 		}
 	}
 
@@ -408,7 +376,29 @@ void GameStateLoad::loadPreview(GameSlot* slot) {
 		}
 	}
 
-	slot->preview.loadGraphics(img_gfx);
+	slot->preview->loadGraphics(img_gfx);
+
+	if (selected_slot >= 0 && static_cast<size_t>(selected_slot) < game_slots.size() && game_slots[selected_slot] == slot)
+		slot->preview->setAnimation("run");
+}
+
+/**
+ * Create the preview of one visible slot per frame, so that the load screen is shown right away
+ * and scrolling never waits for more than one preview.
+ */
+void GameStateLoad::loadVisiblePreviews() {
+	// the selected slot comes first
+	if (selected_slot >= 0 && static_cast<size_t>(selected_slot) < game_slots.size() && game_slots[selected_slot] && !game_slots[selected_slot]->preview) {
+		loadPreview(game_slots[selected_slot]);
+		return;
+	}
+
+	for (int i = scroll_offset; i < scroll_offset + visible_slots && i < static_cast<int>(game_slots.size()); ++i) {
+		if (game_slots[i] && !game_slots[i]->preview) {
+			loadPreview(game_slots[i]);
+			return;
+		}
+	}
 }
 
 
@@ -417,8 +407,10 @@ void GameStateLoad::logic() {
 	if (inpt->window_resized)
 		refreshWidgets();
 
+	loadVisiblePreviews();
+
 	for (size_t i = 0; i < game_slots.size(); ++i) {
-		if (!game_slots[i])
+		if (!game_slots[i] || !game_slots[i]->preview)
 			continue;
 
 		if (static_cast<int>(i) == selected_slot) {
@@ -432,7 +424,7 @@ void GameStateLoad::logic() {
 					game_slots[i]->stats.direction = 0;
 			}
 		}
-		game_slots[i]->preview.logic();
+		game_slots[i]->preview->logic();
 	}
 
 	if (!confirm->visible) {
@@ -778,7 +770,7 @@ void GameStateLoad::render() {
 
 		// map
 		game_slots[off_slot]->label_map.setPos(slot_pos[slot].x, slot_pos[slot].y);
-		game_slots[off_slot]->label_map.setText(game_slots[off_slot]->current_map);
+		game_slots[off_slot]->label_map.setText(msg->get(game_slots[off_slot]->current_map));
 		game_slots[off_slot]->label_map.setColor(font->getColor(FontEngine::COLOR_MENU_NORMAL));
 
 		if (text_trim_boundary > 0 && game_slots[off_slot]->label_map.getBounds()->x + game_slots[off_slot]->label_map.getBounds()->w >= text_trim_boundary + slot_dest.x)
@@ -789,8 +781,10 @@ void GameStateLoad::render() {
 		// render character preview
 		dest.x = slot_pos[slot].x + sprites_pos.x;
 		dest.y = slot_pos[slot].y + sprites_pos.y;
-		game_slots[off_slot]->preview.setPos(Point(dest.x, dest.y));
-		game_slots[off_slot]->preview.render();
+		if (game_slots[off_slot]->preview) {
+			game_slots[off_slot]->preview->setPos(Point(dest.x, dest.y));
+			game_slots[off_slot]->preview->render();
+		}
 
 		// slot number
 		ss.str("");
@@ -829,13 +823,15 @@ void GameStateLoad::setSelectedSlot(int slot) {
 	if (selected_slot != -1 && static_cast<size_t>(selected_slot) < game_slots.size() && game_slots[selected_slot]) {
 		game_slots[selected_slot]->stats.direction = 6;
 		game_slots[selected_slot]->preview_turn_timer.reset(Timer::BEGIN);
-		game_slots[selected_slot]->preview.setAnimation("stance");
+		if (game_slots[selected_slot]->preview)
+			game_slots[selected_slot]->preview->setAnimation("stance");
 	}
 
 	if (slot != -1 && static_cast<size_t>(slot) < game_slots.size() && game_slots[slot]) {
 		game_slots[slot]->stats.direction = 6;
 		game_slots[slot]->preview_turn_timer.reset(Timer::BEGIN);
-		game_slots[slot]->preview.setAnimation("run");
+		if (game_slots[slot]->preview)
+			game_slots[slot]->preview->setAnimation("run");
 	}
 
 	selected_slot = slot;
@@ -47,11 +47,11 @@ public:
 	unsigned id;
 
 	StatBlock stats;
-	std::string current_map;
+	std::string current_map; // untranslated map title
 	unsigned long time_played;
 
 	std::vector<int> equipped;
-	GameSlotPreview preview;
+	GameSlotPreview *preview; // created when the slot is first shown
 	Timer preview_turn_timer;
 
 	WidgetLabel label_name;
@@ -69,12 +69,12 @@ private:
 
 	void loadGraphics();
 	void loadPortrait(int slot);
-	std::string getMapName(const std::string& map_filename);
 	void updateButtons();
 	void refreshWidgets();
 	void logicLoading();
 	void readGameSlots();
 	void loadPreview(GameSlot *slot);
+	void loadVisiblePreviews();
 
 	void scrollUp();
 	void scrollDown();
@@ -103,6 +103,9 @@ private:
 
 	std::vector<GameSlot *> game_slots;
 
+	// default layers that exist for each base graphics set, used by loadPreview()
+	std::map<std::string, std::vector<std::string> > preview_default_layers;
+
 	bool loading_requested;
 	bool loading;
 	bool loaded;
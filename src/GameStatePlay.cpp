@@ -35,6 +35,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "EnemyGroupManager.h"
 #include "EnemyManager.h"
 #include "EngineSettings.h"
+#include "EventManager.h"
 #include "FileParser.h"
 #include "GameState.h"
 #include "GameStateCutscene.h"
@@ -44,6 +45,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "HazardManager.h"
 #include "InputState.h"
 #include "LootManager.h"
+#include "MapPreloader.h"
 #include "MapRenderer.h"
 #include "Menu.h"
 #include "MenuActionBar.h"
@@ -65,6 +67,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "NPC.h"
 #include "NPCManager.h"
 #include "PowerManager.h"
+#include "Profiler.h"
 #include "QuestLog.h"
 #include "RenderDevice.h"
 #include "SaveLoad.h"
@@ -78,6 +81,8 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include <cassert>
 
+const float GameStatePlay::PRELOAD_RANGE = 5;
+
 GameStatePlay::GameStatePlay()
 	: GameState()
 	, enemy(NULL)
@@ -94,6 +99,7 @@ GameStatePlay::GameStatePlay()
 		items = new ItemManager();
 
 	camp = new CampaignManager();
+	EventManager::clearScriptCache();
 
 	loot = new LootManager();
 	powers = new PowerManager();
@@ -105,6 +111,11 @@ GameStatePlay::GameStatePlay()
 	menu = new MenuManager();
 	npcs = new NPCManager();
 	quests = new QuestLog(menu->questlog);
+	preloader = new MapPreloader();
+
+	profile_avatar_id = profiler->addSection("avatar");
+	profile_renderables_id = profiler->addSection("renderables");
+	profile_minimap_id = profiler->addSection("minimap");
 
 	// load the config file for character titles
 	loadTitles();
@@ -177,10 +188,10 @@ void GameStatePlay::checkEnemyFocus() {
 			hazards->last_enemy = NULL;
 		}
 		else {
-			enemy = enemym->enemyFocus(inpt->mouse, mapr->cam, EnemyManager::IS_ALIVE);
+			enemy = enemym->enemyFocus(inpt->mouse, mapr->getRenderCam(), EnemyManager::IS_ALIVE);
 			if (enemy)
 				curs->setCursor(CursorManager::CURSOR_ATTACK);
-			src_pos = Utils::screenToMap(inpt->mouse.x, inpt->mouse.y, mapr->cam.x, mapr->cam.y);
+			src_pos = Utils::screenToMap(inpt->mouse.x, inpt->mouse.y, mapr->getRenderCam().x, mapr->getRenderCam().y);
 
 		}
 	}
@@ -194,7 +205,7 @@ void GameStatePlay::checkEnemyFocus() {
 	}
 	else if (inpt->usingMouse()) {
 		// if we're using a mouse and we didn't select an enemy, try selecting a dead one instead
-		Enemy *temp_enemy = enemym->enemyFocus(inpt->mouse, mapr->cam, !EnemyManager::IS_ALIVE);
+		Enemy *temp_enemy = enemym->enemyFocus(inpt->mouse, mapr->getRenderCam(), !EnemyManager::IS_ALIVE);
 		if (temp_enemy) {
 			pc->stats.target_corpse = &(temp_enemy->stats);
 			menu->enemy->enemy = temp_enemy;
@@ -258,7 +269,7 @@ void GameStatePlay::checkLoot() {
 
 	// Normal pickups
 	if (!pc->using_main1) {
-		pickup = loot->checkPickup(inpt->mouse, mapr->cam, pc->stats.pos);
+		pickup = loot->checkPickup(inpt->mouse, mapr->getRenderCam(), pc->stats.pos);
 	}
 
 	if (!pickup.empty()) {
@@ -270,6 +281,38 @@ void GameStatePlay::checkLoot() {
 
 }
 
+/**
+ * Start preloading the map behind the nearest intermap teleport, so that changing maps takes less time
+ */
+void GameStatePlay::checkPreload() {
+	if (pc->stats.alive) {
+		std::string nearest_map;
+		float best_distance = PRELOAD_RANGE;
+
+		for (size_t i = 0; i < mapr->events.size(); ++i) {
+			Event& ev = mapr->events[i];
+
+			if (ev.activate_type != Event::ACTIVATE_ON_TRIGGER || !EventManager::isActive(ev))
+				continue;
+
+			EventComponent* ec = ev.getComponent(EventComponent::INTERMAP);
+			if (!ec || ec->s.empty() || ec->s == mapr->getFilename())
+				continue;
+
+			float distance = Utils::calcDist(pc->stats.pos, ev.center);
+			if (distance < best_distance) {
+				best_distance = distance;
+				nearest_map = ec->s;
+			}
+		}
+
+		if (!nearest_map.empty())
+			preloader->request(nearest_map);
+	}
+
+	preloader->logic();
+}
+
 void GameStatePlay::checkTeleport() {
 	bool on_load_teleport = false;
 
@@ -311,7 +354,9 @@ void GameStatePlay::checkTeleport() {
 			inpt->lock_all = (teleport_mapname == "maps/spawn.txt");
 			mapr->executeOnMapExitEvents();
 			showLoading();
+			preloader->flush();
 			mapr->load(teleport_mapname);
+			preloader->clear();
 			setLoadingFrame();
 
 			// use the default hero spawn position for this map
@@ -843,6 +888,9 @@ void GameStatePlay::logic() {
 
 	checkCutscene();
 
+	// the camera follows the player in Avatar::logic(), so remember where it was before that
+	mapr->prev_cam = mapr->cam;
+
 	// check menus first (top layer gets mouse click priority)
 	menu->logic();
 
@@ -865,7 +913,9 @@ void GameStatePlay::logic() {
 		checkTitle();
 
 		menu->act->checkAction(action_queue);
+		profiler->begin(profile_avatar_id);
 		pc->logic(action_queue, restrictPowerUse());
+		profiler->end(profile_avatar_id);
 
 		// Transform powers change the actionbar layout,
 		// so we need to prevent accidental clicks if a new power is placed under the slot we clicked on.
@@ -886,7 +936,7 @@ void GameStatePlay::logic() {
 
 		snd->logic(pc->stats.pos);
 
-		comb->logic(mapr->cam);
+		comb->logic();
 	}
 
 	// close menus when the player dies, but still allow them to be reopened
@@ -897,6 +947,7 @@ void GameStatePlay::logic() {
 
 	// these actions occur whether the game is paused or not.
 	// TODO Why? Some of these probably don't need to be executed when paused
+	checkPreload();
 	checkTeleport();
 	checkLootDrop();
 	checkLog();
@@ -1016,6 +1067,8 @@ void GameStatePlay::render() {
 	std::vector<Renderable> rens;
 	std::vector<Renderable> rens_dead;
 
+	profiler->begin(profile_renderables_id);
+
 	pc->addRenders(rens);
 
 	enemym->addRenders(rens, rens_dead);
@@ -1026,25 +1079,29 @@ void GameStatePlay::render() {
 
 	hazards->addRenders(rens, rens_dead);
 
+	profiler->end(profile_renderables_id);
 
 	// render the static map layers plus the renderables
 	mapr->render(rens, rens_dead);
 
 	// mouseover tooltips
-	loot->renderTooltips(mapr->cam);
+	loot->renderTooltips(mapr->getRenderCam());
 
+	profiler->begin(profile_minimap_id);
 	if (mapr->map_change) {
 		menu->mini->prerender(&mapr->collider, mapr->w, mapr->h);
 		mapr->map_change = false;
 	}
 	menu->mini->setMapTitle(mapr->title);
 	menu->mini->render(pc->stats.pos);
+	profiler->end(profile_minimap_id);
+
 	menu->render();
 
 	// render combat text last - this should make it obvious you're being
 	// attacked, even if you have menus open
 	if (!isPaused())
-		comb->render();
+		comb->render(mapr->getInterpolatedCam());
 }
 
 bool GameStatePlay::isPaused() {
@@ -1097,6 +1154,7 @@ bool GameStatePlay::checkPrimaryStat(const std::string& first, const std::string
 }
 
 GameStatePlay::~GameStatePlay() {
+	delete preloader;
 	delete quests;
 	delete npcs;
 	delete hazards;
@@ -33,6 +33,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 class Avatar;
 class Enemy;
+class MapPreloader;
 class MenuManager;
 class NPCManager;
 class QuestLog;
@@ -67,11 +68,13 @@ private:
 
 	NPCManager *npcs;
 	QuestLog *quests;
+	MapPreloader *preloader;
 
 	bool restrictPowerUse();
 	void checkEnemyFocus();
 	void checkLoot();
 	void checkLootDrop();
+	void checkPreload();
 	void checkTeleport();
 	void checkCancel();
 	void checkLog();
@@ -99,7 +102,12 @@ private:
 
 	bool is_first_map_load;
 
+	size_t profile_avatar_id;
+	size_t profile_renderables_id;
+	size_t profile_minimap_id;
+
 	static const unsigned UPDATE_ACTIONBAR_ALL = 0;
+	static const float PRELOAD_RANGE; // in tiles
 
 public:
 	GameStatePlay();
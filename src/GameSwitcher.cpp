@@ -39,6 +39,8 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "GameStateTitle.h"
 #include "GameSwitcher.h"
 #include "InputState.h"
+#include "Profiler.h"
+#include "ProfilerOverlay.h"
 #include "RenderDevice.h"
 #include "Settings.h"
 #include "SharedResources.h"
@@ -54,6 +56,7 @@ GameSwitcher::GameSwitcher()
 	, background_filename("")
 	, fps_update()
 	, last_fps(0)
+	, profiler_overlay(NULL)
 {
 	// update the fps counter 4 times per second
 	fps_update.setDuration(settings->max_frames_per_sec / 4);
@@ -220,11 +223,14 @@ void GameSwitcher::showFPS(float fps) {
 
 			float avg_fps = (fps + last_fps) / 2.f;
 			last_fps = fps;
-			std::string sfps = Utils::floatToString(avg_fps, 2) + std::string (" fps");
+			std::stringstream sfps;
+			sfps << Utils::floatToString(avg_fps, 2) << " fps";
+			if (settings->dev_mode)
+				sfps << ", " << render_device->getDrawCalls() << " draw calls";
 			Rect pos = fps_position;
 			Utils::alignToScreenEdge(fps_corner, &pos);
 			label_fps->setPos(pos.x, pos.y);
-			label_fps->setText(sfps);
+			label_fps->setText(sfps.str());
 			label_fps->setColor(fps_color);
 		}
 		label_fps->render();
@@ -296,9 +302,24 @@ void GameSwitcher::saveUserSettings() {
 		settings->saveSettings();
 }
 
+void GameSwitcher::showProfiler() {
+	if (!profiler->isOverlayVisible()) {
+		if (profiler_overlay) {
+			delete profiler_overlay;
+			profiler_overlay = NULL;
+		}
+		return;
+	}
+
+	if (!profiler_overlay)
+		profiler_overlay = new ProfilerOverlay();
+	profiler_overlay->render();
+}
+
 GameSwitcher::~GameSwitcher() {
 	delete currentState;
 	delete label_fps;
+	delete profiler_overlay;
 	snd->unloadMusic();
 	freeBackground();
 	background_list.clear();
@@ -24,6 +24,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "Utils.h"
 
 class GameState;
+class ProfilerOverlay;
 class WidgetLabel;
 /**
  * class GameSwitcher
@@ -59,6 +60,8 @@ private:
 	Timer fps_update;
 	float last_fps;
 
+	ProfilerOverlay *profiler_overlay;
+
 public:
 	GameSwitcher();
 	GameSwitcher(const GameSwitcher &copy); // not implemented.
@@ -72,6 +75,7 @@ public:
 	void logic();
 	void render();
 	void showFPS(float fps);
+	void showProfiler();
 	void saveUserSettings();
 	bool done;
 };
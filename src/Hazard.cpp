@@ -32,29 +32,101 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "RenderDevice.h"
 #include "SharedResources.h"
 #include "StatBlock.h"
+#include "Utils.h"
 #include "UtilsMath.h"
 #include "UtilsParsing.h"
 
 #include <cmath>
 
+namespace {
+	/**
+	 * Missiles and repeaters create and remove many hazards, so hazards are allocated in blocks.
+	 * Freed slots are reused before a new block is allocated. A hazard keeps its address
+	 * until it is deleted, so Hazard pointers (e.g. parent and children) stay valid.
+	 */
+	class HazardPool {
+	public:
+		static const size_t BLOCK_SIZE = 256;
+
+		HazardPool()
+			: slot_size(((sizeof(Hazard) + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT) {
+		}
+
+		~HazardPool() {
+			for (size_t i = 0; i < blocks.size(); ++i) {
+				delete[] blocks[i];
+			}
+		}
+
+		void* allocate() {
+			if (free_slots.empty()) {
+				char* block = new char[slot_size * BLOCK_SIZE];
+				blocks.push_back(block);
+
+				// reversed, so that the first slot of the block is used first
+				for (size_t i = BLOCK_SIZE; i > 0; --i) {
+					free_slots.push_back(block + (i-1) * slot_size);
+				}
+			}
+
+			void* slot = free_slots.back();
+			free_slots.pop_back();
+			return slot;
+		}
+
+		void release(void* slot) {
+			free_slots.push_back(slot);
+		}
+
+	private:
+		static const size_t ALIGNMENT = 16;
+
+		size_t slot_size;
+		std::vector<char*> blocks;
+		std::vector<void*> free_slots;
+	};
+
+	HazardPool hazard_pool;
+}
+
+void* Hazard::operator new(size_t size) {
+	if (size != sizeof(Hazard))
+		return ::operator new(size);
+	return hazard_pool.allocate();
+}
+
+void Hazard::operator delete(void* ptr, size_t size) {
+	if (!ptr)
+		return;
+
+	if (size != sizeof(Hazard))
+		::operator delete(ptr);
+	else
+		hazard_pool.release(ptr);
+}
+
 Hazard::Hazard(MapCollision *_collider)
-	: active(true)
+	: pos()
+	, prev_pos()
+	, speed()
+	, pos_offset()
+	, lifespan(1)
+	, delay_frames(0)
+	, active(true)
 	, remove_now(false)
 	, hit_wall(false)
 	, relative_pos(false)
 	, sfx_hit_played(false)
+	, power(NULL)
+	, src_stats(NULL)
 	, dmg_min(0)
 	, dmg_max(0)
 	, crit_chance(0)
 	, accuracy(0)
 	, source_type(0)
 	, base_speed(0)
-	, lifespan(1)
 	, animationKind(0)
-	, delay_frames(0)
 	, angle(0)
-	, src_stats(NULL)
-	, power(NULL)
 	, power_index(0)
 	, parent(NULL)
 	, collider(_collider)
@@ -94,6 +166,7 @@ Hazard& Hazard::operator=(const Hazard& other) {
 	power_index = other.power_index;
 
 	pos = other.pos;
+	prev_pos = other.prev_pos;
 	speed = other.speed;
 	pos_offset = other.pos_offset;
 
@@ -144,10 +217,11 @@ Hazard::~Hazard() {
 		delete activeAnimation;
 	}
 
-	anim->cleanUp();
+	// unused animation sets are released once per frame by HazardManager::logic()
 }
 
 void Hazard::logic() {
+	prev_pos = pos;
 
 	// if the hazard is on delay, take no action
 	if (delay_frames > 0) {
@@ -221,7 +295,8 @@ void Hazard::reflect() {
 }
 
 void Hazard::loadAnimation(const std::string &s) {
-	if (!animation_name.empty()) {
+	const bool released = !animation_name.empty();
+	if (released) {
 		anim->decreaseCount(animation_name);
 	}
 	if (activeAnimation) {
@@ -235,7 +310,8 @@ void Hazard::loadAnimation(const std::string &s) {
 		activeAnimation = animationSet->getAnimation("");
 	}
 
-	anim->cleanUp();
+	if (released)
+		anim->cleanUp();
 }
 
 bool Hazard::isDangerousNow() {
@@ -271,8 +347,7 @@ void Hazard::addEntity(Entity *ent) {
 void Hazard::addRenderable(std::vector<Renderable> &r, std::vector<Renderable> &r_dead) {
 	if (delay_frames == 0 && activeAnimation) {
 		Renderable re = activeAnimation->getCurrentFrame(animationKind);
-		re.map_pos.x = pos.x;
-		re.map_pos.y = pos.y;
+		re.map_pos = Utils::interpolate(prev_pos, pos);
 		re.prio = (power->on_floor ? 0 : 2);
 		(power->on_floor ? r_dead : r).push_back(re);
 	}
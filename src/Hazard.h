@@ -43,6 +43,10 @@ public:
 	Hazard & operator= (const Hazard& other);
 	~Hazard();
 
+	// hazards are allocated from a pool, see Hazard.cpp
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
+
 	void logic();
 	bool hasEntity(Entity*);
 	void addEntity(Entity*);
@@ -52,31 +56,35 @@ public:
 	void addRenderable(std::vector<Renderable> &r, std::vector<Renderable> &r_dead);
 	void setPower(size_t power_index);
 
+	// The members used by every hazard on every frame come first, so that they share a cache line.
+	FPoint pos;
+	FPoint prev_pos; // pos at the start of the latest logic frame
+	FPoint speed;
+	FPoint pos_offset;
+	int lifespan; // ticks down to zero
+	int delay_frames;
+
 	bool active;
 	bool remove_now;
 	bool hit_wall;
 	bool relative_pos;
 	bool sfx_hit_played;
 
+	Power *power;
+	StatBlock *src_stats;
+
+	// The members below are mostly used when the hazard is created or hits something.
 	int dmg_min;
 	int dmg_max;
 	int crit_chance;
 	int accuracy;
 	int source_type;
 	float base_speed;
-	int lifespan; // ticks down to zero
 	int animationKind;	// either a direction or option/random
-	int delay_frames;
 	float angle; // in radians
 
-	StatBlock *src_stats;
-	Power *power;
 	size_t power_index;
 
-	FPoint pos;
-	FPoint speed;
-	FPoint pos_offset;
-
 	// for linking hazards together, e.g. repeaters
 	Hazard* parent;
 	std::vector<Hazard*> children;
@@ -25,12 +25,14 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include "Avatar.h"
 #include "Animation.h"
+#include "AnimationManager.h"
 #include "Enemy.h"
 #include "EnemyManager.h"
 #include "EventManager.h"
 #include "Hazard.h"
 #include "HazardManager.h"
 #include "PowerManager.h"
+#include "Profiler.h"
 #include "RenderDevice.h"
 #include "SharedGameResources.h"
 #include "SharedResources.h"
@@ -40,18 +42,45 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 HazardManager::HazardManager()
 	: last_enemy(NULL)
 {
+	profile_id = profiler->addSection("hazards");
+}
+
+/**
+ * Delete a hazard and leave an empty slot, see eraseRemovedHazards()
+ */
+void HazardManager::removeHazard(size_t index) {
+	delete h[index];
+	h[index] = NULL;
+}
+
+/**
+ * Close the slots of removed hazards in one pass, keeping the order of the others.
+ * Hit resolution and drawing depend on that order.
+ */
+size_t HazardManager::eraseRemovedHazards() {
+	size_t kept = 0;
+	for (size_t i = 0; i < h.size(); ++i) {
+		if (h[i])
+			h[kept++] = h[i];
+	}
+
+	const size_t removed_count = h.size() - kept;
+	h.resize(kept);
+	return removed_count;
 }
 
 void HazardManager::logic() {
+	ProfilerScope profile(profile_id);
 
 	// remove all hazards with lifespan 0.  Most hazards still display their last frame.
 	for (size_t i=h.size(); i>0; i--) {
 		if (h[i-1]->lifespan == 0) {
-			delete h[i-1];
-			h.erase(h.begin()+(i-1));
+			removeHazard(i-1);
 		}
 	}
 
+	size_t removed_count = eraseRemovedHazards();
+
 	checkNewHazards();
 
 	// handle single-frame transforms
@@ -60,8 +89,7 @@ void HazardManager::logic() {
 
 		// remove all hazards that need to die immediately (e.g. exit the map)
 		if (h[i-1]->remove_now) {
-			delete h[i-1];
-			h.erase(h.begin()+(i-1));
+			removeHazard(i-1);
 			continue;
 		}
 
@@ -86,24 +114,31 @@ void HazardManager::logic() {
 
 	}
 
+	removed_count += eraseRemovedHazards();
+
+	// release the animations of removed hazards
+	if (removed_count > 0)
+		anim->cleanUp();
+
 	// handle collisions
 	for (size_t i=0; i<h.size(); i++) {
 		if (h[i]->isDangerousNow()) {
 
+			// only enemies close to the hazard can be hit
+			enemym->grid.getInRadius(h[i]->pos, h[i]->power->radius, targets);
+
 			// process hazards that can hurt enemies
 			if (h[i]->source_type != Power::SOURCE_TYPE_ENEMY) { //hero or neutral sources
-				for (unsigned int eindex = 0; eindex < enemym->enemies.size(); eindex++) {
+				for (size_t eindex = 0; eindex < targets.size(); eindex++) {
 
 					// only check living enemies
-					if (enemym->enemies[eindex]->stats.hp > 0 && h[i]->active && (enemym->enemies[eindex]->stats.hero_ally == h[i]->power->target_party)) {
-						if (Utils::isWithinRadius(h[i]->pos, h[i]->power->radius, enemym->enemies[eindex]->stats.pos)) {
-							if (!h[i]->hasEntity(enemym->enemies[eindex])) {
-								// hit!
-								h[i]->addEntity(enemym->enemies[eindex]);
-								hitEntity(i, enemym->enemies[eindex]->takeHit(*h[i]));
-								if (!h[i]->power->beacon) {
-									last_enemy = enemym->enemies[eindex];
-								}
+					if (targets[eindex]->stats.hp > 0 && h[i]->active && (targets[eindex]->stats.hero_ally == h[i]->power->target_party)) {
+						if (!h[i]->hasEntity(targets[eindex])) {
+							// hit!
+							h[i]->addEntity(targets[eindex]);
+							hitEntity(i, targets[eindex]->takeHit(*h[i]));
+							if (!h[i]->power->beacon) {
+								last_enemy = targets[eindex];
 							}
 						}
 					}
@@ -124,15 +159,13 @@ void HazardManager::logic() {
 				}
 
 				//now process allies
-				for (unsigned int eindex = 0; eindex < enemym->enemies.size(); eindex++) {
+				for (size_t eindex = 0; eindex < targets.size(); eindex++) {
 					// only check living allies
-					if (enemym->enemies[eindex]->stats.hp > 0 && h[i]->active && enemym->enemies[eindex]->stats.hero_ally) {
-						if (Utils::isWithinRadius(h[i]->pos, h[i]->power->radius, enemym->enemies[eindex]->stats.pos)) {
-							if (!h[i]->hasEntity(enemym->enemies[eindex])) {
-								// hit!
-								h[i]->addEntity(enemym->enemies[eindex]);
-								hitEntity(i, enemym->enemies[eindex]->takeHit(*h[i]));
-							}
+					if (targets[eindex]->stats.hp > 0 && h[i]->active && targets[eindex]->stats.hero_ally) {
+						if (!h[i]->hasEntity(targets[eindex])) {
+							// hit!
+							h[i]->addEntity(targets[eindex]);
+							hitEntity(i, targets[eindex]->takeHit(*h[i]));
 						}
 					}
 				}
@@ -183,6 +216,8 @@ void HazardManager::handleNewMap() {
 	}
 	h.clear();
 	last_enemy = NULL;
+
+	anim->cleanUp();
 }
 
 /**
@@ -201,4 +236,6 @@ HazardManager::~HazardManager() {
 		delete h[i];
 	// h.clear(); not needed in destructor
 	last_enemy = NULL;
+
+	anim->cleanUp();
 }
@@ -35,6 +35,13 @@ class Hazard;
 class HazardManager {
 private:
 	void hitEntity(size_t index, const bool hit);
+	void removeHazard(size_t index);
+	size_t eraseRemovedHazards();
+
+	// enemies within range of the current hazard, kept to avoid reallocating
+	std::vector<Enemy*> targets;
+
+	size_t profile_id;
 
 public:
 	HazardManager();
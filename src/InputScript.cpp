@@ -0,0 +1,256 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class InputScript
+ */
+
+#include "FileParser.h"
+#include "InputScript.h"
+#include "UtilsParsing.h"
+
+#include <fstream>
+#include <stdlib.h>
+
+namespace {
+	// same order as the Input enum, same names as keybindings.txt
+	const char* KEY_NAMES[InputState::KEY_COUNT] = {
+		"cancel", "accept", "up", "down", "left", "right",
+		"bar1", "bar2", "bar3", "bar4", "bar5", "bar6", "bar7", "bar8", "bar9", "bar0",
+		"character", "inventory", "powers", "log", "main1", "main2",
+		"ctrl", "shift", "alt", "delete",
+		"actionbar", "actionbar_back", "actionbar_forward", "actionbar_use",
+		"developer_menu"
+	};
+
+	bool compareTicks(const InputScript::Event& a, const InputScript::Event& b) {
+		return a.tick < b.tick;
+	}
+}
+
+InputScript::InputScript()
+	: prev_mouse()
+	, prev_done(false)
+	, has_prev(false)
+{
+	for (int i = 0; i < InputState::KEY_COUNT; ++i) {
+		prev_pressing[i] = false;
+	}
+}
+
+InputScript::~InputScript() {
+}
+
+/**
+ * Load a script from a file path (not a mod path)
+ */
+bool InputScript::load(const std::string& filename) {
+	events.clear();
+
+	FileParser infile;
+	if (!infile.open(filename, !FileParser::MOD_FILE, FileParser::ERROR_NORMAL))
+		return false;
+
+	while (infile.next()) {
+		Event ev;
+		ev.tick = static_cast<unsigned>(std::max(Parse::popFirstInt(infile.val), 0));
+
+		if (infile.key == "key") {
+			ev.type = EVENT_KEY;
+			ev.key = getKeyFromName(Parse::popFirstString(infile.val));
+			ev.pressed = Parse::toBool(Parse::popFirstString(infile.val));
+			if (ev.key == -1) {
+				infile.error("InputScript: Unknown action.");
+				continue;
+			}
+		}
+		else if (infile.key == "mouse") {
+			ev.type = EVENT_MOUSE;
+			ev.mouse.x = Parse::popFirstInt(infile.val);
+			ev.mouse.y = Parse::popFirstInt(infile.val);
+		}
+		else if (infile.key == "scroll") {
+			ev.type = (Parse::popFirstString(infile.val) == "up") ? EVENT_SCROLL_UP : EVENT_SCROLL_DOWN;
+		}
+		else if (infile.key == "text") {
+			ev.type = EVENT_TEXT;
+			ev.text = unescapeText(infile.val);
+		}
+		else if (infile.key == "quit") {
+			ev.type = EVENT_QUIT;
+		}
+		else {
+			infile.error("InputScript: '%s' is not a valid key.", infile.key.c_str());
+			continue;
+		}
+
+		events.push_back(ev);
+	}
+	infile.close();
+
+	std::stable_sort(events.begin(), events.end(), compareTicks);
+
+	Utils::logInfo("InputScript: Loaded %u events from '%s'.", static_cast<unsigned>(events.size()), filename.c_str());
+	return true;
+}
+
+bool InputScript::save(const std::string& filename) const {
+	std::ofstream outfile;
+	outfile.open(filename.c_str(), std::ios::out | std::ios::trunc);
+	if (!outfile.is_open()) {
+		Utils::logError("InputScript: Could not write '%s'.", filename.c_str());
+		return false;
+	}
+
+	outfile << "# Recorded by Flare. Replay with --headless --input-script=<this file>\n\n";
+	outfile << "[input]\n";
+
+	for (size_t i = 0; i < events.size(); ++i) {
+		const Event& ev = events[i];
+		if (ev.type == EVENT_KEY)
+			outfile << "key=" << ev.tick << "," << getKeyName(ev.key) << "," << (ev.pressed ? 1 : 0) << "\n";
+		else if (ev.type == EVENT_MOUSE)
+			outfile << "mouse=" << ev.tick << "," << ev.mouse.x << "," << ev.mouse.y << "\n";
+		else if (ev.type == EVENT_SCROLL_UP)
+			outfile << "scroll=" << ev.tick << ",up\n";
+		else if (ev.type == EVENT_SCROLL_DOWN)
+			outfile << "scroll=" << ev.tick << ",down\n";
+		else if (ev.type == EVENT_TEXT)
+			outfile << "text=" << ev.tick << "," << escapeText(ev.text) << "\n";
+		else if (ev.type == EVENT_QUIT)
+			outfile << "quit=" << ev.tick << "\n";
+	}
+
+	const bool success = !outfile.fail();
+	outfile.close();
+
+	if (success)
+		Utils::logInfo("InputScript: Recorded %u events to '%s'.", static_cast<unsigned>(events.size()), filename.c_str());
+	else
+		Utils::logError("InputScript: Could not write '%s'.", filename.c_str());
+
+	return success;
+}
+
+/**
+ * Add an event for everything that changed since the previous call.
+ * Called after InputState::handle(), once per logic tick.
+ */
+void InputScript::record(unsigned tick, const InputState* input) {
+	Event ev;
+	ev.tick = tick;
+
+	for (int i = 0; i < InputState::KEY_COUNT; ++i) {
+		if (input->pressing[i] != prev_pressing[i]) {
+			ev.type = EVENT_KEY;
+			ev.key = i;
+			ev.pressed = input->pressing[i];
+			events.push_back(ev);
+			prev_pressing[i] = input->pressing[i];
+		}
+	}
+
+	if (!has_prev || input->mouse.x != prev_mouse.x || input->mouse.y != prev_mouse.y) {
+		ev.type = EVENT_MOUSE;
+		ev.mouse = input->mouse;
+		events.push_back(ev);
+		prev_mouse = input->mouse;
+	}
+
+	if (input->scroll_up) {
+		ev.type = EVENT_SCROLL_UP;
+		events.push_back(ev);
+	}
+	if (input->scroll_down) {
+		ev.type = EVENT_SCROLL_DOWN;
+		events.push_back(ev);
+	}
+
+	// inkeys is cleared by InputState::handle() on every tick, except while input is locked
+	if (!input->inkeys.empty()) {
+		ev.type = EVENT_TEXT;
+		ev.text = input->inkeys;
+		events.push_back(ev);
+	}
+
+	if (input->done && !prev_done) {
+		ev.type = EVENT_QUIT;
+		events.push_back(ev);
+		prev_done = true;
+	}
+
+	has_prev = true;
+}
+
+const std::vector<InputScript::Event>& InputScript::getEvents() const {
+	return events;
+}
+
+/**
+ * Returns -1 if there is no action with this name
+ */
+int InputScript::getKeyFromName(const std::string& name) {
+	for (int i = 0; i < InputState::KEY_COUNT; ++i) {
+		if (name == KEY_NAMES[i])
+			return i;
+	}
+	return -1;
+}
+
+std::string InputScript::getKeyName(int key) {
+	if (key < 0 || key >= InputState::KEY_COUNT)
+		return "";
+	return KEY_NAMES[key];
+}
+
+/**
+ * Typed text may contain separators, '#' or spaces that FileParser would trim
+ */
+std::string InputScript::escapeText(const std::string& text) {
+	const char* hex_digits = "0123456789ABCDEF";
+	std::string ret;
+
+	for (size_t i = 0; i < text.length(); ++i) {
+		const unsigned char c = static_cast<unsigned char>(text[i]);
+		if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+			ret += text[i];
+		}
+		else {
+			ret += '%';
+			ret += hex_digits[c >> 4];
+			ret += hex_digits[c & 0xf];
+		}
+	}
+
+	return ret;
+}
+
+std::string InputScript::unescapeText(const std::string& text) {
+	std::string ret;
+
+	for (size_t i = 0; i < text.length(); ++i) {
+		if (text[i] == '%' && i + 2 < text.length()) {
+			ret += static_cast<char>(strtol(text.substr(i+1, 2).c_str(), NULL, 16));
+			i += 2;
+		}
+		else {
+			ret += text[i];
+		}
+	}
+
+	return ret;
+}
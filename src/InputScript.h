@@ -0,0 +1,96 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class InputScript
+ *
+ * A list of input changes, each one tagged with the logic tick it happened on.
+ * Scripts are recorded from a normal game (see the --record-input command line option)
+ * and replayed by ScriptedInputState. The file format is:
+ *
+ * [input]
+ * key={tick},{action},{1 for pressed, 0 for released}
+ * mouse={tick},{x},{y}
+ * scroll={tick},{up|down}
+ * text={tick},{typed text}
+ * quit={tick}
+ *
+ * Actions use the same names as keybindings.txt (e.g. "main1").
+ * In typed text, every byte other than a letter or digit is written as %XX (hexadecimal).
+ * Mouse positions are in the internal render size, so replays should use the same window size.
+ */
+
+#ifndef INPUT_SCRIPT_H
+#define INPUT_SCRIPT_H
+
+#include "CommonIncludes.h"
+#include "InputState.h"
+#include "Utils.h"
+
+class InputScript {
+public:
+	enum {
+		EVENT_KEY = 0,
+		EVENT_MOUSE = 1,
+		EVENT_SCROLL_UP = 2,
+		EVENT_SCROLL_DOWN = 3,
+		EVENT_QUIT = 4,
+		EVENT_TEXT = 5
+	};
+
+	class Event {
+	public:
+		unsigned tick;
+		int type;
+		int key;
+		bool pressed;
+		Point mouse;
+		std::string text;
+
+		Event()
+			: tick(0)
+			, type(EVENT_KEY)
+			, key(0)
+			, pressed(false)
+			, mouse() {
+		}
+	};
+
+	InputScript();
+	~InputScript();
+
+	bool load(const std::string& filename);
+	bool save(const std::string& filename) const;
+	void record(unsigned tick, const InputState* input);
+	const std::vector<Event>& getEvents() const;
+
+	static int getKeyFromName(const std::string& name);
+	static std::string getKeyName(int key);
+	static std::string escapeText(const std::string& text);
+	static std::string unescapeText(const std::string& text);
+
+private:
+	std::vector<Event> events;
+
+	// the input state at the last call to record()
+	bool prev_pressing[InputState::KEY_COUNT];
+	Point prev_mouse;
+	bool prev_done;
+	bool has_prev;
+};
+
+#endif
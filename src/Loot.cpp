@@ -60,6 +60,7 @@ Loot& Loot::operator= (const Loot &other) {
 	pos.x = other.pos.x;
 	pos.y = other.pos.y;
 	tip = other.tip;
+	tip_dest = other.tip_dest;
 	tip_bounds = other.tip_bounds;
 	tip_visible = other.tip_visible;
 	dropped_by_hero = other.dropped_by_hero;
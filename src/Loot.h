@@ -33,6 +33,7 @@ public:
 	FPoint pos;
 	Animation *animation;
 	TooltipData tip;
+	Point tip_dest; // where the tooltip is drawn, see LootManager::layoutTooltips()
 	Rect tip_bounds;
 	bool tip_visible;
 	bool dropped_by_hero;
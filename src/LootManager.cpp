@@ -39,6 +39,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "MapRenderer.h"
 #include "Menu.h"
 #include "ModManager.h"
+#include "Profiler.h"
 #include "RenderDevice.h"
 #include "Settings.h"
 #include "SharedGameResources.h"
@@ -52,10 +53,23 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include <limits>
 #include <math.h>
 
+namespace {
+	int toIndexBucket(float pos, int size) {
+		const int bucket = static_cast<int>(floorf(pos / static_cast<float>(LootManager::INDEX_BUCKET_SIZE)));
+		return std::max(0, std::min(bucket, size - 1));
+	}
+}
+
 LootManager::LootManager()
 	: tip(new WidgetTooltip())
 	, sfx_loot(snd->load(eset->loot.sfx_loot, "LootManager dropping loot"))
+	, index_size(0, 0)
+	, index_dirty(true)
+	, layout_dirty(true)
+	, layout_view(0, 0)
 {
+	profile_id = profiler->addSection("loot");
+	profile_tooltips_id = profiler->addSection("loot_tooltips");
 	loadGraphics();
 	loadLootTables();
 }
@@ -82,9 +96,13 @@ void LootManager::loadGraphics() {
 
 void LootManager::handleNewMap() {
 	loot.clear();
+	index_dirty = true;
+	layout_dirty = true;
 }
 
 void LootManager::logic() {
+	ProfilerScope profile(profile_id);
+
 	std::vector<Loot>::iterator it;
 	for (it = loot.begin(); it != loot.end(); ++it) {
 
@@ -121,89 +139,158 @@ void LootManager::logic() {
 void LootManager::renderTooltips(const FPoint& cam) {
 	if (!settings->show_hud) return;
 
-	Point dest;
-	bool tooltip_below = true;
+	ProfilerScope profile(profile_tooltips_id);
 
-	std::vector<Loot>::iterator it;
-	for (it = loot.begin(); it != loot.end(); ) {
-		it->tip_visible = false;
-
-		if (it->on_ground) {
-			Point p = Utils::mapToScreen(it->pos.x, it->pos.y, cam.x, cam.y);
-			dest.x = p.x;
-			dest.y = p.y + eset->tileset.tile_h_half;
-
-			// adjust dest.y so that the tooltip floats above the item
-			dest.y -= eset->loot.tooltip_margin;
-
-			// set hitbox for mouse hover
-			Rect hover;
-			hover.x = p.x - eset->tileset.tile_w_half;
-			hover.y = p.y - eset->tileset.tile_h_half;
-			hover.w = eset->tileset.tile_w;
-			hover.h = eset->tileset.tile_h;
-
-			bool forced_visibility = false;
-			bool default_visibility = true;
-
-			if (settings->loot_tooltips == Settings::LOOT_TIPS_DEFAULT && eset->loot.hide_radius > 0) {
-				if (Utils::calcDist(pc->stats.pos, it->pos) < eset->loot.hide_radius) {
-					default_visibility = false;
-				}
-				else {
-					Enemy* test_enemy = enemym->getNearestEnemy(it->pos, !EnemyManager::GET_CORPSE, NULL, eset->loot.hide_radius);
-					if (test_enemy) {
-						default_visibility = false;
-					}
+	if (cam.x != layout_cam.x || cam.y != layout_cam.y || settings->view_w != layout_view.x || settings->view_h != layout_view.y)
+		layout_dirty = true;
+
+	// when all tooltips are hidden, only the first hovered tooltip is shown
+	const bool show_one = settings->loot_tooltips == Settings::LOOT_TIPS_HIDE_ALL && !inpt->pressing[Input::ALT];
+	bool found_visible = false;
+
+	for (size_t i = 0; i < loot.size(); ++i) {
+		Loot& ld = loot[i];
+
+		bool visible = false;
+		if (!(show_one && found_visible) && isTooltipVisible(ld, cam)) {
+			visible = true;
+			found_visible = true;
+
+			// create tooltip data if needed
+			if (ld.tip.isEmpty()) {
+				if (!ld.stack.empty()) {
+					ld.tip = items->getShortTooltip(ld.stack);
 				}
 			}
-			else if (settings->loot_tooltips == Settings::LOOT_TIPS_HIDE_ALL) {
-				default_visibility = false;
-			}
-			else if (settings->loot_tooltips == Settings::LOOT_TIPS_SHOW_ALL && inpt->pressing[Input::ALT]) {
+		}
+
+		if (ld.tip_visible != visible)
+			layout_dirty = true;
+
+		ld.tip_visible = visible;
+	}
+
+	if (layout_dirty)
+		layoutTooltips(cam);
+
+	for (size_t i = 0; i < loot.size(); ++i) {
+		if (loot[i].tip_visible) {
+			tip->render(loot[i].tip, loot[i].tip_dest, TooltipData::STYLE_TOPLABEL);
+			loot[i].tip_bounds = tip->bounds;
+		}
+	}
+}
+
+/**
+ * Loot tooltips are shown depending on the tooltip setting, the distance to the hero and enemies,
+ * and whether the mouse is over the loot or ALT is held.
+ */
+bool LootManager::isTooltipVisible(const Loot& ld, const FPoint& cam) {
+	if (!ld.on_ground)
+		return false;
+
+	bool default_visibility = true;
+
+	if (settings->loot_tooltips == Settings::LOOT_TIPS_DEFAULT && eset->loot.hide_radius > 0) {
+		if (Utils::calcDist(pc->stats.pos, ld.pos) < eset->loot.hide_radius) {
+			default_visibility = false;
+		}
+		else {
+			Enemy* test_enemy = enemym->getNearestEnemy(ld.pos, !EnemyManager::GET_CORPSE, NULL, eset->loot.hide_radius);
+			if (test_enemy) {
 				default_visibility = false;
 			}
+		}
+	}
+	else if (settings->loot_tooltips == Settings::LOOT_TIPS_HIDE_ALL) {
+		default_visibility = false;
+	}
+	else if (settings->loot_tooltips == Settings::LOOT_TIPS_SHOW_ALL && inpt->pressing[Input::ALT]) {
+		default_visibility = false;
+	}
 
-			if (!default_visibility)
-				forced_visibility = Utils::isWithinRect(hover, inpt->mouse) || (inpt->pressing[Input::ALT] && settings->loot_tooltips != Settings::LOOT_TIPS_SHOW_ALL);
+	if (default_visibility)
+		return true;
 
-			if (default_visibility || forced_visibility) {
-				it->tip_visible = true;
+	if (inpt->pressing[Input::ALT] && settings->loot_tooltips != Settings::LOOT_TIPS_SHOW_ALL)
+		return true;
 
-				// create tooltip data if needed
-				if (it->tip.isEmpty()) {
-					if (!it->stack.empty()) {
-						it->tip = items->getShortTooltip(it->stack);
-					}
-				}
+	// set hitbox for mouse hover
+	Point p = Utils::mapToScreen(ld.pos.x, ld.pos.y, cam.x, cam.y);
+	Rect hover;
+	hover.x = p.x - eset->tileset.tile_w_half;
+	hover.y = p.y - eset->tileset.tile_h_half;
+	hover.w = eset->tileset.tile_w;
+	hover.h = eset->tileset.tile_h;
 
-				// try to prevent tooltips from overlapping
-				tip->prerender(it->tip, dest, TooltipData::STYLE_TOPLABEL);
-				std::vector<Loot>::iterator test_it;
-				for (test_it = loot.begin(); test_it != it; ) {
-					if (test_it->tip_visible && Utils::rectsOverlap(test_it->tip_bounds, tip->bounds)) {
-						if (tooltip_below)
-							dest.y = test_it->tip_bounds.y + test_it->tip_bounds.h + eset->tooltips.offset;
-						else
-							dest.y = test_it->tip_bounds.y - test_it->tip_bounds.h + eset->tooltips.offset;
-
-						tip->bounds.y = dest.y;
-					}
+	return Utils::isWithinRect(hover, inpt->mouse);
+}
 
-					++test_it;
-				}
+/**
+ * Position the visible tooltips so that they don't overlap.
+ * Each tooltip is moved below or above the earlier tooltips that it overlaps.
+ * Tooltips are registered in the columns of the screen that they cover, so only
+ * tooltips that share a column are tested against each other.
+ */
+void LootManager::layoutTooltips(const FPoint& cam) {
+	layout_dirty = false;
+	layout_cam = cam;
+	layout_view.x = settings->view_w;
+	layout_view.y = settings->view_h;
+
+	const int column_count = settings->view_w / TOOLTIP_COLUMN_WIDTH + 1;
+	tooltip_columns.resize(column_count);
+	for (size_t i = 0; i < tooltip_columns.size(); ++i) {
+		tooltip_columns[i].clear();
+	}
 
-				tip->render(it->tip, dest, TooltipData::STYLE_TOPLABEL);
-				it->tip_bounds = tip->bounds;
+	for (size_t i = 0; i < loot.size(); ++i) {
+		Loot& ld = loot[i];
+		if (!ld.tip_visible)
+			continue;
 
-				if (settings->loot_tooltips == Settings::LOOT_TIPS_HIDE_ALL && !inpt->pressing[Input::ALT])
-					break;
+		Point p = Utils::mapToScreen(ld.pos.x, ld.pos.y, cam.x, cam.y);
+		Point dest;
+		dest.x = p.x;
+		dest.y = p.y + eset->tileset.tile_h_half;
+
+		// adjust dest.y so that the tooltip floats above the item
+		dest.y -= eset->loot.tooltip_margin;
+
+		tip->prerender(ld.tip, dest, TooltipData::STYLE_TOPLABEL);
+
+		// moving the tooltip up or down doesn't change the columns it covers
+		const int first_column = std::max(0, std::min(tip->bounds.x / TOOLTIP_COLUMN_WIDTH, column_count - 1));
+		const int last_column = std::max(0, std::min((tip->bounds.x + tip->bounds.w - 1) / TOOLTIP_COLUMN_WIDTH, column_count - 1));
+
+		tooltip_candidates.clear();
+		for (int col = first_column; col <= last_column; ++col) {
+			tooltip_candidates.insert(tooltip_candidates.end(), tooltip_columns[col].begin(), tooltip_columns[col].end());
+		}
+		std::sort(tooltip_candidates.begin(), tooltip_candidates.end());
+		tooltip_candidates.erase(std::unique(tooltip_candidates.begin(), tooltip_candidates.end()), tooltip_candidates.end());
+
+		// try to prevent tooltips from overlapping
+		const bool tooltip_below = (i % 2 == 0);
+		for (size_t j = 0; j < tooltip_candidates.size(); ++j) {
+			const Rect& other = loot[tooltip_candidates[j]].tip_bounds;
+			if (Utils::rectsOverlap(other, tip->bounds)) {
+				if (tooltip_below)
+					dest.y = other.y + other.h + eset->tooltips.offset;
+				else
+					dest.y = other.y - other.h + eset->tooltips.offset;
+
+				tip->bounds.y = dest.y;
 			}
 		}
 
-		tooltip_below = !tooltip_below;
+		ld.tip_dest = dest;
+		tip->prerender(ld.tip, dest, TooltipData::STYLE_TOPLABEL);
+		ld.tip_bounds = tip->bounds;
 
-		++it;
+		for (int col = first_column; col <= last_column; ++col) {
+			tooltip_columns[col].push_back(i);
+		}
 	}
 }
 
@@ -357,9 +444,74 @@ void LootManager::addLoot(ItemStack stack, const FPoint& pos, bool dropped_by_he
 	}
 
 	loot.push_back(ld);
+	index_dirty = true;
+	layout_dirty = true;
+
 	snd->play(sfx_loot, snd->DEFAULT_CHANNEL, pos, false);
 }
 
+void LootManager::removeLoot(size_t index) {
+	loot.erase(loot.begin() + index);
+	index_dirty = true;
+	layout_dirty = true;
+}
+
+/**
+ * Sort the loot into buckets, in the order of the loot list
+ */
+void LootManager::buildIndex() {
+	index_dirty = false;
+
+	index_size.x = std::max((static_cast<int>(mapr->w) + INDEX_BUCKET_SIZE - 1) / INDEX_BUCKET_SIZE, 1);
+	index_size.y = std::max((static_cast<int>(mapr->h) + INDEX_BUCKET_SIZE - 1) / INDEX_BUCKET_SIZE, 1);
+
+	// counting sort: count the loot in each bucket, then turn the counts into offsets
+	index_start.assign(index_size.x * index_size.y + 1, 0);
+	index_ids.resize(loot.size());
+	index_scratch.resize(loot.size());
+	for (size_t i = 0; i < loot.size(); ++i) {
+		const int bx = toIndexBucket(loot[i].pos.x, index_size.x);
+		const int by = toIndexBucket(loot[i].pos.y, index_size.y);
+		index_scratch[i] = static_cast<unsigned>(by * index_size.x + bx);
+		index_start[index_scratch[i] + 1]++;
+	}
+	for (size_t i = 1; i < index_start.size(); ++i) {
+		index_start[i] += index_start[i-1];
+	}
+
+	std::vector<unsigned> fill(index_start.begin(), index_start.end() - 1);
+	for (size_t i = 0; i < loot.size(); ++i) {
+		index_ids[fill[index_scratch[i]]++] = static_cast<unsigned>(i);
+	}
+}
+
+/**
+ * Get the indices of all loot that may be within range of center (in both directions), in ascending order.
+ * Callers still need to check the exact distance.
+ */
+void LootManager::getLootInArea(const FPoint& center, float range, std::vector<size_t>& result) {
+	result.clear();
+	if (loot.empty())
+		return;
+
+	if (index_dirty)
+		buildIndex();
+
+	const int min_x = toIndexBucket(center.x - range, index_size.x);
+	const int min_y = toIndexBucket(center.y - range, index_size.y);
+	const int max_x = toIndexBucket(center.x + range, index_size.x);
+	const int max_y = toIndexBucket(center.y + range, index_size.y);
+
+	for (int by = min_y; by <= max_y; ++by) {
+		for (int bx = min_x; bx <= max_x; ++bx) {
+			const unsigned bucket = static_cast<unsigned>(by * index_size.x + bx);
+			result.insert(result.end(), index_ids.begin() + index_start[bucket], index_ids.begin() + index_start[bucket + 1]);
+		}
+	}
+
+	std::sort(result.begin(), result.end());
+}
+
 /**
  * Click on the map to pick up loot.  We need the camera position to translate
  * screen coordinates to map locations.
@@ -369,17 +521,21 @@ ItemStack LootManager::checkPickup(const Point& mouse, const FPoint& cam, const
 
 	// check left mouse click
 	if (inpt->usingMouse()) {
+		getLootInArea(hero_pos, eset->misc.interact_range, area_result);
+
 		// I'm starting at the end of the loot list so that more recently-dropped
 		// loot is picked up first.  If a player drops several loot in the same
 		// location, picking it back up will work like a stack.
-		std::vector<Loot>::iterator it, it_tip, it_hotspot;
-		it_tip = it_hotspot = loot.end();
-		for (it = loot.end(); it != loot.begin(); ) {
-			--it;
+		const size_t none = loot.size();
+		size_t index_tip = none;
+		size_t index_hotspot = none;
+		for (size_t i = area_result.size(); i > 0; --i) {
+			const size_t index = area_result[i-1];
+			Loot& ld = loot[index];
 
 			// loot close enough to pickup?
-			if (fabs(hero_pos.x - it->pos.x) < eset->misc.interact_range && fabs(hero_pos.y - it->pos.y) < eset->misc.interact_range && !it->isFlying()) {
-				Point p = Utils::mapToScreen(it->pos.x, it->pos.y, cam.x, cam.y);
+			if (fabs(hero_pos.x - ld.pos.x) < eset->misc.interact_range && fabs(hero_pos.y - ld.pos.y) < eset->misc.interact_range && !ld.isFlying()) {
+				Point p = Utils::mapToScreen(ld.pos.x, ld.pos.y, cam.x, cam.y);
 
 				Rect r;
 				r.x = p.x - eset->tileset.tile_w_half;
@@ -387,37 +543,37 @@ ItemStack LootManager::checkPickup(const Point& mouse, const FPoint& cam, const
 				r.w = eset->tileset.tile_w;
 				r.h = eset->tileset.tile_h;
 
-				if (it_tip == loot.end() && it->tip_visible && Utils::isWithinRect(it->tip_bounds, mouse)) {
+				if (index_tip == none && ld.tip_visible && Utils::isWithinRect(ld.tip_bounds, mouse)) {
 					// clicked on a tooltip
 					curs->setCursor(CursorManager::CURSOR_INTERACT);
-					if (inpt->pressing[Input::MAIN1] && !inpt->lock[Input::MAIN1] && !it->stack.empty()) {
-						it_tip = it;
+					if (inpt->pressing[Input::MAIN1] && !inpt->lock[Input::MAIN1] && !ld.stack.empty()) {
+						index_tip = index;
 					}
 				}
-				else if (it_hotspot == loot.end() && Utils::isWithinRect(r, mouse)) {
+				else if (index_hotspot == none && Utils::isWithinRect(r, mouse)) {
 					// clicked on a hotspot
 					curs->setCursor(CursorManager::CURSOR_INTERACT);
-					if (inpt->pressing[Input::MAIN1] && !inpt->lock[Input::MAIN1] && !it->stack.empty()) {
-						it_hotspot = it;
+					if (inpt->pressing[Input::MAIN1] && !inpt->lock[Input::MAIN1] && !ld.stack.empty()) {
+						index_hotspot = index;
 					}
 				}
 
 				// tooltips take priority over hotspots, so we can jump out here if we clicked on a tooltip
-				if (it_tip != loot.end())
+				if (index_tip != none)
 					break;
 			}
 		}
 
-		if (it_tip != loot.end()) {
+		if (index_tip != none) {
 			inpt->lock[Input::MAIN1] = true;
-			loot_stack = it_tip->stack;
-			loot.erase(it_tip);
+			loot_stack = loot[index_tip].stack;
+			removeLoot(index_tip);
 			return loot_stack;
 		}
-		else if (it_hotspot != loot.end()) {
+		else if (index_hotspot != none) {
 			inpt->lock[Input::MAIN1] = true;
-			loot_stack = it_hotspot->stack;
-			loot.erase(it_hotspot);
+			loot_stack = loot[index_hotspot].stack;
+			removeLoot(index_hotspot);
 			return loot_stack;
 		}
 	}
@@ -440,13 +596,18 @@ ItemStack LootManager::checkPickup(const Point& mouse, const FPoint& cam, const
 ItemStack LootManager::checkAutoPickup(const FPoint& hero_pos) {
 	ItemStack loot_stack;
 
-	std::vector<Loot>::iterator it;
-	for (it = loot.end(); it != loot.begin(); ) {
-		--it;
-		if (!it->dropped_by_hero && fabs(hero_pos.x - it->pos.x) < eset->loot.autopickup_range && fabs(hero_pos.y - it->pos.y) < eset->loot.autopickup_range && !it->isFlying()) {
-			if (it->stack.item == eset->misc.currency_id && eset->loot.autopickup_currency) {
-				loot_stack = it->stack;
-				it = loot.erase(it);
+	if (!eset->loot.autopickup_currency)
+		return loot_stack;
+
+	getLootInArea(hero_pos, eset->loot.autopickup_range, area_result);
+
+	for (size_t i = area_result.size(); i > 0; --i) {
+		const size_t index = area_result[i-1];
+		Loot& ld = loot[index];
+		if (!ld.dropped_by_hero && fabs(hero_pos.x - ld.pos.x) < eset->loot.autopickup_range && fabs(hero_pos.y - ld.pos.y) < eset->loot.autopickup_range && !ld.isFlying()) {
+			if (ld.stack.item == eset->misc.currency_id) {
+				loot_stack = ld.stack;
+				removeLoot(index);
 				return loot_stack;
 			}
 		}
@@ -459,22 +620,24 @@ ItemStack LootManager::checkNearestPickup(const FPoint& hero_pos) {
 
 	float best_distance = std::numeric_limits<float>::max();
 
-	std::vector<Loot>::iterator it;
-	std::vector<Loot>::iterator nearest = loot.end();
+	getLootInArea(hero_pos, eset->misc.interact_range, area_result);
+
+	const size_t none = loot.size();
+	size_t nearest = none;
 
-	for (it = loot.end(); it != loot.begin(); ) {
-		--it;
+	for (size_t i = area_result.size(); i > 0; --i) {
+		const size_t index = area_result[i-1];
 
-		float distance = Utils::calcDist(hero_pos, it->pos);
+		float distance = Utils::calcDist(hero_pos, loot[index].pos);
 		if (distance < eset->misc.interact_range && distance < best_distance) {
 			best_distance = distance;
-			nearest = it;
+			nearest = index;
 		}
 	}
 
-	if (nearest != loot.end() && !nearest->stack.empty()) {
-		loot_stack = nearest->stack;
-		loot.erase(nearest);
+	if (nearest != none && !loot[nearest].stack.empty()) {
+		loot_stack = loot[nearest].stack;
+		removeLoot(nearest);
 		return loot_stack;
 	}
 
@@ -50,6 +50,11 @@ private:
 	void loadLootTables();
 	void getLootTable(const std::string &filename, std::vector<EventComponent> *ec_list);
 	void checkLootComponent(EventComponent* ec, FPoint *pos, std::vector<ItemStack> *itemstack_vec);
+	void removeLoot(size_t index);
+	void buildIndex();
+	void getLootInArea(const FPoint& center, float range, std::vector<size_t>& result);
+	bool isTooltipVisible(const Loot& ld, const FPoint& cam);
+	void layoutTooltips(const FPoint& cam);
 
 	SoundID sfx_loot;
 
@@ -68,8 +73,28 @@ private:
 
 	std::vector< std::vector<Animation*> > animations;
 
+	// loot indices sorted into square buckets of tiles, rebuilt when loot is added or removed
+	Point index_size; // number of buckets in each direction
+	std::vector<unsigned> index_start; // [index_size.x * index_size.y + 1] offsets into index_ids
+	std::vector<unsigned> index_ids;
+	std::vector<unsigned> index_scratch;
+	std::vector<size_t> area_result;
+	bool index_dirty;
+
+	// tooltip positions are only recalculated when loot, the camera or the set of visible tooltips change
+	bool layout_dirty;
+	FPoint layout_cam;
+	Point layout_view;
+	std::vector< std::vector<size_t> > tooltip_columns; // visible tooltips that cover each column of the screen
+	std::vector<size_t> tooltip_candidates;
+
+	size_t profile_id;
+	size_t profile_tooltips_id;
+
 public:
 	static const bool DROPPED_BY_HERO = true;
+	static const int INDEX_BUCKET_SIZE = 4; // in tiles
+	static const int TOOLTIP_COLUMN_WIDTH = 64; // in pixels
 
 	LootManager();
 	LootManager(const LootManager &copy); // not implemented
@@ -25,12 +25,14 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "EventManager.h"
 #include "FileParser.h"
 #include "Map.h"
+#include "MapCompiler.h"
 #include "MessageEngine.h"
 #include "ModManager.h"
 #include "PowerManager.h"
 #include "SharedResources.h"
 #include "SharedGameResources.h"
 #include "StatBlock.h"
+#include "UtilsFileSystem.h"
 #include "UtilsParsing.h"
 
 Map::Map()
@@ -42,7 +44,8 @@ Map::Map()
 	, h(1)
 	, hero_pos_enabled(false)
 	, hero_pos()
-	, background_color(0,0,0,0) {
+	, background_color(0,0,0,0)
+	, hierarchical_pathfinding(false) {
 }
 
 Map::~Map() {
@@ -70,9 +73,7 @@ void Map::removeLayer(unsigned index) {
 	layers.erase(layers.begin() + index);
 }
 
-int Map::load(const std::string& fname) {
-	FileParser infile;
-
+int Map::load(const std::string& fname, bool allow_compiled) {
 	clearEvents();
 	clearLayers();
 	clearQueues();
@@ -85,40 +86,25 @@ int Map::load(const std::string& fname) {
 	hero_pos_enabled = false;
 	hero_pos.x = 0;
 	hero_pos.y = 0;
+	hierarchical_pathfinding = false;
 
-	// @CLASS Map|Description of maps/
-	if (!infile.open(fname, FileParser::MOD_FILE, FileParser::ERROR_NORMAL))
-		return 0;
-
-	Utils::logInfo("Map: Loading map '%s'", fname.c_str());
+	if (!allow_compiled || !loadCompiled(fname)) {
+		FileParser infile;
 
-	this->filename = fname;
+		// @CLASS Map|Description of maps/
+		if (!infile.open(fname, FileParser::MOD_FILE, FileParser::ERROR_NORMAL))
+			return 0;
 
-	while (infile.next()) {
-		if (infile.new_section) {
+		Utils::logInfo("Map: Loading map '%s'", fname.c_str());
 
-			// for sections that are stored in collections, add a new object here
-			if (infile.section == "enemy")
-				enemy_groups.push(Map_Group());
-			else if (infile.section == "npc")
-				npcs.push(Map_NPC());
-			else if (infile.section == "event")
-				events.push_back(Event());
+		this->filename = fname;
 
+		while (infile.next()) {
+			loadKeyPair(infile);
 		}
-		if (infile.section == "header")
-			loadHeader(infile);
-		else if (infile.section == "layer")
-			loadLayer(infile);
-		else if (infile.section == "enemy")
-			loadEnemyGroup(infile, &enemy_groups.back());
-		else if (infile.section == "npc")
-			loadNPC(infile);
-		else if (infile.section == "event")
-			EventManager::loadEvent(infile, &events.back());
-	}
 
-	infile.close();
+		infile.close();
+	}
 
 	// create StatBlocks for events that need powers
 	for (unsigned i=0; i<events.size(); ++i) {
@@ -133,10 +119,7 @@ int Map::load(const std::string& fname) {
 	if (std::find(layernames.begin(), layernames.end(), "collision") == layernames.end()) {
 		layernames.push_back("collision");
 		layers.resize(layers.size()+1);
-		layers.back().resize(w);
-		for (size_t i=0; i<layers.back().size(); ++i) {
-			layers.back()[i].resize(h, 0);
-		}
+		layers.back().resize(w, h, 0);
 		collision_layer = static_cast<int>(layers.size())-1;
 	}
 
@@ -147,6 +130,92 @@ int Map::load(const std::string& fname) {
 	return 0;
 }
 
+/**
+ * Load a map that was converted by MapCompiler.
+ * Returns false if there is no compiled map or if it is older than the text map.
+ */
+bool Map::loadCompiled(const std::string& fname) {
+	const std::string compiled_filename = mods->locate(MapCompiler::getCompiledFilename(fname));
+	if (!Filesystem::fileExists(compiled_filename))
+		return false;
+
+	std::vector<unsigned char> buffer;
+	if (!MapCompiler::readFile(compiled_filename, buffer))
+		return false;
+
+	MapCompiler::Reader reader(buffer);
+	std::vector<std::string> sources;
+	std::vector<unsigned> stamps;
+	if (!reader.readHeader(sources, stamps))
+		return false;
+
+	std::vector<unsigned> source_stamps;
+	MapCompiler::getSourceStamps(sources, source_stamps);
+	if (stamps != source_stamps) {
+		Utils::logInfo("Map: Compiled map '%s' is out of date. Using the text map instead.", compiled_filename.c_str());
+		return false;
+	}
+
+	// check the whole file before changing anything, so we can still fall back to the text map
+	std::vector<MapCompiler::Record> records;
+	if (!reader.readRecords(records)) {
+		Utils::logError("Map: Compiled map '%s' is corrupted. Using the text map instead.", compiled_filename.c_str());
+		return false;
+	}
+
+	Utils::logInfo("Map: Loading compiled map '%s'", fname.c_str());
+
+	this->filename = fname;
+
+	FileParser infile;
+	infile.setSource(compiled_filename);
+
+	for (size_t i = 0; i < records.size(); ++i) {
+		const MapCompiler::Record& record = records[i];
+
+		if (record.type == MapCompiler::RECORD_LAYER_DATA) {
+			if (layers.empty() || record.size.x != w || record.size.y != h) {
+				infile.error("Map: Layer data does not match the map size %dx%d.", w, h);
+				continue;
+			}
+			reader.readLayerData(record, layers.back());
+		}
+		else {
+			infile.new_section = record.new_section;
+			infile.section = record.section;
+			infile.key = record.key;
+			infile.val = record.val;
+			loadKeyPair(infile);
+		}
+	}
+
+	return true;
+}
+
+void Map::loadKeyPair(FileParser &infile) {
+	if (infile.new_section) {
+
+		// for sections that are stored in collections, add a new object here
+		if (infile.section == "enemy")
+			enemy_groups.push(Map_Group());
+		else if (infile.section == "npc")
+			npcs.push(Map_NPC());
+		else if (infile.section == "event")
+			events.push_back(Event());
+
+	}
+	if (infile.section == "header")
+		loadHeader(infile);
+	else if (infile.section == "layer")
+		loadLayer(infile);
+	else if (infile.section == "enemy")
+		loadEnemyGroup(infile, &enemy_groups.back());
+	else if (infile.section == "npc")
+		loadNPC(infile);
+	else if (infile.section == "event")
+		EventManager::loadEvent(infile, &events.back());
+}
+
 void Map::loadHeader(FileParser &infile) {
 	if (infile.key == "title") {
 		// @ATTR title|string|Title of map
@@ -182,6 +251,10 @@ void Map::loadHeader(FileParser &infile) {
 		// @ATTR background_color|color, int : Color, alpha|Background color for the map.
 		background_color = Parse::toRGBA(infile.val);
 	}
+	else if (infile.key == "hierarchical_pathfinding") {
+		// @ATTR hierarchical_pathfinding|bool|Plan long enemy paths on a coarse graph of map regions instead of searching every tile. Useful for large maps.
+		hierarchical_pathfinding = Parse::toBool(infile.val);
+	}
 	else if (infile.key == "tilewidth") {
 		// @ATTR tilewidth|int|Inherited from Tiled map file. Unused by engine.
 	}
@@ -200,10 +273,7 @@ void Map::loadLayer(FileParser &infile) {
 	if (infile.key == "type") {
 		// @ATTR layer.type|string|Map layer type.
 		layers.resize(layers.size()+1);
-		layers.back().resize(w);
-		for (size_t i=0; i<layers.back().size(); ++i) {
-			layers.back()[i].resize(h);
-		}
+		layers.back().resize(w, h, 0);
 		layernames.push_back(infile.val);
 		if (infile.val == "collision")
 			collision_layer = static_cast<int>(layernames.size())-1;
@@ -224,23 +294,12 @@ void Map::loadLayer(FileParser &infile) {
 		for (int j=0; j<h; j++) {
 			std::string val = infile.getRawLine();
 			infile.incrementLineNum();
-			if (!val.empty() && val[val.length()-1] != ',') {
-				val += ',';
-			}
 
-			// verify the width of this row
-			int comma_count = 0;
-			for (unsigned i=0; i<val.length(); ++i) {
-				if (val[i] == ',') comma_count++;
-			}
-			if (comma_count != w) {
+			if (!parseLayerRow(val, layers.back().getRow(j), w)) {
 				infile.error("Map: A row of layer data has a width not equal to %d.", w);
 				mods->resetModConfig();
 				Utils::Exit(1);
 			}
-
-			for (int i=0; i<w; i++)
-				layers.back()[i][j] = static_cast<unsigned short>(Parse::popFirstInt(val));
 		}
 	}
 	else {
@@ -373,6 +432,52 @@ void Map::loadNPC(FileParser &infile) {
 	}
 }
 
+/**
+ * Parse a row of comma separated tile ids into dest.
+ * This walks the row once instead of splitting off one value at a time, which gets slow for wide maps.
+ * Returns false if the row doesn't contain exactly width values.
+ */
+bool Map::parseLayerRow(std::string row, unsigned short* dest, unsigned short width) {
+	if (!row.empty() && row[row.length()-1] != ',') {
+		row += ',';
+	}
+
+	// verify the width of this row
+	int comma_count = 0;
+	for (size_t i = 0; i < row.length(); ++i) {
+		if (row[i] == ',') comma_count++;
+	}
+	if (comma_count != width)
+		return false;
+
+	size_t pos = 0;
+	for (unsigned short i = 0; i < width; ++i) {
+		while (pos < row.length() && (row[pos] == ' ' || row[pos] == '\t'))
+			pos++;
+
+		bool negative = false;
+		if (pos < row.length() && (row[pos] == '-' || row[pos] == '+')) {
+			negative = (row[pos] == '-');
+			pos++;
+		}
+
+		int value = 0;
+		while (pos < row.length() && row[pos] >= '0' && row[pos] <= '9') {
+			value = value * 10 + (row[pos] - '0');
+			pos++;
+		}
+
+		dest[i] = static_cast<unsigned short>(negative ? -value : value);
+
+		// skip anything else up to the next value
+		while (pos < row.length() && row[pos] != ',')
+			pos++;
+		pos++;
+	}
+
+	return true;
+}
+
 int Map::addEventStatBlock(Event &evnt) {
 	statblocks.push_back(StatBlock());
 	StatBlock *statb = &statblocks.back();
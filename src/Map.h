@@ -121,6 +121,8 @@ public:
 
 class Map {
 protected:
+	bool loadCompiled(const std::string& fname);
+	void loadKeyPair(FileParser &infile);
 	void loadHeader(FileParser &infile);
 	void loadLayer(FileParser &infile);
 	void loadEnemyGroup(FileParser &infile, Map_Group *group);
@@ -143,7 +145,9 @@ public:
 	void setTileset(const std::string& tset) { tileset = tset; }
 	void removeLayer(unsigned index);
 
-	int load(const std::string& filename);
+	int load(const std::string& filename, bool allow_compiled = true);
+
+	static bool parseLayerRow(std::string row, unsigned short* dest, unsigned short width);
 
 	std::string music_filename;
 
@@ -177,6 +181,7 @@ public:
 	FPoint hero_pos;
 	std::string parallax_filename;
 	Color background_color;
+	bool hierarchical_pathfinding;
 
 };
 
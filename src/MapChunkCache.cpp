@@ -0,0 +1,482 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapChunkCache
+ */
+
+#include "EngineSettings.h"
+#include "MapChunkCache.h"
+#include "RenderDevice.h"
+#include "Settings.h"
+#include "SharedResources.h"
+#include "TileSet.h"
+
+#include <math.h>
+
+MapChunkCache::MapChunkCache()
+	: map_size(0, 0)
+	, chunk_count(0, 0)
+	, memory_used(0)
+	, frame(0)
+	, builds_left(MAX_BUILDS_PER_FRAME)
+	, render_target_version(0)
+{
+}
+
+MapChunkCache::~MapChunkCache() {
+	clear();
+}
+
+/**
+ * Prepare empty chunks for a newly loaded map
+ */
+void MapChunkCache::init(size_t layer_count, const Point& _map_size) {
+	clear();
+
+	map_size = _map_size;
+	render_target_version = render_device->getRenderTargetVersion();
+	chunk_count.x = (map_size.x + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	chunk_count.y = (map_size.y + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	layers.resize(layer_count);
+	for (size_t i = 0; i < layers.size(); ++i) {
+		layers[i].chunks.resize(chunk_count.x * chunk_count.y);
+	}
+}
+
+void MapChunkCache::clear() {
+	freeImages();
+	layers.clear();
+	memory_used = 0;
+	map_size = Point(0, 0);
+	chunk_count = Point(0, 0);
+}
+
+/**
+ * A tile of a layer has changed, so the chunk that contains it needs to be rebuilt
+ */
+void MapChunkCache::invalidate(size_t layer_index, int x, int y) {
+	if (layer_index >= layers.size() || x < 0 || y < 0 || x >= map_size.x || y >= map_size.y)
+		return;
+
+	Layer& cache_layer = layers[layer_index];
+	cache_layer.checked = false;
+
+	Chunk& chunk = cache_layer.chunks[(y / CHUNK_SIZE) * chunk_count.x + (x / CHUNK_SIZE)];
+	freeChunk(chunk);
+	chunk.segments.clear();
+	chunk.scanned = false;
+}
+
+/**
+ * Free the images of all chunks. They are built again when they are drawn.
+ */
+void MapChunkCache::freeImages() {
+	for (size_t i = 0; i < layers.size(); ++i) {
+		for (size_t j = 0; j < layers[i].chunks.size(); ++j) {
+			freeChunk(layers[i].chunks[j]);
+		}
+	}
+}
+
+/**
+ * Called once before the layers of a frame are rendered
+ */
+void MapChunkCache::startFrame() {
+	frame++;
+	builds_left = MAX_BUILDS_PER_FRAME;
+
+	// chunk images are render targets, which may have been lost (e.g. device reset or window resize)
+	if (render_target_version != render_device->getRenderTargetVersion()) {
+		freeImages();
+		render_target_version = render_device->getRenderTargetVersion();
+	}
+}
+
+size_t MapChunkCache::getMemoryUsed() const {
+	return memory_used;
+}
+
+/**
+ * Screen position of a tile, relative to the first tile of its chunk
+ */
+Point MapChunkCache::getTileOffset(int x, int y, const Rect& chunk_tiles) const {
+	const int dx = x - chunk_tiles.x;
+	const int dy = y - chunk_tiles.y;
+
+	if (eset->tileset.orientation == eset->tileset.TILESET_ORTHOGONAL)
+		return Point(dx * eset->tileset.tile_w, dy * eset->tileset.tile_h);
+	else
+		return Point((dx - dy) * eset->tileset.tile_w_half, (dx + dy) * eset->tileset.tile_h_half);
+}
+
+/**
+ * Same as MapRenderer::centerTile(Utils::mapToScreen(x, y, cam.x, cam.y))
+ */
+Point MapChunkCache::getTileCenter(int x, int y, const FPoint& cam) const {
+	Point p = Utils::mapToScreen(static_cast<float>(x), static_cast<float>(y), cam.x, cam.y);
+
+	if (eset->tileset.orientation == eset->tileset.TILESET_ORTHOGONAL)
+		p.x += eset->tileset.tile_w_half;
+	p.y += eset->tileset.tile_h_half;
+
+	return p;
+}
+
+Rect MapChunkCache::getChunkTiles(int chunk_x, int chunk_y) const {
+	Rect r;
+	r.x = chunk_x * CHUNK_SIZE;
+	r.y = chunk_y * CHUNK_SIZE;
+	r.w = std::min(CHUNK_SIZE, map_size.x - r.x);
+	r.h = std::min(CHUNK_SIZE, map_size.y - r.y);
+	return r;
+}
+
+/**
+ * List the tiles of an area in the order that MapRenderer draws them
+ */
+void MapChunkCache::getDrawOrder(const Rect& area, std::vector<Point>& tiles) const {
+	tiles.clear();
+
+	if (eset->tileset.orientation == eset->tileset.TILESET_ORTHOGONAL) {
+		for (int j = area.y; j < area.y + area.h; ++j) {
+			for (int i = area.x; i < area.x + area.w; ++i) {
+				tiles.push_back(Point(i, j));
+			}
+		}
+	}
+	else {
+		// isometric maps are drawn in diagonal lines of constant i+j
+		const int i_end = area.x + area.w - 1;
+		const int j_end = area.y + area.h - 1;
+		for (int d = area.x + area.y; d <= i_end + j_end; ++d) {
+			for (int i = std::max(area.x, d - j_end); i <= std::min(i_end, d - area.y); ++i) {
+				tiles.push_back(Point(i, d - i));
+			}
+		}
+	}
+}
+
+/**
+ * Tiles that are wider than a tile could cover a tile of another chunk that is drawn later
+ */
+bool MapChunkCache::isWide(unsigned short tile_id, const TileSet& tset) const {
+	const Tile_Def& tile = tset.tiles[tile_id];
+	const int clip_w = tile.tile->getClip().w;
+	return (tile.offset.x > eset->tileset.tile_w_half || clip_w - tile.offset.x > eset->tileset.tile_w_half);
+}
+
+void MapChunkCache::checkLayer(Layer& cache_layer, const Map_Layer& layer, const TileSet& tset) {
+	cache_layer.has_wide_tiles = false;
+	cache_layer.checked = true;
+
+	for (int y = 0; y < map_size.y; ++y) {
+		for (int x = 0; x < map_size.x; ++x) {
+			const unsigned short tile_id = layer.get(x, y);
+			if (tile_id && isWide(tile_id, tset)) {
+				cache_layer.has_wide_tiles = true;
+				return;
+			}
+		}
+	}
+}
+
+/**
+ * Find the area covered by the tiles of a chunk, and split its drawing order at the animated tiles
+ */
+void MapChunkCache::scan(Chunk& chunk, int chunk_x, int chunk_y, const Map_Layer& layer, const TileSet& tset) {
+	const Rect chunk_tiles = getChunkTiles(chunk_x, chunk_y);
+	getDrawOrder(chunk_tiles, scratch_tiles);
+
+	Point bounds_min(0, 0), bounds_max(0, 0);
+	Point image_min(0, 0), image_max(0, 0);
+	bool has_tiles = false;
+	bool has_image = false;
+
+	chunk.segments.clear();
+	Segment segment;
+
+	for (size_t i = 0; i < scratch_tiles.size(); ++i) {
+		const Point& t = scratch_tiles[i];
+		const unsigned short tile_id = layer.get(t.x, t.y);
+		if (!tile_id)
+			continue;
+
+		const Tile_Def& tile = tset.tiles[tile_id];
+		const Point offset = getTileOffset(t.x, t.y, chunk_tiles);
+		const Rect& clip = tile.tile->getClip();
+		const Point tile_min(offset.x - tile.offset.x, offset.y - tile.offset.y);
+		const Point tile_max(tile_min.x + clip.w, tile_min.y + clip.h);
+
+		if (!has_tiles) {
+			bounds_min = tile_min;
+			bounds_max = tile_max;
+			has_tiles = true;
+		}
+		else {
+			bounds_min.x = std::min(bounds_min.x, tile_min.x);
+			bounds_min.y = std::min(bounds_min.y, tile_min.y);
+			bounds_max.x = std::max(bounds_max.x, tile_max.x);
+			bounds_max.y = std::max(bounds_max.y, tile_max.y);
+		}
+
+		if (tset.isAnimated(tile_id)) {
+			// the static tiles so far are drawn before this tile
+			segment.end = i;
+			segment.animated_tile = t;
+			segment.has_animated_tile = true;
+			if (has_image)
+				segment.image_bounds = Rect(image_min.x, image_min.y, image_max.x - image_min.x, image_max.y - image_min.y);
+			chunk.segments.push_back(segment);
+
+			segment = Segment();
+			segment.begin = i + 1;
+			has_image = false;
+			continue;
+		}
+
+		if (!has_image) {
+			image_min = tile_min;
+			image_max = tile_max;
+			has_image = true;
+		}
+		else {
+			image_min.x = std::min(image_min.x, tile_min.x);
+			image_min.y = std::min(image_min.y, tile_min.y);
+			image_max.x = std::max(image_max.x, tile_max.x);
+			image_max.y = std::max(image_max.y, tile_max.y);
+		}
+	}
+
+	if (has_image) {
+		segment.end = scratch_tiles.size();
+		segment.image_bounds = Rect(image_min.x, image_min.y, image_max.x - image_min.x, image_max.y - image_min.y);
+		chunk.segments.push_back(segment);
+	}
+
+	chunk.bounds = Rect(bounds_min.x, bounds_min.y, bounds_max.x - bounds_min.x, bounds_max.y - bounds_min.y);
+	chunk.tiled = (chunk.segments.size() > MAX_SEGMENTS);
+	chunk.scanned = true;
+}
+
+/**
+ * Render the static tiles of each segment of a chunk into an image
+ */
+bool MapChunkCache::build(Chunk& chunk, int chunk_x, int chunk_y, const Map_Layer& layer, const TileSet& tset) {
+	if (builds_left <= 0)
+		return false;
+
+	size_t bytes = 0;
+	for (size_t i = 0; i < chunk.segments.size(); ++i) {
+		const Rect& image_bounds = chunk.segments[i].image_bounds;
+		bytes += static_cast<size_t>(image_bounds.w) * static_cast<size_t>(image_bounds.h) * 4;
+	}
+
+	if (!freeMemory(bytes))
+		return false;
+
+	builds_left--;
+
+	const Rect chunk_tiles = getChunkTiles(chunk_x, chunk_y);
+	getDrawOrder(chunk_tiles, scratch_tiles);
+
+	for (size_t i = 0; i < chunk.segments.size(); ++i) {
+		Segment& segment = chunk.segments[i];
+		if (segment.image_bounds.w <= 0 || segment.image_bounds.h <= 0)
+			continue;
+
+		Image *graphics = render_device->createImage(segment.image_bounds.w, segment.image_bounds.h);
+		if (!graphics) {
+			freeChunk(chunk);
+			return false;
+		}
+
+		for (size_t j = segment.begin; j < segment.end; ++j) {
+			const Point& t = scratch_tiles[j];
+			const unsigned short tile_id = layer.get(t.x, t.y);
+			if (!tile_id)
+				continue;
+
+			const Tile_Def& tile = tset.tiles[tile_id];
+			const Point offset = getTileOffset(t.x, t.y, chunk_tiles);
+
+			Rect src = tile.tile->getClip();
+			Rect dest;
+			dest.x = offset.x - tile.offset.x - segment.image_bounds.x;
+			dest.y = offset.y - tile.offset.y - segment.image_bounds.y;
+			render_device->composeToImage(tile.tile->getGraphics(), src, graphics, dest);
+		}
+
+		segment.sprite = graphics->createSprite();
+		graphics->unref();
+	}
+
+	chunk.bytes = bytes;
+	chunk.built = true;
+	memory_used += bytes;
+	return true;
+}
+
+void MapChunkCache::drawTile(unsigned short tile_id, const TileSet& tset, const Point& pos) {
+	const Tile_Def& tile = tset.tiles[tile_id];
+	tile.tile->setDest(pos.x - tile.offset.x, pos.y - tile.offset.y);
+	render_device->render(tile.tile);
+}
+
+void MapChunkCache::freeChunk(Chunk& chunk) {
+	for (size_t i = 0; i < chunk.segments.size(); ++i) {
+		delete chunk.segments[i].sprite;
+		chunk.segments[i].sprite = NULL;
+	}
+
+	memory_used -= chunk.bytes;
+	chunk.bytes = 0;
+	chunk.built = false;
+}
+
+/**
+ * Free the least recently drawn chunks until an image of the given size fits in the budget.
+ * Chunks drawn in the current frame are kept.
+ */
+bool MapChunkCache::freeMemory(size_t bytes) {
+	const size_t budget = static_cast<size_t>(settings->map_chunk_cache_mb) * 1024 * 1024;
+	if (bytes > budget)
+		return false;
+
+	while (memory_used + bytes > budget) {
+		Chunk* oldest = NULL;
+		for (size_t i = 0; i < layers.size(); ++i) {
+			for (size_t j = 0; j < layers[i].chunks.size(); ++j) {
+				Chunk& chunk = layers[i].chunks[j];
+				if (chunk.bytes > 0 && chunk.last_used != frame && (!oldest || chunk.last_used < oldest->last_used))
+					oldest = &chunk;
+			}
+		}
+
+		if (!oldest)
+			return false;
+
+		freeChunk(*oldest);
+	}
+
+	return true;
+}
+
+/**
+ * Draw the visible chunks of a layer in the same order as MapRenderer draws single tiles.
+ * Returns false if the layer can't be drawn in chunks, so MapRenderer has to draw it.
+ */
+bool MapChunkCache::render(size_t layer_index, const Map_Layer& layer, const TileSet& tset, const FPoint& cam) {
+	if (layer_index >= layers.size())
+		return false;
+
+	if (layer.empty())
+		return true;
+
+	Layer& cache_layer = layers[layer_index];
+	if (!cache_layer.checked)
+		checkLayer(cache_layer, layer, tset);
+
+	if (cache_layer.has_wide_tiles)
+		return false;
+
+	std::vector<Chunk>& chunks = cache_layer.chunks;
+
+	// the map area below the screen corners, padded because large tiles reach past their position
+	const FPoint corners[4] = {
+		Utils::screenToMap(0, 0, cam.x, cam.y),
+		Utils::screenToMap(settings->view_w, 0, cam.x, cam.y),
+		Utils::screenToMap(0, settings->view_h, cam.x, cam.y),
+		Utils::screenToMap(settings->view_w, settings->view_h, cam.x, cam.y)
+	};
+	FPoint area_min = corners[0];
+	FPoint area_max = corners[0];
+	for (int i = 1; i < 4; ++i) {
+		area_min.x = std::min(area_min.x, corners[i].x);
+		area_min.y = std::min(area_min.y, corners[i].y);
+		area_max.x = std::max(area_max.x, corners[i].x);
+		area_max.y = std::max(area_max.y, corners[i].y);
+	}
+	const float padding = static_cast<float>(tset.max_size_x + tset.max_size_y + 1);
+
+	Rect area;
+	area.x = std::max(0, static_cast<int>(floorf((area_min.x - padding) / CHUNK_SIZE)));
+	area.y = std::max(0, static_cast<int>(floorf((area_min.y - padding) / CHUNK_SIZE)));
+	area.w = std::min(chunk_count.x - 1, static_cast<int>(floorf((area_max.x + padding) / CHUNK_SIZE))) - area.x + 1;
+	area.h = std::min(chunk_count.y - 1, static_cast<int>(floorf((area_max.y + padding) / CHUNK_SIZE))) - area.y + 1;
+	if (area.w <= 0 || area.h <= 0)
+		return true;
+
+	// chunks are drawn in the same order as the tiles within them
+	getDrawOrder(area, visible);
+
+	for (size_t i = 0; i < visible.size(); ++i) {
+		const int chunk_x = visible[i].x;
+		const int chunk_y = visible[i].y;
+		Chunk& chunk = chunks[chunk_y * chunk_count.x + chunk_x];
+
+		if (!chunk.scanned)
+			scan(chunk, chunk_x, chunk_y, layer, tset);
+
+		if (chunk.bounds.w <= 0 || chunk.bounds.h <= 0)
+			continue;
+
+		const Rect chunk_tiles = getChunkTiles(chunk_x, chunk_y);
+		const Point center = getTileCenter(chunk_tiles.x, chunk_tiles.y, cam);
+
+		if (center.x + chunk.bounds.x >= settings->view_w || center.y + chunk.bounds.y >= settings->view_h ||
+			center.x + chunk.bounds.x + chunk.bounds.w <= 0 || center.y + chunk.bounds.y + chunk.bounds.h <= 0)
+		{
+			continue;
+		}
+
+		chunk.last_used = frame;
+
+		if (!chunk.built && !chunk.tiled)
+			build(chunk, chunk_x, chunk_y, layer, tset);
+
+		if (chunk.built) {
+			for (size_t j = 0; j < chunk.segments.size(); ++j) {
+				const Segment& segment = chunk.segments[j];
+				if (segment.sprite) {
+					segment.sprite->setDest(center.x + segment.image_bounds.x, center.y + segment.image_bounds.y);
+					render_device->render(segment.sprite);
+				}
+
+				if (segment.has_animated_tile) {
+					const Point& t = segment.animated_tile;
+					const Point offset = getTileOffset(t.x, t.y, chunk_tiles);
+					drawTile(layer.get(t.x, t.y), tset, Point(center.x + offset.x, center.y + offset.y));
+				}
+			}
+		}
+		else {
+			// no image for this chunk yet, so draw it the regular way
+			getDrawOrder(chunk_tiles, scratch_tiles);
+			for (size_t j = 0; j < scratch_tiles.size(); ++j) {
+				const Point& t = scratch_tiles[j];
+				if (const unsigned short tile_id = layer.get(t.x, t.y)) {
+					const Point offset = getTileOffset(t.x, t.y, chunk_tiles);
+					drawTile(tile_id, tset, Point(center.x + offset.x, center.y + offset.y));
+				}
+			}
+		}
+	}
+
+	return true;
+}
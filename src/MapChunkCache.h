@@ -0,0 +1,145 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapChunkCache
+ *
+ * Pre-renders the tiles of a map layer into images of CHUNK_SIZE x CHUNK_SIZE tiles, so a
+ * visible chunk costs a single draw instead of one per tile.
+ *
+ * Tiles that are no wider than a tile footprint can only overlap tiles of a neighboring chunk
+ * that come earlier in the regular drawing order, so drawing chunks in that same order keeps
+ * the result identical. Layers with wider tiles are left to MapRenderer (see render()).
+ *
+ * Animated tiles can't be pre-rendered. Each one ends a segment of the chunk: the static
+ * tiles before it are drawn as one image, then the animated tile is drawn on its own. This
+ * keeps the drawing order within the chunk. Chunks that would need more than MAX_SEGMENTS
+ * images are drawn tile by tile.
+ *
+ * Chunk images are built on demand and the least recently drawn ones are freed once the
+ * memory budget is exceeded. Chunks that don't fit are drawn tile by tile. All images are
+ * rebuilt when the render device reports that render targets have lost their contents.
+ */
+
+#ifndef MAP_CHUNK_CACHE_H
+#define MAP_CHUNK_CACHE_H
+
+#include "CommonIncludes.h"
+#include "MapLayer.h"
+#include "Utils.h"
+
+class Sprite;
+class TileSet;
+
+class MapChunkCache {
+private:
+	class Segment {
+	public:
+		Sprite* sprite;
+		Rect image_bounds; // area covered by the static tiles, relative to the center of the first tile of the chunk
+		size_t begin; // the static tiles are [begin, end) of the chunk's drawing order
+		size_t end;
+		Point animated_tile; // drawn after the image, if has_animated_tile is set
+		bool has_animated_tile;
+
+		Segment()
+			: sprite(NULL)
+			, begin(0)
+			, end(0)
+			, has_animated_tile(false) {
+		}
+	};
+
+	class Chunk {
+	public:
+		std::vector<Segment> segments; // in drawing order
+		Rect bounds; // area covered by all tiles, relative to the center of the first tile
+		size_t bytes; // memory used by the segment images
+		unsigned last_used;
+		bool scanned;
+		bool built;
+		bool tiled; // always drawn tile by tile
+
+		Chunk()
+			: bytes(0)
+			, last_used(0)
+			, scanned(false)
+			, built(false)
+			, tiled(false) {
+		}
+	};
+
+	class Layer {
+	public:
+		std::vector<Chunk> chunks;
+		bool checked; // has_wide_tiles is up to date
+		bool has_wide_tiles;
+
+		Layer()
+			: checked(false)
+			, has_wide_tiles(false) {
+		}
+	};
+
+	// limits how many chunks get their images created in a single frame, to avoid a long stall
+	static const int MAX_BUILDS_PER_FRAME = 8;
+
+	// chunks with more animated tiles than this are not worth splitting into images
+	static const size_t MAX_SEGMENTS = 8;
+
+	Point getTileOffset(int x, int y, const Rect& chunk_tiles) const;
+	Point getTileCenter(int x, int y, const FPoint& cam) const;
+	Rect getChunkTiles(int chunk_x, int chunk_y) const;
+	void getDrawOrder(const Rect& area, std::vector<Point>& tiles) const;
+	bool isWide(unsigned short tile_id, const TileSet& tset) const;
+	void checkLayer(Layer& cache_layer, const Map_Layer& layer, const TileSet& tset);
+
+	void scan(Chunk& chunk, int chunk_x, int chunk_y, const Map_Layer& layer, const TileSet& tset);
+	bool build(Chunk& chunk, int chunk_x, int chunk_y, const Map_Layer& layer, const TileSet& tset);
+	void drawTile(unsigned short tile_id, const TileSet& tset, const Point& pos);
+	void freeChunk(Chunk& chunk);
+	bool freeMemory(size_t bytes);
+
+	Point map_size;
+	Point chunk_count;
+	std::vector<Layer> layers;
+
+	size_t memory_used; // in bytes
+	unsigned frame;
+	int builds_left;
+	unsigned render_target_version;
+
+	// kept between frames to avoid reallocating
+	std::vector<Point> scratch_tiles;
+	std::vector<Point> visible;
+
+public:
+	static const int CHUNK_SIZE = 16; // in tiles
+
+	MapChunkCache();
+	~MapChunkCache();
+
+	void init(size_t layer_count, const Point& _map_size);
+	void clear();
+	void invalidate(size_t layer_index, int x, int y);
+	void freeImages();
+	void startFrame();
+	bool render(size_t layer_index, const Map_Layer& layer, const TileSet& tset, const FPoint& cam);
+	size_t getMemoryUsed() const;
+};
+
+#endif
@@ -46,23 +46,84 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 const float MapCollision::MIN_TILE_GAP = 0.001f;
 
 MapCollision::MapCollision()
-	: map_size(Point())
+	: colflags(1, 1, 0)
+	, colmap(1, 1, BLOCKS_NONE)
+	, map_size(Point())
 {
-	colmap.resize(1);
-	colmap[0].resize(1);
 }
 
-void MapCollision::setMap(const Map_Layer& _colmap, unsigned short w, unsigned short h) {
-	colmap.resize(w);
-	for (unsigned i=0; i<w; ++i) {
-		colmap[i].resize(h);
+void MapCollision::setMap(const Map_Layer& _colmap, bool hierarchical_pathfinding) {
+	const unsigned short w = _colmap.getWidth();
+	const unsigned short h = _colmap.getHeight();
+
+	colmap = _colmap;
+	colflags.resize(w, h);
+	for (unsigned short j=0; j<h; ++j) {
+		for (unsigned short i=0; i<w; ++i) {
+			colflags.set(i, j, getTileFlags(colmap.get(i, j)));
+		}
 	}
-	for (unsigned i=0; i<w; i++)
-		for (unsigned j=0; j<h; j++)
-			colmap[i][j] = _colmap[i][j];
 
 	map_size.x = w;
 	map_size.y = h;
+
+	path_open.resize(w, h);
+	path_close.resize(w, h);
+
+	setHierarchicalPathfinding(hierarchical_pathfinding);
+	flow_field.init(this);
+}
+
+void MapCollision::setHierarchicalPathfinding(bool enable) {
+	if (enable)
+		path_hierarchy.init(this);
+	else
+		path_hierarchy.clear();
+}
+
+bool MapCollision::isHierarchicalPathfinding() const {
+	return path_hierarchy.isEnabled();
+}
+
+/**
+ * Change the static collision type of a tile (e.g. through a map event)
+ */
+void MapCollision::setTile(int tile_x, int tile_y, unsigned short tile_type) {
+	if (isTileOutsideMap(tile_x, tile_y))
+		return;
+
+	updateTile(tile_x, tile_y, tile_type);
+	path_hierarchy.invalidate(tile_x, tile_y);
+	flow_field.invalidate();
+}
+
+/**
+ * Translate a collision tile type into the flags used by the movement and sight checks
+ */
+unsigned char MapCollision::getTileFlags(unsigned short tile_type) {
+	switch (tile_type) {
+		case BLOCKS_NONE:
+		case MAP_ONLY:
+		case MAP_ONLY_ALT:
+			return 0;
+		case BLOCKS_ALL:
+		case BLOCKS_ALL_HIDDEN:
+			return FLAG_WALL | FLAG_OBSTACLE;
+		case BLOCKS_ENTITIES:
+			return FLAG_ENTITY;
+		case BLOCKS_ENEMIES:
+			return FLAG_ALLY;
+		default:
+			return FLAG_OBSTACLE;
+	}
+}
+
+/**
+ * Keeps colmap and colflags in sync. Does no bounds checking.
+ */
+void MapCollision::updateTile(int tile_x, int tile_y, unsigned short tile_type) {
+	colmap.set(tile_x, tile_y, tile_type);
+	colflags.set(tile_x, tile_y, getTileFlags(tile_type));
 }
 
 int sgn(float f) {
@@ -221,7 +282,7 @@ bool MapCollision::isEmpty(const float& x, const float& y) const {
 	if (isTileOutsideMap(tile_x, tile_y)) return false;
 
 	// collision type check
-	return (colmap[tile_x][tile_y] == BLOCKS_NONE || colmap[tile_x][tile_y] == MAP_ONLY || colmap[tile_x][tile_y] == MAP_ONLY_ALT);
+	return (colflags.get(tile_x, tile_y) & (FLAG_OBSTACLE | FLAG_ENTITY | FLAG_ALLY)) == 0;
 }
 
 /**
@@ -235,7 +296,7 @@ bool MapCollision::isWall(const float& x, const float& y) const {
 	if (isTileOutsideMap(tile_x, tile_y)) return true;
 
 	// collision type check
-	return (colmap[tile_x][tile_y] == BLOCKS_ALL || colmap[tile_x][tile_y] == BLOCKS_ALL_HIDDEN);
+	return (colflags.get(tile_x, tile_y) & FLAG_WALL) != 0;
 }
 
 /**
@@ -245,14 +306,14 @@ bool MapCollision::isValidTile(const int& tile_x, const int& tile_y, int movemen
 	// outside the map isn't valid
 	if (isTileOutsideMap(tile_x,tile_y)) return false;
 
+	const unsigned char flags = colflags.get(tile_x, tile_y);
+
 	if (collide_type == COLLIDE_NORMAL) {
-		if (colmap[tile_x][tile_y] == BLOCKS_ENEMIES)
-			return false;
-		if (colmap[tile_x][tile_y] == BLOCKS_ENTITIES)
+		if (flags & (FLAG_ENTITY | FLAG_ALLY))
 			return false;
 	}
 	else if (collide_type == COLLIDE_HERO) {
-		if (colmap[tile_x][tile_y] == BLOCKS_ENEMIES && !eset->misc.enable_ally_collision)
+		if ((flags & FLAG_ALLY) && !eset->misc.enable_ally_collision)
 			return true;
 	}
 
@@ -261,15 +322,28 @@ bool MapCollision::isValidTile(const int& tile_x, const int& tile_y, int movemen
 		return true;
 
 	// flying creatures can't be in walls
-	if (movement_type == MOVE_FLYING) {
-		return (!(colmap[tile_x][tile_y] == BLOCKS_ALL || colmap[tile_x][tile_y] == BLOCKS_ALL_HIDDEN));
-	}
+	if (movement_type == MOVE_FLYING)
+		return (flags & FLAG_WALL) == 0;
+
+	// normal creatures can only be in empty spaces
+	return (flags & (FLAG_OBSTACLE | FLAG_ENTITY | FLAG_ALLY)) == 0;
+}
+
+/**
+ * Like isValidTile(), but tiles blocked by entities are treated as empty
+ * Used by the pathfinding helpers that only care about static collision
+ */
+bool MapCollision::isWalkableTile(int tile_x, int tile_y, int movement_type) const {
+	if (isTileOutsideMap(tile_x, tile_y)) return false;
+
+	const unsigned char flags = colflags.get(tile_x, tile_y);
 
-	if (colmap[tile_x][tile_y] == MAP_ONLY || colmap[tile_x][tile_y] == MAP_ONLY_ALT)
+	if (movement_type == MOVE_INTANGIBLE)
 		return true;
+	else if (movement_type == MOVE_FLYING)
+		return (flags & FLAG_WALL) == 0;
 
-	// normal creatures can only be in empty spaces
-	return (colmap[tile_x][tile_y] == BLOCKS_NONE);
+	return (flags & FLAG_OBSTACLE) == 0;
 }
 
 /**
@@ -342,8 +416,8 @@ bool MapCollision::lineOfMovement(const float& x1, const float& y1, const float&
 	int tile_x = int(x2);
 	int tile_y = int(y2);
 	bool target_blocks = false;
-	int target_blocks_type = colmap[tile_x][tile_y];
-	if (colmap[tile_x][tile_y] == BLOCKS_ENTITIES || colmap[tile_x][tile_y] == BLOCKS_ENEMIES) {
+	int target_blocks_type = colmap.get(tile_x, tile_y);
+	if (target_blocks_type == BLOCKS_ENTITIES || target_blocks_type == BLOCKS_ENEMIES) {
 		target_blocks = true;
 		unblock(x2,y2);
 	}
@@ -387,6 +461,10 @@ bool MapCollision::isFacing(const float& x1, const float& y1, char direction, co
 * Compute a path from (x1,y1) to (x2,y2)
 * Store waypoint inside path
 * limit is the maximum number of explored node
+* The open/close containers are kept between calls, so no nodes are allocated per search
+* If the map uses hierarchical pathfinding and the target is far away, the path is planned on the
+* abstract graph and only the first part of it is computed here. Callers will compute the rest once
+* they've walked that part.
 * @return true if a path is found
 */
 bool MapCollision::computePath(const FPoint& start_pos, const FPoint& end_pos, std::vector<FPoint> &path, int movement_type, unsigned int limit) {
@@ -407,43 +485,59 @@ bool MapCollision::computePath(const FPoint& start_pos, const FPoint& end_pos, s
 
 	// if the target square has an entity, temporarily clear it to compute the path
 	bool target_blocks = false;
-	int target_blocks_type = colmap[end.x][end.y];
-	if (colmap[end.x][end.y] == BLOCKS_ENTITIES || colmap[end.x][end.y] == BLOCKS_ENEMIES) {
+	int target_blocks_type = colmap.get(end.x, end.y);
+	if (target_blocks_type == BLOCKS_ENTITIES || target_blocks_type == BLOCKS_ENEMIES) {
 		target_blocks = true;
 		unblock(end_pos.x, end_pos.y);
 	}
 
+	// plan long paths on the abstract graph and only search up to a nearby waypoint
+	if (movement_type != MOVE_INTANGIBLE && path_hierarchy.isDistant(start, end)) {
+		std::vector<Point> waypoints;
+		if (path_hierarchy.findPath(start, end, movement_type, waypoints)) {
+			Point refine_end = waypoints[0];
+			for (size_t i = 1; i < waypoints.size(); ++i) {
+				if (Utils::calcDist(FPoint(start), FPoint(waypoints[i])) > static_cast<float>(HIERARCHICAL_REFINE_DISTANCE))
+					break;
+				refine_end = waypoints[i];
+			}
+			end = refine_end;
+		}
+	}
+
 	Point current = start;
-	AStarNode* node = new AStarNode(start);
-	node->setActualCost(0);
-	node->setEstimatedCost(Utils::calcDist(FPoint(start),FPoint(end)));
-	node->setParent(current);
+	AStarNode node(start);
+	node.setActualCost(0);
+	node.setEstimatedCost(Utils::calcDist(FPoint(start),FPoint(end)));
+	node.setParent(current);
+
+	path_open.reset(limit);
+	path_close.reset(limit);
 
-	AStarContainer open(map_size.x, map_size.y, limit);
-	AStarCloseContainer close(map_size.x, map_size.y, limit);
+	path_open.add(node);
 
-	open.add(node);
+	Point neighbours[node_max_neighbours];
 
-	while (!open.isEmpty() && static_cast<unsigned>(close.getSize()) < limit) {
-		node = open.get_shortest_f();
+	while (!path_open.isEmpty() && static_cast<unsigned>(path_close.getSize()) < limit) {
+		node = path_open.get_shortest_f();
 
-		current.x = node->getX();
-		current.y = node->getY();
-		close.add(node);
-		open.remove(node);
+		current.x = node.getX();
+		current.y = node.getY();
+		path_close.add(node);
+		path_open.remove(current);
 
 		if ( current.x == end.x && current.y == end.y)
 			break; //path found !
 
 		//limit evaluated nodes to the size of the map
-		std::list<Point> neighbours = node->getNeighbours(map_size.x, map_size.y);
+		int neighbour_count = node.getNeighbours(neighbours, map_size.x, map_size.y);
 
 		// for every neighbour of current node
-		for (std::list<Point>::iterator it=neighbours.begin(); it != neighbours.end(); ++it)	{
-			Point neighbour = *it;
+		for (int i = 0; i < neighbour_count; ++i) {
+			const Point& neighbour = neighbours[i];
 
 			// do not exceed the node limit when adding nodes
-			if (static_cast<unsigned>(open.getSize()) >= limit) {
+			if (static_cast<unsigned>(path_open.getSize()) >= limit) {
 				break;
 			}
 
@@ -451,24 +545,24 @@ bool MapCollision::computePath(const FPoint& start_pos, const FPoint& end_pos, s
 			if (!isValidTile(neighbour.x,neighbour.y,movement_type, MapCollision::COLLIDE_NORMAL))
 				continue;
 			// if nabour is already in close, skip it
-			if(close.exists(neighbour))
+			if(path_close.exists(neighbour))
 				continue;
 
 			// if neighbour isn't inside open, add it as a new Node
-			if(!open.exists(neighbour)) {
-				AStarNode* newNode = new AStarNode(neighbour);
-				newNode->setActualCost(node->getActualCost() + Utils::calcDist(FPoint(current),FPoint(neighbour)));
-				newNode->setParent(current);
-				newNode->setEstimatedCost(Utils::calcDist(FPoint(neighbour),FPoint(end)));
-				open.add(newNode);
+			if(!path_open.exists(neighbour)) {
+				AStarNode new_node(neighbour);
+				new_node.setActualCost(node.getActualCost() + Utils::calcDist(FPoint(current),FPoint(neighbour)));
+				new_node.setParent(current);
+				new_node.setEstimatedCost(Utils::calcDist(FPoint(neighbour),FPoint(end)));
+				path_open.add(new_node);
 			}
 			// else, update it's cost if better
 			else {
-				AStarNode* i = open.get(neighbour.x, neighbour.y);
-				if (node->getActualCost() + Utils::calcDist(FPoint(current),FPoint(neighbour)) < i->getActualCost()) {
-					Point pos(i->getX(), i->getY());
-					Point parent_pos(node->getX(), node->getY());
-					open.updateParent(pos, parent_pos, node->getActualCost() + Utils::calcDist(FPoint(current),FPoint(neighbour)));
+				AStarNode* open_node = path_open.get(neighbour.x, neighbour.y);
+				if (node.getActualCost() + Utils::calcDist(FPoint(current),FPoint(neighbour)) < open_node->getActualCost()) {
+					Point pos(open_node->getX(), open_node->getY());
+					Point parent_pos(node.getX(), node.getY());
+					path_open.updateParent(pos, parent_pos, node.getActualCost() + Utils::calcDist(FPoint(current),FPoint(neighbour)));
 				}
 			}
 		}
@@ -477,13 +571,13 @@ bool MapCollision::computePath(const FPoint& start_pos, const FPoint& end_pos, s
 	if (!(current.x == end.x && current.y == end.y)) {
 
 		//couldnt find the target so map a path to the closest node found
-		node = close.get_shortest_h();
-		current.x = node->getX();
-		current.y = node->getY();
+		AStarNode* closest = path_close.get_shortest_h();
+		current.x = closest->getX();
+		current.y = closest->getY();
 
 		while (!(current.x == start.x && current.y == start.y)) {
 			path.push_back(collisionToMap(current));
-			current = close.get(current.x, current.y)->getParent();
+			current = path_close.get(current.x, current.y)->getParent();
 		}
 	}
 	else {
@@ -491,7 +585,7 @@ bool MapCollision::computePath(const FPoint& start_pos, const FPoint& end_pos, s
 		path.push_back(collisionToMap(end));
 		while (!(current.x == start.x && current.y == start.y)) {
 			path.push_back(collisionToMap(current));
-			current = close.get(current.x, current.y)->getParent();
+			current = path_close.get(current.x, current.y)->getParent();
 		}
 	}
 	// reblock target if needed
@@ -504,11 +598,11 @@ void MapCollision::block(const float& map_x, const float& map_y, bool is_ally) {
 	const int tile_x = int(map_x);
 	const int tile_y = int(map_y);
 
-	if (colmap[tile_x][tile_y] == BLOCKS_NONE) {
+	if (colmap.get(tile_x, tile_y) == BLOCKS_NONE) {
 		if(is_ally)
-			colmap[tile_x][tile_y] = BLOCKS_ENEMIES;
+			updateTile(tile_x, tile_y, BLOCKS_ENEMIES);
 		else
-			colmap[tile_x][tile_y] = BLOCKS_ENTITIES;
+			updateTile(tile_x, tile_y, BLOCKS_ENTITIES);
 	}
 
 }
@@ -517,8 +611,9 @@ void MapCollision::unblock(const float& map_x, const float& map_y) {
 	const int tile_x = int(map_x);
 	const int tile_y = int(map_y);
 
-	if (colmap[tile_x][tile_y] == BLOCKS_ENTITIES || colmap[tile_x][tile_y] == BLOCKS_ENEMIES) {
-		colmap[tile_x][tile_y] = BLOCKS_NONE;
+	const unsigned short tile_type = colmap.get(tile_x, tile_y);
+	if (tile_type == BLOCKS_ENTITIES || tile_type == BLOCKS_ENEMIES) {
+		updateTile(tile_x, tile_y, BLOCKS_NONE);
 	}
 
 }
@@ -26,11 +26,13 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #ifndef MAP_COLLISION_H
 #define MAP_COLLISION_H
 
+#include "AStarContainer.h"
 #include "CommonIncludes.h"
+#include "MapFlowField.h"
+#include "MapLayer.h"
+#include "MapPathHierarchy.h"
 #include "Utils.h"
 
-typedef std::vector< std::vector<unsigned short> > Map_Layer;
-
 class MapCollision {
 private:
 	static const float MIN_TILE_GAP;
@@ -41,6 +43,17 @@ private:
 		CHECK_SIGHT = 2
 	};
 
+	// per-tile flags derived from the collision type, so the hot checks only need one lookup
+	enum {
+		FLAG_WALL = 1, // blocks sight and all non-intangible movement
+		FLAG_OBSTACLE = 2, // blocks normal movement
+		FLAG_ENTITY = 4, // BLOCKS_ENTITIES
+		FLAG_ALLY = 8 // BLOCKS_ENEMIES
+	};
+
+	static unsigned char getTileFlags(unsigned short tile_type);
+	void updateTile(int tile_x, int tile_y, unsigned short tile_type);
+
 	bool isTileOutsideMap(const int& tile_x, const int& tile_y) const;
 
 	bool lineCheck(const float& x1, const float& y1, const float& x2, const float& y2, int check_type, int movement_type);
@@ -56,11 +69,21 @@ private:
 
 	FPoint collisionToMap(const Point& p);
 
+	MapGrid<unsigned char> colflags;
+
+	// reused by every computePath() call
+	AStarContainer path_open;
+	AStarCloseContainer path_close;
+
+	// optional abstraction used to plan long paths
+	MapPathHierarchy path_hierarchy;
+
 public:
 	// const flags
 	static const bool IGNORE_BLOCKED = true;
 	static const bool IS_ALLY = true;
 	static const int DEFAULT_PATH_LIMIT = 0;
+	static const int HIERARCHICAL_REFINE_DISTANCE = MapPathHierarchy::CLUSTER_SIZE * 2;
 
 	// entity collision type
 	enum {
@@ -94,7 +117,10 @@ public:
 	MapCollision();
 	~MapCollision();
 
-	void setMap(const Map_Layer& _colmap, unsigned short w, unsigned short h);
+	void setMap(const Map_Layer& _colmap, bool hierarchical_pathfinding);
+	void setTile(int tile_x, int tile_y, unsigned short tile_type);
+	void setHierarchicalPathfinding(bool enable);
+	bool isHierarchicalPathfinding() const;
 	bool move(float &x, float &y, float step_x, float step_y, int movement_type, int collide_type);
 
 	bool isOutsideMap(const float& tile_x, const float& tile_y) const;
@@ -102,6 +128,7 @@ public:
 	bool isWall(const float& x, const float& y) const;
 
 	bool isValidPosition(const float& x, const float& y, int movement_type, int collide_type) const;
+	bool isWalkableTile(int tile_x, int tile_y, int movement_type) const;
 
 	bool lineOfSight(const float& x1, const float& y1, const float& x2, const float& y2);
 	bool lineOfMovement(const float& x1, const float& y1, const float& x2, const float& y2, int movement_type);
@@ -119,8 +146,12 @@ public:
 		return hero ? COLLIDE_HERO : COLLIDE_NORMAL;
 	}
 
+	// read-only outside of this class, use setTile() to change collision
 	Map_Layer colmap;
 	Point map_size;
+
+	// shared field used by enemies pursuing the hero
+	MapFlowField flow_field;
 };
 
 #endif
@@ -0,0 +1,376 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapCompiler
+ */
+
+#include "FileParser.h"
+#include "Map.h"
+#include "MapCompiler.h"
+#include "ModManager.h"
+#include "SharedResources.h"
+#include "UtilsFileSystem.h"
+#include "UtilsParsing.h"
+
+#include <fstream>
+
+namespace {
+	const char MAGIC[8] = {'F', 'L', 'A', 'R', 'E', 'M', 'A', 'P'};
+}
+
+MapCompiler::Reader::Reader(const std::vector<unsigned char>& _buffer)
+	: buffer(_buffer)
+	, pos(0)
+{
+}
+
+bool MapCompiler::Reader::readByte(unsigned char& value) {
+	if (pos + 1 > buffer.size())
+		return false;
+
+	value = buffer[pos];
+	pos += 1;
+	return true;
+}
+
+bool MapCompiler::Reader::readShort(unsigned short& value) {
+	if (pos + 2 > buffer.size())
+		return false;
+
+	value = static_cast<unsigned short>(buffer[pos] | (buffer[pos+1] << 8));
+	pos += 2;
+	return true;
+}
+
+bool MapCompiler::Reader::readInt(unsigned& value) {
+	if (pos + 4 > buffer.size())
+		return false;
+
+	value = static_cast<unsigned>(buffer[pos]) | (static_cast<unsigned>(buffer[pos+1]) << 8) | (static_cast<unsigned>(buffer[pos+2]) << 16) | (static_cast<unsigned>(buffer[pos+3]) << 24);
+	pos += 4;
+	return true;
+}
+
+bool MapCompiler::Reader::readString(std::string& value) {
+	unsigned length;
+	if (!readInt(length) || pos + length > buffer.size())
+		return false;
+
+	value.assign(reinterpret_cast<const char*>(&buffer[0]) + pos, length);
+	pos += length;
+	return true;
+}
+
+/**
+ * Check the file type and get the text files that the map was compiled from, and their stamps
+ */
+bool MapCompiler::Reader::readHeader(std::vector<std::string>& sources, std::vector<unsigned>& stamps) {
+	sources.clear();
+	stamps.clear();
+	pos = 0;
+
+	if (buffer.size() < sizeof(MAGIC) || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), reinterpret_cast<const char*>(&buffer[0])))
+		return false;
+	pos += sizeof(MAGIC);
+
+	unsigned version;
+	if (!readInt(version) || version != VERSION)
+		return false;
+
+	unsigned source_count;
+	if (!readInt(source_count) || static_cast<size_t>(source_count) > buffer.size() / 8)
+		return false;
+
+	sources.resize(source_count);
+	for (unsigned i = 0; i < source_count; ++i) {
+		if (!readString(sources[i]))
+			return false;
+
+		// see getSourceStamps()
+		unsigned file_count;
+		if (!readInt(file_count) || pos + static_cast<size_t>(file_count) * 8 > buffer.size())
+			return false;
+
+		stamps.push_back(file_count);
+		for (unsigned j = 0; j < file_count * 2; ++j) {
+			unsigned stamp;
+			readInt(stamp);
+			stamps.push_back(stamp);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Read all records after the header. Layer data is only checked for size here, see readLayerData()
+ */
+bool MapCompiler::Reader::readRecords(std::vector<Record>& records) {
+	records.clear();
+
+	unsigned record_count;
+	if (!readInt(record_count))
+		return false;
+
+	// every record takes at least 5 bytes
+	if (static_cast<size_t>(record_count) > buffer.size() / 5)
+		return false;
+
+	records.resize(record_count);
+	for (unsigned i = 0; i < record_count; ++i) {
+		Record& record = records[i];
+
+		if (!readByte(record.type))
+			return false;
+
+		if (record.type == RECORD_KEY_PAIR) {
+			unsigned char new_section;
+			if (!readByte(new_section) || !readString(record.section) || !readString(record.key) || !readString(record.val))
+				return false;
+			record.new_section = (new_section != 0);
+		}
+		else if (record.type == RECORD_LAYER_DATA) {
+			unsigned short layer_w, layer_h;
+			if (!readShort(layer_w) || !readShort(layer_h))
+				return false;
+
+			const size_t bytes = static_cast<size_t>(layer_w) * layer_h * 2;
+			if (pos + bytes > buffer.size())
+				return false;
+
+			record.size = Point(layer_w, layer_h);
+			record.data_offset = pos;
+			pos += bytes;
+		}
+		else {
+			return false;
+		}
+	}
+
+	return pos == buffer.size();
+}
+
+/**
+ * Copy the tile ids of a layer data record. The layer must have the size of the record.
+ */
+void MapCompiler::Reader::readLayerData(const Record& record, Map_Layer& layer) const {
+	size_t offset = record.data_offset;
+	for (unsigned short y = 0; y < record.size.y; ++y) {
+		unsigned short* row = layer.getRow(y);
+		for (unsigned short x = 0; x < record.size.x; ++x) {
+			row[x] = static_cast<unsigned short>(buffer[offset] | (buffer[offset+1] << 8));
+			offset += 2;
+		}
+	}
+}
+
+MapCompiler::MapCompiler() {
+}
+
+MapCompiler::~MapCompiler() {
+}
+
+void MapCompiler::writeByte(unsigned char value) {
+	output.push_back(value);
+}
+
+void MapCompiler::writeShort(unsigned short value) {
+	output.push_back(static_cast<unsigned char>(value & 0xff));
+	output.push_back(static_cast<unsigned char>((value >> 8) & 0xff));
+}
+
+void MapCompiler::writeInt(unsigned value) {
+	for (int i = 0; i < 4; ++i) {
+		output.push_back(static_cast<unsigned char>((value >> (i * 8)) & 0xff));
+	}
+}
+
+void MapCompiler::writeString(const std::string& value) {
+	writeInt(static_cast<unsigned>(value.length()));
+	output.insert(output.end(), value.begin(), value.end());
+}
+
+/**
+ * Compile a map (e.g. "maps/spawn.txt"), using the same mod files that Map::load() would use
+ */
+bool MapCompiler::compile(const std::string& filename) {
+	FileParser infile;
+	if (!infile.open(filename, FileParser::MOD_FILE, FileParser::ERROR_NORMAL))
+		return false;
+
+	// the records are written first, the header needs the files that were included
+	output.clear();
+
+	// the number of records is filled in at the end
+	const size_t record_count_pos = output.size();
+	writeInt(0);
+	unsigned record_count = 0;
+
+	unsigned short w = 1;
+	unsigned short h = 1;
+	std::vector<unsigned short> row;
+
+	while (infile.next()) {
+		// layer data is stored with the map size that Map::loadHeader() will see
+		if (infile.section == "header" && infile.key == "width")
+			w = static_cast<unsigned short>(std::max(Parse::toInt(infile.val), 1));
+		else if (infile.section == "header" && infile.key == "height")
+			h = static_cast<unsigned short>(std::max(Parse::toInt(infile.val), 1));
+
+		if (infile.section == "layer" && infile.key == "data") {
+			writeByte(RECORD_LAYER_DATA);
+			writeShort(w);
+			writeShort(h);
+
+			row.resize(w);
+			for (unsigned short j = 0; j < h; ++j) {
+				std::string val = infile.getRawLine();
+				infile.incrementLineNum();
+
+				if (!Map::parseLayerRow(val, &row[0], w)) {
+					infile.error("MapCompiler: A row of layer data has a width not equal to %d.", w);
+					infile.close();
+					return false;
+				}
+
+				for (unsigned short i = 0; i < w; ++i) {
+					writeShort(row[i]);
+				}
+			}
+		}
+		else {
+			writeByte(RECORD_KEY_PAIR);
+			writeByte(infile.new_section ? 1 : 0);
+			writeString(infile.section);
+			writeString(infile.key);
+			writeString(infile.val);
+		}
+
+		record_count++;
+	}
+
+	std::vector<std::string> sources(1, filename);
+	sources.insert(sources.end(), infile.getIncludedFiles().begin(), infile.getIncludedFiles().end());
+
+	infile.close();
+
+	for (int i = 0; i < 4; ++i) {
+		output[record_count_pos + i] = static_cast<unsigned char>((record_count >> (i * 8)) & 0xff);
+	}
+
+	std::vector<unsigned> stamps;
+	getSourceStamps(sources, stamps);
+
+	std::vector<unsigned char> records;
+	records.swap(output);
+
+	output.insert(output.end(), MAGIC, MAGIC + sizeof(MAGIC));
+	writeInt(VERSION);
+	writeInt(static_cast<unsigned>(sources.size()));
+	size_t stamp_index = 0;
+	for (size_t i = 0; i < sources.size(); ++i) {
+		writeString(sources[i]);
+
+		const unsigned file_count = stamps[stamp_index++];
+		writeInt(file_count);
+		for (unsigned j = 0; j < file_count * 2; ++j) {
+			writeInt(stamps[stamp_index++]);
+		}
+	}
+	output.insert(output.end(), records.begin(), records.end());
+
+	// write the compiled map next to the text map that takes priority
+	const std::string dest = getCompiledFilename(mods->locate(filename));
+
+	std::ofstream outfile;
+	outfile.open(dest.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!outfile.is_open()) {
+		Utils::logError("MapCompiler: Could not write '%s'.", dest.c_str());
+		return false;
+	}
+
+	outfile.write(reinterpret_cast<const char*>(&output[0]), static_cast<std::streamsize>(output.size()));
+	const bool success = !outfile.fail();
+	outfile.close();
+	mods->fileWritten(dest);
+
+	if (success)
+		Utils::logInfo("MapCompiler: Compiled '%s' (%d records).", dest.c_str(), record_count);
+	else
+		Utils::logError("MapCompiler: Could not write '%s'.", dest.c_str());
+
+	return success;
+}
+
+/**
+ * "maps/spawn.txt" -> "maps/spawn.bin"
+ */
+std::string MapCompiler::getCompiledFilename(const std::string& filename) {
+	const std::string ext = ".txt";
+	if (filename.length() >= ext.length() && filename.compare(filename.length() - ext.length(), ext.length(), ext) == 0)
+		return filename.substr(0, filename.length() - ext.length()) + ".bin";
+	return filename + ".bin";
+}
+
+/**
+ * For each source (e.g. "maps/spawn.txt" and the files it includes): the number of mod files
+ * that FileParser would read for it, then the size and modification time of each.
+ */
+void MapCompiler::getSourceStamps(const std::vector<std::string>& sources, std::vector<unsigned>& stamps) {
+	stamps.clear();
+
+	for (size_t i = 0; i < sources.size(); ++i) {
+		std::vector<std::string> files = mods->list(sources[i], ModManager::LIST_FULL_PATHS);
+		stamps.push_back(static_cast<unsigned>(files.size()));
+
+		for (size_t j = 0; j < files.size(); ++j) {
+			long size = -1;
+			long mtime = -1;
+			Filesystem::getFileStamp(files[j], size, mtime);
+
+			stamps.push_back(static_cast<unsigned>(size));
+			stamps.push_back(static_cast<unsigned>(mtime));
+		}
+	}
+}
+
+/**
+ * Read a whole file into memory at once
+ */
+bool MapCompiler::readFile(const std::string& path, std::vector<unsigned char>& buffer) {
+	buffer.clear();
+
+	std::ifstream infile;
+	infile.open(path.c_str(), std::ios::in | std::ios::binary);
+	if (!infile.is_open())
+		return false;
+
+	infile.seekg(0, std::ios::end);
+	const std::streamoff size = infile.tellg();
+	infile.seekg(0, std::ios::beg);
+
+	if (size > 0) {
+		buffer.resize(static_cast<size_t>(size));
+		infile.read(reinterpret_cast<char*>(&buffer[0]), static_cast<std::streamsize>(size));
+	}
+
+	const bool success = !infile.fail();
+	infile.close();
+
+	return success;
+}
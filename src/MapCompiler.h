@@ -0,0 +1,106 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapCompiler
+ *
+ * Converts text maps to a binary format that can be loaded without parsing text.
+ * Run with "flare --compile-maps" to compile every map of the enabled mods. Each compiled
+ * map is written next to its text map, with the ".txt" extension replaced by ".bin".
+ *
+ * Layer data is stored as packed arrays of tile ids. All other key pairs are stored already
+ * split into section, key and value, and are passed to the regular map loaders, because
+ * things like status names, item ids and translated text have to be resolved at load time.
+ *
+ * A compiled map also stores the size and modification time of every text file that it was
+ * built from, including the files of every mod that override or APPEND to the map and files
+ * read with INCLUDE. Map::load() only uses it if those still match, which only takes a stat()
+ * per file. Otherwise it falls back to the text map.
+ */
+
+#ifndef MAP_COMPILER_H
+#define MAP_COMPILER_H
+
+#include "CommonIncludes.h"
+#include "MapLayer.h"
+#include "Utils.h"
+
+class MapCompiler {
+public:
+	enum {
+		RECORD_KEY_PAIR = 0,
+		RECORD_LAYER_DATA = 1
+	};
+
+	// increment this whenever the layout of compiled maps changes
+	static const unsigned VERSION = 2;
+
+	class Record {
+	public:
+		unsigned char type;
+		bool new_section;
+		std::string section;
+		std::string key;
+		std::string val;
+		Point size; // layer data only
+		size_t data_offset; // layer data only, position of the tile ids in the file
+
+		Record()
+			: type(RECORD_KEY_PAIR)
+			, new_section(false)
+			, size(0, 0)
+			, data_offset(0) {
+		}
+	};
+
+	class Reader {
+	private:
+		bool readByte(unsigned char& value);
+		bool readShort(unsigned short& value);
+		bool readInt(unsigned& value);
+		bool readString(std::string& value);
+
+		const std::vector<unsigned char>& buffer;
+		size_t pos;
+
+	public:
+		explicit Reader(const std::vector<unsigned char>& _buffer);
+
+		bool readHeader(std::vector<std::string>& sources, std::vector<unsigned>& stamps);
+		bool readRecords(std::vector<Record>& records);
+		void readLayerData(const Record& record, Map_Layer& layer) const;
+	};
+
+	MapCompiler();
+	~MapCompiler();
+
+	bool compile(const std::string& filename);
+
+	static std::string getCompiledFilename(const std::string& filename);
+	static void getSourceStamps(const std::vector<std::string>& sources, std::vector<unsigned>& stamps);
+	static bool readFile(const std::string& path, std::vector<unsigned char>& buffer);
+
+private:
+	void writeByte(unsigned char value);
+	void writeShort(unsigned short value);
+	void writeInt(unsigned value);
+	void writeString(const std::string& value);
+
+	std::vector<unsigned char> output;
+};
+
+#endif
@@ -0,0 +1,220 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#include "AStarNode.h"
+#include "MapCollision.h"
+#include "MapFlowField.h"
+
+#include <cfloat>
+#include <functional>
+
+MapFlowField::MapFlowField()
+	: collider(NULL)
+	, has_target(false)
+{
+}
+
+MapFlowField::~MapFlowField() {
+}
+
+void MapFlowField::init(const MapCollision* _collider) {
+	collider = _collider;
+	map_size = collider->map_size;
+
+	const size_t tile_count = map_size.x * map_size.y;
+	for (int i = 0; i < LAYER_COUNT; ++i) {
+		layers[i].dist.assign(tile_count, FLT_MAX);
+		layers[i].next.assign(tile_count, -1);
+		layers[i].gen.assign(tile_count, 0);
+		layers[i].generation = 0;
+		layers[i].dirty = true;
+	}
+
+	has_target = false;
+}
+
+void MapFlowField::clear() {
+	for (int i = 0; i < LAYER_COUNT; ++i) {
+		layers[i].dist.clear();
+		layers[i].next.clear();
+		layers[i].gen.clear();
+		layers[i].dirty = true;
+	}
+	has_target = false;
+}
+
+/**
+ * Static collision changed, so the field needs to be rebuilt before it is used again
+ */
+void MapFlowField::invalidate() {
+	for (int i = 0; i < LAYER_COUNT; ++i) {
+		layers[i].dirty = true;
+	}
+}
+
+/**
+ * Called every frame with the target's position
+ * Nothing is rebuilt unless the target entered a new tile
+ */
+void MapFlowField::setTarget(const FPoint& pos) {
+	Point tile(pos);
+	if (has_target && tile.x == target.x && tile.y == target.y)
+		return;
+
+	target = tile;
+	has_target = true;
+	invalidate();
+}
+
+/**
+ * Dijkstra search outwards from the target, limited to RADIUS tiles in each direction
+ * Tiles from previous builds are discarded by bumping the generation instead of clearing the arrays
+ */
+void MapFlowField::build(int layer, int movement_type) {
+	FlowLayer& fl = layers[layer];
+	fl.dirty = false;
+
+	fl.generation++;
+	if (fl.generation == 0) {
+		fl.gen.assign(fl.gen.size(), 0);
+		fl.generation = 1;
+	}
+
+	if (!collider->isWalkableTile(target.x, target.y, movement_type))
+		return;
+
+	std::greater< std::pair<float, int> > compare;
+	queue.clear();
+
+	const int target_index = target.x + target.y * map_size.x;
+	fl.dist[target_index] = 0;
+	fl.next[target_index] = -1;
+	fl.gen[target_index] = fl.generation;
+	queue.push_back(std::pair<float, int>(0, target_index));
+
+	Point neighbors[node_max_neighbours];
+
+	while (!queue.empty()) {
+		std::pop_heap(queue.begin(), queue.end(), compare);
+		std::pair<float, int> entry = queue.back();
+		queue.pop_back();
+
+		if (entry.first > fl.dist[entry.second])
+			continue;
+
+		Point current(entry.second % map_size.x, entry.second / map_size.x);
+
+		// same neighbors as the regular A* search
+		int neighbor_count = AStarNode(current).getNeighbours(neighbors, map_size.x, map_size.y);
+		for (int i = 0; i < neighbor_count; ++i) {
+			const Point& n = neighbors[i];
+			if (abs(n.x - target.x) > RADIUS || abs(n.y - target.y) > RADIUS)
+				continue;
+			if (!collider->isWalkableTile(n.x, n.y, movement_type))
+				continue;
+
+			const int n_index = n.x + n.y * map_size.x;
+			const float cost = entry.first + Utils::calcDist(FPoint(current), FPoint(n));
+
+			if (fl.gen[n_index] != fl.generation || cost < fl.dist[n_index]) {
+				fl.dist[n_index] = cost;
+				fl.next[n_index] = entry.second;
+				fl.gen[n_index] = fl.generation;
+				queue.push_back(std::pair<float, int>(cost, n_index));
+				std::push_heap(queue.begin(), queue.end(), compare);
+			}
+		}
+	}
+}
+
+/**
+ * Find the layer for this movement type and the index of the tile at pos, building the layer if needed
+ * Returns NULL if pos is not covered by the field
+ */
+MapFlowField::FlowLayer* MapFlowField::getLayer(const FPoint& pos, int movement_type, int& index) {
+	if (!has_target || collider == NULL || movement_type == MapCollision::MOVE_INTANGIBLE)
+		return NULL;
+
+	Point tile(pos);
+	if (tile.x < 0 || tile.y < 0 || tile.x >= map_size.x || tile.y >= map_size.y)
+		return NULL;
+
+	const int layer = (movement_type == MapCollision::MOVE_FLYING) ? LAYER_FLYING : LAYER_NORMAL;
+	FlowLayer* fl = &layers[layer];
+	if (fl->dist.empty())
+		return NULL;
+	if (fl->dirty)
+		build(layer, movement_type);
+
+	index = tile.x + tile.y * map_size.x;
+	if (fl->gen[index] != fl->generation)
+		return NULL;
+
+	return fl;
+}
+
+/**
+ * Get the center of the next tile to move to in order to reach the target
+ * If the best tile is occupied by another entity, any free neighbor that is closer to the target is used instead
+ * Returns false if pos is outside the field, already at the target, or has no free way forward
+ */
+bool MapFlowField::getNextStep(const FPoint& pos, int movement_type, FPoint& next_step) {
+	int index = 0;
+	FlowLayer* fl = getLayer(pos, movement_type, index);
+	if (!fl || fl->next[index] == -1)
+		return false;
+
+	int best = fl->next[index];
+	Point best_tile(best % map_size.x, best / map_size.x);
+
+	if (!collider->isValidPosition(static_cast<float>(best_tile.x), static_cast<float>(best_tile.y), movement_type, MapCollision::COLLIDE_NORMAL)) {
+		best = -1;
+		float best_dist = fl->dist[index];
+
+		Point neighbors[node_max_neighbours];
+		int neighbor_count = AStarNode(Point(pos)).getNeighbours(neighbors, map_size.x, map_size.y);
+		for (int i = 0; i < neighbor_count; ++i) {
+			const int n_index = neighbors[i].x + neighbors[i].y * map_size.x;
+			if (fl->gen[n_index] != fl->generation || fl->dist[n_index] >= best_dist)
+				continue;
+			if (!collider->isValidPosition(static_cast<float>(neighbors[i].x), static_cast<float>(neighbors[i].y), movement_type, MapCollision::COLLIDE_NORMAL))
+				continue;
+
+			best = n_index;
+			best_dist = fl->dist[n_index];
+		}
+
+		if (best == -1)
+			return false;
+	}
+
+	next_step.x = static_cast<float>(best % map_size.x) + 0.5f;
+	next_step.y = static_cast<float>(best / map_size.x) + 0.5f;
+	return true;
+}
+
+/**
+ * Path distance from pos to the target, or -1 if pos is outside the field
+ */
+float MapFlowField::getDistance(const FPoint& pos, int movement_type) {
+	int index = 0;
+	FlowLayer* fl = getLayer(pos, movement_type, index);
+	if (!fl)
+		return -1;
+
+	return fl->dist[index];
+}
@@ -0,0 +1,88 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapFlowField
+ *
+ * A Dijkstra map around a single target (usually the hero).
+ * Every tile within RADIUS of the target stores its distance to the target and the
+ * neighboring tile that leads there, so any number of pursuers can look up their next
+ * step without running their own path search.
+ *
+ * The field is only rebuilt when the target moves to a different tile, and only for the
+ * movement types that have actually been queried since then.
+ */
+
+#ifndef MAP_FLOW_FIELD_H
+#define MAP_FLOW_FIELD_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+class MapCollision;
+
+class MapFlowField {
+private:
+	enum {
+		LAYER_NORMAL = 0,
+		LAYER_FLYING = 1,
+		LAYER_COUNT = 2
+	};
+
+	class FlowLayer {
+	public:
+		std::vector<float> dist;
+		std::vector<int> next; // index of the tile to step to, or -1 at the target
+		std::vector<unsigned int> gen;
+		unsigned int generation;
+		bool dirty;
+
+		FlowLayer()
+			: generation(0)
+			, dirty(true) {
+		}
+	};
+
+	void build(int layer, int movement_type);
+	FlowLayer* getLayer(const FPoint& pos, int movement_type, int& index);
+
+	const MapCollision* collider;
+	Point map_size;
+	Point target;
+	bool has_target;
+
+	FlowLayer layers[LAYER_COUNT];
+
+	// kept between builds to avoid reallocating
+	std::vector< std::pair<float, int> > queue;
+
+public:
+	// how far from the target the field extends, in tiles
+	static const int RADIUS = 32;
+
+	MapFlowField();
+	~MapFlowField();
+
+	void init(const MapCollision* _collider);
+	void clear();
+	void invalidate();
+	void setTarget(const FPoint& pos);
+	bool getNextStep(const FPoint& pos, int movement_type, FPoint& next_step);
+	float getDistance(const FPoint& pos, int movement_type);
+};
+
+#endif
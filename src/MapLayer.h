@@ -0,0 +1,131 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapGrid
+ *
+ * A 2D grid of map tiles stored in a single contiguous block of memory, in row-major order.
+ * Neighboring tiles of a row are next to each other in memory, so walking a row or
+ * checking adjacent tiles does not have to chase a pointer for every column.
+ *
+ * get() and set() do no bounds checking and are meant for loops that already clamp
+ * their coordinates to the grid. getChecked() and setChecked() are safe to use with any
+ * coordinates.
+ */
+
+#ifndef MAP_LAYER_H
+#define MAP_LAYER_H
+
+#include "CommonIncludes.h"
+
+template <typename T>
+class MapGrid {
+private:
+	unsigned short w;
+	unsigned short h;
+	std::vector<T> data;
+
+public:
+	MapGrid()
+		: w(0)
+		, h(0) {
+	}
+
+	MapGrid(unsigned short _w, unsigned short _h, const T& value = T())
+		: w(_w)
+		, h(_h)
+		, data(static_cast<size_t>(_w) * _h, value) {
+	}
+
+	/**
+	 * Resizes the grid and sets every tile to value. Previous contents are discarded.
+	 */
+	void resize(unsigned short _w, unsigned short _h, const T& value = T()) {
+		w = _w;
+		h = _h;
+		data.assign(static_cast<size_t>(w) * h, value);
+	}
+
+	void fill(const T& value) {
+		std::fill(data.begin(), data.end(), value);
+	}
+
+	void clear() {
+		w = 0;
+		h = 0;
+		data.clear();
+	}
+
+	bool empty() const {
+		return data.empty();
+	}
+
+	unsigned short getWidth() const {
+		return w;
+	}
+
+	unsigned short getHeight() const {
+		return h;
+	}
+
+	bool isValid(int x, int y) const {
+		return (x >= 0 && y >= 0 && x < w && y < h);
+	}
+
+	size_t getIndex(size_t x, size_t y) const {
+		return y * w + x;
+	}
+
+	T get(size_t x, size_t y) const {
+		return data[getIndex(x, y)];
+	}
+
+	void set(size_t x, size_t y, const T& value) {
+		data[getIndex(x, y)] = value;
+	}
+
+	/**
+	 * Returns fallback for coordinates outside the grid
+	 */
+	T getChecked(int x, int y, const T& fallback) const {
+		if (!isValid(x, y))
+			return fallback;
+		return data[getIndex(x, y)];
+	}
+
+	/**
+	 * Returns false (and does nothing) for coordinates outside the grid
+	 */
+	bool setChecked(int x, int y, const T& value) {
+		if (!isValid(x, y))
+			return false;
+		data[getIndex(x, y)] = value;
+		return true;
+	}
+
+	const T* getRow(size_t y) const {
+		return &data[getIndex(0, y)];
+	}
+
+	T* getRow(size_t y) {
+		return &data[getIndex(0, y)];
+	}
+};
+
+typedef MapGrid<unsigned short> Map_Layer;
+
+#endif
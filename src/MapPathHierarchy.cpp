@@ -0,0 +1,443 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#include "AStarNode.h"
+#include "MapCollision.h"
+#include "MapPathHierarchy.h"
+
+#include <cfloat>
+#include <cstdlib>
+#include <functional>
+
+const int MapPathHierarchy::CLUSTER_SIZE;
+const float MapPathHierarchy::COST_NONE = FLT_MAX;
+
+int MapPathCluster::find(const Point& p) const {
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (nodes[i].x == p.x && nodes[i].y == p.y)
+			return static_cast<int>(i);
+	}
+	return -1;
+}
+
+MapPathHierarchy::MapPathHierarchy()
+	: collider(NULL)
+{
+	for (int i = 0; i < LAYER_COUNT; ++i) {
+		node_total[i] = 0;
+		layer_dirty[i] = false;
+	}
+}
+
+MapPathHierarchy::~MapPathHierarchy() {
+}
+
+/**
+ * Split the collision map into clusters and build the abstraction for every movement type
+ */
+void MapPathHierarchy::init(const MapCollision* _collider) {
+	clear();
+
+	collider = _collider;
+	map_size = collider->map_size;
+	cluster_count.x = (map_size.x + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	cluster_count.y = (map_size.y + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+
+	for (int i = 0; i < LAYER_COUNT; ++i) {
+		clusters[i].resize(cluster_count.x * cluster_count.y);
+		layer_dirty[i] = true;
+	}
+
+	update(LAYER_NORMAL, MapCollision::MOVE_NORMAL);
+	update(LAYER_FLYING, MapCollision::MOVE_FLYING);
+}
+
+void MapPathHierarchy::clear() {
+	for (int i = 0; i < LAYER_COUNT; ++i) {
+		clusters[i].clear();
+		node_offsets[i].clear();
+		node_clusters[i].clear();
+		node_total[i] = 0;
+		layer_dirty[i] = false;
+	}
+	cluster_count = Point();
+}
+
+bool MapPathHierarchy::isEnabled() const {
+	return !clusters[LAYER_NORMAL].empty();
+}
+
+/**
+ * Static collision at this tile has changed
+ * The cluster (and its neighbors, which share its entrances) will be rebuilt on the next search
+ */
+void MapPathHierarchy::invalidate(int x, int y) {
+	if (!isEnabled() || x < 0 || y < 0 || x >= map_size.x || y >= map_size.y)
+		return;
+
+	int cluster = getClusterIndex(Point(x, y));
+	for (int i = 0; i < LAYER_COUNT; ++i) {
+		clusters[i][cluster].dirty = true;
+		layer_dirty[i] = true;
+	}
+}
+
+/**
+ * Only paths that leave the immediate neighborhood of the start cluster benefit from the abstraction
+ */
+bool MapPathHierarchy::isDistant(const Point& start, const Point& end) const {
+	if (!isEnabled())
+		return false;
+
+	return abs(start.x / CLUSTER_SIZE - end.x / CLUSTER_SIZE) > 1 || abs(start.y / CLUSTER_SIZE - end.y / CLUSTER_SIZE) > 1;
+}
+
+int MapPathHierarchy::getClusterIndex(const Point& p) const {
+	return (p.x / CLUSTER_SIZE) + (p.y / CLUSTER_SIZE) * cluster_count.x;
+}
+
+Rect MapPathHierarchy::getClusterRect(int cluster_x, int cluster_y) const {
+	Rect r;
+	r.x = cluster_x * CLUSTER_SIZE;
+	r.y = cluster_y * CLUSTER_SIZE;
+	r.w = std::min(CLUSTER_SIZE, map_size.x - r.x);
+	r.h = std::min(CLUSTER_SIZE, map_size.y - r.y);
+	return r;
+}
+
+/**
+ * Rebuild all dirty clusters of a layer
+ * Entrances are shared with neighboring clusters, so those get rebuilt as well
+ */
+void MapPathHierarchy::update(int layer, int movement_type) {
+	if (!layer_dirty[layer])
+		return;
+
+	std::vector<MapPathCluster>& layer_clusters = clusters[layer];
+	std::vector<bool> rebuild(layer_clusters.size(), false);
+
+	for (int cy = 0; cy < cluster_count.y; ++cy) {
+		for (int cx = 0; cx < cluster_count.x; ++cx) {
+			int index = cx + cy * cluster_count.x;
+			if (!layer_clusters[index].dirty)
+				continue;
+
+			rebuild[index] = true;
+			if (cx > 0) rebuild[index-1] = true;
+			if (cx < cluster_count.x-1) rebuild[index+1] = true;
+			if (cy > 0) rebuild[index-cluster_count.x] = true;
+			if (cy < cluster_count.y-1) rebuild[index+cluster_count.x] = true;
+		}
+	}
+
+	for (size_t i = 0; i < rebuild.size(); ++i) {
+		if (rebuild[i])
+			buildCluster(layer, static_cast<int>(i), movement_type);
+	}
+
+	// assign each entrance a unique id for the abstract search
+	node_offsets[layer].resize(layer_clusters.size());
+	node_clusters[layer].clear();
+	node_total[layer] = 0;
+	for (size_t i = 0; i < layer_clusters.size(); ++i) {
+		node_offsets[layer][i] = node_total[layer];
+		node_total[layer] += static_cast<int>(layer_clusters[i].nodes.size());
+		node_clusters[layer].resize(node_total[layer], static_cast<int>(i));
+	}
+
+	layer_dirty[layer] = false;
+}
+
+/**
+ * Find the entrances on the border between two neighboring clusters
+ * cluster_a must be to the left of or above cluster_b
+ * The resulting tiles are stored in pairs; tiles_a[i] connects to tiles_b[i]
+ */
+void MapPathHierarchy::scanBorder(int cluster_a, int cluster_b, int movement_type, std::vector<Point>& tiles_a, std::vector<Point>& tiles_b) const {
+	tiles_a.clear();
+	tiles_b.clear();
+
+	Rect rect_a = getClusterRect(cluster_a % cluster_count.x, cluster_a / cluster_count.x);
+
+	// a vertical border has the clusters side by side
+	bool vertical = (cluster_b == cluster_a + 1);
+
+	Point step = vertical ? Point(0, 1) : Point(1, 0);
+	Point across = vertical ? Point(1, 0) : Point(0, 1);
+	Point pos = vertical ? Point(rect_a.x + rect_a.w - 1, rect_a.y) : Point(rect_a.x, rect_a.y + rect_a.h - 1);
+	int length = vertical ? rect_a.h : rect_a.w;
+
+	int run_start = -1;
+	for (int i = 0; i <= length; ++i) {
+		Point a(pos.x + step.x * i, pos.y + step.y * i);
+		Point b(a.x + across.x, a.y + across.y);
+
+		bool open = (i < length && collider->isWalkableTile(a.x, a.y, movement_type) && collider->isWalkableTile(b.x, b.y, movement_type));
+
+		if (open && run_start == -1) {
+			run_start = i;
+		}
+		else if (!open && run_start != -1) {
+			int run_end = i-1;
+
+			std::vector<int> entrances;
+			if (run_end - run_start + 1 > MAX_ENTRANCE_WIDTH) {
+				entrances.push_back(run_start);
+				entrances.push_back(run_end);
+			}
+			else {
+				entrances.push_back((run_start + run_end) / 2);
+			}
+
+			for (size_t j = 0; j < entrances.size(); ++j) {
+				Point ea(pos.x + step.x * entrances[j], pos.y + step.y * entrances[j]);
+				tiles_a.push_back(ea);
+				tiles_b.push_back(Point(ea.x + across.x, ea.y + across.y));
+			}
+
+			run_start = -1;
+		}
+	}
+}
+
+void MapPathHierarchy::buildCluster(int layer, int cluster, int movement_type) {
+	MapPathCluster& c = clusters[layer][cluster];
+	c.nodes.clear();
+	c.links.clear();
+	c.costs.clear();
+
+	const int cx = cluster % cluster_count.x;
+	const int cy = cluster / cluster_count.x;
+
+	// neighbors in the order left, right, up, down
+	int neighbors[4] = {-1, -1, -1, -1};
+	if (cx > 0) neighbors[0] = cluster - 1;
+	if (cx < cluster_count.x-1) neighbors[1] = cluster + 1;
+	if (cy > 0) neighbors[2] = cluster - cluster_count.x;
+	if (cy < cluster_count.y-1) neighbors[3] = cluster + cluster_count.x;
+
+	std::vector<Point> tiles_a;
+	std::vector<Point> tiles_b;
+
+	for (int i = 0; i < 4; ++i) {
+		if (neighbors[i] == -1)
+			continue;
+
+		// scan each border in a consistent direction so both clusters agree on its entrances
+		bool is_first = (neighbors[i] > cluster);
+		if (is_first)
+			scanBorder(cluster, neighbors[i], movement_type, tiles_a, tiles_b);
+		else
+			scanBorder(neighbors[i], cluster, movement_type, tiles_a, tiles_b);
+
+		const std::vector<Point>& own = is_first ? tiles_a : tiles_b;
+		const std::vector<Point>& other = is_first ? tiles_b : tiles_a;
+
+		for (size_t j = 0; j < own.size(); ++j) {
+			int index = c.find(own[j]);
+			if (index == -1) {
+				index = static_cast<int>(c.nodes.size());
+				c.nodes.push_back(own[j]);
+				c.links.resize(c.nodes.size());
+			}
+			c.links[index].push_back(other[j]);
+		}
+	}
+
+	const size_t node_count = c.nodes.size();
+	c.costs.resize(node_count * node_count, COST_NONE);
+
+	Rect bounds = getClusterRect(cx, cy);
+	std::vector<float> row;
+	for (size_t i = 0; i < node_count; ++i) {
+		calcCosts(bounds, c.nodes[i], movement_type, c.nodes, row);
+		for (size_t j = 0; j < node_count; ++j) {
+			c.costs[i * node_count + j] = row[j];
+		}
+	}
+
+	c.dirty = false;
+}
+
+/**
+ * Dijkstra search from src that stays within bounds
+ * Stores the cost to reach each of the targets in result (COST_NONE if it can't be reached)
+ */
+void MapPathHierarchy::calcCosts(const Rect& bounds, const Point& src, int movement_type, const std::vector<Point>& targets, std::vector<float>& result) {
+	local_dist.assign(bounds.w * bounds.h, COST_NONE);
+
+	typedef std::pair<float, int> QueueEntry;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+
+	int src_index = (src.x - bounds.x) + (src.y - bounds.y) * bounds.w;
+	local_dist[src_index] = 0;
+	queue.push(QueueEntry(0, src_index));
+
+	Point neighbors[node_max_neighbours];
+
+	while (!queue.empty()) {
+		QueueEntry entry = queue.top();
+		queue.pop();
+
+		if (entry.first > local_dist[entry.second])
+			continue;
+
+		Point current(bounds.x + entry.second % bounds.w, bounds.y + entry.second / bounds.w);
+
+		// use the same neighbors as the tile-level A* search, so that costs match
+		int neighbor_count = AStarNode(current).getNeighbours(neighbors, map_size.x, map_size.y);
+		for (int i = 0; i < neighbor_count; ++i) {
+			const Point& n = neighbors[i];
+			if (n.x < bounds.x || n.y < bounds.y || n.x >= bounds.x + bounds.w || n.y >= bounds.y + bounds.h)
+				continue;
+			if (!collider->isWalkableTile(n.x, n.y, movement_type))
+				continue;
+
+			float cost = entry.first + Utils::calcDist(FPoint(current), FPoint(n));
+			int n_index = (n.x - bounds.x) + (n.y - bounds.y) * bounds.w;
+			if (cost < local_dist[n_index]) {
+				local_dist[n_index] = cost;
+				queue.push(QueueEntry(cost, n_index));
+			}
+		}
+	}
+
+	result.resize(targets.size());
+	for (size_t i = 0; i < targets.size(); ++i) {
+		result[i] = local_dist[(targets[i].x - bounds.x) + (targets[i].y - bounds.y) * bounds.w];
+	}
+}
+
+/**
+ * Search the abstract graph from start to end
+ * On success, waypoints holds the entrances to pass through (in order), followed by end
+ */
+bool MapPathHierarchy::findPath(const Point& start, const Point& end, int movement_type, std::vector<Point>& waypoints) {
+	waypoints.clear();
+
+	if (!isEnabled() || movement_type == MapCollision::MOVE_INTANGIBLE)
+		return false;
+
+	const int layer = (movement_type == MapCollision::MOVE_FLYING) ? LAYER_FLYING : LAYER_NORMAL;
+	update(layer, movement_type);
+
+	const std::vector<MapPathCluster>& layer_clusters = clusters[layer];
+	const std::vector<int>& offsets = node_offsets[layer];
+
+	const int start_cluster = getClusterIndex(start);
+	const int end_cluster = getClusterIndex(end);
+
+	// connect the start and end points to the entrances of their clusters
+	std::vector<float> start_costs;
+	std::vector<float> end_costs;
+	calcCosts(getClusterRect(start_cluster % cluster_count.x, start_cluster / cluster_count.x), start, movement_type, layer_clusters[start_cluster].nodes, start_costs);
+	calcCosts(getClusterRect(end_cluster % cluster_count.x, end_cluster / cluster_count.x), end, movement_type, layer_clusters[end_cluster].nodes, end_costs);
+
+	const int id_start = node_total[layer];
+	const int id_end = node_total[layer] + 1;
+
+	search_g.assign(node_total[layer] + 2, COST_NONE);
+	search_parent.assign(node_total[layer] + 2, -1);
+	search_closed.assign(node_total[layer] + 2, false);
+
+	typedef std::pair<float, int> QueueEntry;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > open;
+
+	search_g[id_start] = 0;
+	open.push(QueueEntry(Utils::calcDist(FPoint(start), FPoint(end)), id_start));
+
+	while (!open.empty()) {
+		const int id = open.top().second;
+		open.pop();
+
+		if (search_closed[id])
+			continue;
+		search_closed[id] = true;
+
+		if (id == id_end)
+			break;
+
+		// collect the edges leaving this node
+		search_edges.clear();
+		if (id == id_start) {
+			for (size_t i = 0; i < start_costs.size(); ++i) {
+				if (start_costs[i] != COST_NONE)
+					search_edges.push_back(std::pair<int, float>(offsets[start_cluster] + static_cast<int>(i), start_costs[i]));
+			}
+		}
+		else {
+			const int cluster = node_clusters[layer][id];
+			const MapPathCluster& c = layer_clusters[cluster];
+			const size_t index = id - offsets[cluster];
+			const size_t node_count = c.nodes.size();
+
+			for (size_t j = 0; j < node_count; ++j) {
+				if (j != index && c.costs[index * node_count + j] != COST_NONE)
+					search_edges.push_back(std::pair<int, float>(offsets[cluster] + static_cast<int>(j), c.costs[index * node_count + j]));
+			}
+
+			for (size_t j = 0; j < c.links[index].size(); ++j) {
+				const Point& link = c.links[index][j];
+				const int link_cluster = getClusterIndex(link);
+				const int link_index = layer_clusters[link_cluster].find(link);
+				if (link_index != -1)
+					search_edges.push_back(std::pair<int, float>(offsets[link_cluster] + link_index, Utils::calcDist(FPoint(c.nodes[index]), FPoint(link))));
+			}
+
+			if (cluster == end_cluster && end_costs[index] != COST_NONE)
+				search_edges.push_back(std::pair<int, float>(id_end, end_costs[index]));
+		}
+
+		for (size_t i = 0; i < search_edges.size(); ++i) {
+			const int next = search_edges[i].first;
+			if (search_closed[next])
+				continue;
+
+			float g = search_g[id] + search_edges[i].second;
+			if (g < search_g[next]) {
+				search_g[next] = g;
+				search_parent[next] = id;
+
+				float h = 0;
+				if (next != id_end) {
+					const int next_cluster = node_clusters[layer][next];
+					h = Utils::calcDist(FPoint(layer_clusters[next_cluster].nodes[next - offsets[next_cluster]]), FPoint(end));
+				}
+				open.push(QueueEntry(g + h, next));
+			}
+		}
+	}
+
+	if (!search_closed[id_end])
+		return false;
+
+	// walk back from the end to build the list of waypoints
+	int id = id_end;
+	while (id != id_start && id != -1) {
+		if (id == id_end) {
+			waypoints.push_back(end);
+		}
+		else {
+			const int cluster = node_clusters[layer][id];
+			waypoints.push_back(layer_clusters[cluster].nodes[id - offsets[cluster]]);
+		}
+		id = search_parent[id];
+	}
+	std::reverse(waypoints.begin(), waypoints.end());
+
+	return !waypoints.empty();
+}
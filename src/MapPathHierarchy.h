@@ -0,0 +1,111 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapPathHierarchy
+ *
+ * Hierarchical pathfinding (HPA*) abstraction over the collision map.
+ *
+ * The map is split into square clusters. Wherever two neighboring clusters share walkable
+ * border tiles, an entrance is placed. The path costs between all entrances of a cluster are
+ * precomputed, so long searches only need to walk this small graph of entrances.
+ *
+ * Only static collision is considered. Entities blocking tiles are ignored here and are
+ * handled by the regular A* search that refines the first part of the abstract path.
+ */
+
+#ifndef MAP_PATH_HIERARCHY_H
+#define MAP_PATH_HIERARCHY_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+class MapCollision;
+
+class MapPathCluster {
+public:
+	// entrance tiles inside this cluster
+	std::vector<Point> nodes;
+
+	// for each entrance, the tiles in neighboring clusters that it connects to
+	std::vector< std::vector<Point> > links;
+
+	// [nodes.size() * nodes.size()] path costs between entrances, or COST_NONE if there is no path
+	std::vector<float> costs;
+
+	bool dirty;
+
+	MapPathCluster()
+		: dirty(true) {
+	}
+
+	int find(const Point& p) const;
+};
+
+class MapPathHierarchy {
+private:
+	// we keep a separate abstraction for each movement type that uses collision
+	enum {
+		LAYER_NORMAL = 0,
+		LAYER_FLYING = 1,
+		LAYER_COUNT = 2
+	};
+
+	// entrance runs longer than this get an entrance at both ends instead of only in the middle
+	static const int MAX_ENTRANCE_WIDTH = 6;
+
+	int getClusterIndex(const Point& p) const;
+	Rect getClusterRect(int cluster_x, int cluster_y) const;
+
+	void update(int layer, int movement_type);
+	void scanBorder(int cluster_a, int cluster_b, int movement_type, std::vector<Point>& tiles_a, std::vector<Point>& tiles_b) const;
+	void buildCluster(int layer, int cluster, int movement_type);
+	void calcCosts(const Rect& bounds, const Point& src, int movement_type, const std::vector<Point>& targets, std::vector<float>& result);
+
+	const MapCollision* collider;
+	Point map_size;
+	Point cluster_count;
+
+	std::vector<MapPathCluster> clusters[LAYER_COUNT];
+	std::vector<int> node_offsets[LAYER_COUNT]; // id of the first entrance of each cluster
+	std::vector<int> node_clusters[LAYER_COUNT]; // cluster of each entrance id
+	int node_total[LAYER_COUNT];
+	bool layer_dirty[LAYER_COUNT];
+
+	// scratch space for searches, kept around to avoid reallocation
+	std::vector<float> local_dist;
+	std::vector<float> search_g;
+	std::vector<int> search_parent;
+	std::vector<bool> search_closed;
+	std::vector< std::pair<int, float> > search_edges; // edges leaving the node that is being expanded
+
+public:
+	static const int CLUSTER_SIZE = 16;
+	static const float COST_NONE;
+
+	MapPathHierarchy();
+	~MapPathHierarchy();
+
+	void init(const MapCollision* _collider);
+	void clear();
+	void invalidate(int x, int y);
+	bool isEnabled() const;
+	bool isDistant(const Point& start, const Point& end) const;
+	bool findPath(const Point& start, const Point& end, int movement_type, std::vector<Point>& waypoints);
+};
+
+#endif
@@ -0,0 +1,306 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapPreloader
+ */
+
+#include <SDL_image.h>
+
+#ifdef __EMSCRIPTEN__
+#include <SDL/SDL_mixer.h>
+#else
+#include <SDL_mixer.h>
+#endif
+
+#include "FileParser.h"
+#include "MapPreloader.h"
+#include "ModManager.h"
+#include "RenderDevice.h"
+#include "Settings.h"
+#include "SharedResources.h"
+#include "SoundManager.h"
+#include "UtilsParsing.h"
+
+MapPreloader::MapPreloader()
+	: thread(NULL)
+	, mutex(SDL_CreateMutex())
+	, cond(SDL_CreateCond())
+	, quit(false)
+	, request_id(0)
+	, pending_audio(false)
+{
+	if (mutex && cond)
+		thread = SDL_CreateThread(threadFunc, "MapPreloader", this);
+
+	if (!thread)
+		Utils::logInfo("MapPreloader: Could not start worker thread, maps will not be preloaded. %s", SDL_GetError());
+}
+
+MapPreloader::~MapPreloader() {
+	if (thread) {
+		SDL_LockMutex(mutex);
+		quit = true;
+		SDL_CondSignal(cond);
+		SDL_UnlockMutex(mutex);
+
+		SDL_WaitThread(thread, NULL);
+		thread = NULL;
+	}
+
+	clear();
+
+	if (cond)
+		SDL_DestroyCond(cond);
+	if (mutex)
+		SDL_DestroyMutex(mutex);
+}
+
+int MapPreloader::threadFunc(void* data) {
+	static_cast<MapPreloader*>(data)->work();
+	return 0;
+}
+
+/**
+ * Worker thread: wait for a map request, then decode the files used by that map
+ */
+void MapPreloader::work() {
+	std::vector<std::string> image_files;
+	std::vector<std::string> sound_files;
+
+	SDL_LockMutex(mutex);
+
+	while (true) {
+		while (!quit && pending_map.empty()) {
+			SDL_CondWait(cond, mutex);
+		}
+
+		if (quit)
+			break;
+
+		const std::string map_filename = pending_map;
+		const bool audio = pending_audio;
+		const unsigned id = request_id;
+		pending_map.clear();
+
+		SDL_UnlockMutex(mutex);
+
+		collectFiles(map_filename, audio, image_files, sound_files);
+
+		for (size_t i = 0; i < image_files.size() + sound_files.size(); ++i) {
+			if (isCancelled(id))
+				break;
+
+			Asset asset;
+			if (i < image_files.size()) {
+				asset.filename = image_files[i];
+				asset.surface = IMG_Load(mods->locate(asset.filename).c_str());
+				if (!asset.surface)
+					continue;
+			}
+			else {
+				asset.filename = sound_files[i - image_files.size()];
+				asset.chunk = Mix_LoadWAV(mods->locate(asset.filename).c_str());
+				if (!asset.chunk)
+					continue;
+			}
+
+			SDL_LockMutex(mutex);
+			if (!quit && id == request_id)
+				ready.push_back(asset);
+			else
+				freeAsset(asset);
+			SDL_UnlockMutex(mutex);
+		}
+
+		SDL_LockMutex(mutex);
+	}
+
+	SDL_UnlockMutex(mutex);
+}
+
+/**
+ * Find the images and sounds used by a map's tileset, parallax layers and sound events.
+ * Failures are not reported here, because Map::load() will report them.
+ */
+void MapPreloader::collectFiles(const std::string& map_filename, bool audio, std::vector<std::string>& image_files, std::vector<std::string>& sound_files) {
+	image_files.clear();
+	sound_files.clear();
+
+	std::string tileset_filename;
+	std::string parallax_filename;
+
+	FileParser infile;
+	if (infile.open(map_filename, FileParser::MOD_FILE, FileParser::ERROR_NONE)) {
+		while (infile.next()) {
+			if (infile.section == "header") {
+				if (infile.key == "tileset")
+					tileset_filename = infile.val;
+				else if (infile.key == "parallax_layers")
+					parallax_filename = infile.val;
+			}
+			else if (infile.section == "layer" && infile.key == "data") {
+				// skip the rows of layer data without parsing them
+				while (!infile.getRawLine().empty()) {
+					infile.incrementLineNum();
+				}
+			}
+			else if (infile.section == "event" && infile.key == "soundfx" && audio) {
+				std::string val = infile.val;
+				std::string filename = Parse::popFirstString(val);
+				if (!filename.empty() && std::find(sound_files.begin(), sound_files.end(), filename) == sound_files.end())
+					sound_files.push_back(filename);
+			}
+		}
+		infile.close();
+	}
+
+	if (!tileset_filename.empty() && infile.open(tileset_filename, FileParser::MOD_FILE, FileParser::ERROR_NONE)) {
+		while (infile.next()) {
+			if (infile.key == "img" && std::find(image_files.begin(), image_files.end(), infile.val) == image_files.end())
+				image_files.push_back(infile.val);
+		}
+		infile.close();
+	}
+
+	if (!parallax_filename.empty() && infile.open(parallax_filename, FileParser::MOD_FILE, FileParser::ERROR_NONE)) {
+		while (infile.next()) {
+			if (infile.key == "image" && std::find(image_files.begin(), image_files.end(), infile.val) == image_files.end())
+				image_files.push_back(infile.val);
+		}
+		infile.close();
+	}
+}
+
+bool MapPreloader::isCancelled(unsigned id) {
+	SDL_LockMutex(mutex);
+	const bool cancelled = quit || id != request_id;
+	SDL_UnlockMutex(mutex);
+	return cancelled;
+}
+
+/**
+ * Turn up to max_count decoded files into images and sounds
+ */
+void MapPreloader::upload(size_t max_count) {
+	SDL_LockMutex(mutex);
+	uploads.insert(uploads.end(), ready.begin(), ready.end());
+	ready.clear();
+	SDL_UnlockMutex(mutex);
+
+	const size_t count = std::min(max_count, uploads.size());
+	for (size_t i = 0; i < count; ++i) {
+		Asset& asset = uploads[i];
+
+		if (asset.surface) {
+			Image* image = render_device->loadImageFromSurface(asset.filename, asset.surface);
+			if (image)
+				images.push_back(image);
+		}
+		else if (asset.chunk) {
+			SoundID sid = snd->loadFromChunk(asset.filename, asset.chunk);
+			if (sid)
+				sounds.push_back(sid);
+		}
+	}
+
+	uploads.erase(uploads.begin(), uploads.begin() + count);
+}
+
+void MapPreloader::freeAsset(Asset& asset) {
+	if (asset.surface) {
+		SDL_FreeSurface(asset.surface);
+		asset.surface = NULL;
+	}
+	if (asset.chunk) {
+		Mix_FreeChunk(asset.chunk);
+		asset.chunk = NULL;
+	}
+}
+
+void MapPreloader::freeAssets(std::vector<Asset>& assets) {
+	for (size_t i = 0; i < assets.size(); ++i) {
+		freeAsset(assets[i]);
+	}
+	assets.clear();
+}
+
+/**
+ * Start preloading a map (e.g. "maps/spawn.txt"). Anything preloaded for another map is released.
+ */
+void MapPreloader::request(const std::string& map_filename) {
+	if (!thread || map_filename.empty() || map_filename == requested_map)
+		return;
+
+	clear();
+	requested_map = map_filename;
+
+	SDL_LockMutex(mutex);
+	pending_map = map_filename;
+	// the worker thread must not read settings, which the main thread may change
+	pending_audio = settings->audio;
+	SDL_CondSignal(cond);
+	SDL_UnlockMutex(mutex);
+}
+
+/**
+ * Called once per frame on the main thread
+ */
+void MapPreloader::logic() {
+	if (thread)
+		upload(MAX_UPLOADS_PER_FRAME);
+}
+
+/**
+ * Hand over everything that has been decoded so far. Used right before the map is loaded.
+ */
+void MapPreloader::flush() {
+	if (thread)
+		upload(static_cast<size_t>(-1));
+}
+
+/**
+ * Cancel the current request and release all preloaded images and sounds.
+ * Images and sounds that were used by a map since then stay loaded.
+ */
+void MapPreloader::clear() {
+	if (mutex) {
+		SDL_LockMutex(mutex);
+		request_id++;
+		pending_map.clear();
+		freeAssets(ready);
+		SDL_UnlockMutex(mutex);
+	}
+
+	freeAssets(uploads);
+
+	for (size_t i = 0; i < images.size(); ++i) {
+		images[i]->unref();
+	}
+	images.clear();
+
+	for (size_t i = 0; i < sounds.size(); ++i) {
+		snd->unload(sounds[i]);
+	}
+	sounds.clear();
+
+	requested_map.clear();
+}
+
+const std::string& MapPreloader::getRequestedMap() const {
+	return requested_map;
+}
@@ -0,0 +1,91 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapPreloader
+ *
+ * Loads the images and sounds of a map that the player is likely to teleport to next.
+ *
+ * A worker thread reads the map, its tileset and its parallax layers to find the files
+ * they use, and decodes those files. Creating textures and registering sounds has to
+ * happen on the main thread, so logic() hands over a few finished files per frame.
+ * The preloader keeps a reference to everything it has handed over, so that loading the
+ * map only has to look them up. Call clear() after the map has been loaded.
+ */
+
+#ifndef MAP_PRELOADER_H
+#define MAP_PRELOADER_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+struct Mix_Chunk;
+
+class MapPreloader {
+private:
+	class Asset {
+	public:
+		std::string filename;
+		SDL_Surface* surface;
+		Mix_Chunk* chunk;
+
+		Asset()
+			: surface(NULL)
+			, chunk(NULL) {
+		}
+	};
+
+	static int threadFunc(void* data);
+	void work();
+	void collectFiles(const std::string& map_filename, bool audio, std::vector<std::string>& images, std::vector<std::string>& sounds);
+	bool isCancelled(unsigned id);
+	void upload(size_t max_count);
+	void freeAsset(Asset& asset);
+	void freeAssets(std::vector<Asset>& assets);
+
+	SDL_Thread* thread;
+	SDL_mutex* mutex;
+	SDL_cond* cond;
+
+	// shared with the worker thread, protected by mutex
+	bool quit;
+	unsigned request_id;
+	std::string pending_map;
+	bool pending_audio; // settings->audio when the map was requested
+	std::vector<Asset> ready;
+
+	// main thread only
+	std::string requested_map;
+	std::vector<Asset> uploads;
+	std::vector<Image*> images;
+	std::vector<SoundID> sounds;
+
+public:
+	// textures and sounds handed over to the main thread per frame
+	static const size_t MAX_UPLOADS_PER_FRAME = 2;
+
+	MapPreloader();
+	~MapPreloader();
+
+	void request(const std::string& map_filename);
+	void logic();
+	void flush();
+	void clear();
+	const std::string& getRequestedMap() const;
+};
+
+#endif
@@ -36,6 +36,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "MenuDevConsole.h"
 #include "MenuManager.h"
 #include "PowerManager.h"
+#include "Profiler.h"
 #include "RenderDevice.h"
 #include "Settings.h"
 #include "SharedGameResources.h"
@@ -57,9 +58,14 @@ MapRenderer::MapRenderer()
 	, tip_pos()
 	, show_tooltip(false)
 	, shakycam()
+	, render_cam()
 	, entity_hidden_normal(NULL)
 	, entity_hidden_enemy(NULL)
+	, event_index_dirty(true)
+	, screen_index_dirty(true)
+	, screen_index_view(0, 0)
 	, cam()
+	, prev_cam()
 	, map_change(false)
 	, teleportation(false)
 	, teleport_destination()
@@ -75,6 +81,8 @@ MapRenderer::MapRenderer()
 	, show_book("")
 	, index_objectlayer(0)
 {
+	profile_logic_id = profiler->addSection("mapr");
+	profile_render_id = profiler->addSection("mapr_render");
 	// Load entity markers
 	Image *gfx = render_device->loadImage("images/menus/entity_hidden.png", RenderDevice::ERROR_NORMAL);
 	if (gfx) {
@@ -207,13 +215,11 @@ int MapRenderer::load(const std::string& fname) {
 
 	for (unsigned i = 0; i < layers.size(); ++i) {
 		if (layernames[i] == "collision") {
-			short width = static_cast<short>(layers[i].size());
-			if (width == 0) {
+			if (layers[i].empty()) {
 				Utils::logError("MapRenderer: Map width is 0. Can't set collision layer.");
 				break;
 			}
-			short height = static_cast<short>(layers[i][0].size());
-			collider.setMap(layers[i], width, height);
+			collider.setMap(layers[i], hierarchical_pathfinding);
 			removeLayer(i);
 		}
 	}
@@ -230,14 +236,15 @@ int MapRenderer::load(const std::string& fname) {
 
 	std::vector<unsigned> corrupted;
 	for (unsigned i = 0; i < layers.size(); ++i) {
-		for (unsigned x = 0; x < layers[i].size(); ++x) {
-			for (unsigned y = 0; y < layers[i][x].size(); ++y) {
-				const unsigned tile_id = layers[i][x][y];
+		for (unsigned short y = 0; y < layers[i].getHeight(); ++y) {
+			unsigned short* row = layers[i].getRow(y);
+			for (unsigned short x = 0; x < layers[i].getWidth(); ++x) {
+				const unsigned tile_id = row[x];
 				if (tile_id > 0 && (tile_id >= tset.tiles.size() || tset.tiles[tile_id].tile == NULL)) {
 					if (std::find(corrupted.begin(), corrupted.end(), tile_id) == corrupted.end()) {
 						corrupted.push_back(tile_id);
 					}
-					layers[i][x][y] = 0;
+					row[x] = 0;
 				}
 			}
 		}
@@ -251,6 +258,11 @@ int MapRenderer::load(const std::string& fname) {
 		}
 	}
 
+	chunk_cache.init(layers.size(), Point(w, h));
+
+	event_index.clear();
+	event_index_dirty = true;
+
 	map_parallax.load(parallax_filename);
 	map_parallax.setMapCenter(w/2, h/2);
 
@@ -272,6 +284,7 @@ void MapRenderer::loadMusic() {
 }
 
 void MapRenderer::logic(bool paused) {
+	ProfilerScope profile(profile_logic_id);
 
 	// handle tile set logic e.g. animations
 	tset.logic();
@@ -349,8 +362,22 @@ void calculatePriosOrtho(std::vector<Renderable> &r) {
 }
 
 void MapRenderer::render(std::vector<Renderable> &r, std::vector<Renderable> &r_dead) {
+	ProfilerScope profile(profile_render_id);
+
+	// only the camera movement is smoothed; the shaking stays as jerky as it is meant to be
+	render_cam = getInterpolatedCam();
+	render_cam.x += shakycam.x - cam.x;
+	render_cam.y += shakycam.y - cam.y;
+
+	// tiles are drawn as sprites, so let the render device merge them into fewer draw calls
+	render_device->beginBatch();
 
-	map_parallax.render(shakycam, "");
+	if (settings->map_chunk_cache)
+		chunk_cache.startFrame();
+	else if (chunk_cache.getMemoryUsed() > 0)
+		chunk_cache.init(layers.size(), Point(w, h));
+
+	map_parallax.render(render_cam, "");
 
 	if (eset->tileset.orientation == eset->tileset.TILESET_ORTHOGONAL) {
 		calculatePriosOrtho(r);
@@ -367,13 +394,15 @@ void MapRenderer::render(std::vector<Renderable> &r, std::vector<Renderable> &r_
 		renderIso(r, r_dead);
 	}
 
+	render_device->endBatch();
+
 	drawHiddenEntityMarkers();
 }
 
 void MapRenderer::drawRenderable(std::vector<Renderable>::iterator r_cursor) {
 	if (r_cursor->image != NULL) {
 		Rect dest;
-		Point p = Utils::mapToScreen(r_cursor->map_pos.x, r_cursor->map_pos.y, shakycam.x, shakycam.y);
+		Point p = Utils::mapToScreen(r_cursor->map_pos.x, r_cursor->map_pos.y, render_cam.x, render_cam.y);
 		dest.x = p.x - r_cursor->offset.x;
 		dest.y = p.y - r_cursor->offset.y;
 		render_device->render(*r_cursor, dest);
@@ -384,7 +413,7 @@ void MapRenderer::renderIsoLayer(const Map_Layer& layerdata) {
 	int_fast16_t i; // first index of the map array
 	int_fast16_t j; // second index of the map array
 	Point dest;
-	const Point upperleft(Utils::screenToMap(0, 0, shakycam.x, shakycam.y));
+	const Point upperleft(Utils::screenToMap(0, 0, render_cam.x, render_cam.y));
 	const int_fast16_t max_tiles_width =   static_cast<int_fast16_t>((settings->view_w / eset->tileset.tile_w) + 2*tset.max_size_x);
 	const int_fast16_t max_tiles_height = static_cast<int_fast16_t>((2 * settings->view_h / eset->tileset.tile_h) + 2*(tset.max_size_y+1));
 
@@ -413,7 +442,7 @@ void MapRenderer::renderIsoLayer(const Map_Layer& layerdata) {
 		// lower left (south west) corner is caught by having 0 in there, so j>0
 		const int_fast16_t j_end = std::max(static_cast<int_fast16_t>(j+i-w+1),	std::max(static_cast<int_fast16_t>(j - max_tiles_width), static_cast<int_fast16_t>(0)));
 
-		Point p = Utils::mapToScreen(float(i), float(j), shakycam.x, shakycam.y);
+		Point p = Utils::mapToScreen(float(i), float(j), render_cam.x, render_cam.y);
 		p = centerTile(p);
 
 		// draw one horizontal line
@@ -423,7 +452,7 @@ void MapRenderer::renderIsoLayer(const Map_Layer& layerdata) {
 			++tiles_width;
 			p.x += eset->tileset.tile_w;
 
-			if (const uint_fast16_t current_tile = layerdata[i][j]) {
+			if (const uint_fast16_t current_tile = layerdata.get(i, j)) {
 				const Tile_Def &tile = tset.tiles[current_tile];
 				dest.x = p.x - tile.offset.x;
 				dest.y = p.y - tile.offset.y;
@@ -443,6 +472,19 @@ void MapRenderer::renderIsoLayer(const Map_Layer& layerdata) {
 	}
 }
 
+/**
+ * Renders a layer that doesn't interleave with objects
+ */
+void MapRenderer::renderTileLayer(size_t index) {
+	if (settings->map_chunk_cache && chunk_cache.render(index, layers[index], tset, render_cam))
+		return;
+
+	if (eset->tileset.orientation == eset->tileset.TILESET_ORTHOGONAL)
+		renderOrthoLayer(layers[index]);
+	else
+		renderIsoLayer(layers[index]);
+}
+
 void MapRenderer::renderIsoBackObjects(std::vector<Renderable> &r) {
 	std::vector<Renderable>::iterator it;
 	for (it = r.begin(); it != r.end(); ++it)
@@ -452,7 +494,7 @@ void MapRenderer::renderIsoBackObjects(std::vector<Renderable> &r) {
 void MapRenderer::renderIsoFrontObjects(std::vector<Renderable> &r) {
 	Point dest;
 
-	const Point upperleft(Utils::screenToMap(0, 0, shakycam.x, shakycam.y));
+	const Point upperleft(Utils::screenToMap(0, 0, render_cam.x, render_cam.y));
 	const int_fast16_t max_tiles_width = static_cast<int_fast16_t>((settings->view_w / eset->tileset.tile_w) + 2 * tset.max_size_x);
 	const int_fast16_t max_tiles_height = static_cast<int_fast16_t>(((settings->view_h / eset->tileset.tile_h) + 2 * tset.max_size_y)*2);
 
@@ -473,7 +515,7 @@ void MapRenderer::renderIsoFrontObjects(std::vector<Renderable> &r) {
 	std::queue<std::vector<Renderable>::iterator> render_behind_NE;
 	std::queue<std::vector<Renderable>::iterator> render_behind_none;
 
-	Map_Layer drawn_tiles(w, std::vector<unsigned short>(h, 0));
+	MapGrid<unsigned char> drawn_tiles(w, h, 0);
 
 	for (uint_fast16_t y = max_tiles_height ; y; --y) {
 		int_fast16_t tiles_width = 0;
@@ -493,7 +535,7 @@ void MapRenderer::renderIsoFrontObjects(std::vector<Renderable> &r) {
 		const int_fast16_t j_end = std::max(static_cast<int_fast16_t>(j+i-w+1), std::max(static_cast<int_fast16_t>(j - max_tiles_width), static_cast<int_fast16_t>(0)));
 
 		// draw one horizontal line
-		Point p = Utils::mapToScreen(float(i), float(j), shakycam.x, shakycam.y);
+		Point p = Utils::mapToScreen(float(i), float(j), render_cam.x, render_cam.y);
 		p = centerTile(p);
 		const Map_Layer &current_layer = layers[index_objectlayer];
 		bool is_last_NE_tile = false;
@@ -520,15 +562,15 @@ void MapRenderer::renderIsoFrontObjects(std::vector<Renderable> &r) {
 				++r_pre_cursor;
 			}
 
-			if (draw_tile && !drawn_tiles[i][j]) {
-				if (const uint_fast16_t current_tile = current_layer[i][j]) {
+			if (draw_tile && !drawn_tiles.get(i, j)) {
+				if (const uint_fast16_t current_tile = current_layer.get(i, j)) {
 					const Tile_Def &tile = tset.tiles[current_tile];
 					dest.x = p.x - tile.offset.x;
 					dest.y = p.y - tile.offset.y;
 					tile.tile->setDestFromPoint(dest);
 					checkHiddenEntities(i, j, current_layer, r);
 					render_device->render(tile.tile);
-					drawn_tiles[i][j] = 1;
+					drawn_tiles.set(i, j, 1);
 				}
 			}
 
@@ -563,7 +605,7 @@ do_last_NE_tile:
 					draw_NE_tile = !is_last_NE_tile;
 
 					// r_cursor left/right side
-					Point r_cursor_left = Utils::mapToScreen(r_cursor->map_pos.x, r_cursor->map_pos.y, shakycam.x, shakycam.y);
+					Point r_cursor_left = Utils::mapToScreen(r_cursor->map_pos.x, r_cursor->map_pos.y, render_cam.x, render_cam.y);
 					r_cursor_left.y -= r_cursor->offset.y;
 					Point r_cursor_right = r_cursor_left;
 					r_cursor_left.x -= r_cursor->offset.x;
@@ -602,15 +644,15 @@ do_last_NE_tile:
 			}
 
 			// draw the south-west tile
-			if (draw_SW_tile && i-2 >= 0 && j+2 < h && !drawn_tiles[i-2][j+2]) {
-				if (const uint_fast16_t current_tile = current_layer[i-2][j+2]) {
+			if (draw_SW_tile && i-2 >= 0 && j+2 < h && !drawn_tiles.get(i-2, j+2)) {
+				if (const uint_fast16_t current_tile = current_layer.get(i-2, j+2)) {
 					const Tile_Def &tile = tset.tiles[current_tile];
 					dest.x = tile_SW_center.x - tile.offset.x;
 					dest.y = tile_SW_center.y - tile.offset.y;
 					tile.tile->setDestFromPoint(dest);
 					checkHiddenEntities(i, j, current_layer, r);
 					render_device->render(tile.tile);
-					drawn_tiles[i-2][j+2] = 1;
+					drawn_tiles.set(i-2, j+2, 1);
 				}
 			}
 
@@ -620,15 +662,15 @@ do_last_NE_tile:
 			}
 
 			// draw the north-east tile
-			if (draw_NE_tile && !draw_tile && !drawn_tiles[i][j]) {
-				if (const uint_fast16_t current_tile = current_layer[i][j]) {
+			if (draw_NE_tile && !draw_tile && !drawn_tiles.get(i, j)) {
+				if (const uint_fast16_t current_tile = current_layer.get(i, j)) {
 					const Tile_Def &tile = tset.tiles[current_tile];
 					dest.x = tile_NE_center.x - tile.offset.x;
 					dest.y = tile_NE_center.y - tile.offset.y;
 					tile.tile->setDestFromPoint(dest);
 					checkHiddenEntities(i, j, current_layer, r);
 					render_device->render(tile.tile);
-					drawn_tiles[i][j] = 1;
+					drawn_tiles.set(i, j, 1);
 				}
 			}
 
@@ -667,19 +709,19 @@ do_last_NE_tile:
 void MapRenderer::renderIso(std::vector<Renderable> &r, std::vector<Renderable> &r_dead) {
 	size_t index = 0;
 	while (index < index_objectlayer) {
-		renderIsoLayer(layers[index]);
-		map_parallax.render(shakycam, layernames[index]);
+		renderTileLayer(index);
+		map_parallax.render(render_cam, layernames[index]);
 		index++;
 	}
 
 	renderIsoBackObjects(r_dead);
 	renderIsoFrontObjects(r);
-	map_parallax.render(shakycam, layernames[index]);
+	map_parallax.render(render_cam, layernames[index]);
 
 	index++;
 	while (index < layers.size()) {
-		renderIsoLayer(layers[index]);
-		map_parallax.render(shakycam, layernames[index]);
+		renderTileLayer(index);
+		map_parallax.render(render_cam, layernames[index]);
 		index++;
 	}
 
@@ -692,7 +734,7 @@ void MapRenderer::renderIso(std::vector<Renderable> &r, std::vector<Renderable>
 void MapRenderer::renderOrthoLayer(const Map_Layer& layerdata) {
 
 	Point dest;
-	const Point upperleft(Utils::screenToMap(0, 0, shakycam.x, shakycam.y));
+	const Point upperleft(Utils::screenToMap(0, 0, render_cam.x, render_cam.y));
 
 	short int startj = static_cast<short int>(std::max(0, upperleft.y));
 	short int starti = static_cast<short int>(std::max(0, upperleft.x));
@@ -703,11 +745,12 @@ void MapRenderer::renderOrthoLayer(const Map_Layer& layerdata) {
 	short int j;
 
 	for (j = startj; j < max_tiles_height; j++) {
-		Point p = Utils::mapToScreen(starti, j, shakycam.x, shakycam.y);
+		Point p = Utils::mapToScreen(starti, j, render_cam.x, render_cam.y);
 		p = centerTile(p);
+		const unsigned short* row = layerdata.getRow(j);
 		for (i = starti; i < max_tiles_width; i++) {
 
-			if (const unsigned short current_tile = layerdata[i][j]) {
+			if (const unsigned short current_tile = row[i]) {
 				const Tile_Def &tile = tset.tiles[current_tile];
 				dest.x = p.x - tile.offset.x;
 				dest.y = p.y - tile.offset.y;
@@ -734,7 +777,7 @@ void MapRenderer::renderOrthoFrontObjects(std::vector<Renderable> &r) {
 	std::vector<Renderable>::iterator r_cursor = r.begin();
 	std::vector<Renderable>::iterator r_end = r.end();
 
-	const Point upperleft(Utils::screenToMap(0, 0, shakycam.x, shakycam.y));
+	const Point upperleft(Utils::screenToMap(0, 0, render_cam.x, render_cam.y));
 
 	short int startj = static_cast<short int>(std::max(0, upperleft.y));
 	short int starti = static_cast<short int>(std::max(0, upperleft.x));
@@ -748,11 +791,11 @@ void MapRenderer::renderOrthoFrontObjects(std::vector<Renderable> &r) {
 		return;
 
 	for (j = startj; j < max_tiles_height; j++) {
-		Point p = Utils::mapToScreen(starti, j, shakycam.x, shakycam.y);
+		Point p = Utils::mapToScreen(starti, j, render_cam.x, render_cam.y);
 		p = centerTile(p);
 		for (i = starti; i<max_tiles_width; i++) {
 
-			if (const unsigned short current_tile = layers[index_objectlayer][i][j]) {
+			if (const unsigned short current_tile = layers[index_objectlayer].get(i, j)) {
 				const Tile_Def &tile = tset.tiles[current_tile];
 				dest.x = p.x - tile.offset.x;
 				dest.y = p.y - tile.offset.y;
@@ -777,19 +820,19 @@ void MapRenderer::renderOrthoFrontObjects(std::vector<Renderable> &r) {
 void MapRenderer::renderOrtho(std::vector<Renderable> &r, std::vector<Renderable> &r_dead) {
 	unsigned index = 0;
 	while (index < index_objectlayer) {
-		renderOrthoLayer(layers[index]);
-		map_parallax.render(shakycam, layernames[index]);
+		renderTileLayer(index);
+		map_parallax.render(render_cam, layernames[index]);
 		index++;
 	}
 
 	renderOrthoBackObjects(r_dead);
 	renderOrthoFrontObjects(r);
-	map_parallax.render(shakycam, layernames[index]);
+	map_parallax.render(render_cam, layernames[index]);
 
 	index++;
 	while (index < layers.size()) {
-		renderOrthoLayer(layers[index]);
-		map_parallax.render(shakycam, layernames[index]);
+		renderTileLayer(index);
+		map_parallax.render(render_cam, layernames[index]);
 		index++;
 	}
 
@@ -825,8 +868,10 @@ void MapRenderer::executeOnLoadEvents() {
 		if (!EventManager::isActive(*it)) continue;
 
 		if ((*it).activate_type == Event::ACTIVATE_ON_LOAD) {
-			if (EventManager::executeEvent(*it))
+			if (EventManager::executeEvent(*it)) {
 				it = events.erase(it);
+				event_index_dirty = true;
+			}
 		}
 	}
 }
@@ -852,52 +897,56 @@ void MapRenderer::checkEvents(const FPoint& loc) {
 	Point maploc;
 	maploc.x = int(loc.x);
 	maploc.y = int(loc.y);
-	std::vector<Event>::iterator it;
+
+	// only events that can run at this location are checked
+	updateEventIndex();
+	event_index.getTriggerEvents(maploc, event_candidates);
 
 	// loop in reverse because we may erase elements
-	for (it = events.end(); it != events.begin(); ) {
-		--it;
+	for (size_t i = event_candidates.size(); i > 0; --i) {
+		const size_t index = event_candidates[i-1];
+		Event& ev = events[index];
 
 		// skip inactive events
-		if (!EventManager::isActive(*it)) continue;
+		if (!EventManager::isActive(ev)) continue;
 
 		// static events are run every frame without interaction from the player
-		if ((*it).activate_type == Event::ACTIVATE_STATIC) {
-			if (EventManager::executeEvent(*it))
-				it = events.erase(it);
+		if (ev.activate_type == Event::ACTIVATE_STATIC) {
+			if (EventManager::executeEvent(ev))
+				removeEvent(index);
 			continue;
 		}
 
-		if ((*it).activate_type == Event::ACTIVATE_ON_CLEAR) {
-			if (enemies_cleared && EventManager::executeEvent(*it))
-				it = events.erase(it);
+		if (ev.activate_type == Event::ACTIVATE_ON_CLEAR) {
+			if (enemies_cleared && EventManager::executeEvent(ev))
+				removeEvent(index);
 			continue;
 		}
 
-		bool inside = maploc.x >= (*it).location.x &&
-					  maploc.y >= (*it).location.y &&
-					  maploc.x <= (*it).location.x + (*it).location.w-1 &&
-					  maploc.y <= (*it).location.y + (*it).location.h-1;
+		bool inside = maploc.x >= ev.location.x &&
+					  maploc.y >= ev.location.y &&
+					  maploc.x <= ev.location.x + ev.location.w-1 &&
+					  maploc.y <= ev.location.y + ev.location.h-1;
 
-		if ((*it).activate_type == Event::ACTIVATE_ON_LEAVE) {
+		if (ev.activate_type == Event::ACTIVATE_ON_LEAVE) {
 			if (inside) {
-				if (!(*it).getComponent(EventComponent::WAS_INSIDE_EVENT_AREA)) {
-					(*it).components.push_back(EventComponent());
-					(*it).components.back().type = EventComponent::WAS_INSIDE_EVENT_AREA;
+				if (!ev.getComponent(EventComponent::WAS_INSIDE_EVENT_AREA)) {
+					ev.components.push_back(EventComponent());
+					ev.components.back().type = EventComponent::WAS_INSIDE_EVENT_AREA;
 				}
 			}
 			else {
-				if ((*it).getComponent(EventComponent::WAS_INSIDE_EVENT_AREA)) {
-					(*it).deleteAllComponents(EventComponent::WAS_INSIDE_EVENT_AREA);
-					if (EventManager::executeEvent(*it))
-						it = events.erase(it);
+				if (ev.getComponent(EventComponent::WAS_INSIDE_EVENT_AREA)) {
+					ev.deleteAllComponents(EventComponent::WAS_INSIDE_EVENT_AREA);
+					if (EventManager::executeEvent(ev))
+						removeEvent(index);
 				}
 			}
 		}
-		else if ((*it).activate_type == -1 || (*it).activate_type == Event::ACTIVATE_ON_TRIGGER) {
+		else if (ev.activate_type == -1 || ev.activate_type == Event::ACTIVATE_ON_TRIGGER) {
 			if (inside)
-				if (EventManager::executeEvent(*it))
-					it = events.erase(it);
+				if (EventManager::executeEvent(ev))
+					removeEvent(index);
 		}
 	}
 }
@@ -916,135 +965,244 @@ void MapRenderer::checkHotspots() {
 
 	show_tooltip = false;
 
-	std::vector<Event>::iterator it;
+	// only the hotspots that may cover the mouse position are checked
+	updateScreenIndex();
+	event_index.getScreenHotspots(inpt->mouse, event_candidates);
 
 	// work backwards through events because events can be erased in the loop.
-	// this prevents the iterator from becoming invalid.
-	for (it = events.end(); it != events.begin(); ) {
-		--it;
+	for (size_t i = event_candidates.size(); i > 0; --i) {
+		const size_t index = event_candidates[i-1];
+		Event& ev = events[index];
 
-		for (int x=it->hotspot.x; x < it->hotspot.x + it->hotspot.w; ++x) {
-			for (int y=it->hotspot.y; y < it->hotspot.y + it->hotspot.h; ++y) {
-				bool matched = false;
-				bool is_npc = false;
+		Point hotspot_tip_pos;
+		if (!isHotspotUnderMouse(ev, hotspot_tip_pos)) continue;
 
-				EventComponent* npc = (*it).getComponent(EventComponent::NPC_HOTSPOT);
-				if (npc) {
-					is_npc = true;
+		// skip inactive events
+		if (!EventManager::isActive(ev)) continue;
+
+		// skip events without hotspots
+		if (ev.hotspot.h == 0) continue;
+
+		// skip events on cooldown
+		if (!ev.cooldown.isEnd() || !ev.delay.isEnd()) continue;
+
+		tip_pos = hotspot_tip_pos;
 
-					Point p = Utils::mapToScreen(float(npc->x), float(npc->y), shakycam.x, shakycam.y);
-					p = centerTile(p);
+		// new tooltip?
+		createTooltip(ev.getComponent(EventComponent::TOOLTIP));
 
+		if (((ev.reachable_from.w == 0 && ev.reachable_from.h == 0) || Utils::isWithinRect(ev.reachable_from, Point(cam)))
+				&& Utils::calcDist(cam, ev.center) < eset->misc.interact_range) {
+
+			// only check events if the player is clicking
+			// and allowed to click
+			if (ev.getComponent(EventComponent::NPC_HOTSPOT)) {
+				curs->setCursor(CursorManager::CURSOR_TALK);
+			}
+			else {
+				curs->setCursor(CursorManager::CURSOR_INTERACT);
+			}
+			if (!inpt->pressing[Input::MAIN1]) return;
+			else if (inpt->lock[Input::MAIN1]) return;
+			else if (pc->using_main1) return;
+
+			inpt->lock[Input::MAIN1] = true;
+			if (EventManager::executeEvent(ev))
+				removeEvent(index);
+		}
+		return;
+	}
+}
+
+/**
+ * Check if the mouse is over the hotspot of an event: either the area of its NPC, or a tile
+ * on one of its hotspot tiles, up to the object layer. Also gets the position of the event's tooltip.
+ */
+bool MapRenderer::isHotspotUnderMouse(Event& ev, Point& hotspot_tip_pos) {
+	if (ev.hotspot.w <= 0 || ev.hotspot.h <= 0)
+		return false;
+
+	EventComponent* npc = ev.getComponent(EventComponent::NPC_HOTSPOT);
+	if (npc) {
+		Point p = Utils::mapToScreen(float(npc->x), float(npc->y), shakycam.x, shakycam.y);
+		p = centerTile(p);
+
+		Rect dest;
+		dest.x = p.x - npc->z;
+		dest.y = p.y - npc->a;
+		dest.w = npc->b;
+		dest.h = npc->c;
+
+		if (Utils::isWithinRect(dest, inpt->mouse)) {
+			hotspot_tip_pos.x = dest.x + dest.w/2;
+			hotspot_tip_pos.y = p.y - eset->tooltips.margin_npc;
+			return true;
+		}
+		return false;
+	}
+
+	for (int x=ev.hotspot.x; x < ev.hotspot.x + ev.hotspot.w; ++x) {
+		for (int y=ev.hotspot.y; y < ev.hotspot.y + ev.hotspot.h; ++y) {
+			Point p = Utils::mapToScreen(float(x), float(y), shakycam.x, shakycam.y);
+			p = centerTile(p);
+
+			for (unsigned index = 0; index <= index_objectlayer; ++index) {
+				if (const short current_tile = layers[index].get(x, y)) {
+					// first check if mouse pointer is in rectangle of that tile:
+					const Tile_Def &tile = tset.tiles[current_tile];
 					Rect dest;
-					dest.x = p.x - npc->z;
-					dest.y = p.y - npc->a;
-					dest.w = npc->b;
-					dest.h = npc->c;
+					dest.x = p.x - tile.offset.x;
+					dest.y = p.y - tile.offset.y;
+					dest.w = tile.tile->getClip().w;
+					dest.h = tile.tile->getClip().h;
 
 					if (Utils::isWithinRect(dest, inpt->mouse)) {
-						matched = true;
-						tip_pos.x = dest.x + dest.w/2;
-						tip_pos.y = p.y - eset->tooltips.margin_npc;
-					}
-				}
-				else {
-					for (unsigned index = 0; index <= index_objectlayer; ++index) {
-						Point p = Utils::mapToScreen(float(x), float(y), shakycam.x, shakycam.y);
-						p = centerTile(p);
-
-						if (const short current_tile = layers[index][x][y]) {
-							// first check if mouse pointer is in rectangle of that tile:
-							const Tile_Def &tile = tset.tiles[current_tile];
-							Rect dest;
-							dest.x = p.x - tile.offset.x;
-							dest.y = p.y - tile.offset.y;
-							dest.w = tile.tile->getClip().w;
-							dest.h = tile.tile->getClip().h;
-
-							if (Utils::isWithinRect(dest, inpt->mouse)) {
-								matched = true;
-								tip_pos = Utils::mapToScreen(it->center.x, it->center.y, shakycam.x, shakycam.y);
-								tip_pos.y -= eset->tileset.tile_h;
-							}
-						}
-					}
-				}
-
-				if (matched) {
-					// skip inactive events
-					if (!EventManager::isActive(*it)) continue;
-
-					// skip events without hotspots
-					if (it->hotspot.h == 0) continue;
-
-					// skip events on cooldown
-					if (!it->cooldown.isEnd() || !it->delay.isEnd()) continue;
-
-					// new tooltip?
-					createTooltip(it->getComponent(EventComponent::TOOLTIP));
-
-					if (((it->reachable_from.w == 0 && it->reachable_from.h == 0) || Utils::isWithinRect(it->reachable_from, Point(cam)))
-							&& Utils::calcDist(cam, it->center) < eset->misc.interact_range) {
-
-						// only check events if the player is clicking
-						// and allowed to click
-						if (is_npc) {
-							curs->setCursor(CursorManager::CURSOR_TALK);
-						}
-						else {
-							curs->setCursor(CursorManager::CURSOR_INTERACT);
-						}
-						if (!inpt->pressing[Input::MAIN1]) return;
-						else if (inpt->lock[Input::MAIN1]) return;
-						else if (pc->using_main1) return;
-
-						inpt->lock[Input::MAIN1] = true;
-						if (EventManager::executeEvent(*it))
-							it = events.erase(it);
+						hotspot_tip_pos = Utils::mapToScreen(ev.center.x, ev.center.y, shakycam.x, shakycam.y);
+						hotspot_tip_pos.y -= eset->tileset.tile_h;
+						return true;
 					}
-					return;
 				}
-				else show_tooltip = false;
 			}
 		}
 	}
+
+	return false;
+}
+
+/**
+ * The screen area in which isHotspotUnderMouse() can match this event.
+ * Every tile is assumed to be as large as the largest tile of the tileset, so that
+ * the area stays valid when events change the map tiles.
+ */
+Rect MapRenderer::getHotspotScreenArea(Event& ev) {
+	Rect area;
+	if (ev.hotspot.w <= 0 || ev.hotspot.h <= 0)
+		return area;
+
+	EventComponent* npc = ev.getComponent(EventComponent::NPC_HOTSPOT);
+	if (npc) {
+		Point p = Utils::mapToScreen(float(npc->x), float(npc->y), shakycam.x, shakycam.y);
+		p = centerTile(p);
+		return Rect(p.x - npc->z, p.y - npc->a, npc->b, npc->c);
+	}
+
+	Point area_min(std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+	Point area_max(std::numeric_limits<int>::min(), std::numeric_limits<int>::min());
+	for (int x=ev.hotspot.x; x < ev.hotspot.x + ev.hotspot.w; ++x) {
+		for (int y=ev.hotspot.y; y < ev.hotspot.y + ev.hotspot.h; ++y) {
+			Point p = Utils::mapToScreen(float(x), float(y), shakycam.x, shakycam.y);
+			p = centerTile(p);
+			area_min.x = std::min(area_min.x, p.x);
+			area_min.y = std::min(area_min.y, p.y);
+			area_max.x = std::max(area_max.x, p.x);
+			area_max.y = std::max(area_max.y, p.y);
+		}
+	}
+
+	area.x = area_min.x + tile_extent.x;
+	area.y = area_min.y + tile_extent.y;
+	area.w = area_max.x - area_min.x + tile_extent.w;
+	area.h = area_max.y - area_min.y + tile_extent.h;
+	return area;
+}
+
+void MapRenderer::removeEvent(size_t index) {
+	events.erase(events.begin() + index);
+	event_index_dirty = true;
+}
+
+/**
+ * Rebuild the event index if events were added or removed since it was built
+ */
+void MapRenderer::updateEventIndex() {
+	if (!event_index_dirty && event_index.getEventCount() == events.size())
+		return;
+
+	event_index.build(events, w, h);
+	event_index_dirty = false;
+	screen_index_dirty = true;
+
+	// the area covered by the largest tile, relative to the tile's center
+	Point extent_min(0, 0);
+	Point extent_max(0, 0);
+	for (size_t i = 0; i < tset.tiles.size(); ++i) {
+		const Tile_Def &tile = tset.tiles[i];
+		if (!tile.tile)
+			continue;
+
+		extent_min.x = std::min(extent_min.x, -tile.offset.x);
+		extent_min.y = std::min(extent_min.y, -tile.offset.y);
+		extent_max.x = std::max(extent_max.x, tile.tile->getClip().w - tile.offset.x);
+		extent_max.y = std::max(extent_max.y, tile.tile->getClip().h - tile.offset.y);
+	}
+	tile_extent = Rect(extent_min.x, extent_min.y, extent_max.x - extent_min.x, extent_max.y - extent_min.y);
+}
+
+/**
+ * Rebuild the screen areas of the hotspots if the camera moved or events were added or removed
+ */
+void MapRenderer::updateScreenIndex() {
+	updateEventIndex();
+
+	if (!screen_index_dirty && shakycam.x == screen_index_cam.x && shakycam.y == screen_index_cam.y &&
+		screen_index_view.x == settings->view_w && screen_index_view.y == settings->view_h)
+	{
+		return;
+	}
+
+	hotspot_screen_areas.resize(events.size());
+	for (size_t i = 0; i < events.size(); ++i) {
+		hotspot_screen_areas[i] = getHotspotScreenArea(events[i]);
+	}
+	event_index.buildScreen(hotspot_screen_areas, settings->view_w, settings->view_h);
+
+	screen_index_dirty = false;
+	screen_index_cam = shakycam;
+	screen_index_view.x = settings->view_w;
+	screen_index_view.y = settings->view_h;
 }
 
 void MapRenderer::checkNearestEvent() {
 	if (!inpt->usingMouse()) show_tooltip = false;
 
-	std::vector<Event>::iterator it;
-	std::vector<Event>::iterator nearest = events.end();
+	size_t nearest = events.size();
 	float best_distance = std::numeric_limits<float>::max();
 
+	// only events with a hotspot near the hero are checked
+	updateEventIndex();
+	event_index.getHotspotEvents(cam, eset->misc.interact_range, event_candidates);
+
 	// loop in reverse because we may erase elements
-	for (it = events.end(); it != events.begin(); ) {
-		--it;
+	for (size_t i = event_candidates.size(); i > 0; --i) {
+		const size_t index = event_candidates[i-1];
+		Event& ev = events[index];
 
 		// skip inactive events
-		if (!EventManager::isActive(*it)) continue;
+		if (!EventManager::isActive(ev)) continue;
 
 		// skip events without hotspots
-		if (it->hotspot.h == 0) continue;
+		if (ev.hotspot.h == 0) continue;
 
 		// skip events on cooldown
-		if (!it->cooldown.isEnd() || !it->delay.isEnd()) continue;
+		if (!ev.cooldown.isEnd() || !ev.delay.isEnd()) continue;
 
-		float distance = Utils::calcDist(cam, it->center);
-		if (((it->reachable_from.w == 0 && it->reachable_from.h == 0) || Utils::isWithinRect(it->reachable_from, Point(cam)))
+		float distance = Utils::calcDist(cam, ev.center);
+		if (((ev.reachable_from.w == 0 && ev.reachable_from.h == 0) || Utils::isWithinRect(ev.reachable_from, Point(cam)))
 				&& distance < eset->misc.interact_range && distance < best_distance) {
 			best_distance = distance;
-			nearest = it;
+			nearest = index;
 		}
 
 	}
 
-	if (nearest != events.end()) {
+	if (nearest != events.size()) {
+		Event& ev = events[nearest];
+
 		if (!inpt->usingMouse() || settings->touchscreen) {
 			// new tooltip?
-			createTooltip(nearest->getComponent(EventComponent::TOOLTIP));
-			tip_pos = Utils::mapToScreen(nearest->center.x, nearest->center.y, shakycam.x, shakycam.y);
-			if (nearest->getComponent(EventComponent::NPC_HOTSPOT)) {
+			createTooltip(ev.getComponent(EventComponent::TOOLTIP));
+			tip_pos = Utils::mapToScreen(ev.center.x, ev.center.y, shakycam.x, shakycam.y);
+			if (ev.getComponent(EventComponent::NPC_HOTSPOT)) {
 				tip_pos.y -= eset->tooltips.margin_npc;
 			}
 			else {
@@ -1055,8 +1213,8 @@ void MapRenderer::checkNearestEvent() {
 		if (inpt->pressing[Input::ACCEPT] && !inpt->lock[Input::ACCEPT]) {
 			inpt->lock[Input::ACCEPT] = true;
 
-			if(EventManager::executeEvent(*nearest))
-				events.erase(nearest);
+			if(EventManager::executeEvent(ev))
+				removeEvent(nearest);
 		}
 	}
 }
@@ -1111,6 +1269,21 @@ bool MapRenderer::isValidTile(const unsigned &tile) {
 	return tset.tiles[tile].tile != NULL;
 }
 
+/**
+ * Where the camera is drawn between the latest two logic frames, without shaking
+ */
+FPoint MapRenderer::getInterpolatedCam() {
+	return Utils::interpolate(prev_cam, cam);
+}
+
+/**
+ * The camera that the latest frame was drawn with, including the shaking.
+ * Anything the player points at on the screen should be looked up with this camera.
+ */
+const FPoint& MapRenderer::getRenderCam() const {
+	return render_cam;
+}
+
 Point MapRenderer::centerTile(const Point& p) {
 	Point r = p;
 
@@ -1125,11 +1298,11 @@ Point MapRenderer::centerTile(const Point& p) {
 
 void MapRenderer::getTileBounds(const int_fast16_t x, const int_fast16_t y, const Map_Layer& layerdata, Rect& bounds, Point& center) {
 	if (x >= 0 && x < w && y >= 0 && y < h) {
-		if (const uint_fast16_t tile_index = layerdata[x][y]) {
+		if (const uint_fast16_t tile_index = layerdata.get(x, y)) {
 			const Tile_Def &tile = tset.tiles[tile_index];
 			if (!tile.tile)
 				return;
-			center = centerTile(Utils::mapToScreen(float(x), float(y), shakycam.x, shakycam.y));
+			center = centerTile(Utils::mapToScreen(float(x), float(y), render_cam.x, render_cam.y));
 			bounds.x = center.x - tile.offset.x;
 			bounds.y = center.y - tile.offset.y;
 			bounds.w = tile.tile->getClip().w;
@@ -1144,17 +1317,17 @@ void MapRenderer::drawDevCursor() {
 		return;
 
 	Color dev_cursor_color = Color(255,255,0,255);
-	FPoint target = Utils::screenToMap(inpt->mouse.x,  inpt->mouse.y, shakycam.x, shakycam.y);
+	FPoint target = Utils::screenToMap(inpt->mouse.x,  inpt->mouse.y, render_cam.x, render_cam.y);
 
 	if (!collider.isOutsideMap(floorf(target.x), floorf(target.y))) {
 		if (eset->tileset.orientation == eset->tileset.TILESET_ORTHOGONAL) {
-			Point p_topleft = Utils::mapToScreen(floorf(target.x), floorf(target.y), shakycam.x, shakycam.y);
+			Point p_topleft = Utils::mapToScreen(floorf(target.x), floorf(target.y), render_cam.x, render_cam.y);
 			Point p_bottomright(p_topleft.x + eset->tileset.tile_w, p_topleft.y + eset->tileset.tile_h);
 
 			render_device->drawRectangle(p_topleft, p_bottomright, dev_cursor_color);
 		}
 		else {
-			Point p_left = Utils::mapToScreen(floorf(target.x), floorf(target.y+1), shakycam.x, shakycam.y);
+			Point p_left = Utils::mapToScreen(floorf(target.x), floorf(target.y+1), render_cam.x, render_cam.y);
 			Point p_top(p_left.x + eset->tileset.tile_w_half, p_left.y - eset->tileset.tile_h_half);
 			Point p_right(p_left.x + eset->tileset.tile_w, p_left.y);
 			Point p_bottom(p_left.x + eset->tileset.tile_w_half, p_left.y + eset->tileset.tile_h_half);
@@ -1167,8 +1340,9 @@ void MapRenderer::drawDevCursor() {
 
 		// draw distance line
 		if (menu->devconsole->distance_timer.isEnd()) {
-			Point p0 = Utils::mapToScreen(menu->devconsole->target.x, menu->devconsole->target.y, shakycam.x, shakycam.y);
-			Point p1 = Utils::mapToScreen(pc->stats.pos.x, pc->stats.pos.y, shakycam.x, shakycam.y);
+			Point p0 = Utils::mapToScreen(menu->devconsole->target.x, menu->devconsole->target.y, render_cam.x, render_cam.y);
+			const FPoint pos = Utils::interpolate(pc->stats.prev_pos, pc->stats.pos);
+			Point p1 = Utils::mapToScreen(pos.x, pos.y, render_cam.x, render_cam.y);
 			render_device->drawLine(p0.x, p0.y, p1.x, p1.y, dev_cursor_color);
 		}
 	}
@@ -1187,14 +1361,16 @@ void MapRenderer::drawDevHUD() {
 
 	// player
 	{
-		Point p0 = Utils::mapToScreen(pc->stats.pos.x, pc->stats.pos.y, shakycam.x, shakycam.y);
+		const FPoint pos = Utils::interpolate(pc->stats.prev_pos, pc->stats.pos);
+		Point p0 = Utils::mapToScreen(pos.x, pos.y, render_cam.x, render_cam.y);
 		render_device->drawLine(p0.x - cross_size, p0.y, p0.x + cross_size, p0.y, color_entity);
 		render_device->drawLine(p0.x, p0.y - cross_size, p0.x, p0.y + cross_size, color_entity);
 	}
 
 	// enemies
 	for (size_t i = 0; i < enemym->enemies.size(); ++i) {
-		Point p0 = Utils::mapToScreen(enemym->enemies[i]->stats.pos.x, enemym->enemies[i]->stats.pos.y, shakycam.x, shakycam.y);
+		const FPoint pos = Utils::interpolate(enemym->enemies[i]->stats.prev_pos, enemym->enemies[i]->stats.pos);
+		Point p0 = Utils::mapToScreen(pos.x, pos.y, render_cam.x, render_cam.y);
 		render_device->drawLine(p0.x - cross_size, p0.y, p0.x + cross_size, p0.y, color_entity);
 		render_device->drawLine(p0.x, p0.y - cross_size, p0.x, p0.y + cross_size, color_entity);
 	}
@@ -1205,8 +1381,9 @@ void MapRenderer::drawDevHUD() {
 			continue;
 
 		float radius_c = sqrtf(powf(hazards->h[i]->power->radius, 2) + powf(hazards->h[i]->power->radius, 2));
-		Point p0 = Utils::mapToScreen(hazards->h[i]->pos.x, hazards->h[i]->pos.y, shakycam.x, shakycam.y);
-		Point p1 = Utils::mapToScreen(hazards->h[i]->pos.x + radius_c, hazards->h[i]->pos.y, shakycam.x, shakycam.y);
+		const FPoint pos = Utils::interpolate(hazards->h[i]->prev_pos, hazards->h[i]->pos);
+		Point p0 = Utils::mapToScreen(pos.x, pos.y, render_cam.x, render_cam.y);
+		Point p1 = Utils::mapToScreen(pos.x + radius_c, pos.y, render_cam.x, render_cam.y);
 		int radius = p1.x - p0.x;
 		render_device->drawLine(p0.x - cross_size, p0.y, p0.x + cross_size, p0.y, color_hazard);
 		render_device->drawLine(p0.x, p0.y - cross_size, p0.x, p0.y + cross_size, color_hazard);
@@ -1230,7 +1407,7 @@ void MapRenderer::drawHiddenEntityMarkers() {
 			continue;
 
 		Point dest;
-		Point p = Utils::mapToScreen(hidden_entities[i]->map_pos.x, hidden_entities[i]->map_pos.y, shakycam.x, shakycam.y);
+		Point p = Utils::mapToScreen(hidden_entities[i]->map_pos.x, hidden_entities[i]->map_pos.y, render_cam.x, render_cam.y);
 		dest.x = p.x - marker_w / 2;
 		dest.y = p.y - hidden_entities[i]->offset.y - marker_h;
 
@@ -1297,7 +1474,7 @@ void MapRenderer::checkHiddenEntities(const int_fast16_t x, const int_fast16_t y
 			is_hidden = true;
 		}
 		else if (it->type != Renderable::TYPE_NORMAL) {
-			Point p = Utils::mapToScreen(it->map_pos.x, it->map_pos.y, shakycam.x, shakycam.y);
+			Point p = Utils::mapToScreen(it->map_pos.x, it->map_pos.y, render_cam.x, render_cam.y);
 			p.x -= it->offset.x;
 			if (Utils::isWithinRect(tile_bounds, p)) {
 				is_hidden = true;
@@ -29,7 +29,9 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #define MAP_RENDERER_H
 
 #include "CommonIncludes.h"
+#include "EventIndex.h"
 #include "Map.h"
+#include "MapChunkCache.h"
 #include "MapCollision.h"
 #include "MapParallax.h"
 #include "TileSet.h"
@@ -56,6 +58,7 @@ private:
 	void drawRenderable(std::vector<Renderable>::iterator r_cursor);
 
 	void renderIsoLayer(const Map_Layer& layerdata);
+	void renderTileLayer(size_t index);
 
 	// renders only objects
 	void renderIsoBackObjects(std::vector<Renderable> &r);
@@ -73,6 +76,12 @@ private:
 
 	void createTooltip(EventComponent *ec);
 
+	void removeEvent(size_t index);
+	void updateEventIndex();
+	void updateScreenIndex();
+	Rect getHotspotScreenArea(Event& ev);
+	bool isHotspotUnderMouse(Event& ev, Point& hotspot_tip_pos);
+
 	void getTileBounds(const int_fast16_t x, const int_fast16_t y, const Map_Layer& layerdata, Rect& bounds, Point& center);
 
 	void drawDevCursor();
@@ -83,6 +92,7 @@ private:
 	void checkHiddenEntities(const int_fast16_t x, const int_fast16_t y, const Map_Layer& layerdata, std::vector<Renderable> &r);
 
 	FPoint shakycam;
+	FPoint render_cam; // cam smoothed between logic frames plus the shaking of shakycam, used while drawing
 	TileSet tset;
 
 	MapParallax map_parallax;
@@ -92,6 +102,18 @@ private:
 
 	std::vector<std::vector<Renderable>::iterator> hidden_entities;
 
+	EventIndex event_index;
+	bool event_index_dirty;
+	bool screen_index_dirty;
+	FPoint screen_index_cam; // shakycam when the screen areas of the hotspots were indexed
+	Point screen_index_view;
+	Rect tile_extent; // the area that any tile of the tileset covers, relative to the tile center
+	std::vector<Rect> hotspot_screen_areas;
+	std::vector<size_t> event_candidates;
+
+	size_t profile_logic_id;
+	size_t profile_render_id;
+
 public:
 	// functions
 	MapRenderer();
@@ -120,8 +142,12 @@ public:
 	bool isValidTile(const unsigned &tile);
 	Point centerTile(const Point& p);
 
+	FPoint getInterpolatedCam();
+	const FPoint& getRenderCam() const;
+
 	// cam(x,y) is where on the map the camera is pointing
 	FPoint cam;
+	FPoint prev_cam; // cam at the start of the latest logic frame, set by GameStatePlay::logic()
 
 	// indicates that the map was changed by an event, so the GameStatePlay
 	// will tell the mini map to update.
@@ -129,6 +155,9 @@ public:
 
 	MapCollision collider;
 
+	// pre-rendered chunks of the tile layers, used when settings->map_chunk_cache is enabled
+	MapChunkCache chunk_cache;
+
 	// event-created loot or items
 	std::vector<EventComponent> loot;
 	Point loot_count;
@@ -20,6 +20,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
  */
 
 #include "Avatar.h"
+#include "Benchmarks.h"
 #include "CampaignManager.h"
 #include "Enemy.h"
 #include "EnemyManager.h"
@@ -34,9 +35,11 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "MessageEngine.h"
 #include "ModManager.h"
 #include "PowerManager.h"
+#include "Profiler.h"
 #include "Settings.h"
 #include "SharedGameResources.h"
 #include "SharedResources.h"
+#include "SoundManager.h"
 #include "UtilsFileSystem.h"
 #include "UtilsParsing.h"
 #include "WidgetButton.h"
@@ -50,6 +53,9 @@ MenuDevConsole::MenuDevConsole()
 	: Menu()
 	, first_open(false)
 	, input_scrollback_pos(0)
+#ifdef FLARE_BENCHMARKS
+	, benchmarks(NULL)
+#endif
 {
 	distance_timer.setDuration(settings->max_frames_per_sec);
 
@@ -107,6 +113,10 @@ MenuDevConsole::MenuDevConsole()
 
 	setBackground("images/menus/dev_console.png");
 
+#ifdef FLARE_BENCHMARKS
+	benchmarks = new Benchmarks(log_history);
+#endif
+
 	align();
 	reset();
 	input_box->accept_to_defocus = false;
@@ -117,6 +127,9 @@ MenuDevConsole::~MenuDevConsole() {
 	delete button_confirm;
 	delete input_box;
 	delete log_history;
+#ifdef FLARE_BENCHMARKS
+	delete benchmarks;
+#endif
 }
 
 void MenuDevConsole::align() {
@@ -248,16 +261,16 @@ void MenuDevConsole::getTileInfo() {
 
 	std::stringstream ss;
 	for (size_t i = 0; i < mapr->layers.size(); ++i) {
-		if (mapr->layers[i][tile.x][tile.y] == 0)
+		if (mapr->layers[i].get(tile.x, tile.y) == 0)
 			continue;
 		ss.str("");
-		ss << "    " << mapr->layernames[i] << "=" << mapr->layers[i][tile.x][tile.y];
+		ss << "    " << mapr->layernames[i] << "=" << mapr->layers[i].get(tile.x, tile.y);
 		log_history->add(ss.str(), WidgetLog::MSG_NORMAL);
 	}
 
 	ss.str("");
-	ss << "    " << "collision=" << mapr->collider.colmap[tile.x][tile.y] << " (";
-	switch(mapr->collider.colmap[tile.x][tile.y]) {
+	ss << "    " << "collision=" << mapr->collider.colmap.get(tile.x, tile.y) << " (";
+	switch(mapr->collider.colmap.get(tile.x, tile.y)) {
 		case MapCollision::BLOCKS_NONE: ss << msg->get("none"); break;
 		case MapCollision::BLOCKS_ALL: ss << msg->get("wall"); break;
 		case MapCollision::BLOCKS_MOVEMENT: ss << msg->get("short wall / pit"); break;
@@ -361,11 +374,18 @@ void MenuDevConsole::execute() {
 		log_history->add("toggle_fps - " + msg->get("turns on/off the display of the FPS counter"), WidgetLog::MSG_UNIQUE);
 		log_history->add("toggle_hud - " + msg->get("turns on/off all of the HUD elements"), WidgetLog::MSG_UNIQUE);
 		log_history->add("toggle_devhud - " + msg->get("turns on/off the developer hud"), WidgetLog::MSG_UNIQUE);
+		log_history->add("toggle_stat_check - " + msg->get("turns on/off comparing the per-frame stat updates to a full calculation"), WidgetLog::MSG_UNIQUE);
+		log_history->add("toggle_profiler - " + msg->get("turns on/off the display of the time taken by each game subsystem"), WidgetLog::MSG_UNIQUE);
+		log_history->add("profiler_trace - " + msg->get("writes the time taken by each game subsystem during a number of frames to a trace file for chrome://tracing"), WidgetLog::MSG_UNIQUE);
+		log_history->add("sound_stats - " + msg->get("prints the number of playing sound effects, and how many were merged or culled"), WidgetLog::MSG_UNIQUE);
 		log_history->add("list_powers - " + msg->get("Prints a list of powers that match a search term. No search term will list all items"), WidgetLog::MSG_UNIQUE);
 		log_history->add("list_maps - " + msg->get("Prints out all the map filenames located in the \"maps/\" directory."), WidgetLog::MSG_UNIQUE);
 		log_history->add("list_status - " + msg->get("Prints out the active campaign statuses that match a search term. No search term will list all active statuses"), WidgetLog::MSG_UNIQUE);
 		log_history->add("list_items - " + msg->get("Prints a list of items that match a search term. No search term will list all items"), WidgetLog::MSG_UNIQUE);
 		log_history->add("exec - " + msg->get("parses a series of event components and executes them as a single event"), WidgetLog::MSG_UNIQUE);
+#ifdef FLARE_BENCHMARKS
+		benchmarks->addHelp();
+#endif
 		log_history->add("clear - " + msg->get("clears the command history"), WidgetLog::MSG_UNIQUE);
 		log_history->add("help - " + msg->get("displays this text"), WidgetLog::MSG_UNIQUE);
 	}
@@ -564,6 +584,43 @@ void MenuDevConsole::execute() {
 			log_history->add(msg->get("HINT:") + ' ' + args[0] + ' ' + msg->get("<key>=<val> <key>=<val> ..."), WidgetLog::MSG_UNIQUE);
 		}
 	}
+	else if (args[0] == "toggle_stat_check") {
+		settings->verify_stats = !settings->verify_stats;
+		log_history->add(msg->get("Toggled checking the per-frame stat updates"), WidgetLog::MSG_UNIQUE);
+	}
+	else if (args[0] == "toggle_profiler") {
+		profiler->setOverlayVisible(!profiler->isOverlayVisible());
+		log_history->add(msg->get("Toggled the profiler"), WidgetLog::MSG_UNIQUE);
+	}
+	else if (args[0] == "profiler_trace") {
+		int frames = (args.size() > 1) ? Parse::toInt(args[1]) : 120;
+		if (frames <= 0) {
+			log_history->add(msg->get("ERROR: Invalid number of frames"), WidgetLog::MSG_UNIQUE);
+		}
+		else if (profiler->isTracing()) {
+			log_history->add(msg->get("ERROR: A trace is already being recorded"), WidgetLog::MSG_UNIQUE);
+		}
+		else {
+			const std::string filename = settings->path_user + "profiler_trace.json";
+			profiler->startTrace(static_cast<unsigned>(frames), filename);
+			log_history->add(msg->get("Recording %d frames to '%s'", frames, filename), WidgetLog::MSG_UNIQUE);
+		}
+	}
+	else if (args[0] == "sound_stats") {
+		SoundManager::VoiceStats voice_stats;
+		snd->getVoiceStats(voice_stats);
+
+		std::stringstream ss;
+		ss << "sound_stats: " << voice_stats.active << "/" << voice_stats.channels << " voices active, ";
+		ss << voice_stats.started << " started, " << voice_stats.merged << " merged, " << voice_stats.culled << " culled, ";
+		ss << voice_stats.culled_per_second << " culled in the last second";
+		log_history->add(ss.str(), WidgetLog::MSG_NORMAL);
+	}
+#ifdef FLARE_BENCHMARKS
+	else if (benchmarks->execute(args)) {
+		// the benchmark has printed its results
+	}
+#endif
 	else {
 		log_history->setNextColor(font->getColor(FontEngine::COLOR_MENU_PENALTY));
 		log_history->add(msg->get("ERROR: Unknown command"), WidgetLog::MSG_UNIQUE);
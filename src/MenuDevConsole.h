@@ -27,6 +27,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "Utils.h"
 #include "WidgetLabel.h"
 
+class Benchmarks;
 class WidgetButton;
 class WidgetInput;
 class WidgetLog;
@@ -54,6 +55,10 @@ protected:
 	size_t input_scrollback_pos;
 	std::vector<std::string> input_scrollback;
 
+#ifdef FLARE_BENCHMARKS
+	Benchmarks *benchmarks;
+#endif
+
 public:
 	MenuDevConsole();
 	~MenuDevConsole();
@@ -1021,6 +1021,9 @@ void MenuInventory::applyEquipment() {
 			}
 		}
 	}
+	// damage and absorb bonuses aren't effects, so they aren't picked up by StatBlock::updateStats()
+	pc->stats.setStatsOutdated();
+
 	// update stat display
 	pc->stats.refresh_stats = true;
 }
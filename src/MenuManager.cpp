@@ -51,6 +51,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "ModManager.h"
 #include "NPC.h"
 #include "PowerManager.h"
+#include "Profiler.h"
 #include "RenderDevice.h"
 #include "Settings.h"
 #include "SharedGameResources.h"
@@ -98,6 +99,9 @@ MenuManager::MenuManager()
 	, pause(false)
 	, menus_open(false) {
 
+	profile_logic_id = profiler->addSection("menus");
+	profile_render_id = profiler->addSection("menus_render");
+
 	hp = new MenuStatBar("hp");
 	mp = new MenuStatBar("mp");
 	xp = new MenuStatBar("xp");
@@ -272,6 +276,8 @@ void MenuManager::handleKeyboardNavigation() {
 	}
 }
 void MenuManager::logic() {
+	ProfilerScope profile(profile_logic_id);
+
 	ItemStack stack;
 
 	subtitles->logic(snd->getLastPlayedSID());
@@ -1179,6 +1185,8 @@ void MenuManager::resetDrag() {
 }
 
 void MenuManager::render() {
+	ProfilerScope profile(profile_render_id);
+
 	if (!settings->show_hud) {
 		// if the hud is disabled, only show a few necessary menus
 
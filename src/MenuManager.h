@@ -86,6 +86,9 @@ private:
 	void handleKeyboardNavigation();
 	void dragAndDropWithKeyboard();
 
+	size_t profile_logic_id;
+	size_t profile_render_id;
+
 public:
 	explicit MenuManager();
 	MenuManager(const MenuManager &copy); // not implemented
@@ -0,0 +1,331 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class ModIndex
+ */
+
+#include "ModIndex.h"
+#include "Utils.h"
+#include "UtilsFileSystem.h"
+#include "UtilsParsing.h"
+
+#include <stdlib.h>
+
+ModIndex::ModIndex()
+	: built(false)
+{
+}
+
+ModIndex::~ModIndex() {
+}
+
+/**
+ * Index the given directories, or load the index from cache_file if it is still up to date.
+ * An empty cache_file disables the cache.
+ */
+void ModIndex::build(const std::vector<std::string>& root_paths, const std::string& cache_file) {
+	clear();
+
+	uint64_t start_ticks = SDL_GetPerformanceCounter();
+
+	bool from_cache = !cache_file.empty() && readCache(cache_file, root_paths);
+	if (!from_cache) {
+		clear();
+
+		for (size_t i = 0; i < root_paths.size(); ++i) {
+			roots.resize(roots.size() + 1);
+			roots.back().path = root_paths[i];
+			scan(i, "", 0);
+		}
+
+		if (!cache_file.empty())
+			writeCache(cache_file);
+	}
+
+	for (size_t i = 0; i < roots.size(); ++i) {
+		std::set<std::string>::const_iterator it;
+		for (it = roots[i].files.begin(); it != roots[i].files.end(); ++it) {
+			winners[*it] = i;
+		}
+	}
+
+	built = true;
+
+	float ms = static_cast<float>(SDL_GetPerformanceCounter() - start_ticks) * 1000.f / static_cast<float>(SDL_GetPerformanceFrequency());
+	Utils::logInfo("ModIndex: Indexed %u files in %u directories (%s ms%s).", static_cast<unsigned>(winners.size()), static_cast<unsigned>(stamps.size()), Utils::floatToString(ms, 2).c_str(), (from_cache ? ", cached" : ""));
+}
+
+void ModIndex::clear() {
+	roots.clear();
+	stamps.clear();
+	winners.clear();
+	built = false;
+}
+
+/**
+ * Add a file that was created after the index was built, e.g. a compiled map.
+ * Returns false if the file isn't inside one of the roots.
+ */
+bool ModIndex::addFile(const std::string& full_path) {
+	for (size_t i = roots.size(); i > 0; --i) {
+		Root& root = roots[i-1];
+		if (full_path.compare(0, root.path.length(), root.path) != 0)
+			continue;
+
+		const std::string filename = full_path.substr(root.path.length());
+		root.files.insert(filename);
+
+		size_t slash = filename.find('/');
+		while (slash != std::string::npos) {
+			root.dirs.insert(filename.substr(0, slash));
+			slash = filename.find('/', slash + 1);
+		}
+
+		// a file in a later root takes priority
+		std::map<std::string, size_t>::iterator it = winners.find(filename);
+		if (it == winners.end() || it->second < i-1)
+			winners[filename] = i-1;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool ModIndex::isBuilt() const {
+	return built;
+}
+
+/**
+ * Get the full path of a file from the root that takes priority.
+ * Returns false if none of the roots have this file.
+ */
+bool ModIndex::locate(const std::string& filename, std::string& path) const {
+	std::map<std::string, size_t>::const_iterator it = winners.find(filename);
+	if (it == winners.end())
+		return false;
+
+	path = roots[it->second].path + filename;
+	return true;
+}
+
+/**
+ * Same results as ModManager::list() with full paths: either the file in every root that has it,
+ * or the ".txt" files directly inside the directory in every root that has it.
+ */
+void ModIndex::list(const std::string& path, std::vector<std::string>& ret) const {
+	std::string key = path;
+	while (!key.empty() && key[key.length()-1] == '/')
+		key.erase(key.length()-1);
+
+	const std::string prefix = key + "/";
+
+	for (size_t i = 0; i < roots.size(); ++i) {
+		const Root& root = roots[i];
+
+		if (root.dirs.find(key) != root.dirs.end()) {
+			std::set<std::string>::const_iterator it;
+			for (it = root.files.lower_bound(prefix); it != root.files.end() && it->compare(0, prefix.length(), prefix) == 0; ++it) {
+				// skip files in subdirectories
+				if (it->find('/', prefix.length()) != std::string::npos)
+					continue;
+
+				if (it->length() > prefix.length() + 3 && it->compare(it->length() - 3, 3, "txt") == 0)
+					ret.push_back(root.path + path + "/" + it->substr(prefix.length()));
+			}
+		}
+		else if (root.files.find(key) != root.files.end()) {
+			ret.push_back(root.path + path);
+		}
+	}
+}
+
+size_t ModIndex::getFileCount() const {
+	return winners.size();
+}
+
+/**
+ * Only plain relative paths are looked up in the index.
+ * Anything else (e.g. "../file.txt" or "/tmp/file.txt") is left to the file system.
+ */
+bool ModIndex::isIndexable(const std::string& path) {
+	if (path.empty() || path[0] == '/' || path[0] == '.')
+		return false;
+
+	return path.find('\\') == std::string::npos
+		&& path.find("//") == std::string::npos
+		&& path.find("/.") == std::string::npos;
+}
+
+std::string ModIndex::getDirPath(size_t root_index, const std::string& dir) const {
+	const std::string& root_path = roots[root_index].path;
+	if (dir.empty())
+		return root_path.substr(0, root_path.length()-1);
+	return root_path + dir;
+}
+
+void ModIndex::scan(size_t root_index, const std::string& dir, int depth) {
+	const std::string dir_path = getDirPath(root_index, dir);
+
+	DirStamp stamp;
+	stamp.root = root_index;
+	stamp.dir = dir;
+	stamp.mtime = Filesystem::getModifiedTime(dir_path);
+	stamps.push_back(stamp);
+
+	if (stamp.mtime == -1)
+		return;
+
+	std::vector<std::string> files;
+	std::vector<std::string> dirs;
+	Filesystem::getDirEntries(dir_path, files, dirs);
+
+	const std::string prefix = dir.empty() ? "" : dir + "/";
+
+	for (size_t i = 0; i < files.size(); ++i) {
+		roots[root_index].files.insert(prefix + files[i]);
+	}
+
+	if (depth >= MAX_DEPTH)
+		return;
+
+	for (size_t i = 0; i < dirs.size(); ++i) {
+		roots[root_index].dirs.insert(prefix + dirs[i]);
+		scan(root_index, prefix + dirs[i], depth + 1);
+	}
+}
+
+/**
+ * Returns false if the cache doesn't exist, is for different roots or if any directory has changed
+ */
+bool ModIndex::readCache(const std::string& cache_file, const std::vector<std::string>& root_paths) {
+	std::ifstream infile;
+	infile.open(cache_file.c_str(), std::ios::in | std::ios::binary);
+	if (!infile.is_open())
+		return false;
+
+	bool valid = false;
+	bool complete = false;
+	std::string line;
+
+	while (infile.good()) {
+		line = Parse::getLine(infile);
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		size_t sep = line.find('=');
+		if (sep == std::string::npos) {
+			valid = false;
+			break;
+		}
+
+		const std::string key = line.substr(0, sep);
+		const std::string val = line.substr(sep+1);
+
+		if (key == "version") {
+			valid = (Parse::toInt(val) == VERSION);
+		}
+		else if (!valid) {
+			break;
+		}
+		else if (key == "root") {
+			if (roots.size() >= root_paths.size() || val != root_paths[roots.size()]) {
+				valid = false;
+				break;
+			}
+
+			roots.resize(roots.size() + 1);
+			roots.back().path = val;
+		}
+		else if (key == "dir") {
+			sep = val.find(',');
+			if (roots.empty() || sep == std::string::npos) {
+				valid = false;
+				break;
+			}
+
+			DirStamp stamp;
+			stamp.root = roots.size() - 1;
+			stamp.dir = val.substr(sep+1);
+			stamp.mtime = atol(val.substr(0, sep).c_str());
+
+			if (Filesystem::getModifiedTime(getDirPath(stamp.root, stamp.dir)) != stamp.mtime) {
+				valid = false;
+				break;
+			}
+
+			stamps.push_back(stamp);
+			if (!stamp.dir.empty())
+				roots.back().dirs.insert(stamp.dir);
+		}
+		else if (key == "end") {
+			complete = true;
+			break;
+		}
+		else if (key == "file") {
+			if (roots.empty()) {
+				valid = false;
+				break;
+			}
+
+			roots.back().files.insert(val);
+		}
+		else {
+			valid = false;
+			break;
+		}
+	}
+
+	infile.close();
+
+	return valid && complete && roots.size() == root_paths.size();
+}
+
+void ModIndex::writeCache(const std::string& cache_file) const {
+	std::ofstream outfile;
+	outfile.open(cache_file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!outfile.is_open()) {
+		Utils::logError("ModIndex: Could not write '%s'.", cache_file.c_str());
+		return;
+	}
+
+	outfile << "# Generated by Flare. Delete this file if mod files can't be found." << std::endl;
+	outfile << "version=" << VERSION << std::endl;
+
+	size_t stamp_index = 0;
+	for (size_t i = 0; i < roots.size(); ++i) {
+		outfile << "root=" << roots[i].path << std::endl;
+
+		while (stamp_index < stamps.size() && stamps[stamp_index].root == i) {
+			outfile << "dir=" << stamps[stamp_index].mtime << "," << stamps[stamp_index].dir << std::endl;
+			stamp_index++;
+		}
+
+		std::set<std::string>::const_iterator it;
+		for (it = roots[i].files.begin(); it != roots[i].files.end(); ++it) {
+			outfile << "file=" << *it << std::endl;
+		}
+	}
+
+	outfile << "end=" << std::endl;
+
+	if (outfile.bad())
+		Utils::logError("ModIndex: Could not write '%s'.", cache_file.c_str());
+
+	outfile.close();
+}
@@ -0,0 +1,85 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class ModIndex
+ *
+ * A list of every file in the active mod directories, so that ModManager can find files
+ * without checking each mod directory on disk.
+ *
+ * The directories ("roots") are given in the order that ModManager::list() returns files,
+ * so a file in a later root overrides the same file in an earlier one.
+ *
+ * The index can be saved to a cache file. The cache stores the modification time of every
+ * directory, and is only used if none of them have changed since then. Adding, removing or
+ * renaming a file changes the time of its directory, while editing a file doesn't matter
+ * because only file names are indexed.
+ */
+
+#ifndef MOD_INDEX_H
+#define MOD_INDEX_H
+
+#include "CommonIncludes.h"
+
+class ModIndex {
+private:
+	class Root {
+	public:
+		std::string path; // with a trailing '/'
+		std::set<std::string> files; // relative to path
+		std::set<std::string> dirs; // relative to path, without a trailing '/'
+	};
+
+	class DirStamp {
+	public:
+		size_t root;
+		std::string dir;
+		long mtime;
+	};
+
+	// protects against symbolic links that point to a parent directory
+	static const int MAX_DEPTH = 32;
+
+	std::string getDirPath(size_t root_index, const std::string& dir) const;
+	void scan(size_t root_index, const std::string& dir, int depth);
+	bool readCache(const std::string& cache_file, const std::vector<std::string>& root_paths);
+	void writeCache(const std::string& cache_file) const;
+
+	std::vector<Root> roots;
+	std::vector<DirStamp> stamps;
+	std::map<std::string, size_t> winners; // file -> index of the root that contains the version in use
+	bool built;
+
+public:
+	// increment this whenever the layout of the cache file changes
+	static const int VERSION = 1;
+
+	ModIndex();
+	~ModIndex();
+
+	void build(const std::vector<std::string>& root_paths, const std::string& cache_file);
+	void clear();
+	bool addFile(const std::string& full_path);
+	bool isBuilt() const;
+	bool locate(const std::string& filename, std::string& path) const;
+	void list(const std::string& path, std::vector<std::string>& ret) const;
+	size_t getFileCount() const;
+
+	static bool isIndexable(const std::string& path);
+};
+
+#endif
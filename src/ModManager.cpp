@@ -115,7 +115,9 @@ const std::string ModManager::FALLBACK_MOD = "default";
 const std::string ModManager::FALLBACK_GAME = "default";
 
 ModManager::ModManager(const std::vector<std::string> *_cmd_line_mods)
-	: cmd_line_mods(_cmd_line_mods)
+	: use_index(true)
+	, cache_mutex(SDL_CreateMutex())
+	, cmd_line_mods(_cmd_line_mods)
 {
 	loc_cache.clear();
 	mod_dirs.clear();
@@ -240,32 +242,63 @@ void ModManager::loadModList() {
  * Use private loc_cache to prevent excessive disk I/O
  */
 std::string ModManager::locate(const std::string& filename) {
-	// if we have this location already cached, return it
-	if (loc_cache.find(filename) != loc_cache.end()) {
-		return loc_cache[filename];
+	SDL_LockMutex(cache_mutex);
+
+	// if we have this location already cached, return it (an empty path means that the file is missing)
+	std::map<std::string,std::string>::iterator it = loc_cache.find(filename);
+	if (it != loc_cache.end()) {
+		std::string cached_path = it->second;
+		SDL_UnlockMutex(cache_mutex);
+		return cached_path;
 	}
 
 	// search through mods for the first instance of this filename
 	std::string test_path;
+	bool found = false;
 
-	for (size_t i = mod_list.size(); i > 0; i--) {
-		for (size_t j = 0; j < mod_paths.size(); j++) {
-			test_path = mod_paths[j] + "mods/" + mod_list[i-1].name + "/" + filename;
-			if (Filesystem::fileExists(test_path)) {
-				loc_cache[filename] = test_path;
-				return test_path;
+	if (use_index && ModIndex::isIndexable(filename)) {
+		if (!index.isBuilt())
+			buildIndex();
+
+		found = index.locate(filename, test_path);
+	}
+	else {
+		for (size_t i = mod_list.size(); i > 0 && !found; i--) {
+			for (size_t j = 0; j < mod_paths.size() && !found; j++) {
+				test_path = mod_paths[j] + "mods/" + mod_list[i-1].name + "/" + filename;
+				found = Filesystem::fileExists(test_path);
 			}
 		}
 	}
 
 	// all else failing, simply return the filename if it exists
-	test_path = settings->path_data + filename;
-	if (!Filesystem::fileExists(test_path))
-		test_path = "";
+	if (!found) {
+		test_path = settings->path_data + filename;
+		if (!Filesystem::fileExists(test_path))
+			test_path = "";
+	}
+
+	// misses are cached too. Files that the engine writes to a mod directory are reported with
+	// fileWritten(), which clears the cache.
+	loc_cache[filename] = test_path;
+
+	SDL_UnlockMutex(cache_mutex);
 
 	return test_path;
 }
 
+/**
+ * Must be called after the engine writes a file into a mod directory (e.g. a compiled map),
+ * so that locate() and list() find it. path is the full path of the file.
+ */
+void ModManager::fileWritten(const std::string& path) {
+	SDL_LockMutex(cache_mutex);
+	if (index.isBuilt())
+		index.addFile(path);
+	loc_cache.clear();
+	SDL_UnlockMutex(cache_mutex);
+}
+
 void amendPathToVector(const std::string &path, std::vector<std::string> &vec) {
 	if (Filesystem::pathExists(path)) {
 		if (Filesystem::isDirectory(path)) {
@@ -281,12 +314,22 @@ std::vector<std::string> ModManager::list(const std::string &path, bool full_pat
 	std::vector<std::string> ret;
 	std::string test_path;
 
-	for (size_t i = 0; i < mod_list.size(); ++i) {
-		for (size_t j = mod_paths.size(); j > 0; j--) {
-			test_path = mod_paths[j-1] + "mods/" + mod_list[i].name + "/" + path;
-			amendPathToVector(test_path, ret);
+	SDL_LockMutex(cache_mutex);
+	if (use_index && ModIndex::isIndexable(path)) {
+		if (!index.isBuilt())
+			buildIndex();
+
+		index.list(path, ret);
+	}
+	else {
+		for (size_t i = 0; i < mod_list.size(); ++i) {
+			for (size_t j = mod_paths.size(); j > 0; j--) {
+				test_path = mod_paths[j-1] + "mods/" + mod_list[i].name + "/" + path;
+				amendPathToVector(test_path, ret);
+			}
 		}
 	}
+	SDL_UnlockMutex(cache_mutex);
 
 	// we don't need to check for duplicates if there are no paths
 	if (ret.empty()) return ret;
@@ -297,20 +340,67 @@ std::vector<std::string> ModManager::list(const std::string &path, bool full_pat
 			ret[i] = ret[i].substr(ret[i].rfind(path), ret[i].length());
 		}
 
-		// remove duplicates
-		for (unsigned i = 0; i < ret.size(); ++i) {
-			for (unsigned j = 0; j < i; ++j) {
-				if (ret[i] == ret[j]) {
-					ret.erase(ret.begin()+j);
-					break;
-				}
-			}
+		// remove duplicates, keeping the last instance of each file
+		std::set<std::string> found;
+		std::vector<std::string> unique;
+		for (size_t i = ret.size(); i > 0; --i) {
+			if (found.insert(ret[i-1]).second)
+				unique.push_back(ret[i-1]);
 		}
+		ret.assign(unique.rbegin(), unique.rend());
 	}
 
 	return ret;
 }
 
+/**
+ * Index the directories of all active mods. Must be called with cache_mutex locked.
+ */
+void ModManager::buildIndex() {
+	// same order as list(), so that files from later directories take priority
+	std::vector<std::string> root_paths;
+	for (size_t i = 0; i < mod_list.size(); ++i) {
+		for (size_t j = mod_paths.size(); j > 0; j--) {
+			root_paths.push_back(mod_paths[j-1] + "mods/" + mod_list[i].name + "/");
+		}
+	}
+
+	index.build(root_paths, (settings->mod_index_cache ? getIndexCacheFilename() : ""));
+
+	// cached locations (and misses) may be out of date now
+	loc_cache.clear();
+}
+
+void ModManager::setIndexEnabled(bool enabled) {
+	SDL_LockMutex(cache_mutex);
+	use_index = enabled;
+	index.clear();
+	loc_cache.clear();
+	SDL_UnlockMutex(cache_mutex);
+}
+
+bool ModManager::isIndexEnabled() {
+	return use_index;
+}
+
+std::string ModManager::getIndexCacheFilename() {
+	return settings->path_user + "mod_index.txt";
+}
+
+/**
+ * Get every file that locate() has looked up so far, including missing files
+ */
+void ModManager::getLocatedFiles(std::vector<std::string>& files) {
+	files.clear();
+
+	SDL_LockMutex(cache_mutex);
+	std::map<std::string,std::string>::iterator it;
+	for (it = loc_cache.begin(); it != loc_cache.end(); ++it) {
+		files.push_back(it->first);
+	}
+	SDL_UnlockMutex(cache_mutex);
+}
+
 void ModManager::setPaths() {
 	// set some flags if directories are identical
 	bool uniq_path_data = settings->path_user != settings->path_data;
@@ -428,6 +518,12 @@ Mod ModManager::loadMod(const std::string& name) {
 }
 
 void ModManager::applyDepends() {
+	// the active mods may change, so everything that was found so far has to be looked up again
+	SDL_LockMutex(cache_mutex);
+	index.clear();
+	loc_cache.clear();
+	SDL_UnlockMutex(cache_mutex);
+
 	std::vector<Mod> new_mods;
 	bool finished = true;
 	std::string game;
@@ -558,4 +654,6 @@ void ModManager::resetModConfig() {
 }
 
 ModManager::~ModManager() {
+	if (cache_mutex)
+		SDL_DestroyMutex(cache_mutex);
 }
@@ -27,6 +27,7 @@ mods in priority order when loading data files.
 #define MOD_MANAGER_H
 
 #include "CommonIncludes.h"
+#include "ModIndex.h"
 
 class Version;
 
@@ -57,8 +58,12 @@ class ModManager {
 private:
 	void loadModList();
 	void setPaths();
+	void buildIndex();
 
-	std::map<std::string,std::string> loc_cache;
+	std::map<std::string,std::string> loc_cache; // an empty path for files that don't exist
+	ModIndex index;
+	bool use_index;
+	SDL_mutex* cache_mutex; // locate() and list() are also used by MapPreloader's worker thread
 	std::vector<std::string> mod_paths;
 
 	const std::vector<std::string> *cmd_line_mods;
@@ -90,6 +95,17 @@ public:
 	// that can be passed to locate() later
 	std::vector<std::string> list(const std::string& path, bool full_paths);
 
+	// Lookups (including misses) are cached, so files that the engine writes into
+	// a mod directory must be reported here.
+	void fileWritten(const std::string& path);
+
+	// The index is enabled by default. Disabling it makes locate() and list() check
+	// every mod directory on disk, which is only useful for comparing performance.
+	void setIndexEnabled(bool enabled);
+	bool isIndexEnabled();
+	std::string getIndexCacheFilename();
+	void getLocatedFiles(std::vector<std::string>& files);
+
 	std::vector<std::string> mod_dirs;
 	std::vector<Mod> mod_list;
 };
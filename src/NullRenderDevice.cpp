@@ -0,0 +1,264 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+#include <SDL_image.h>
+
+#include "CursorManager.h"
+#include "EngineSettings.h"
+#include "IconManager.h"
+#include "InputState.h"
+#include "ModManager.h"
+#include "Settings.h"
+#include "SharedResources.h"
+
+#include "NullRenderDevice.h"
+#include "SDLFontEngine.h"
+
+NullImage::NullImage(RenderDevice *_device, int _width, int _height)
+	: Image(_device)
+	, width(_width)
+	, height(_height) {
+}
+
+NullImage::~NullImage() {
+}
+
+int NullImage::getWidth() const {
+	return width;
+}
+
+int NullImage::getHeight() const {
+	return height;
+}
+
+void NullImage::fillWithColor(const Color&) {
+}
+
+void NullImage::drawPixel(int, int, const Color&) {
+}
+
+/**
+ * Deletes the original image and returns a pointer to the resized version
+ */
+Image* NullImage::resize(int _width, int _height) {
+	if (_width <= 0 || _height <= 0)
+		return NULL;
+
+	NullImage *scaled = new NullImage(device, _width, _height);
+	this->unref();
+	return scaled;
+}
+
+NullRenderDevice::NullRenderDevice() {
+	Utils::logInfo("RenderDevice: Using NullRenderDevice (nothing is drawn)");
+
+	fullscreen = false;
+	hwsurface = false;
+	vsync = false;
+	texture_filter = false;
+
+	min_screen.x = eset->resolutions.min_screen_w;
+	min_screen.y = eset->resolutions.min_screen_h;
+}
+
+int NullRenderDevice::createContextInternal() {
+	settings->fullscreen = false;
+	settings->vsync = false;
+
+	if (!is_initialized) {
+		is_initialized = true;
+		Utils::logInfo("RenderDevice: Window size is %dx%d", settings->screen_w, settings->screen_h);
+	}
+
+	windowResize();
+
+	// load persistent resources
+	delete icons;
+	icons = new IconManager();
+	delete curs;
+	curs = new CursorManager();
+
+	return 0;
+}
+
+void NullRenderDevice::createContextError() {
+	Utils::logError("NullRenderDevice: createContext() failed.");
+}
+
+int NullRenderDevice::render(Renderable&, Rect&) {
+	draw_calls++;
+	return 0;
+}
+
+int NullRenderDevice::render(Sprite *r) {
+	if (r == NULL || !localToGlobal(r))
+		return -1;
+
+	draw_calls++;
+	return 0;
+}
+
+int NullRenderDevice::renderToImage(Image* src_image, Rect&, Image* dest_image, Rect&) {
+	if (!src_image || !dest_image)
+		return -1;
+
+	draw_calls++;
+	return 0;
+}
+
+int NullRenderDevice::renderRectsToImage(Image* src_image, const std::vector<Rect>& src, Image* dest_image, const std::vector<Rect>&, const Color&) {
+	if (!src_image || !dest_image)
+		return -1;
+
+	draw_calls += static_cast<int>(src.size());
+	return 0;
+}
+
+int NullRenderDevice::copyToImage(Image* src_image, Rect&, Image* dest_image, Rect&) {
+	if (!src_image || !dest_image)
+		return -1;
+
+	draw_calls++;
+	return 0;
+}
+
+int NullRenderDevice::composeToImage(Image* src_image, Rect&, Image* dest_image, Rect&) {
+	if (!src_image || !dest_image)
+		return -1;
+
+	draw_calls++;
+	return 0;
+}
+
+/**
+ * The text isn't drawn, but the image has the size it would have with the real font
+ */
+Image* NullRenderDevice::renderTextToImage(FontStyle* font_style, const std::string& text, const Color&, bool) {
+	int w = 0;
+	int h = 0;
+	if (!font_style || TTF_SizeUTF8(static_cast<SDLFontStyle *>(font_style)->ttfont, text.c_str(), &w, &h) != 0 || w <= 0 || h <= 0)
+		return NULL;
+
+	return new NullImage(this, w, h);
+}
+
+void NullRenderDevice::drawPixel(int, int, const Color&) {
+}
+
+void NullRenderDevice::drawLine(int, int, int, int, const Color&) {
+}
+
+void NullRenderDevice::drawRectangle(const Point&, const Point&, const Color&) {
+}
+
+void NullRenderDevice::blankScreen() {
+}
+
+void NullRenderDevice::commitFrame() {
+	inpt->window_resized = false;
+
+	draw_calls_last_frame = draw_calls;
+	draw_calls = 0;
+}
+
+void NullRenderDevice::destroyContext() {
+	RenderDevice::cacheRemoveAll();
+	reload_graphics = true;
+	invalidateRenderTargets();
+
+	if (icons) {
+		delete icons;
+		icons = NULL;
+	}
+	if (curs) {
+		delete curs;
+		curs = NULL;
+	}
+}
+
+Image *NullRenderDevice::createImage(int width, int height) {
+	if (width <= 0 || height <= 0)
+		return NULL;
+
+	return new NullImage(this, width, height);
+}
+
+void NullRenderDevice::setGamma(float) {
+}
+
+void NullRenderDevice::resetGamma() {
+}
+
+void NullRenderDevice::updateTitleBar() {
+}
+
+/**
+ * The image is decoded once to get its size
+ */
+Image *NullRenderDevice::loadImage(const std::string& filename, int error_type) {
+	Image *img = cacheLookup(filename);
+	if (img != NULL) return img;
+
+	SDL_Surface *surface = IMG_Load(mods->locate(filename).c_str());
+	if (!surface) {
+		if (error_type != ERROR_NONE)
+			Utils::logError("NullRenderDevice: Couldn't load image: '%s'. %s", filename.c_str(), IMG_GetError());
+
+		if (error_type == ERROR_EXIT) {
+			mods->resetModConfig();
+			Utils::Exit(1);
+		}
+
+		return NULL;
+	}
+
+	NullImage *image = new NullImage(this, surface->w, surface->h);
+	SDL_FreeSurface(surface);
+
+	cacheStore(filename, image);
+	return image;
+}
+
+/**
+ * Takes ownership of the surface
+ */
+Image *NullRenderDevice::loadImageFromSurface(const std::string& filename, SDL_Surface* surface) {
+	if (!surface)
+		return NULL;
+
+	Image *img = cacheLookup(filename);
+	if (img == NULL) {
+		img = new NullImage(this, surface->w, surface->h);
+		cacheStore(filename, img);
+	}
+
+	SDL_FreeSurface(surface);
+	return img;
+}
+
+/**
+ * There is no window, so the window always has the size from the settings
+ */
+void NullRenderDevice::getWindowSize(short unsigned *screen_w, short unsigned *screen_h) {
+	*screen_w = std::max(settings->screen_w, eset->resolutions.min_screen_w);
+	*screen_h = std::max(settings->screen_h, eset->resolutions.min_screen_h);
+}
+
+void NullRenderDevice::windowResize() {
+	windowResizeInternal();
+	settings->updateScreenVars();
+}
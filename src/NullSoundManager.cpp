@@ -0,0 +1,96 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class NullSoundManager
+ */
+
+#ifdef __EMSCRIPTEN__
+#include <SDL/SDL_mixer.h>
+#else
+#include <SDL_mixer.h>
+#endif
+
+#include "NullSoundManager.h"
+
+NullSoundManager::NullSoundManager() {
+	Utils::logInfo("SoundManager: Using NullSoundManager (nothing is played)");
+}
+
+NullSoundManager::~NullSoundManager() {
+}
+
+SoundID NullSoundManager::load(const std::string&, const std::string&) {
+	return 0;
+}
+
+/**
+ * Takes ownership of the chunk
+ */
+SoundID NullSoundManager::loadFromChunk(const std::string&, Mix_Chunk* chunk) {
+	if (chunk)
+		Mix_FreeChunk(chunk);
+	return 0;
+}
+
+void NullSoundManager::unload(SoundID) {
+}
+
+void NullSoundManager::play(SoundID, const std::string&, const FPoint&, bool) {
+}
+
+void NullSoundManager::pauseAll() {
+}
+
+void NullSoundManager::resumeAll() {
+}
+
+void NullSoundManager::setVolumeSFX(int) {
+}
+
+void NullSoundManager::loadMusic(const std::string&) {
+}
+
+void NullSoundManager::unloadMusic() {
+}
+
+void NullSoundManager::playMusic() {
+}
+
+void NullSoundManager::stopMusic() {
+}
+
+void NullSoundManager::setVolumeMusic(int) {
+}
+
+bool NullSoundManager::isPlayingMusic() {
+	return false;
+}
+
+void NullSoundManager::logic(const FPoint&) {
+}
+
+void NullSoundManager::reset() {
+}
+
+SoundID NullSoundManager::getLastPlayedSID() {
+	return 0;
+}
+
+void NullSoundManager::getVoiceStats(VoiceStats& stats) {
+	stats = VoiceStats();
+}
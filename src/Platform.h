@@ -35,6 +35,8 @@ public:
 	void setExitEventFilter();
 	bool dirCreate(const std::string& path);
 	bool dirRemove(const std::string& path);
+	bool fileReplace(const std::string& src, const std::string& dest);
+	bool fileSync(const std::string& path);
 
 	void FSInit();
 	bool FSCheckReady();
@@ -30,6 +30,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include <stdio.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h>
 
@@ -177,6 +178,31 @@ bool Platform::dirRemove(const std::string& path) {
 	return true;
 }
 
+/**
+ * Atomically replace dest with src
+ */
+bool Platform::fileReplace(const std::string& src, const std::string& dest) {
+	if (rename(src.c_str(), dest.c_str()) == -1) {
+		std::string error_msg = "Platform::fileReplace (" + src + " -> " + dest + ")";
+		perror(error_msg.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool Platform::fileSync(const std::string& path) {
+	int fd = open(path.c_str(), O_WRONLY);
+	if (fd == -1 || fsync(fd) == -1) {
+		std::string error_msg = "Platform::fileSync (" + path + ")";
+		perror(error_msg.c_str());
+		if (fd != -1)
+			close(fd);
+		return false;
+	}
+	close(fd);
+	return true;
+}
+
 // unused
 void Platform::FSInit() {}
 bool Platform::FSCheckReady() { return true; }
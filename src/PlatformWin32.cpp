@@ -28,6 +28,11 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include <direct.h>
 
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
 Platform platform;
 
 Platform::Platform()
@@ -93,6 +98,29 @@ bool Platform::dirRemove(const std::string& path) {
 	return true;
 }
 
+/**
+ * Replace dest with src. Unlike rename(), this works when dest already exists.
+ */
+bool Platform::fileReplace(const std::string& src, const std::string& dest) {
+	if (!MoveFileExA(src.c_str(), dest.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+		Utils::logError("Platform::fileReplace (%s -> %s): error %lu", src.c_str(), dest.c_str(), static_cast<unsigned long>(GetLastError()));
+		return false;
+	}
+	return true;
+}
+
+bool Platform::fileSync(const std::string& path) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE || !FlushFileBuffers(file)) {
+		Utils::logError("Platform::fileSync (%s): error %lu", path.c_str(), static_cast<unsigned long>(GetLastError()));
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		return false;
+	}
+	CloseHandle(file);
+	return true;
+}
+
 // unused
 void Platform::FSInit() {}
 bool Platform::FSCheckReady() { return true; }
@@ -65,7 +65,7 @@ Power::Power()
 	, new_state(-1)
 	, state_duration(0)
 	, prevent_interrupt(false)
-	, attack_anim("")
+	, attack_anim(0)
 	, face(false)
 	, source_type(-1)
 	, beacon(false)
@@ -253,7 +253,7 @@ void PowerManager::loadEffects() {
 		}
 		else if (infile.key == "attack_speed_anim") {
 			// @ATTR effect.attack_speed_anim|string|If the type of Effect is attack_speed, this defines the attack animation that will have its speed changed.
-			effects.back().attack_speed_anim = infile.val;
+			effects.back().attack_speed_anim = Utils::internString(infile.val);
 		}
 		else {
 			infile.error("PowerManager: '%s' is not a valid key.", infile.key.c_str());
@@ -325,7 +325,7 @@ void PowerManager::loadPowers() {
 			if (infile.val == "instant") powers[input_id].new_state = Power::STATE_INSTANT;
 			else {
 				powers[input_id].new_state = Power::STATE_ATTACK;
-				powers[input_id].attack_anim = infile.val;
+				powers[input_id].attack_anim = Utils::internString(infile.val);
 			}
 		}
 		else if (infile.key == "state_duration") {
@@ -837,15 +837,15 @@ void PowerManager::loadPowers() {
 		}
 		else if (infile.key == "remove_effect") {
 			// @ATTR power.remove_effect|repeatable(predefined_string, int) : Effect ID, Number of Effect instances|Removes a number of instances of a specific Effect ID. Omitting the number of instances, or setting it to zero, will remove all instances/stacks.
-			std::string first = Parse::popFirstString(infile.val);
+			StringID first = Utils::internString(Parse::popFirstString(infile.val));
 			int second = Parse::popFirstInt(infile.val);
-			powers[input_id].remove_effects.push_back(std::pair<std::string, int>(first, second));
+			powers[input_id].remove_effects.push_back(std::pair<StringID, int>(first, second));
 		}
 		else if (infile.key == "replace_by_effect") {
 			// @ATTR power.replace_by_effect|repeatable(int, predefined_string, int) : Power ID, Effect ID, Number of Effect instances|If the caster has at least the number of instances of the Effect ID, the defined Power ID will be cast instead.
 			PowerReplaceByEffect prbe;
 			prbe.power_id = Parse::popFirstInt(infile.val);
-			prbe.effect_id = Parse::popFirstString(infile.val);
+			prbe.effect_id = Utils::internString(Parse::popFirstString(infile.val));
 			prbe.count = Parse::popFirstInt(infile.val);
 			powers[input_id].replace_by_effect.push_back(prbe);
 		}
@@ -1801,5 +1801,6 @@ PowerManager::~PowerManager() {
 		delete hazards.front();
 		hazards.pop();
 	}
+	anim->cleanUp();
 }
 
@@ -58,7 +58,7 @@ class PowerReplaceByEffect {
 public:
 	int power_id;
 	int count;
-	std::string effect_id;
+	StringID effect_id;
 };
 
 class PowerRequiredItem {
@@ -146,7 +146,7 @@ public:
 	int new_state; // when using this power the user (avatar/enemy) starts a new state
 	int state_duration; // can be used to extend the length of a state animation by pausing on the last frame
 	bool prevent_interrupt; // prevents hits from interrupting the casting state
-	std::string attack_anim; // name of the animation to play when using this power, if it is not block
+	StringID attack_anim; // name of the animation to play when using this power, if it is not block
 	bool face; // does the user turn to face the mouse cursor when using this power?
 	int source_type; //hero, neutral, or enemy
 	bool beacon; //true if it's just an ememy calling its allies
@@ -280,7 +280,7 @@ public:
 	int script_trigger;
 	std::string script;
 
-	std::vector< std::pair<std::string, int> > remove_effects;
+	std::vector< std::pair<StringID, int> > remove_effects; // effect ids are interned, see Utils::internString()
 
 	std::vector<PowerReplaceByEffect> replace_by_effect;
 
@@ -0,0 +1,352 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class Profiler
+ */
+
+#include "Profiler.h"
+#include "Utils.h"
+
+#include <iomanip>
+
+Profiler::Profiler()
+	: sample_frames(0)
+	, history_pos(0)
+	, open_sections(0)
+	, frame_start(0)
+	, enabled(false)
+	, overlay_visible(false)
+	, keep_samples(false)
+	, trace_frames_left(0)
+	, trace_origin(0)
+{
+}
+
+Profiler::~Profiler() {
+}
+
+/**
+ * Returns the id of the section with this name, adding it if needed
+ */
+size_t Profiler::addSection(const std::string& name) {
+	for (size_t i = 0; i < sections.size(); ++i) {
+		if (sections[i].name == name)
+			return i;
+	}
+
+	sections.resize(sections.size() + 1);
+	sections.back().name = name;
+	// sections added later have no samples for the frames that already passed
+	sections.back().samples.resize(sample_frames, 0);
+	return sections.size() - 1;
+}
+
+void Profiler::beginInternal(size_t id) {
+	Section& section = sections[id];
+	section.depth = open_sections;
+	section.open = true;
+	open_sections++;
+	section.start = SDL_GetPerformanceCounter();
+}
+
+void Profiler::endInternal(size_t id) {
+	const uint64_t now = SDL_GetPerformanceCounter();
+
+	Section& section = sections[id];
+
+	// the profiler may have been enabled while this section was running
+	if (!section.open)
+		return;
+
+	section.open = false;
+	open_sections--;
+	section.current += now - section.start;
+
+	if (trace_frames_left > 0) {
+		TraceEvent ev;
+		ev.id = id;
+		ev.start = section.start;
+		ev.end = now;
+		trace_events.push_back(ev);
+	}
+}
+
+/**
+ * Store the time of every section for the frame that just finished
+ */
+void Profiler::endFrame() {
+	if (!enabled)
+		return;
+
+	const uint64_t now = SDL_GetPerformanceCounter();
+
+	for (size_t i = 0; i < sections.size(); ++i) {
+		Section& section = sections[i];
+		section.history[history_pos] = section.current;
+		if (keep_samples)
+			section.samples.push_back(section.current);
+		section.current = 0;
+	}
+
+	history_pos = (history_pos + 1) % HISTORY_SIZE;
+	if (keep_samples)
+		sample_frames++;
+
+	if (trace_frames_left > 0) {
+		TraceEvent frame;
+		frame.id = trace_frames.size();
+		frame.start = std::max(frame_start, trace_origin);
+		frame.end = now;
+		trace_frames.push_back(frame);
+
+		trace_frames_left--;
+		if (trace_frames_left == 0) {
+			writeTrace();
+			trace_events.clear();
+			trace_frames.clear();
+			updateEnabled();
+		}
+	}
+
+	frame_start = now;
+}
+
+/**
+ * Measure only when something uses the measurements
+ */
+void Profiler::updateEnabled() {
+	const bool prev_enabled = enabled;
+	enabled = overlay_visible || keep_samples || trace_frames_left > 0;
+
+	if (enabled && !prev_enabled) {
+		for (size_t i = 0; i < sections.size(); ++i) {
+			sections[i].open = false;
+			sections[i].current = 0;
+		}
+		open_sections = 0;
+		frame_start = SDL_GetPerformanceCounter();
+	}
+}
+
+bool Profiler::isEnabled() const {
+	return enabled;
+}
+
+void Profiler::setOverlayVisible(bool visible) {
+	overlay_visible = visible;
+	updateEnabled();
+}
+
+bool Profiler::isOverlayVisible() const {
+	return overlay_visible;
+}
+
+/**
+ * Keep the time of every frame for writeJSON()
+ */
+void Profiler::setKeepSamples(bool keep) {
+	keep_samples = keep;
+	updateEnabled();
+}
+
+/**
+ * Record every section for the next frame_count frames, then write them to filename
+ * in the Chrome trace event format (open with chrome://tracing or Perfetto).
+ */
+void Profiler::startTrace(unsigned frame_count, const std::string& filename) {
+	trace_events.clear();
+	trace_frames.clear();
+	trace_filename = filename;
+	trace_frames_left = frame_count;
+	trace_origin = SDL_GetPerformanceCounter();
+	updateEnabled();
+}
+
+bool Profiler::isTracing() const {
+	return trace_frames_left > 0;
+}
+
+const std::vector<Profiler::Section>& Profiler::getSections() const {
+	return sections;
+}
+
+/**
+ * Index in Section::history that the next frame will be written to
+ */
+size_t Profiler::getHistoryPos() const {
+	return history_pos;
+}
+
+/**
+ * Discard all samples. Sections stay registered.
+ */
+void Profiler::reset() {
+	for (size_t i = 0; i < sections.size(); ++i) {
+		sections[i].current = 0;
+		sections[i].history.assign(HISTORY_SIZE, 0);
+		sections[i].samples.clear();
+	}
+	sample_frames = 0;
+	history_pos = 0;
+}
+
+/**
+ * Extra values written to the "info" object of the JSON file (e.g. the random seed)
+ */
+void Profiler::setInfo(const std::string& key, const std::string& value) {
+	info[key] = value;
+}
+
+float Profiler::getMilliseconds(uint64_t counter_ticks) const {
+	return static_cast<float>(counter_ticks) * 1000.f / static_cast<float>(SDL_GetPerformanceFrequency());
+}
+
+double Profiler::getMicroseconds(uint64_t counter_ticks) const {
+	return static_cast<double>(counter_ticks) * 1000000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+std::string Profiler::escapeJSON(const std::string& s) {
+	std::string ret;
+	for (size_t i = 0; i < s.length(); ++i) {
+		if (s[i] == '"' || s[i] == '\\')
+			ret += '\\';
+
+		if (static_cast<unsigned char>(s[i]) < 0x20)
+			ret += ' ';
+		else
+			ret += s[i];
+	}
+	return ret;
+}
+
+/**
+ * Write a summary and the per-frame times (in microseconds) of every section
+ */
+bool Profiler::writeJSON(const std::string& filename) const {
+	std::ofstream outfile;
+	outfile.open(filename.c_str(), std::ios::out | std::ios::trunc);
+	if (!outfile.is_open()) {
+		Utils::logError("Profiler: Could not write '%s'.", filename.c_str());
+		return false;
+	}
+
+	outfile << "{\n";
+
+	outfile << "\t\"info\": {";
+	std::map<std::string, std::string>::const_iterator it;
+	for (it = info.begin(); it != info.end(); ++it) {
+		outfile << (it == info.begin() ? "\n" : ",\n");
+		outfile << "\t\t\"" << escapeJSON(it->first) << "\": \"" << escapeJSON(it->second) << "\"";
+	}
+	outfile << (info.empty() ? "},\n" : "\n\t},\n");
+
+	outfile << "\t\"frames\": " << sample_frames << ",\n";
+	outfile << "\t\"sections\": {";
+
+	std::vector<uint64_t> sorted;
+
+	for (size_t i = 0; i < sections.size(); ++i) {
+		const Section& section = sections[i];
+
+		uint64_t total = 0;
+		for (size_t j = 0; j < section.samples.size(); ++j) {
+			total += section.samples[j];
+		}
+
+		sorted = section.samples;
+		std::sort(sorted.begin(), sorted.end());
+
+		const uint64_t p50 = sorted.empty() ? 0 : sorted[(sorted.size() - 1) / 2];
+		const uint64_t p95 = sorted.empty() ? 0 : sorted[((sorted.size() - 1) * 95) / 100];
+		const uint64_t max = sorted.empty() ? 0 : sorted.back();
+		const float mean = sorted.empty() ? 0 : getMilliseconds(total) / static_cast<float>(sorted.size());
+
+		outfile << (i == 0 ? "\n" : ",\n");
+		outfile << "\t\t\"" << escapeJSON(section.name) << "\": {\n";
+		outfile << "\t\t\t\"total_ms\": " << getMilliseconds(total) << ",\n";
+		outfile << "\t\t\t\"mean_ms\": " << mean << ",\n";
+		outfile << "\t\t\t\"p50_ms\": " << getMilliseconds(p50) << ",\n";
+		outfile << "\t\t\t\"p95_ms\": " << getMilliseconds(p95) << ",\n";
+		outfile << "\t\t\t\"max_ms\": " << getMilliseconds(max) << ",\n";
+		outfile << "\t\t\t\"frames_us\": [";
+		for (size_t j = 0; j < section.samples.size(); ++j) {
+			if (j > 0)
+				outfile << ",";
+			outfile << static_cast<unsigned long>(getMicroseconds(section.samples[j]) + 0.5);
+		}
+		outfile << "]\n";
+		outfile << "\t\t}";
+	}
+	outfile << (sections.empty() ? "}\n" : "\n\t}\n");
+
+	outfile << "}\n";
+
+	const bool success = !outfile.fail();
+	outfile.close();
+
+	if (success)
+		Utils::logInfo("Profiler: Wrote timings of %u frames to '%s'.", sample_frames, filename.c_str());
+	else
+		Utils::logError("Profiler: Could not write '%s'.", filename.c_str());
+
+	return success;
+}
+
+/**
+ * Write the captured frames and sections as complete ("X") trace events
+ */
+bool Profiler::writeTrace() const {
+	std::ofstream outfile;
+	outfile.open(trace_filename.c_str(), std::ios::out | std::ios::trunc);
+	if (!outfile.is_open()) {
+		Utils::logError("Profiler: Could not write '%s'.", trace_filename.c_str());
+		return false;
+	}
+
+	outfile << std::fixed << std::setprecision(3);
+	outfile << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+	for (size_t i = 0; i < trace_frames.size(); ++i) {
+		const TraceEvent& frame = trace_frames[i];
+		outfile << (i == 0 ? "" : ",\n");
+		outfile << "{\"name\": \"frame\", \"cat\": \"frame\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1";
+		outfile << ", \"ts\": " << getMicroseconds(frame.start > trace_origin ? frame.start - trace_origin : 0);
+		outfile << ", \"dur\": " << getMicroseconds(frame.end - frame.start);
+		outfile << ", \"args\": {\"frame\": " << frame.id << "}}";
+	}
+
+	for (size_t i = 0; i < trace_events.size(); ++i) {
+		const TraceEvent& ev = trace_events[i];
+		outfile << (i == 0 && trace_frames.empty() ? "" : ",\n");
+		outfile << "{\"name\": \"" << escapeJSON(sections[ev.id].name) << "\", \"cat\": \"flare\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1";
+		outfile << ", \"ts\": " << getMicroseconds(ev.start > trace_origin ? ev.start - trace_origin : 0);
+		outfile << ", \"dur\": " << getMicroseconds(ev.end - ev.start) << "}";
+	}
+
+	outfile << "\n]}\n";
+
+	const bool success = !outfile.fail();
+	outfile.close();
+
+	if (success)
+		Utils::logInfo("Profiler: Wrote a trace of %u frames to '%s'.", static_cast<unsigned>(trace_frames.size()), trace_filename.c_str());
+	else
+		Utils::logError("Profiler: Could not write '%s'.", trace_filename.c_str());
+
+	return success;
+}
@@ -0,0 +1,142 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class Profiler
+ *
+ * Measures how long named sections of code (e.g. "enemym") take on each frame.
+ * Sections are registered once with addSection(), and then timed with begin() and end(),
+ * or with a ProfilerScope. Sections may be nested, but a section can't contain itself.
+ *
+ * Nothing is measured while the profiler is disabled, which is the case unless
+ * the overlay is shown (see ProfilerOverlay), a trace is being captured, or all
+ * samples are kept for writeJSON().
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "CommonIncludes.h"
+#include "SharedResources.h"
+
+class Profiler {
+public:
+	// number of frames that the overlay can show
+	static const size_t HISTORY_SIZE = 120;
+
+	class Section {
+	public:
+		std::string name;
+		int depth; // number of sections that were open when this one began
+		bool open;
+		uint64_t start;
+		uint64_t current; // time spent during the current frame
+		std::vector<uint64_t> history; // time spent during the last HISTORY_SIZE frames
+		std::vector<uint64_t> samples; // time spent during every frame, if samples are kept
+
+		Section()
+			: depth(0)
+			, open(false)
+			, start(0)
+			, current(0)
+			, history(HISTORY_SIZE, 0) {
+		}
+	};
+
+private:
+	class TraceEvent {
+	public:
+		size_t id;
+		uint64_t start;
+		uint64_t end;
+	};
+
+	void beginInternal(size_t id);
+	void endInternal(size_t id);
+	void updateEnabled();
+	bool writeTrace() const;
+	static std::string escapeJSON(const std::string& s);
+	double getMicroseconds(uint64_t counter_ticks) const;
+
+	std::vector<Section> sections;
+	std::map<std::string, std::string> info;
+	unsigned sample_frames; // number of frames in Section::samples
+	size_t history_pos;
+	int open_sections;
+	uint64_t frame_start;
+	bool enabled;
+	bool overlay_visible;
+	bool keep_samples;
+
+	// trace capture
+	std::vector<TraceEvent> trace_events;
+	std::vector<TraceEvent> trace_frames; // id is the frame number
+	std::string trace_filename;
+	unsigned trace_frames_left;
+	uint64_t trace_origin;
+
+public:
+	Profiler();
+	~Profiler();
+
+	size_t addSection(const std::string& name);
+
+	void begin(size_t id) {
+		if (enabled) beginInternal(id);
+	}
+	void end(size_t id) {
+		if (enabled) endInternal(id);
+	}
+
+	void endFrame();
+
+	bool isEnabled() const;
+	void setOverlayVisible(bool visible);
+	bool isOverlayVisible() const;
+	void setKeepSamples(bool keep);
+	void startTrace(unsigned frame_count, const std::string& filename);
+	bool isTracing() const;
+
+	const std::vector<Section>& getSections() const;
+	size_t getHistoryPos() const;
+	float getMilliseconds(uint64_t counter_ticks) const;
+
+	void reset();
+	void setInfo(const std::string& key, const std::string& value);
+	bool writeJSON(const std::string& filename) const;
+};
+
+/**
+ * class ProfilerScope
+ *
+ * Times a section of the shared profiler from its construction until the end of the scope.
+ */
+class ProfilerScope {
+private:
+	size_t id;
+
+public:
+	explicit ProfilerScope(size_t _id)
+		: id(_id) {
+		profiler->begin(id);
+	}
+	~ProfilerScope() {
+		profiler->end(id);
+	}
+};
+
+#endif
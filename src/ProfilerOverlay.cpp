@@ -0,0 +1,160 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class ProfilerOverlay
+ */
+
+#include "FontEngine.h"
+#include "Profiler.h"
+#include "ProfilerOverlay.h"
+#include "RenderDevice.h"
+#include "Settings.h"
+#include "SharedResources.h"
+#include "WidgetLabel.h"
+
+ProfilerOverlay::ProfilerOverlay()
+	: update_timer()
+{
+	// update the table 4 times per second, like the fps counter
+	update_timer.setDuration(settings->max_frames_per_sec / 4);
+}
+
+ProfilerOverlay::~ProfilerOverlay() {
+	for (size_t i = 0; i < labels.size(); ++i) {
+		delete labels[i];
+	}
+}
+
+/**
+ * Colors of the top level sections in the graph
+ */
+Color ProfilerOverlay::getSectionColor(size_t index) const {
+	const Color colors[COLOR_COUNT] = {
+		Color(80, 160, 255, 255),
+		Color(255, 160, 64, 255),
+		Color(96, 224, 96, 255),
+		Color(224, 96, 224, 255),
+		Color(240, 224, 80, 255),
+		Color(96, 224, 224, 255)
+	};
+	return colors[index % COLOR_COUNT];
+}
+
+/**
+ * One row per section that has been used during the recent frames, indented by nesting depth
+ */
+void ProfilerOverlay::updateLabels() {
+	const std::vector<Profiler::Section>& sections = profiler->getSections();
+	const size_t last = (profiler->getHistoryPos() + Profiler::HISTORY_SIZE - 1) % Profiler::HISTORY_SIZE;
+
+	while (labels.size() < sections.size()) {
+		labels.push_back(new WidgetLabel());
+	}
+
+	font->setFont(WidgetLabel::DEFAULT_FONT);
+	const int line_height = font->getLineHeight();
+
+	int y = PADDING * 2 + GRAPH_HEIGHT;
+	size_t top_level = 0;
+
+	for (size_t i = 0; i < sections.size(); ++i) {
+		const Profiler::Section& section = sections[i];
+
+		uint64_t total = 0;
+		uint64_t max = 0;
+		for (size_t j = 0; j < Profiler::HISTORY_SIZE; ++j) {
+			total += section.history[j];
+			max = std::max(max, section.history[j]);
+		}
+
+		const bool is_top_level = (section.depth == 0);
+		const Color color = is_top_level ? getSectionColor(top_level) : font->getColor(FontEngine::COLOR_WHITE);
+		if (is_top_level)
+			top_level++;
+
+		if (max == 0) {
+			labels[i]->setHidden(true);
+			continue;
+		}
+
+		std::stringstream ss;
+		ss << std::string(static_cast<size_t>(section.depth) * 2, ' ') << section.name << ": ";
+		ss << Utils::floatToString(profiler->getMilliseconds(section.history[last]), 2) << " / ";
+		ss << Utils::floatToString(profiler->getMilliseconds(total) / static_cast<float>(Profiler::HISTORY_SIZE), 2) << " / ";
+		ss << Utils::floatToString(profiler->getMilliseconds(max), 2) << " ms";
+
+		labels[i]->setHidden(false);
+		labels[i]->setPos(PADDING + section.depth * PADDING, y);
+		labels[i]->setText(ss.str());
+		labels[i]->setColor(color);
+
+		y += line_height;
+	}
+}
+
+void ProfilerOverlay::render() {
+	if (update_timer.isEnd()) {
+		update_timer.reset(Timer::BEGIN);
+		updateLabels();
+	}
+	update_timer.tick();
+
+	const std::vector<Profiler::Section>& sections = profiler->getSections();
+
+	// the middle of the graph is the time available for one frame
+	const float frame_ms = 1000.f / static_cast<float>(settings->max_frames_per_sec);
+	const float pixels_per_ms = static_cast<float>(GRAPH_HEIGHT) / (frame_ms * 2.f);
+
+	const int graph_w = static_cast<int>(Profiler::HISTORY_SIZE) * GRAPH_BAR_WIDTH;
+	const int bottom = PADDING + GRAPH_HEIGHT;
+
+	// oldest frame on the left
+	for (size_t i = 0; i < Profiler::HISTORY_SIZE; ++i) {
+		const size_t frame = (profiler->getHistoryPos() + i) % Profiler::HISTORY_SIZE;
+		const int x = PADDING + static_cast<int>(i) * GRAPH_BAR_WIDTH;
+		int y = bottom;
+		size_t top_level = 0;
+
+		for (size_t j = 0; j < sections.size() && y > PADDING; ++j) {
+			if (sections[j].depth != 0)
+				continue;
+
+			const Color color = getSectionColor(top_level);
+			top_level++;
+
+			int h = static_cast<int>(profiler->getMilliseconds(sections[j].history[frame]) * pixels_per_ms);
+			h = std::min(h, y - PADDING);
+			if (h <= 0)
+				continue;
+
+			for (int k = 0; k < GRAPH_BAR_WIDTH; ++k) {
+				render_device->drawLine(x + k, y - 1, x + k, y - h, color);
+			}
+			y -= h;
+		}
+	}
+
+	const Color color_frame(255, 255, 255, 255);
+	render_device->drawLine(PADDING, bottom - GRAPH_HEIGHT / 2, PADDING + graph_w, bottom - GRAPH_HEIGHT / 2, color_frame);
+	render_device->drawRectangle(Point(PADDING - 1, PADDING - 1), Point(PADDING + graph_w, bottom), color_frame);
+
+	for (size_t i = 0; i < labels.size(); ++i) {
+		if (!labels[i]->isHidden())
+			labels[i]->render();
+	}
+}
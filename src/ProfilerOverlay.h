@@ -0,0 +1,55 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class ProfilerOverlay
+ *
+ * Draws the recent frames of the shared Profiler: a graph of the top level sections
+ * (e.g. "logic" and "render") stacked on top of each other, and a table with the last,
+ * average and highest time of every section. Toggled with the "profiler" command of
+ * the developer console.
+ */
+
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+class WidgetLabel;
+
+class ProfilerOverlay {
+private:
+	static const int PADDING = 8;
+	static const int GRAPH_HEIGHT = 64;
+	static const int GRAPH_BAR_WIDTH = 2;
+	static const size_t COLOR_COUNT = 6;
+
+	void updateLabels();
+	Color getSectionColor(size_t index) const;
+
+	std::vector<WidgetLabel*> labels;
+	Timer update_timer;
+
+public:
+	ProfilerOverlay();
+	~ProfilerOverlay();
+
+	void render();
+};
+
+#endif
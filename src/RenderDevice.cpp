@@ -160,6 +160,10 @@ RenderDevice::RenderDevice()
 	, min_screen(640, 480)
 	, is_initialized(false)
 	, reload_graphics(false)
+	, render_target_version(0)
+	, batching_enabled(true)
+	, draw_calls(0)
+	, draw_calls_last_frame(0)
 	, ddpi(0)
 {
 	// don't bother initializing gamma_r, gamma_g, gamma_b
@@ -252,6 +256,25 @@ void RenderDevice::cacheRemoveAll() {
 	}
 }
 
+void RenderDevice::beginBatch() {
+}
+
+void RenderDevice::endBatch() {
+}
+
+void RenderDevice::setBatching(bool enable) {
+	endBatch();
+	batching_enabled = enable;
+}
+
+bool RenderDevice::isBatching() const {
+	return batching_enabled;
+}
+
+int RenderDevice::getDrawCalls() const {
+	return draw_calls_last_frame;
+}
+
 bool RenderDevice::localToGlobal(Sprite *r) {
 	m_clip = r->getClip();
 
@@ -306,6 +329,14 @@ bool RenderDevice::reloadGraphics() {
 	return false;
 }
 
+unsigned RenderDevice::getRenderTargetVersion() const {
+	return render_target_version;
+}
+
+void RenderDevice::invalidateRenderTargets() {
+	render_target_version++;
+}
+
 void RenderDevice::freeImage(Image *image) {
 	if (!image) return;
 
@@ -318,6 +349,8 @@ void RenderDevice::windowResizeInternal() {
 	unsigned short old_screen_w = settings->screen_w;
 	unsigned short old_screen_h = settings->screen_h;
 
+	invalidateRenderTargets();
+
 	getWindowSize(&settings->screen_w, &settings->screen_h);
 
 	unsigned short temp_screen_h;
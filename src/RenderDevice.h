@@ -124,6 +124,7 @@ private:
 	virtual ~Image();
 	friend class SDLSoftwareImage;
 	friend class SDLHardwareImage;
+	friend class NullImage;
 
 private:
 	RenderDevice *device;
@@ -212,6 +213,7 @@ public:
 
 	/** factory functions for Image */
 	virtual Image *loadImage(const std::string& filename, int error_type) = 0;
+	virtual Image *loadImageFromSurface(const std::string& filename, SDL_Surface* surface) = 0;
 	virtual Image *createImage(int width, int height) = 0;
 	void freeImage(Image *image);
 
@@ -219,6 +221,9 @@ public:
 	virtual int render(Sprite* r) = 0;
 	virtual int render(Renderable& r, Rect& dest) = 0;
 	virtual int renderToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest) = 0;
+	virtual int renderRectsToImage(Image* src_image, const std::vector<Rect>& src, Image* dest_image, const std::vector<Rect>& dest, const Color& color_mod) = 0;
+	virtual int copyToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest) = 0;
+	virtual int composeToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest) = 0;
 	virtual Image* renderTextToImage(FontStyle* font_style, const std::string& text, const Color& color, bool blended) = 0;
 	virtual void blankScreen() = 0;
 	virtual void commitFrame() = 0;
@@ -229,8 +234,30 @@ public:
 	virtual void windowResize() = 0;
 	virtual void setBackgroundColor(Color color);
 
+	/** Sprite batching
+	 * Between beginBatch() and endBatch(), render(Sprite*) calls may be queued and merged into fewer draw calls.
+	 * Devices that can't batch, like the software renderer, draw immediately with one blit per sprite.
+	 */
+	virtual void beginBatch();
+	virtual void endBatch();
+	void setBatching(bool enable);
+	bool isBatching() const;
+
+	/**
+	 * Number of draw calls issued during the last committed frame.
+	 * Every copy of an image area counts, whether it is drawn to the screen or into another image.
+	 * Pixels, lines, rectangles, clearing the screen and presenting the frame don't count.
+	 */
+	int getDrawCalls() const;
+
 	bool reloadGraphics();
 
+	/** Changes whenever images that were drawn into may have lost their contents,
+	 * e.g. when the renderer was reset. Such images have to be drawn again.
+	 */
+	unsigned getRenderTargetVersion() const;
+	void invalidateRenderTargets();
+
 protected:
 	/* Compute clipping and global position from local frame. */
 	bool localToGlobal(Sprite *r);
@@ -255,6 +282,11 @@ protected:
 
 	bool is_initialized;
 	bool reload_graphics;
+	unsigned render_target_version;
+
+	bool batching_enabled;
+	int draw_calls;
+	int draw_calls_last_frame;
 
 	float ddpi;
 
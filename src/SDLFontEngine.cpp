@@ -31,10 +31,62 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "Settings.h"
 #include "UtilsParsing.h"
 
-SDLFontStyle::SDLFontStyle() : FontStyle(), ttfont(NULL) {
+namespace {
+	/**
+	 * Read the UTF-8 character at pos. Returns its length in bytes, or 0 if it isn't valid UTF-8.
+	 */
+	size_t decodeUTF8(const std::string& text, size_t pos, uint32_t& codepoint) {
+		unsigned char c = static_cast<unsigned char>(text[pos]);
+		size_t length;
+
+		if (c < 0x80) {
+			codepoint = c;
+			return 1;
+		}
+		else if ((c & 0xe0) == 0xc0) {
+			length = 2;
+			codepoint = c & 0x1f;
+		}
+		else if ((c & 0xf0) == 0xe0) {
+			length = 3;
+			codepoint = c & 0x0f;
+		}
+		else if ((c & 0xf8) == 0xf0) {
+			length = 4;
+			codepoint = c & 0x07;
+		}
+		else {
+			return 0;
+		}
+
+		if (pos + length > text.length())
+			return 0;
+
+		for (size_t i = 1; i < length; ++i) {
+			c = static_cast<unsigned char>(text[pos+i]);
+			if ((c & 0xc0) != 0x80)
+				return 0;
+			codepoint = (codepoint << 6) | (c & 0x3f);
+		}
+
+		return length;
+	}
+}
+
+SDLFontStyle::SDLFontStyle()
+	: FontStyle()
+	, ttfont(NULL)
+	, atlas_row_height(0) {
 }
 
-SDLFontEngine::SDLFontEngine() : FontEngine(), active_font(NULL) {
+SDLFontEngine::SDLFontEngine()
+	: FontEngine()
+	, active_font(NULL)
+	, layout_font(NULL)
+	, layout_valid(false)
+	, layout_width(0)
+	, render_target_version(0)
+{
 	// Initiate SDL_ttf
 	if(!TTF_WasInit() && TTF_Init()==-1) {
 		Utils::logError("SDLFontEngine: TTF_Init: %s", TTF_GetError());
@@ -115,6 +167,9 @@ int SDLFontEngine::getFontHeight() {
  * For single-line text, just calculate the width
  */
 int SDLFontEngine::calc_width(const std::string& text) {
+	if (layoutText(text))
+		return layout_width;
+
 	int w, h;
 	TTF_SizeUTF8(active_font->ttfont, text.c_str(), &w, &h);
 
@@ -204,6 +259,43 @@ void SDLFontEngine::renderInternal(const std::string& text, int x, int y, int ju
 
 	Rect dest_rect = position(text, x, y, justify);
 
+	if (layoutText(text)) {
+		// draw the glyphs of each atlas page together
+		for (size_t page = 0; page < active_font->atlas_pages.size(); ++page) {
+			glyph_src.clear();
+			glyph_dest.clear();
+
+			for (size_t i = 0; i < layout.size(); ++i) {
+				const SDLGlyph* glyph = layout[i].glyph;
+				if (glyph->page != page || glyph->src.w == 0)
+					continue;
+
+				glyph_src.push_back(glyph->src);
+				glyph_dest.push_back(Rect(dest_rect.x + layout[i].x + glyph->image_x, dest_rect.y, glyph->src.w, glyph->src.h));
+			}
+
+			if (glyph_src.empty())
+				continue;
+
+			if (target) {
+				render_device->renderRectsToImage(active_font->atlas_pages[page], glyph_src, target, glyph_dest, color);
+			}
+			else {
+				Sprite* temp_sprite = active_font->atlas_pages[page]->createSprite();
+				if (temp_sprite) {
+					temp_sprite->color_mod = color;
+					for (size_t i = 0; i < glyph_src.size(); ++i) {
+						temp_sprite->setClipFromRect(glyph_src[i]);
+						temp_sprite->setDestFromRect(glyph_dest[i]);
+						render_device->render(temp_sprite);
+					}
+					delete temp_sprite;
+				}
+			}
+		}
+		return;
+	}
+
 	// Render text into target
 	graphics = render_device->renderTextToImage(active_font, text, color, active_font->blend);
 	if (graphics) {
@@ -227,7 +319,156 @@ void SDLFontEngine::renderInternal(const std::string& text, int x, int y, int ju
 	}
 }
 
+/**
+ * Get a glyph of the active font, adding it to the atlas if needed.
+ * Returns NULL if the glyph has to be drawn as part of a whole string instead.
+ */
+const SDLGlyph* SDLFontEngine::getGlyph(uint32_t codepoint, const std::string& character) {
+	std::map<uint32_t, SDLGlyph>::iterator it = active_font->glyphs.find(codepoint);
+	if (it != active_font->glyphs.end())
+		return (it->second.valid ? &(it->second) : NULL);
+
+	SDLGlyph& glyph = active_font->glyphs[codepoint];
+
+	// TTF_GlyphMetrics() only supports the basic multilingual plane
+	int minx, maxx, miny, maxy, advance;
+	if (codepoint > 0xffff || TTF_GlyphMetrics(active_font->ttfont, static_cast<Uint16>(codepoint), &minx, &maxx, &miny, &maxy, &advance) != 0)
+		return NULL;
+
+	glyph.minx = minx;
+	glyph.image_x = std::min(0, minx);
+	glyph.right = std::max(maxx, advance);
+	glyph.advance = advance;
+
+	// nothing is drawn for characters like spaces
+	Image *graphics = render_device->renderTextToImage(active_font, character, Color(255, 255, 255), active_font->blend);
+	if (!graphics) {
+		glyph.valid = true;
+		return &glyph;
+	}
+
+	const int w = graphics->getWidth();
+	const int h = graphics->getHeight();
+	if (w > ATLAS_SIZE || h > ATLAS_SIZE) {
+		graphics->unref();
+		return NULL;
+	}
+
+	// fill the atlas row by row, leaving a pixel between glyphs so that filtering doesn't mix them
+	if (active_font->atlas_cursor.x + w > ATLAS_SIZE) {
+		active_font->atlas_cursor.x = 0;
+		active_font->atlas_cursor.y += active_font->atlas_row_height;
+		active_font->atlas_row_height = 0;
+	}
+
+	if (active_font->atlas_pages.empty() || active_font->atlas_cursor.y + h > ATLAS_SIZE) {
+		Image *page = render_device->createImage(ATLAS_SIZE, ATLAS_SIZE);
+		if (!page || page->getWidth() == 0) {
+			Utils::logError("SDLFontEngine: Could not create glyph atlas.");
+			if (page)
+				page->unref();
+			graphics->unref();
+			return NULL;
+		}
+
+		active_font->atlas_pages.push_back(page);
+		active_font->atlas_cursor = Point();
+		active_font->atlas_row_height = 0;
+	}
+
+	Rect src(0, 0, w, h);
+	glyph.page = active_font->atlas_pages.size() - 1;
+	glyph.src = Rect(active_font->atlas_cursor.x, active_font->atlas_cursor.y, w, h);
+	render_device->copyToImage(graphics, src, active_font->atlas_pages.back(), glyph.src);
+	graphics->unref();
+
+	active_font->atlas_cursor.x += w + 1;
+	active_font->atlas_row_height = std::max(active_font->atlas_row_height, h + 1);
+
+	glyph.valid = true;
+	return &glyph;
+}
+
+/**
+ * Position the glyphs of a single line of text, the same way SDL_ttf does (without kerning).
+ * Returns false if the text has to be rendered as a whole.
+ */
+bool SDLFontEngine::layoutText(const std::string& text) {
+	if (!settings->font_atlas || !active_font->ttfont)
+		return false;
+
+	// the atlas pages are render targets, which may have lost their contents
+	if (render_target_version != render_device->getRenderTargetVersion()) {
+		clearGlyphCache();
+		render_target_version = render_device->getRenderTargetVersion();
+	}
+
+	if (layout_font == active_font && layout_text == text)
+		return layout_valid;
+
+	layout_font = active_font;
+	layout_text = text;
+	layout_valid = false;
+	layout.clear();
+	layout_width = 0;
+
+	int pen = 0;
+	int min_x = 0;
+	int max_x = 0;
+
+	size_t pos = 0;
+	while (pos < text.length()) {
+		uint32_t codepoint;
+		size_t length = decodeUTF8(text, pos, codepoint);
+		if (length == 0)
+			return false;
+
+		GlyphPos glyph_pos;
+		glyph_pos.glyph = getGlyph(codepoint, text.substr(pos, length));
+		if (!glyph_pos.glyph)
+			return false;
+
+		glyph_pos.x = pen;
+		layout.push_back(glyph_pos);
+
+		min_x = std::min(min_x, pen + glyph_pos.glyph->minx);
+		max_x = std::max(max_x, pen + glyph_pos.glyph->right);
+		pen += glyph_pos.glyph->advance;
+		pos += length;
+	}
+
+	// glyphs that reach left of the pen's start position shift the whole line
+	for (size_t i = 0; i < layout.size(); ++i) {
+		layout[i].x -= min_x;
+	}
+
+	layout_width = max_x - min_x;
+	layout_valid = true;
+	return true;
+}
+
+/**
+ * Free the glyph atlases. Glyphs will be rendered again the next time they are used.
+ */
+void SDLFontEngine::clearGlyphCache() {
+	for (size_t i = 0; i < font_styles.size(); ++i) {
+		for (size_t j = 0; j < font_styles[i].atlas_pages.size(); ++j) {
+			font_styles[i].atlas_pages[j]->unref();
+		}
+		font_styles[i].atlas_pages.clear();
+		font_styles[i].glyphs.clear();
+		font_styles[i].atlas_cursor = Point();
+		font_styles[i].atlas_row_height = 0;
+	}
+
+	layout_font = NULL;
+	layout_text.clear();
+	layout_valid = false;
+	layout.clear();
+}
+
 SDLFontEngine::~SDLFontEngine() {
+	clearGlyphCache();
 	for (unsigned int i=0; i<font_styles.size(); ++i) TTF_CloseFont(font_styles[i].ttfont);
 	TTF_Quit();
 }
@@ -23,12 +23,38 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "FontEngine.h"
 #include <SDL_ttf.h>
 
+class SDLGlyph {
+public:
+	bool valid; // false if the glyph can't be drawn from the atlas
+	size_t page;
+	Rect src; // area in the atlas page, empty if there is nothing to draw (e.g. a space)
+	int minx; // left edge of the glyph, relative to the pen position
+	int image_x; // left edge of src, relative to the pen position
+	int right; // right edge of the glyph or its advance, whichever is larger
+	int advance;
+
+	SDLGlyph()
+		: valid(false)
+		, page(0)
+		, minx(0)
+		, image_x(0)
+		, right(0)
+		, advance(0) {
+	}
+};
+
 class SDLFontStyle : public FontStyle {
 public:
 	SDLFontStyle();
 	~SDLFontStyle() {};
 
 	TTF_Font *ttfont;
+
+	// glyphs are rendered in white once and tinted when drawn
+	std::map<uint32_t, SDLGlyph> glyphs;
+	std::vector<Image*> atlas_pages;
+	Point atlas_cursor;
+	int atlas_row_height;
 };
 
 /**
@@ -40,9 +66,34 @@ public:
 
 class SDLFontEngine : public FontEngine {
 private:
+	class GlyphPos {
+	public:
+		const SDLGlyph* glyph;
+		int x;
+	};
+
+	static const int ATLAS_SIZE = 512;
+
+	const SDLGlyph* getGlyph(uint32_t codepoint, const std::string& character);
+	bool layoutText(const std::string& text);
+
 	std::vector<SDLFontStyle> font_styles;
 	SDLFontStyle *active_font;
 
+	// the last string passed to layoutText()
+	std::string layout_text;
+	SDLFontStyle *layout_font;
+	bool layout_valid;
+	std::vector<GlyphPos> layout;
+	int layout_width;
+
+	// see RenderDevice::getRenderTargetVersion(), atlas pages are rendered again when it changes
+	unsigned render_target_version;
+
+	// kept between calls to avoid reallocating
+	std::vector<Rect> glyph_src;
+	std::vector<Rect> glyph_dest;
+
 protected:
 	void renderInternal(const std::string& text, int x, int y, int justify, Image *target, const Color& color);
 
@@ -57,6 +108,8 @@ public:
 
 	int calc_width(const std::string& text);
 	std::string trimTextToWidth(const std::string& text, const int width, const bool use_ellipsis, size_t left_pos);
+
+	void clearGlyphCache();
 };
 
 #endif
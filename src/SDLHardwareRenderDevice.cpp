@@ -209,6 +209,9 @@ SDLHardwareRenderDevice::SDLHardwareRenderDevice()
 	, titlebar_icon(NULL)
 	, title(NULL)
 	, background_color(0,0,0,0)
+	, compose_blend_mode(SDL_BLENDMODE_BLEND)
+	, premultiplied_blend_mode(SDL_BLENDMODE_BLEND)
+	, batch_active(false)
 {
 	Utils::logInfo("Using Render Device: SDLHardwareRenderDevice (hardware, SDL 2, %s)", SDL_GetCurrentVideoDriver());
 
@@ -220,6 +223,8 @@ SDLHardwareRenderDevice::SDLHardwareRenderDevice()
 	min_screen.x = eset->resolutions.min_screen_w;
 	min_screen.y = eset->resolutions.min_screen_h;
 
+	initBlendModes();
+
 	SDL_DisplayMode desktop;
 	if (SDL_GetDesktopDisplayMode(0, &desktop) == 0) {
 		// we only support display #0
@@ -227,6 +232,23 @@ SDLHardwareRenderDevice::SDLHardwareRenderDevice()
 	}
 }
 
+/**
+ * Blend modes for composeToImage(). Requires SDL 2.0.6 and a renderer that supports them.
+ */
+void SDLHardwareRenderDevice::initBlendModes() {
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+	// the source has straight alpha, the destination accumulates premultiplied colors
+	compose_blend_mode = SDL_ComposeCustomBlendMode(
+		SDL_BLENDFACTOR_SRC_ALPHA, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+
+	// draws an image with premultiplied colors
+	premultiplied_blend_mode = SDL_ComposeCustomBlendMode(
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+#endif
+}
+
 int SDLHardwareRenderDevice::createContextInternal() {
 	bool settings_changed = (fullscreen != settings->fullscreen ||
 			                 hwsurface != settings->hwsurface ||
@@ -353,6 +375,8 @@ void SDLHardwareRenderDevice::createContextError() {
 }
 
 int SDLHardwareRenderDevice::render(Renderable& r, Rect& dest) {
+	flushBatch();
+
 	dest.w = r.src.w;
 	dest.h = r.src.h;
     SDL_Rect src = r.src;
@@ -371,6 +395,7 @@ int SDLHardwareRenderDevice::render(Renderable& r, Rect& dest) {
 	SDL_SetTextureColorMod(surface, r.color_mod.r, r.color_mod.g, r.color_mod.b);
 	SDL_SetTextureAlphaMod(surface, r.alpha_mod);
 
+	draw_calls++;
 	return SDL_RenderCopy(renderer, surface, &src, &_dest);
 }
 
@@ -400,19 +425,180 @@ int SDLHardwareRenderDevice::render(Sprite *r) {
 
     SDL_Rect src = m_clip;
     SDL_Rect dest = m_dest;
-	SDL_SetRenderTarget(renderer, texture);
 
 	SDL_Texture *surface = static_cast<SDLHardwareImage *>(r->getGraphics())->surface;
+
+	if (batch_active) {
+		queueQuad(surface, src, dest, r->color_mod, r->alpha_mod);
+		return 0;
+	}
+
+	SDL_SetRenderTarget(renderer, texture);
+
 	SDL_SetTextureColorMod(surface, r->color_mod.r, r->color_mod.g, r->color_mod.b);
 	SDL_SetTextureAlphaMod(surface, r->alpha_mod);
 
-	return SDL_RenderCopy(renderer, static_cast<SDLHardwareImage *>(r->getGraphics())->surface, &src, &dest);
+	draw_calls++;
+	return SDL_RenderCopy(renderer, surface, &src, &dest);
+}
+
+void SDLHardwareRenderDevice::beginBatch() {
+	if (!batching_enabled)
+		return;
+
+	batch_active = true;
+}
+
+void SDLHardwareRenderDevice::endBatch() {
+	flushBatch();
+	batch_active = false;
+}
+
+/**
+ * Add a sprite to the batch of its texture.
+ * The sprite may join an earlier batch, but only if it doesn't overlap anything that is drawn in between.
+ * This keeps the painter's order wherever sprites actually overlap.
+ */
+void SDLHardwareRenderDevice::queueQuad(SDL_Texture *surface, const SDL_Rect& src, const SDL_Rect& dest, const Color& color, uint8_t alpha) {
+	const Rect dest_rect(dest.x, dest.y, dest.w, dest.h);
+
+	size_t target = batches.size();
+	for (size_t i = batches.size(), looked = 0; i > 0 && looked < BATCH_LOOKBACK; --i, ++looked) {
+		const Batch& b = batches[i-1];
+		if (b.texture == surface) {
+			target = i-1;
+			break;
+		}
+		// Utils::rectsOverlap() only tests corners, which misses rectangles that cross each other
+		if (dest_rect.x < b.bounds.x + b.bounds.w && b.bounds.x < dest_rect.x + dest_rect.w &&
+			dest_rect.y < b.bounds.y + b.bounds.h && b.bounds.y < dest_rect.y + dest_rect.h)
+			break;
+	}
+
+	if (target == batches.size()) {
+		Batch b;
+		b.texture = surface;
+		b.bounds = dest_rect;
+		b.count = 0;
+		batches.push_back(b);
+	}
+	else {
+		Rect& bounds = batches[target].bounds;
+		const int x1 = std::max(bounds.x + bounds.w, dest_rect.x + dest_rect.w);
+		const int y1 = std::max(bounds.y + bounds.h, dest_rect.y + dest_rect.h);
+		bounds.x = std::min(bounds.x, dest_rect.x);
+		bounds.y = std::min(bounds.y, dest_rect.y);
+		bounds.w = x1 - bounds.x;
+		bounds.h = y1 - bounds.y;
+	}
+
+	BatchQuad q;
+	q.src = src;
+	q.dest = dest;
+	q.color = color;
+	q.alpha = alpha;
+	q.batch = target;
+	batch_quads.push_back(q);
+	batches[target].count++;
+}
+
+/**
+ * Draw all queued sprites, one draw call per batch
+ */
+void SDLHardwareRenderDevice::flushBatch() {
+	if (batch_quads.empty())
+		return;
+
+	// group the quads by batch, keeping their queued order within each batch
+	std::vector<size_t> offsets(batches.size() + 1, 0);
+	for (size_t i = 0; i < batches.size(); ++i) {
+		offsets[i+1] = offsets[i] + batches[i].count;
+	}
+	batch_sorted.resize(batch_quads.size());
+	for (size_t i = 0; i < batch_quads.size(); ++i) {
+		batch_sorted[offsets[batch_quads[i].batch]++] = batch_quads[i];
+	}
+
+	SDL_SetRenderTarget(renderer, texture);
+
+	const BatchQuad* quads = &batch_sorted[0];
+	for (size_t i = 0; i < batches.size(); ++i) {
+		drawBatch(batches[i], quads);
+		quads += batches[i].count;
+	}
+
+	batches.clear();
+	batch_quads.clear();
+}
+
+void SDLHardwareRenderDevice::drawBatch(const Batch& batch, const BatchQuad* quads) {
+#if SDL_VERSION_ATLEAST(2,0,18)
+	int tex_w = 0;
+	int tex_h = 0;
+	if (batch.count > 1 && SDL_QueryTexture(batch.texture, NULL, NULL, &tex_w, &tex_h) == 0 && tex_w > 0 && tex_h > 0) {
+		batch_vertices.resize(batch.count * 4);
+		batch_indices.resize(batch.count * 6);
+
+		for (size_t i = 0; i < batch.count; ++i) {
+			const BatchQuad& q = quads[i];
+			const float u0 = static_cast<float>(q.src.x) / static_cast<float>(tex_w);
+			const float v0 = static_cast<float>(q.src.y) / static_cast<float>(tex_h);
+			const float u1 = static_cast<float>(q.src.x + q.src.w) / static_cast<float>(tex_w);
+			const float v1 = static_cast<float>(q.src.y + q.src.h) / static_cast<float>(tex_h);
+			const float x0 = static_cast<float>(q.dest.x);
+			const float y0 = static_cast<float>(q.dest.y);
+			const float x1 = static_cast<float>(q.dest.x + q.dest.w);
+			const float y1 = static_cast<float>(q.dest.y + q.dest.h);
+
+			SDL_Vertex* v = &batch_vertices[i*4];
+			for (int j = 0; j < 4; ++j) {
+				v[j].color.r = q.color.r;
+				v[j].color.g = q.color.g;
+				v[j].color.b = q.color.b;
+				v[j].color.a = q.alpha;
+			}
+			v[0].position.x = x0; v[0].position.y = y0; v[0].tex_coord.x = u0; v[0].tex_coord.y = v0;
+			v[1].position.x = x1; v[1].position.y = y0; v[1].tex_coord.x = u1; v[1].tex_coord.y = v0;
+			v[2].position.x = x1; v[2].position.y = y1; v[2].tex_coord.x = u1; v[2].tex_coord.y = v1;
+			v[3].position.x = x0; v[3].position.y = y1; v[3].tex_coord.x = u0; v[3].tex_coord.y = v1;
+
+			int* index = &batch_indices[i*6];
+			const int first = static_cast<int>(i*4);
+			index[0] = first;
+			index[1] = first + 1;
+			index[2] = first + 2;
+			index[3] = first;
+			index[4] = first + 2;
+			index[5] = first + 3;
+		}
+
+		// the color and alpha of each sprite are in its vertices
+		SDL_SetTextureColorMod(batch.texture, 255, 255, 255);
+		SDL_SetTextureAlphaMod(batch.texture, 255);
+
+		if (SDL_RenderGeometry(renderer, batch.texture, &batch_vertices[0], static_cast<int>(batch_vertices.size()), &batch_indices[0], static_cast<int>(batch_indices.size())) == 0) {
+			draw_calls++;
+			return;
+		}
+	}
+#endif
+
+	// single sprites, old SDL versions, or SDL_RenderGeometry() failed
+	for (size_t i = 0; i < batch.count; ++i) {
+		const BatchQuad& q = quads[i];
+		SDL_SetTextureColorMod(batch.texture, q.color.r, q.color.g, q.color.b);
+		SDL_SetTextureAlphaMod(batch.texture, q.alpha);
+		draw_calls++;
+		SDL_RenderCopy(renderer, batch.texture, &q.src, &q.dest);
+	}
 }
 
 int SDLHardwareRenderDevice::renderToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest) {
 	if (!src_image || !dest_image)
 		return -1;
 
+	flushBatch();
+
 	if (SDL_SetRenderTarget(renderer, static_cast<SDLHardwareImage *>(dest_image)->surface) != 0)
 		return -1;
 
@@ -422,11 +608,120 @@ int SDLHardwareRenderDevice::renderToImage(Image* src_image, Rect& src, Image* d
     SDL_Rect _dest = dest;
 
 	SDL_SetTextureBlendMode(static_cast<SDLHardwareImage *>(dest_image)->surface, SDL_BLENDMODE_BLEND);
+	draw_calls++;
 	SDL_RenderCopy(renderer, static_cast<SDLHardwareImage *>(src_image)->surface, &_src, &_dest);
 	SDL_SetRenderTarget(renderer, NULL);
 	return 0;
 }
 
+/**
+ * Draw many areas of one image onto another, e.g. the glyphs of a string.
+ * The target is only switched once.
+ */
+int SDLHardwareRenderDevice::renderRectsToImage(Image* src_image, const std::vector<Rect>& src, Image* dest_image, const std::vector<Rect>& dest, const Color& color_mod) {
+	if (!src_image || !dest_image || src.size() != dest.size())
+		return -1;
+
+	flushBatch();
+
+	if (SDL_SetRenderTarget(renderer, static_cast<SDLHardwareImage *>(dest_image)->surface) != 0)
+		return -1;
+
+	SDL_Texture *src_texture = static_cast<SDLHardwareImage *>(src_image)->surface;
+	SDL_Texture *dest_texture = static_cast<SDLHardwareImage *>(dest_image)->surface;
+	SDL_BlendMode prev_blend_mode;
+	SDL_GetTextureBlendMode(dest_texture, &prev_blend_mode);
+
+	SDL_SetTextureBlendMode(dest_texture, SDL_BLENDMODE_BLEND);
+	SDL_SetTextureColorMod(src_texture, color_mod.r, color_mod.g, color_mod.b);
+
+	for (size_t i = 0; i < src.size(); ++i) {
+		SDL_Rect _src = src[i];
+		SDL_Rect _dest = dest[i];
+		_dest.w = _src.w;
+		_dest.h = _src.h;
+
+		draw_calls++;
+		SDL_RenderCopy(renderer, src_texture, &_src, &_dest);
+	}
+
+	SDL_SetTextureColorMod(src_texture, 255, 255, 255);
+	SDL_SetTextureBlendMode(dest_texture, prev_blend_mode);
+	SDL_SetRenderTarget(renderer, NULL);
+	return 0;
+}
+
+/**
+ * Like renderToImage(), but replaces the destination pixels instead of blending with them
+ */
+int SDLHardwareRenderDevice::copyToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest) {
+	if (!src_image || !dest_image)
+		return -1;
+
+	flushBatch();
+
+	if (SDL_SetRenderTarget(renderer, static_cast<SDLHardwareImage *>(dest_image)->surface) != 0)
+		return -1;
+
+	dest.w = src.w;
+	dest.h = src.h;
+	SDL_Rect _src = src;
+	SDL_Rect _dest = dest;
+
+	SDL_Texture *src_texture = static_cast<SDLHardwareImage *>(src_image)->surface;
+	SDL_BlendMode prev_blend_mode;
+	SDL_GetTextureBlendMode(src_texture, &prev_blend_mode);
+
+	SDL_SetTextureBlendMode(src_texture, SDL_BLENDMODE_NONE);
+	draw_calls++;
+	SDL_RenderCopy(renderer, src_texture, &_src, &_dest);
+	SDL_SetTextureBlendMode(src_texture, prev_blend_mode);
+
+	SDL_SetRenderTarget(renderer, NULL);
+	return 0;
+}
+
+/**
+ * Like renderToImage(), for building an image out of many semi-transparent images.
+ * The destination keeps premultiplied colors, so edges drawn onto transparent pixels aren't
+ * darkened by blending with transparent black. The destination is then drawn with a matching
+ * blend mode. Renderers without custom blend modes fall back to renderToImage().
+ */
+int SDLHardwareRenderDevice::composeToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest) {
+	if (!src_image || !dest_image)
+		return -1;
+
+	SDL_Texture *src_texture = static_cast<SDLHardwareImage *>(src_image)->surface;
+	SDL_Texture *dest_texture = static_cast<SDLHardwareImage *>(dest_image)->surface;
+
+	SDL_BlendMode prev_blend_mode;
+	SDL_GetTextureBlendMode(src_texture, &prev_blend_mode);
+
+	if (compose_blend_mode == SDL_BLENDMODE_BLEND || SDL_SetTextureBlendMode(src_texture, compose_blend_mode) != 0 || SDL_SetTextureBlendMode(dest_texture, premultiplied_blend_mode) != 0) {
+		SDL_SetTextureBlendMode(src_texture, prev_blend_mode);
+		return renderToImage(src_image, src, dest_image, dest);
+	}
+
+	flushBatch();
+
+	if (SDL_SetRenderTarget(renderer, dest_texture) != 0) {
+		SDL_SetTextureBlendMode(src_texture, prev_blend_mode);
+		return -1;
+	}
+
+	dest.w = src.w;
+	dest.h = src.h;
+	SDL_Rect _src = src;
+	SDL_Rect _dest = dest;
+
+	draw_calls++;
+	SDL_RenderCopy(renderer, src_texture, &_src, &_dest);
+	SDL_SetTextureBlendMode(src_texture, prev_blend_mode);
+
+	SDL_SetRenderTarget(renderer, NULL);
+	return 0;
+}
+
 Image * SDLHardwareRenderDevice::renderTextToImage(FontStyle* font_style, const std::string& text, const Color& color, bool blended) {
 	SDLHardwareImage *image = new SDLHardwareImage(this, renderer);
 
@@ -450,16 +745,19 @@ Image * SDLHardwareRenderDevice::renderTextToImage(FontStyle* font_style, const
 }
 
 void SDLHardwareRenderDevice::drawPixel(int x, int y, const Color& color) {
+	flushBatch();
 	SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
 	SDL_RenderDrawPoint(renderer, x, y);
 }
 
 void SDLHardwareRenderDevice::drawLine(int x0, int y0, int x1, int y1, const Color& color) {
+	flushBatch();
 	SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
 	SDL_RenderDrawLine(renderer, x0, y0, x1, y1);
 }
 
 void SDLHardwareRenderDevice::drawRectangle(const Point& p0, const Point& p1, const Color& color) {
+	flushBatch();
 	SDL_Rect r;
 	r.x = p0.x;
 	r.y = p0.y;
@@ -470,6 +768,7 @@ void SDLHardwareRenderDevice::drawRectangle(const Point& p0, const Point& p1, co
 }
 
 void SDLHardwareRenderDevice::blankScreen() {
+	flushBatch();
 	SDL_SetRenderDrawColor(renderer, background_color.r, background_color.g, background_color.b, background_color.a);
 	SDL_SetRenderTarget(renderer, NULL);
 	SDL_RenderClear(renderer);
@@ -479,20 +778,31 @@ void SDLHardwareRenderDevice::blankScreen() {
 }
 
 void SDLHardwareRenderDevice::commitFrame() {
+	flushBatch();
+
 	SDL_SetRenderTarget(renderer, NULL);
 	SDL_RenderCopy(renderer, texture, NULL, NULL);
 	SDL_RenderPresent(renderer);
 	inpt->window_resized = false;
 
+	draw_calls_last_frame = draw_calls;
+	draw_calls = 0;
+
 	return;
 }
 
 void SDLHardwareRenderDevice::destroyContext() {
+	// queued sprites refer to textures that are about to be freed
+	batches.clear();
+	batch_quads.clear();
+	batch_active = false;
+
 	resetGamma();
 
 	// we need to free all loaded graphics as they may be tied to the current context
 	RenderDevice::cacheRemoveAll();
 	reload_graphics = true;
+	invalidateRenderTargets();
 
 	if (icons) {
 		delete icons;
@@ -603,6 +913,35 @@ Image *SDLHardwareRenderDevice::loadImage(const std::string& filename, int error
 	return image;
 }
 
+/**
+ * Create an image from a surface that was decoded ahead of time (see MapPreloader).
+ * Takes ownership of the surface.
+ */
+Image *SDLHardwareRenderDevice::loadImageFromSurface(const std::string& filename, SDL_Surface* surface) {
+	if (!surface)
+		return NULL;
+
+	// the image may have been loaded since the surface was decoded
+	Image *img = cacheLookup(filename);
+	if (img != NULL) {
+		SDL_FreeSurface(surface);
+		return img;
+	}
+
+	SDLHardwareImage *image = new SDLHardwareImage(this, renderer);
+	image->surface = SDL_CreateTextureFromSurface(renderer, surface);
+	SDL_FreeSurface(surface);
+
+	if (image->surface == NULL) {
+		Utils::logError("SDLHardwareRenderDevice: Couldn't load image: '%s'. %s", filename.c_str(), SDL_GetError());
+		delete image;
+		return NULL;
+	}
+
+	cacheStore(filename, image);
+	return image;
+}
+
 void SDLHardwareRenderDevice::getWindowSize(short unsigned *screen_w, short unsigned *screen_h) {
 	int w,h;
 	SDL_GetWindowSize(window, &w, &h);
@@ -64,6 +64,9 @@ public:
 	virtual int render(Renderable& r, Rect& dest);
 	virtual int render(Sprite* r);
 	virtual int renderToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest);
+	virtual int renderRectsToImage(Image* src_image, const std::vector<Rect>& src, Image* dest_image, const std::vector<Rect>& dest, const Color& color_mod);
+	virtual int copyToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest);
+	virtual int composeToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest);
 
 	Image *renderTextToImage(FontStyle* font_style, const std::string& text, const Color& color, bool blended);
 	void drawPixel(int x, int y, const Color& color);
@@ -79,14 +82,43 @@ public:
 	void resetGamma();
 	void updateTitleBar();
 
+	void beginBatch();
+	void endBatch();
+
 	Image* loadImage(const std::string& filename, int error_type);
+	Image* loadImageFromSurface(const std::string& filename, SDL_Surface* surface);
 
 protected:
 	int createContextInternal();
 	void createContextError();
 
 private:
+	// a queued render(Sprite*) call
+	class BatchQuad {
+	public:
+		SDL_Rect src;
+		SDL_Rect dest;
+		Color color;
+		uint8_t alpha;
+		size_t batch;
+	};
+
+	// queued quads that share a texture and are drawn with one call
+	class Batch {
+	public:
+		SDL_Texture *texture;
+		Rect bounds;
+		size_t count;
+	};
+
+	// how many batches back a quad may be moved to join one with the same texture
+	static const size_t BATCH_LOOKBACK = 4;
+
 	void getWindowSize(short unsigned *screen_w, short unsigned *screen_h);
+	void queueQuad(SDL_Texture *surface, const SDL_Rect& src, const SDL_Rect& dest, const Color& color, uint8_t alpha);
+	void flushBatch();
+	void drawBatch(const Batch& batch, const BatchQuad* quads);
+	void initBlendModes();
 
 	SDL_Window *window;
 	SDL_Renderer *renderer;
@@ -94,6 +126,17 @@ private:
 	SDL_Surface* titlebar_icon;
 	char* title;
 	Color background_color;
+
+	// see composeToImage()
+	SDL_BlendMode compose_blend_mode;
+	SDL_BlendMode premultiplied_blend_mode;
+
+	bool batch_active;
+	std::vector<Batch> batches;
+	std::vector<BatchQuad> batch_quads;
+	std::vector<BatchQuad> batch_sorted;
+	std::vector<SDL_Vertex> batch_vertices;
+	std::vector<int> batch_indices;
 };
 
 #endif
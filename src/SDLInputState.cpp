@@ -519,6 +519,11 @@ void SDLInputState::handle() {
 			case SDL_QUIT:
 				done = 1;
 				break;
+			case SDL_RENDER_TARGETS_RESET:
+			case SDL_RENDER_DEVICE_RESET:
+				// images that were drawn into need to be drawn again
+				render_device->invalidateRenderTargets();
+				break;
 			default:
 				break;
 		}
@@ -311,6 +311,7 @@ int SDLSoftwareRenderDevice::render(Renderable& r, Rect& dest) {
 	SDL_SetSurfaceColorMod(surface, r.color_mod.r, r.color_mod.g, r.color_mod.b);
 	SDL_SetSurfaceAlphaMod(surface, r.alpha_mod);
 
+	draw_calls++;
 	return SDL_BlitSurface(surface, &src, screen, &_dest);
 }
 
@@ -330,6 +331,7 @@ int SDLSoftwareRenderDevice::render(Sprite *r) {
 	SDL_SetSurfaceColorMod(surface, r->color_mod.r, r->color_mod.g, r->color_mod.b);
 	SDL_SetSurfaceAlphaMod(surface, r->alpha_mod);
 
+	draw_calls++;
 	return SDL_BlitSurface(surface, &src, screen, &dest);
 }
 
@@ -339,10 +341,118 @@ int SDLSoftwareRenderDevice::renderToImage(Image* src_image, Rect& src, Image* d
 	SDL_Rect _src = src;
 	SDL_Rect _dest = dest;
 
+	draw_calls++;
 	return SDL_BlitSurface(static_cast<SDLSoftwareImage *>(src_image)->surface, &_src,
 						   static_cast<SDLSoftwareImage *>(dest_image)->surface, &_dest);
 }
 
+/**
+ * Draw many areas of one image onto another, e.g. the glyphs of a string
+ */
+int SDLSoftwareRenderDevice::renderRectsToImage(Image* src_image, const std::vector<Rect>& src, Image* dest_image, const std::vector<Rect>& dest, const Color& color_mod) {
+	if (!src_image || !dest_image || src.size() != dest.size()) return -1;
+
+	SDL_Surface *src_surface = static_cast<SDLSoftwareImage *>(src_image)->surface;
+	SDL_Surface *dest_surface = static_cast<SDLSoftwareImage *>(dest_image)->surface;
+
+	SDL_SetSurfaceColorMod(src_surface, color_mod.r, color_mod.g, color_mod.b);
+
+	for (size_t i = 0; i < src.size(); ++i) {
+		SDL_Rect _src = src[i];
+		SDL_Rect _dest = dest[i];
+		draw_calls++;
+		SDL_BlitSurface(src_surface, &_src, dest_surface, &_dest);
+	}
+
+	SDL_SetSurfaceColorMod(src_surface, 255, 255, 255);
+	return 0;
+}
+
+/**
+ * Like renderToImage(), but replaces the destination pixels instead of blending with them
+ */
+int SDLSoftwareRenderDevice::copyToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest) {
+	if (!src_image || !dest_image) return -1;
+
+	SDL_Rect _src = src;
+	SDL_Rect _dest = dest;
+
+	SDL_Surface *src_surface = static_cast<SDLSoftwareImage *>(src_image)->surface;
+	SDL_BlendMode prev_blend_mode;
+	SDL_GetSurfaceBlendMode(src_surface, &prev_blend_mode);
+
+	SDL_SetSurfaceBlendMode(src_surface, SDL_BLENDMODE_NONE);
+	draw_calls++;
+	int ret = SDL_BlitSurface(src_surface, &_src, static_cast<SDLSoftwareImage *>(dest_image)->surface, &_dest);
+	SDL_SetSurfaceBlendMode(src_surface, prev_blend_mode);
+
+	return ret;
+}
+
+/**
+ * Like renderToImage(), for building an image out of many semi-transparent images.
+ * SDL's blending darkens edges that are drawn onto transparent pixels, so pixels are combined
+ * here with the "over" operator for straight alpha instead.
+ */
+int SDLSoftwareRenderDevice::composeToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest) {
+	if (!src_image || !dest_image) return -1;
+
+	SDL_Surface *src_surface = static_cast<SDLSoftwareImage *>(src_image)->surface;
+	SDL_Surface *dest_surface = static_cast<SDLSoftwareImage *>(dest_image)->surface;
+
+	if (src_surface->format->format != SDL_PIXELFORMAT_ARGB8888 || dest_surface->format->format != SDL_PIXELFORMAT_ARGB8888)
+		return renderToImage(src_image, src, dest_image, dest);
+
+	dest.w = src.w;
+	dest.h = src.h;
+
+	draw_calls++;
+
+	// the part of the area that is inside both surfaces
+	const int x_begin = std::max(0, std::max(-src.x, -dest.x));
+	const int y_begin = std::max(0, std::max(-src.y, -dest.y));
+	const int x_end = std::min(src.w, std::min(src_surface->w - src.x, dest_surface->w - dest.x));
+	const int y_end = std::min(src.h, std::min(src_surface->h - src.y, dest_surface->h - dest.y));
+	if (x_begin >= x_end || y_begin >= y_end)
+		return 0;
+
+	if (SDL_MUSTLOCK(src_surface)) SDL_LockSurface(src_surface);
+	if (SDL_MUSTLOCK(dest_surface)) SDL_LockSurface(dest_surface);
+
+	for (int y = y_begin; y < y_end; ++y) {
+		const Uint32 *src_row = reinterpret_cast<const Uint32 *>(static_cast<const Uint8 *>(src_surface->pixels) + (src.y + y) * src_surface->pitch) + src.x;
+		Uint32 *dest_row = reinterpret_cast<Uint32 *>(static_cast<Uint8 *>(dest_surface->pixels) + (dest.y + y) * dest_surface->pitch) + dest.x;
+
+		for (int x = x_begin; x < x_end; ++x) {
+			const Uint32 s = src_row[x];
+			const Uint32 sa = s >> 24;
+			if (sa == 0)
+				continue;
+
+			const Uint32 d = dest_row[x];
+			const Uint32 da = d >> 24;
+			if (sa == 255 || da == 0) {
+				dest_row[x] = s;
+				continue;
+			}
+
+			// weight of the destination color, and the resulting alpha
+			const Uint32 dw = da * (255 - sa) / 255;
+			const Uint32 oa = sa + dw;
+
+			const Uint32 r = (((s >> 16) & 0xff) * sa + ((d >> 16) & 0xff) * dw) / oa;
+			const Uint32 g = (((s >> 8) & 0xff) * sa + ((d >> 8) & 0xff) * dw) / oa;
+			const Uint32 b = ((s & 0xff) * sa + (d & 0xff) * dw) / oa;
+			dest_row[x] = (oa << 24) | (r << 16) | (g << 8) | b;
+		}
+	}
+
+	if (SDL_MUSTLOCK(dest_surface)) SDL_UnlockSurface(dest_surface);
+	if (SDL_MUSTLOCK(src_surface)) SDL_UnlockSurface(src_surface);
+
+	return 0;
+}
+
 Image* SDLSoftwareRenderDevice::renderTextToImage(FontStyle* font_style, const std::string& text, const Color& color, bool blended) {
 	SDLSoftwareImage *image = new SDLSoftwareImage(this);
 	if (!image) return NULL;
@@ -454,6 +564,9 @@ void SDLSoftwareRenderDevice::commitFrame() {
 	SDL_RenderPresent(renderer);
 	inpt->window_resized = false;
 
+	draw_calls_last_frame = draw_calls;
+	draw_calls = 0;
+
 	return;
 }
 
@@ -463,6 +576,7 @@ void SDLSoftwareRenderDevice::destroyContext() {
 	// we need to free all loaded graphics as they may be tied to the current context
 	RenderDevice::cacheRemoveAll();
 	reload_graphics = true;
+	invalidateRenderTargets();
 
 	if (icons) {
 		delete icons;
@@ -590,6 +704,35 @@ Image *SDLSoftwareRenderDevice::loadImage(const std::string& filename, int error
 	return image;
 }
 
+/**
+ * Create an image from a surface that was decoded ahead of time (see MapPreloader).
+ * Takes ownership of the surface.
+ */
+Image *SDLSoftwareRenderDevice::loadImageFromSurface(const std::string& filename, SDL_Surface* surface) {
+	if (!surface)
+		return NULL;
+
+	// the image may have been loaded since the surface was decoded
+	Image *img = cacheLookup(filename);
+	if (img != NULL) {
+		SDL_FreeSurface(surface);
+		return img;
+	}
+
+	SDLSoftwareImage *image = new SDLSoftwareImage(this);
+	image->surface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+	SDL_FreeSurface(surface);
+
+	if (image->surface == NULL) {
+		Utils::logError("SDLSoftwareRenderDevice: Couldn't load image: '%s'. %s", filename.c_str(), SDL_GetError());
+		delete image;
+		return NULL;
+	}
+
+	cacheStore(filename, image);
+	return image;
+}
+
 void SDLSoftwareRenderDevice::setSDL_RGBA(Uint32 *rmask, Uint32 *gmask, Uint32 *bmask, Uint32 *amask) {
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
 	*rmask = 0xff000000;
@@ -64,6 +64,9 @@ public:
 	virtual int render(Renderable& r, Rect& dest);
 	virtual int render(Sprite* r);
 	virtual int renderToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest);
+	virtual int renderRectsToImage(Image* src_image, const std::vector<Rect>& src, Image* dest_image, const std::vector<Rect>& dest, const Color& color_mod);
+	virtual int copyToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest);
+	virtual int composeToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest);
 
 	Image* renderTextToImage(FontStyle* font_style, const std::string& text, const Color& color, bool blended);
 	void drawPixel(int x, int y, const Color& color);
@@ -80,6 +83,7 @@ public:
 	void updateTitleBar();
 
 	Image* loadImage(const std::string& filename, int error_type);
+	Image* loadImageFromSurface(const std::string& filename, SDL_Surface* surface);
 
 protected:
 	int createContextInternal();
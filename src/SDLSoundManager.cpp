@@ -47,6 +47,9 @@ SDLSoundManager::SDLSoundManager()
 	, music(NULL)
 	, music_filename("")
 	, last_played_sid(-1)
+	, frame(0)
+	, culled_this_second(0)
+	, stats_ticks(0)
 {
 	if (settings->audio && Mix_OpenAudio(22050, AUDIO_S16SYS, 2, 1024)) {
 		Utils::logError("SDLSoundManager: Error during Mix_OpenAudio: %s", SDL_GetError());
@@ -57,7 +60,7 @@ SDLSoundManager::SDLSoundManager()
 		Utils::logInfo("SoundManager: Using SDLSoundManager (SDL2, %s)", SDL_GetCurrentAudioDriver());
 	}
 
-	Mix_AllocateChannels(128);
+	Mix_AllocateChannels(CHANNEL_COUNT);
 	setVolumeSFX(settings->sound_volume);
 }
 
@@ -73,6 +76,15 @@ SDLSoundManager::~SDLSoundManager() {
 
 void SDLSoundManager::logic(const FPoint& center) {
 
+	frame++;
+
+	const Uint32 ticks = SDL_GetTicks();
+	if (ticks - stats_ticks >= 1000) {
+		stats.culled_per_second = culled_this_second;
+		culled_this_second = 0;
+		stats_ticks = ticks;
+	}
+
 	PlaybackMapIterator it = playback.begin();
 	if (it == playback.end())
 		return;
@@ -121,20 +133,78 @@ void SDLSoundManager::logic(const FPoint& center) {
 
 	/* clenaup finished soundplayback */
 	while (!cleanup.empty()) {
+		removePlayback(playback.find(cleanup.back()));
+		cleanup.pop_back();
+	}
+}
 
-		it = playback.find(cleanup.back());
+/**
+ * Release the sound of a playback and its virtual channel
+ */
+void SDLSoundManager::removePlayback(PlaybackMapIterator it) {
+	if (it == playback.end())
+		return;
 
-		unload(it->second.sid);
+	unload(it->second.sid);
 
-		/* find and erase virtual channel for playback if exists */
+	/* find and erase virtual channel for playback if exists */
+	/* the virtual channel may already play a newer sound on another channel */
+	if (it->second.virtual_channel != 0) {
 		VirtualChannelMapIterator vcit = channels.find(it->second.virtual_channel);
-		if (vcit != channels.end())
+		if (vcit != channels.end() && vcit->second == it->first)
 			channels.erase(vcit);
+	}
 
-		playback.erase(it);
+	playback.erase(it);
+}
 
-		cleanup.pop_back();
+/**
+ * Only one-shot sounds that have a location and no virtual channel may be merged or stopped early.
+ * Music-like loops, and sounds of the player or the interface are always played.
+ */
+bool SDLSoundManager::isCullable(const Playback& p) {
+	return !p.loop && p.virtual_channel == 0 && (p.location.x != 0 || p.location.y != 0);
+}
+
+/**
+ * Distance to the listener, where 1 is the distance at which sounds can't be heard anymore
+ */
+float SDLSoundManager::getDistance(const Playback& p) {
+	if (p.location.x == 0 && p.location.y == 0)
+		return 0;
+
+	return Utils::calcDist(lastPos, p.location) / static_cast<float>(eset->misc.sound_falloff);
+}
+
+Uint8 SDLSoundManager::getMixDistance(float distance) {
+	return Uint8(255.0f * std::min<float>(std::max<float>(distance, 0.0f), 1.0f));
+}
+
+/**
+ * Returns the playing voice that is farthest from the listener and may be stopped early.
+ * If sid isn't 0, only voices of that sound are considered.
+ */
+SDLSoundManager::PlaybackMapIterator SDLSoundManager::getFarthestCullable(SoundID sid) {
+	PlaybackMapIterator farthest = playback.end();
+	float farthest_distance = -1;
+
+	for (PlaybackMapIterator it = playback.begin(); it != playback.end(); ++it) {
+		if (it->second.finished || !isCullable(it->second) || (sid != 0 && it->second.sid != sid))
+			continue;
+
+		const float distance = getDistance(it->second);
+		if (distance > farthest_distance) {
+			farthest = it;
+			farthest_distance = distance;
+		}
 	}
+
+	return farthest;
+}
+
+void SDLSoundManager::cullVoice() {
+	stats.culled++;
+	culled_this_second++;
 }
 
 void SDLSoundManager::reset() {
@@ -187,6 +257,36 @@ SoundID SDLSoundManager::load(const std::string& filename, const std::string& er
 	return sid;
 }
 
+/**
+ * Add a sound that was decoded ahead of time (see MapPreloader).
+ * Takes ownership of the chunk.
+ */
+SoundID SDLSoundManager::loadFromChunk(const std::string& filename, Mix_Chunk* chunk) {
+	if (!chunk)
+		return 0;
+
+	if (!settings->audio) {
+		Mix_FreeChunk(chunk);
+		return 0;
+	}
+
+	const SoundID sid = Utils::hashString(mods->locate(filename));
+	SoundMapIterator it = sounds.find(sid);
+	if (it != sounds.end()) {
+		// the sound may have been loaded since the chunk was decoded
+		Mix_FreeChunk(chunk);
+		it->second->refCnt++;
+		return sid;
+	}
+
+	Sound *psnd = new Sound;
+	psnd->chunk = chunk;
+	psnd->refCnt = 1;
+	sounds.insert(std::pair<SoundID,Sound *>(sid, psnd));
+
+	return sid;
+}
+
 void SDLSoundManager::unload(SoundID sid) {
 
 	SoundMapIterator it;
@@ -223,42 +323,92 @@ void SDLSoundManager::play(SoundID sid, const std::string& channel, const FPoint
 	Playback p;
 	p.sid = sid;
 	p.location = pos;
-	p.virtual_channel = channel;
+	p.virtual_channel = (channel == DEFAULT_CHANNEL) ? 0 : Utils::internString(channel);
 	p.loop = loop;
 	p.finished = false;
+	p.start_frame = frame;
+
+	const float distance = getDistance(p);
+	const bool cullable = isCullable(p);
+
+	if (cullable) {
+		int instances = 0;
+
+		for (PlaybackMapIterator pit = playback.begin(); pit != playback.end(); ++pit) {
+			if (pit->second.finished || pit->second.sid != sid || !isCullable(pit->second))
+				continue;
+
+			// the same sound was already started during this frame (e.g. many enemies hit at once)
+			// keep one voice, heard from the closest of the positions
+			if (pit->second.start_frame == frame) {
+				if (distance < getDistance(pit->second)) {
+					pit->second.location = p.location;
+					SetChannelPosition(pit->first, 0, getMixDistance(distance));
+				}
+				stats.merged++;
+				return;
+			}
+
+			instances++;
+		}
+
+		// too many voices of this sound: replace the farthest one if the new one is closer
+		if (instances >= MAX_VOICES_PER_SOUND) {
+			PlaybackMapIterator farthest = getFarthestCullable(sid);
+			if (farthest == playback.end() || getDistance(farthest->second) <= distance) {
+				cullVoice();
+				return;
+			}
+
+			Mix_HaltChannel(farthest->first);
+			cullVoice();
+		}
+	}
 
-	if (p.virtual_channel != DEFAULT_CHANNEL) {
+	if (p.virtual_channel != 0) {
 
 		/* if playback exists, stop it befor playin next sound */
 		vcit = channels.find(p.virtual_channel);
 		if (vcit != channels.end())
 			Mix_HaltChannel(vcit->second);
+	}
+
+	Mix_ChannelFinished(&channel_finished);
+	int c = Mix_PlayChannel(-1, it->second->chunk, (loop ? -1 : 0));
+
+	if (c == -1) {
+		// no free channel: replace the farthest voice that may be stopped, if it is farther away than the new sound
+		// sounds that can't be culled always take the place of one that can
+		PlaybackMapIterator farthest = getFarthestCullable(0);
+		if (farthest != playback.end() && (!cullable || getDistance(farthest->second) > distance)) {
+			const int farthest_channel = farthest->first;
+			Mix_HaltChannel(farthest_channel);
+			cullVoice();
+			c = Mix_PlayChannel(farthest_channel, it->second->chunk, (loop ? -1 : 0));
+		}
 
-		vcit = channels.insert(std::pair<std::string, int>(p.virtual_channel, -1)).first;
+		if (c == -1) {
+			if (!cullable)
+				Utils::logError("SoundManager: Failed to play sound, no more channels available.");
+			cullVoice();
+			return;
+		}
 	}
 
+	stats.started++;
+
 	// Let playback own a reference to prevent unloading playbacked sound.
 	if (!loop)
 		it->second->refCnt++;
 
-	Mix_ChannelFinished(&channel_finished);
-	int c = Mix_PlayChannel(-1, it->second->chunk, (loop ? -1 : 0));
+	// the channel may still have a playback that finished since the last logic()
+	removePlayback(playback.find(c));
 
-	if (c == -1)
-		Utils::logError("SoundManager: Failed to play sound, no more channels available.");
+	if (p.virtual_channel != 0)
+		channels[p.virtual_channel] = c;
 
 	// precalculate mixing volume if sound has a location
-	Uint8 d = 0;
-	if (p.location.x != 0 || p.location.y != 0) {
-		float v = 255.0f * (Utils::calcDist(lastPos, p.location) / static_cast<float>(eset->misc.sound_falloff));
-		v = std::min<float>(std::max<float>(v, 0.0f), 255.0f);
-		d = Uint8(v);
-	}
-
-	SetChannelPosition(c, 0, d);
-
-	if (vcit != channels.end())
-		vcit->second = c;
+	SetChannelPosition(c, 0, getMixDistance(distance));
 
 	playback.insert(std::pair<int, Playback>(c, p));
 }
@@ -355,6 +505,17 @@ int SDLSoundManager::SetChannelPosition(int channel, Sint16 angle, Uint8 distanc
 #endif
 }
 
+void SDLSoundManager::getVoiceStats(VoiceStats& _stats) {
+	stats.active = 0;
+	for (PlaybackMapIterator it = playback.begin(); it != playback.end(); ++it) {
+		if (!it->second.finished)
+			stats.active++;
+	}
+	stats.channels = CHANNEL_COUNT;
+
+	_stats = stats;
+}
+
 SoundID SDLSoundManager::getLastPlayedSID() {
 	SoundID ret = last_played_sid;
 	last_played_sid = -1;
@@ -33,10 +33,16 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 class SDLSoundManager : public SoundManager {
 public:
+	static const int CHANNEL_COUNT = 128;
+
+	// a sound can't play on more channels than this at once
+	static const int MAX_VOICES_PER_SOUND = 4;
+
 	SDLSoundManager();
 	~SDLSoundManager();
 
 	SoundID load(const std::string& filename, const std::string& errormessage);
+	SoundID loadFromChunk(const std::string& filename, Mix_Chunk* chunk);
 	void unload(SoundID);
 	void play(SoundID, const std::string& channel, const FPoint& pos, bool loop);
 	void pauseAll();
@@ -54,9 +60,10 @@ public:
 	void reset();
 
 	SoundID getLastPlayedSID();
+	void getVoiceStats(VoiceStats& stats);
 
 private:
-	typedef std::map<std::string, int> VirtualChannelMap;
+	typedef std::map<StringID, int> VirtualChannelMap;
 	typedef VirtualChannelMap::iterator VirtualChannelMapIterator;
 
 	typedef std::map<SoundID, class Sound *> SoundMap;
@@ -70,6 +77,13 @@ private:
 
 	int SetChannelPosition(int channel, Sint16 angle, Uint8 distance);
 
+	void removePlayback(PlaybackMapIterator it);
+	bool isCullable(const Playback& p);
+	float getDistance(const Playback& p);
+	Uint8 getMixDistance(float distance);
+	PlaybackMapIterator getFarthestCullable(SoundID sid);
+	void cullVoice();
+
 	SoundMap sounds;
 	VirtualChannelMap channels;
 	PlaybackMap playback;
@@ -79,6 +93,13 @@ private:
 	std::string music_filename;
 
 	SoundID last_played_sid;
+
+	// incremented by logic(), so that sounds started during the same frame can be merged
+	unsigned frame;
+
+	VoiceStats stats;
+	int culled_this_second;
+	Uint32 stats_ticks; // when the current second started
 };
 
 #endif
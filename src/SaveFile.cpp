@@ -0,0 +1,324 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class SaveFile
+ */
+
+#include "FileParser.h"
+#include "Platform.h"
+#include "SaveFile.h"
+#include "Utils.h"
+#include "UtilsFileSystem.h"
+
+const std::string SaveFile::MAGIC = "FLARESAV";
+
+SaveFile::SaveFile()
+	: changed(false)
+{
+}
+
+SaveFile::~SaveFile() {
+}
+
+void SaveFile::clear() {
+	sections.clear();
+	filename.clear();
+	changed = false;
+}
+
+/**
+ * Replace the data of a section, or add the section if it doesn't exist.
+ * Returns false if the section already had this data.
+ */
+bool SaveFile::setSection(const std::string& name, const std::string& data) {
+	for (size_t i = 0; i < sections.size(); ++i) {
+		if (sections[i].name != name)
+			continue;
+
+		if (sections[i].data == data)
+			return false;
+
+		sections[i].data = data;
+		sections[i].checksum = getChecksum(data, data.size());
+		changed = true;
+		return true;
+	}
+
+	sections.resize(sections.size() + 1);
+	sections.back().name = name;
+	sections.back().data = data;
+	sections.back().checksum = getChecksum(data, data.size());
+	changed = true;
+	return true;
+}
+
+/**
+ * Get the key/value pairs of every section, in the order that the sections were added
+ */
+void SaveFile::getValues(std::vector<Value>& values) const {
+	for (size_t i = 0; i < sections.size(); ++i) {
+		const std::string& data = sections[i].data;
+		size_t pos = 0;
+
+		while (pos < data.size()) {
+			Value value;
+			if (!readString(data, pos, value.key) || !readString(data, pos, value.val))
+				break;
+			values.push_back(value);
+		}
+	}
+}
+
+const std::string& SaveFile::getFilename() const {
+	return filename;
+}
+
+/**
+ * Returns false (and keeps no sections) if the file is missing, damaged or from a newer version
+ */
+bool SaveFile::read(const std::string& _filename) {
+	clear();
+
+	std::ifstream infile;
+	infile.open(_filename.c_str(), std::ios::in | std::ios::binary);
+	if (!infile.is_open())
+		return false;
+
+	std::stringstream ss;
+	ss << infile.rdbuf();
+	infile.close();
+
+	const std::string buf = ss.str();
+	size_t pos = MAGIC.size();
+	uint32_t version = 0;
+	uint32_t section_count = 0;
+
+	bool valid = buf.compare(0, MAGIC.size(), MAGIC) == 0
+		&& readUInt32(buf, pos, version)
+		&& version == VERSION
+		&& readUInt32(buf, pos, section_count);
+
+	for (uint32_t i = 0; valid && i < section_count; ++i) {
+		Section section;
+		valid = readString(buf, pos, section.name)
+			&& readUInt32(buf, pos, section.checksum)
+			&& readString(buf, pos, section.data)
+			&& section.checksum == getChecksum(section.data, section.data.size());
+
+		if (valid)
+			sections.push_back(section);
+	}
+
+	const size_t data_end = pos;
+	uint32_t file_checksum = 0;
+	valid = valid
+		&& readUInt32(buf, pos, file_checksum)
+		&& pos == buf.size()
+		&& file_checksum == getChecksum(buf, data_end);
+
+	if (!valid) {
+		Utils::logError("SaveFile: '%s' is damaged or was saved by a different version (%u).", _filename.c_str(), version);
+		clear();
+		return false;
+	}
+
+	filename = _filename;
+	return true;
+}
+
+/**
+ * Write all sections to a temporary file, flush it to the disk, then replace the file with it.
+ * Nothing is written if the file already has the current sections.
+ */
+bool SaveFile::write(const std::string& _filename) {
+	if (!changed && _filename == filename && Filesystem::fileExists(filename))
+		return true;
+
+	std::string buf = MAGIC;
+	writeUInt32(buf, VERSION);
+	writeUInt32(buf, static_cast<uint32_t>(sections.size()));
+
+	for (size_t i = 0; i < sections.size(); ++i) {
+		writeString(buf, sections[i].name);
+		writeUInt32(buf, sections[i].checksum);
+		writeString(buf, sections[i].data);
+	}
+
+	writeUInt32(buf, getChecksum(buf, buf.size()));
+
+	const std::string temp_filename = _filename + ".tmp";
+
+	std::ofstream outfile;
+	outfile.open(temp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!outfile.is_open()) {
+		Utils::logError("SaveFile: Could not write '%s'.", temp_filename.c_str());
+		return false;
+	}
+
+	outfile.write(buf.data(), buf.size());
+	outfile.flush();
+	const bool written = !outfile.fail();
+	outfile.close();
+
+	// the data has to be on the disk before the rename, or a crash could leave an empty file behind
+	if (!written || !platform.fileSync(temp_filename) || !platform.fileReplace(temp_filename, _filename)) {
+		Utils::logError("SaveFile: Could not write '%s'. No write access or disk is full!", _filename.c_str());
+		Filesystem::removeFile(temp_filename);
+		return false;
+	}
+
+	filename = _filename;
+	changed = false;
+	return true;
+}
+
+void SaveFile::addValue(std::string& data, const std::string& key, const std::string& val) {
+	writeString(data, key);
+	writeString(data, val);
+}
+
+/**
+ * Get the key/value pairs from whichever of the binary and the text save file is newer.
+ * If the binary file can't be read, the text file is used instead.
+ */
+bool SaveFile::readValues(const std::string& filename, const std::string& text_filename, std::vector<Value>& values) {
+	return readValues(std::vector<std::string>(1, filename), text_filename, values);
+}
+
+/**
+ * Same as above for a save that is split into several binary files. The first file decides
+ * whether the binary or the text save is newer. The other files are optional, because older
+ * binary saves kept all sections in the first file.
+ */
+bool SaveFile::readValues(const std::vector<std::string>& filenames, const std::string& text_filename, std::vector<Value>& values) {
+	const long mtime = Filesystem::getModifiedTime(filenames[0]);
+	const long text_mtime = Filesystem::getModifiedTime(text_filename);
+
+	if (mtime != -1 && mtime >= text_mtime) {
+		std::vector<Value> binary_values;
+		bool first_valid = false;
+		bool all_valid = true;
+
+		for (size_t i = 0; i < filenames.size(); ++i) {
+			if (i > 0 && !Filesystem::fileExists(filenames[i]))
+				continue;
+
+			SaveFile save_file;
+			const bool valid = save_file.read(filenames[i]);
+			if (valid)
+				save_file.getValues(binary_values);
+
+			if (i == 0)
+				first_valid = valid;
+			all_valid = all_valid && valid;
+		}
+
+		if (all_valid || (first_valid && text_mtime == -1)) {
+			if (!all_valid)
+				Utils::logError("SaveFile: Parts of the save '%s' are damaged. Their progress is lost!", filenames[0].c_str());
+
+			values.insert(values.end(), binary_values.begin(), binary_values.end());
+			return true;
+		}
+
+		if (text_mtime != -1)
+			Utils::logError("SaveFile: Falling back to the older save '%s'. Progress made since it was written is lost!", text_filename.c_str());
+	}
+
+	if (text_mtime == -1)
+		return false;
+
+	FileParser infile;
+	if (!infile.open(text_filename, !FileParser::MOD_FILE, FileParser::ERROR_NORMAL))
+		return false;
+
+	while (infile.next()) {
+		Value value;
+		value.key = infile.key;
+		value.val = infile.val;
+		values.push_back(value);
+	}
+	infile.close();
+
+	return true;
+}
+
+/**
+ * Modification time of the save, which may be in either format. Returns -1 if there is no save.
+ */
+long SaveFile::getModifiedTime(const std::string& filename, const std::string& text_filename) {
+	return std::max(Filesystem::getModifiedTime(filename), Filesystem::getModifiedTime(text_filename));
+}
+
+/**
+ * CRC-32 of the first length bytes of data
+ */
+uint32_t SaveFile::getChecksum(const std::string& data, size_t length) {
+	static uint32_t table[256];
+	static bool table_ready = false;
+
+	if (!table_ready) {
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; ++k) {
+				c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+			}
+			table[i] = c;
+		}
+		table_ready = true;
+	}
+
+	uint32_t crc = 0xFFFFFFFF;
+	for (size_t i = 0; i < length && i < data.size(); ++i) {
+		crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+	}
+	return crc ^ 0xFFFFFFFF;
+}
+
+void SaveFile::writeUInt32(std::string& buf, uint32_t val) {
+	for (int i = 0; i < 4; ++i) {
+		buf += static_cast<char>((val >> (i * 8)) & 0xFF);
+	}
+}
+
+bool SaveFile::readUInt32(const std::string& buf, size_t& pos, uint32_t& val) {
+	if (pos + 4 > buf.size())
+		return false;
+
+	val = 0;
+	for (int i = 0; i < 4; ++i) {
+		val |= static_cast<uint32_t>(static_cast<unsigned char>(buf[pos + i])) << (i * 8);
+	}
+	pos += 4;
+	return true;
+}
+
+void SaveFile::writeString(std::string& buf, const std::string& s) {
+	writeUInt32(buf, static_cast<uint32_t>(s.size()));
+	buf += s;
+}
+
+bool SaveFile::readString(const std::string& buf, size_t& pos, std::string& s) {
+	uint32_t length = 0;
+	if (!readUInt32(buf, pos, length) || length > buf.size() - pos)
+		return false;
+
+	s = buf.substr(pos, length);
+	pos += length;
+	return true;
+}
@@ -0,0 +1,95 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class SaveFile
+ *
+ * Binary save file made of named sections (e.g. "avatar" or "stash").
+ * Each section holds the same key/value pairs as the text save format, and has its own checksum.
+ *
+ * File layout (integers are 32 bit little endian):
+ *   "FLARESAV", version, section count,
+ *   for each section: name length, name, data checksum, data length, data,
+ *   checksum of everything before it
+ *
+ * Section data is a list of key length, key, value length, value.
+ *
+ * A SaveFile keeps the sections that were last read or written. setSection() only recalculates
+ * the checksum of sections that changed. write() always writes the whole file, and skips it only
+ * if no section changed at all. So data that changes at different rates is kept in separate files
+ * (see SaveLoad::saveGame()), and readValues() can read a save that is split into several files.
+ * Files are written to a temporary file and synced to the disk first, which then replaces the old file.
+ */
+
+#ifndef SAVE_FILE_H
+#define SAVE_FILE_H
+
+#include "CommonIncludes.h"
+
+class SaveFile {
+public:
+	static const uint32_t VERSION = 1;
+	static const std::string MAGIC;
+
+	class Value {
+	public:
+		std::string key;
+		std::string val;
+	};
+
+	SaveFile();
+	~SaveFile();
+
+	void clear();
+	bool setSection(const std::string& name, const std::string& data);
+	void getValues(std::vector<Value>& values) const;
+	const std::string& getFilename() const;
+
+	bool read(const std::string& filename);
+	bool write(const std::string& filename);
+
+	static void addValue(std::string& data, const std::string& key, const std::string& val);
+	template <typename T> static void addValue(std::string& data, const std::string& key, const T& val) {
+		std::stringstream ss;
+		ss << val;
+		addValue(data, key, ss.str());
+	}
+
+	static bool readValues(const std::string& filename, const std::string& text_filename, std::vector<Value>& values);
+	static bool readValues(const std::vector<std::string>& filenames, const std::string& text_filename, std::vector<Value>& values);
+	static long getModifiedTime(const std::string& filename, const std::string& text_filename);
+
+private:
+	class Section {
+	public:
+		std::string name;
+		std::string data;
+		uint32_t checksum;
+	};
+
+	static uint32_t getChecksum(const std::string& data, size_t length);
+	static void writeUInt32(std::string& buf, uint32_t val);
+	static bool readUInt32(const std::string& buf, size_t& pos, uint32_t& val);
+	static void writeString(std::string& buf, const std::string& s);
+	static bool readString(const std::string& buf, size_t& pos, std::string& s);
+
+	std::vector<Section> sections;
+	std::string filename; // file that the sections were last read from or written to
+	bool changed;
+};
+
+#endif
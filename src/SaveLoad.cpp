@@ -51,7 +51,9 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "NPC.h"
 #include "Platform.h"
 #include "PowerManager.h"
+#include "SaveFile.h"
 #include "SaveLoad.h"
+#include "SaveSummary.h"
 #include "Settings.h"
 #include "SharedGameResources.h"
 #include "SharedResources.h"
@@ -74,6 +76,9 @@ void SaveLoad::saveGame() {
 
 	if (game_slot <= 0) return;
 
+	// simulations must not change the save that they were started from
+	if (settings->headless) return;
+
 	// if needed, create the save file structure
 	Utils::createSaveDir(game_slot);
 
@@ -81,161 +86,159 @@ void SaveLoad::saveGame() {
 	menu->inv->inventory[MenuInventory::EQUIPMENT].clean();
 	menu->inv->inventory[MenuInventory::CARRIED].clean();
 
-	std::ofstream outfile;
-
-	std::stringstream ss;
-	ss << settings->path_user << "saves/" << eset->misc.save_prefix << "/" << game_slot << "/avatar.txt";
-
-	outfile.open(Filesystem::path(&ss).c_str(), std::ios::out);
-
-	if (outfile.is_open()) {
+	// a file is only written again if its section changed since the last save.
+	// The avatar file always changes, because it holds time_played.
+	const std::vector<std::string> slot_filenames = getSlotFilenames();
+	if (avatar_file.getFilename() != slot_filenames[0]) {
+		avatar_file.clear();
+		inventory_file.clear();
+		campaign_file.clear();
+	}
 
-		// comment
-		outfile << "## flare-engine save file ##" << "\n";
+	std::string data;
+	std::stringstream val;
 
-		// hero name
-		outfile << "name=" << pc->stats.name << "\n";
+	// hero name
+	SaveFile::addValue(data, "name", pc->stats.name);
 
-		// permadeath
-		outfile << "permadeath=" << pc->stats.permadeath << "\n";
+	// permadeath
+	SaveFile::addValue(data, "permadeath", pc->stats.permadeath);
 
-		// hero visual option
-		outfile << "option=" << pc->stats.gfx_base << "," << pc->stats.gfx_head << "," << pc->stats.gfx_portrait << "\n";
+	// hero visual option
+	val.str("");
+	val << pc->stats.gfx_base << "," << pc->stats.gfx_head << "," << pc->stats.gfx_portrait;
+	SaveFile::addValue(data, "option", val.str());
 
-		// hero class
-		outfile << "class=" << pc->stats.character_class << "," << pc->stats.character_subclass << "\n";
+	// hero class
+	SaveFile::addValue(data, "class", pc->stats.character_class + "," + pc->stats.character_subclass);
 
-		// current experience
-		outfile << "xp=" << pc->stats.xp << "\n";
+	// current experience
+	SaveFile::addValue(data, "xp", pc->stats.xp);
 
-		// hp and mp
-		if (eset->misc.save_hpmp) outfile << "hpmp=" << pc->stats.hp << "," << pc->stats.mp << "\n";
+	// hp and mp
+	if (eset->misc.save_hpmp) {
+		val.str("");
+		val << pc->stats.hp << "," << pc->stats.mp;
+		SaveFile::addValue(data, "hpmp", val.str());
+	}
 
-		// stat spec
-		outfile << "build=";
-		for (size_t i = 0; i < eset->primary_stats.list.size(); ++i) {
-			outfile << pc->stats.primary[i];
-			if (i < eset->primary_stats.list.size() - 1)
-				outfile << ",";
+	// stat spec
+	val.str("");
+	for (size_t i = 0; i < eset->primary_stats.list.size(); ++i) {
+		val << pc->stats.primary[i];
+		if (i < eset->primary_stats.list.size() - 1)
+			val << ",";
+	}
+	SaveFile::addValue(data, "build", val.str());
+
+	// spawn point
+	val.str("");
+	val << mapr->respawn_map << "," << static_cast<int>(mapr->respawn_point.x) << "," << static_cast<int>(mapr->respawn_point.y);
+	SaveFile::addValue(data, "spawn", val.str());
+
+	// action bar
+	// NOTE we need to reset any bonus-modified powers in the action bar before writing
+	// we use menu->pow->setUnlockedPowers() after to restore the action bar state
+	menu->pow->clearActionBarBonusLevels();
+	val.str("");
+	for (unsigned i = 0; i < static_cast<unsigned>(MenuActionBar::SLOT_MAX); i++) {
+		if (i < menu->act->slots_count)
+		{
+			if (pc->stats.transformed) val << menu->act->hotkeys_temp[i];
+			else val << menu->act->hotkeys[i];
 		}
-		outfile << "\n";
-
-		// equipped gear
-		outfile << "equipped_quantity=" << menu->inv->inventory[MenuInventory::EQUIPMENT].getQuantities() << "\n";
-		outfile << "equipped=" << menu->inv->inventory[MenuInventory::EQUIPMENT].getItems() << "\n";
-
-		// carried items
-		outfile << "carried_quantity=" << menu->inv->inventory[MenuInventory::CARRIED].getQuantities() << "\n";
-		outfile << "carried=" << menu->inv->inventory[MenuInventory::CARRIED].getItems() << "\n";
-
-		// spawn point
-		outfile << "spawn=" << mapr->respawn_map << "," << static_cast<int>(mapr->respawn_point.x) << "," << static_cast<int>(mapr->respawn_point.y) << "\n";
-
-		// action bar
-		// NOTE we need to reset any bonus-modified powers in the action bar before writing
-		// we use menu->pow->setUnlockedPowers() after to restore the action bar state
-		menu->pow->clearActionBarBonusLevels();
-		outfile << "actionbar=";
-		for (unsigned i = 0; i < static_cast<unsigned>(MenuActionBar::SLOT_MAX); i++) {
-			if (i < menu->act->slots_count)
-			{
-				if (pc->stats.transformed) outfile << menu->act->hotkeys_temp[i];
-				else outfile << menu->act->hotkeys[i];
-			}
-			else
-			{
-				outfile << 0;
-			}
-			if (i < MenuActionBar::SLOT_MAX - 1) outfile << ",";
+		else
+		{
+			val << 0;
 		}
-		outfile << "\n";
-		menu->pow->setUnlockedPowers();
+		if (i < MenuActionBar::SLOT_MAX - 1) val << ",";
+	}
+	SaveFile::addValue(data, "actionbar", val.str());
+	menu->pow->setUnlockedPowers();
 
-		//shapeshifter value
-		if (pc->stats.transform_type == "untransform" || pc->stats.transform_duration != -1) outfile << "transformed=" << "\n";
-		else outfile << "transformed=" << pc->stats.transform_type << "," << pc->stats.manual_untransform << "\n";
+	//shapeshifter value
+	if (pc->stats.transform_type == "untransform" || pc->stats.transform_duration != -1) SaveFile::addValue(data, "transformed", "");
+	else SaveFile::addValue(data, "transformed", pc->stats.transform_type + "," + (pc->stats.manual_untransform ? "1" : "0"));
 
-		// restore hero powers
-		if (pc->stats.transformed && pc->hero_stats) {
-			pc->stats.powers_list = pc->hero_stats->powers_list;
-		}
+	// restore hero powers
+	if (pc->stats.transformed && pc->hero_stats) {
+		pc->stats.powers_list = pc->hero_stats->powers_list;
+	}
 
-		// enabled powers
-		outfile << "powers=";
-		for (unsigned int i=0; i<pc->stats.powers_list.size(); i++) {
-			if (i < pc->stats.powers_list.size()-1) {
-				if (pc->stats.powers_list[i] > 0)
-					outfile << pc->stats.powers_list[i] << ",";
-			}
-			else {
-				if (pc->stats.powers_list[i] > 0)
-					outfile << pc->stats.powers_list[i];
-			}
+	// enabled powers
+	val.str("");
+	for (unsigned int i=0; i<pc->stats.powers_list.size(); i++) {
+		if (i < pc->stats.powers_list.size()-1) {
+			if (pc->stats.powers_list[i] > 0)
+				val << pc->stats.powers_list[i] << ",";
 		}
-		outfile << "\n";
-
-		// restore transformed powers
-		if (pc->stats.transformed && pc->charmed_stats) {
-			pc->stats.powers_list = pc->charmed_stats->powers_list;
+		else {
+			if (pc->stats.powers_list[i] > 0)
+				val << pc->stats.powers_list[i];
 		}
+	}
+	SaveFile::addValue(data, "powers", val.str());
 
-		// campaign data
-		outfile << "campaign=" << camp->getAll() << "\n";
+	// restore transformed powers
+	if (pc->stats.transformed && pc->charmed_stats) {
+		pc->stats.powers_list = pc->charmed_stats->powers_list;
+	}
 
-		outfile << "time_played=" << pc->time_played << "\n";
+	SaveFile::addValue(data, "time_played", pc->time_played);
 
-		// save the engine version for troubleshooting purposes
-		outfile << "engine_version=" << VersionInfo::ENGINE.getString() << "\n";
+	// save the engine version for troubleshooting purposes
+	SaveFile::addValue(data, "engine_version", VersionInfo::ENGINE.getString());
 
-		// save the vendor buyback
-		if (eset->misc.save_buyback) {
-			std::map<std::string, ItemStorage>::iterator it;
+	// save the vendor buyback
+	if (eset->misc.save_buyback) {
+		std::map<std::string, ItemStorage>::iterator it;
 
-			for (it = menu->vendor->buyback_stock.begin(); it != menu->vendor->buyback_stock.end(); ++it) {
-				if (it->second.empty())
-					continue;
+		for (it = menu->vendor->buyback_stock.begin(); it != menu->vendor->buyback_stock.end(); ++it) {
+			if (it->second.empty())
+				continue;
 
-				outfile << "buyback_item=" << it->first << ";" << it->second.getItems() << "\n";
-				outfile << "buyback_quantity=" << it->first << ";" << it->second.getQuantities() << "\n";
-			}
+			SaveFile::addValue(data, "buyback_item", it->first + ";" + it->second.getItems());
+			SaveFile::addValue(data, "buyback_quantity", it->first + ";" + it->second.getQuantities());
 		}
+	}
 
-		outfile << "questlog_dismissed=" << !menu->act->requires_attention[MenuActionBar::MENU_LOG];
+	SaveFile::addValue(data, "questlog_dismissed", !menu->act->requires_attention[MenuActionBar::MENU_LOG]);
 
-		outfile << std::endl;
+	avatar_file.setSection("avatar", data);
 
-		if (outfile.bad()) Utils::logError("SaveLoad: Unable to save the game. No write access or disk is full!");
-		outfile.close();
-		outfile.clear();
+	// equipped gear and carried items
+	data.clear();
+	SaveFile::addValue(data, "equipped_quantity", menu->inv->inventory[MenuInventory::EQUIPMENT].getQuantities());
+	SaveFile::addValue(data, "equipped", menu->inv->inventory[MenuInventory::EQUIPMENT].getItems());
+	SaveFile::addValue(data, "carried_quantity", menu->inv->inventory[MenuInventory::CARRIED].getQuantities());
+	SaveFile::addValue(data, "carried", menu->inv->inventory[MenuInventory::CARRIED].getItems());
+	inventory_file.setSection("inventory", data);
 
-		platform.FSCommit();
-	}
+	// campaign data
+	data.clear();
+	SaveFile::addValue(data, "campaign", camp->getAll());
+	campaign_file.setSection("campaign", data);
 
-	// Save stash
-	ss.str("");
-	if (pc->stats.permadeath)
-		ss << settings->path_user << "saves/" << eset->misc.save_prefix << "/" << game_slot << "/stash_HC.txt";
+	// the avatar file is written last, because its time tells the load screen when the game was saved
+	if (inventory_file.write(slot_filenames[1]) && campaign_file.write(slot_filenames[2]) && avatar_file.write(slot_filenames[0]))
+		saveSummary();
 	else
-		ss << settings->path_user << "saves/" << eset->misc.save_prefix << "/stash.txt";
-
-	outfile.open(Filesystem::path(&ss).c_str(), std::ios::out);
-
-	if (outfile.is_open()) {
+		Utils::logError("SaveLoad: Unable to save the game. No write access or disk is full!");
 
-		// comment
-		outfile << "## flare-engine stash file ##" << "\n";
-
-		outfile << "quantity=" << menu->stash->stock.getQuantities() << "\n";
-		outfile << "item=" << menu->stash->stock.getItems() << "\n";
+	// Save stash
+	const std::string stash_filename = getStashFilename(".dat");
+	if (stash_file.getFilename() != stash_filename)
+		stash_file.clear();
 
-		outfile << std::endl;
+	data.clear();
+	SaveFile::addValue(data, "quantity", menu->stash->stock.getQuantities());
+	SaveFile::addValue(data, "item", menu->stash->stock.getItems());
+	stash_file.setSection("stash", data);
 
-		if (outfile.bad()) Utils::logError("SaveLoad: Unable to save stash. No write access or disk is full!");
-		outfile.close();
-		outfile.clear();
+	if (!stash_file.write(stash_filename))
+		Utils::logError("SaveLoad: Unable to save stash. No write access or disk is full!");
 
-		platform.FSCommit();
-	}
+	platform.FSCommit();
 
 	settings->prev_save_slot = game_slot-1;
 
@@ -244,6 +247,28 @@ void SaveLoad::saveGame() {
 	menu->hudlog->add(msg->get("Game saved."), MenuHUDLog::MSG_NORMAL);
 }
 
+/**
+ * Write the summary of the save that the load screen reads instead of the whole save
+ */
+void SaveLoad::saveSummary() {
+	SaveSummary summary;
+	summary.avatar_mtime = SaveFile::getModifiedTime(getSlotFilename("avatar.dat"), getSlotFilename("avatar.txt"));
+	summary.mod_list = SaveSummary::getModList();
+	summary.name = pc->stats.name;
+	summary.permadeath = pc->stats.permadeath;
+	summary.level = SaveSummary::getLevelFromXP(pc->stats.xp);
+	summary.character_class = pc->stats.character_class;
+	summary.character_subclass = pc->stats.character_subclass;
+	summary.gfx_base = pc->stats.gfx_base;
+	summary.gfx_head = pc->stats.gfx_head;
+	summary.gfx_portrait = pc->stats.gfx_portrait;
+	summary.map_title = SaveSummary::getMapTitle(mapr->respawn_map);
+	summary.time_played = pc->time_played;
+	summary.setEquipped(menu->inv->inventory[MenuInventory::EQUIPMENT].getItems());
+
+	summary.write(getSlotFilename("summary.txt"));
+}
+
 /**
  * When loading the game, load from file if possible
  */
@@ -255,63 +280,66 @@ void SaveLoad::loadGame() {
 	int currency = 0;
 	Version save_version(VersionInfo::MIN);
 
-	FileParser infile;
 	std::vector<int> hotkeys(MenuActionBar::SLOT_MAX, -1);
 
-	std::stringstream ss;
-	ss << settings->path_user << "saves/" << eset->misc.save_prefix << "/" << game_slot << "/avatar.txt";
+	// older saves are text files
+	std::vector<SaveFile::Value> values;
+	const std::vector<std::string> slot_filenames = getSlotFilenames();
+
+	if (SaveFile::readValues(slot_filenames, getSlotFilename("avatar.txt"), values)) {
+		for (size_t j = 0; j < values.size(); ++j) {
+			const std::string& key = values[j].key;
+			std::string& val = values[j].val;
 
-	if (infile.open(Filesystem::path(&ss), !FileParser::MOD_FILE, FileParser::ERROR_NORMAL)) {
-		while (infile.next()) {
-			if (infile.key == "name") pc->stats.name = infile.val;
-			else if (infile.key == "permadeath") {
-				pc->stats.permadeath = Parse::toBool(infile.val);
+			if (key == "name") pc->stats.name = val;
+			else if (key == "permadeath") {
+				pc->stats.permadeath = Parse::toBool(val);
 			}
-			else if (infile.key == "option") {
-				pc->stats.gfx_base = Parse::popFirstString(infile.val);
-				pc->stats.gfx_head = Parse::popFirstString(infile.val);
-				pc->stats.gfx_portrait = Parse::popFirstString(infile.val);
+			else if (key == "option") {
+				pc->stats.gfx_base = Parse::popFirstString(val);
+				pc->stats.gfx_head = Parse::popFirstString(val);
+				pc->stats.gfx_portrait = Parse::popFirstString(val);
 			}
-			else if (infile.key == "class") {
-				pc->stats.character_class = Parse::popFirstString(infile.val);
-				pc->stats.character_subclass = Parse::popFirstString(infile.val);
+			else if (key == "class") {
+				pc->stats.character_class = Parse::popFirstString(val);
+				pc->stats.character_subclass = Parse::popFirstString(val);
 			}
-			else if (infile.key == "xp") {
-				pc->stats.xp = Parse::toUnsignedLong(infile.val);
+			else if (key == "xp") {
+				pc->stats.xp = Parse::toUnsignedLong(val);
 			}
-			else if (infile.key == "hpmp") {
-				saved_hp = Parse::popFirstInt(infile.val);
-				saved_mp = Parse::popFirstInt(infile.val);
+			else if (key == "hpmp") {
+				saved_hp = Parse::popFirstInt(val);
+				saved_mp = Parse::popFirstInt(val);
 			}
-			else if (infile.key == "build") {
+			else if (key == "build") {
 				for (size_t i = 0; i < eset->primary_stats.list.size(); ++i) {
-					pc->stats.primary[i] = Parse::popFirstInt(infile.val);
+					pc->stats.primary[i] = Parse::popFirstInt(val);
 					if (pc->stats.primary[i] < 0 || pc->stats.primary[i] > pc->stats.max_points_per_stat) {
 						Utils::logInfo("SaveLoad: Primary stat value for '%s' is out of bounds, setting to zero.", eset->primary_stats.list[i].id.c_str());
 						pc->stats.primary[i] = 0;
 					}
 				}
 			}
-			else if (infile.key == "currency") {
-				currency = Parse::toInt(infile.val);
+			else if (key == "currency") {
+				currency = Parse::toInt(val);
 			}
-			else if (infile.key == "equipped") {
-				menu->inv->inventory[MenuInventory::EQUIPMENT].setItems(infile.val);
+			else if (key == "equipped") {
+				menu->inv->inventory[MenuInventory::EQUIPMENT].setItems(val);
 			}
-			else if (infile.key == "equipped_quantity") {
-				menu->inv->inventory[MenuInventory::EQUIPMENT].setQuantities(infile.val);
+			else if (key == "equipped_quantity") {
+				menu->inv->inventory[MenuInventory::EQUIPMENT].setQuantities(val);
 			}
-			else if (infile.key == "carried") {
-				menu->inv->inventory[MenuInventory::CARRIED].setItems(infile.val);
+			else if (key == "carried") {
+				menu->inv->inventory[MenuInventory::CARRIED].setItems(val);
 			}
-			else if (infile.key == "carried_quantity") {
-				menu->inv->inventory[MenuInventory::CARRIED].setQuantities(infile.val);
+			else if (key == "carried_quantity") {
+				menu->inv->inventory[MenuInventory::CARRIED].setQuantities(val);
 			}
-			else if (infile.key == "spawn") {
-				mapr->teleport_mapname = Parse::popFirstString(infile.val);
+			else if (key == "spawn") {
+				mapr->teleport_mapname = Parse::popFirstString(val);
 				if (mapr->teleport_mapname != "" && Filesystem::fileExists(mods->locate(mapr->teleport_mapname))) {
-					mapr->teleport_destination.x = static_cast<float>(Parse::popFirstInt(infile.val)) + 0.5f;
-					mapr->teleport_destination.y = static_cast<float>(Parse::popFirstInt(infile.val)) + 0.5f;
+					mapr->teleport_destination.x = static_cast<float>(Parse::popFirstInt(val)) + 0.5f;
+					mapr->teleport_destination.y = static_cast<float>(Parse::popFirstInt(val)) + 0.5f;
 					mapr->teleportation = true;
 					// prevent spawn.txt from putting us on the starting map
 					mapr->clearEvents();
@@ -324,9 +352,9 @@ void SaveLoad::loadGame() {
 					mapr->teleportation = true;
 				}
 			}
-			else if (infile.key == "actionbar") {
+			else if (key == "actionbar") {
 				for (int i = 0; i < MenuActionBar::SLOT_MAX; i++) {
-					hotkeys[i] = Parse::popFirstInt(infile.val);
+					hotkeys[i] = Parse::popFirstInt(val);
 					if (hotkeys[i] < 0) {
 						Utils::logError("SaveLoad: Hotkey power on position %d has negative id, skipping", i);
 						hotkeys[i] = 0;
@@ -342,43 +370,42 @@ void SaveLoad::loadGame() {
 				}
 				menu->act->set(hotkeys);
 			}
-			else if (infile.key == "transformed") {
-				pc->stats.transform_type = Parse::popFirstString(infile.val);
+			else if (key == "transformed") {
+				pc->stats.transform_type = Parse::popFirstString(val);
 				if (pc->stats.transform_type != "") {
 					pc->stats.transform_duration = -1;
-					pc->stats.manual_untransform = Parse::toBool(Parse::popFirstString(infile.val));
+					pc->stats.manual_untransform = Parse::toBool(Parse::popFirstString(val));
 				}
 			}
-			else if (infile.key == "powers") {
+			else if (key == "powers") {
 				std::string power;
-				while ( (power = Parse::popFirstString(infile.val)) != "") {
+				while ( (power = Parse::popFirstString(val)) != "") {
 					if (Parse::toInt(power) > 0)
 						pc->stats.powers_list.push_back(Parse::toInt(power));
 				}
 			}
-			else if (infile.key == "campaign") camp->setAll(infile.val);
-			else if (infile.key == "time_played") pc->time_played = Parse::toUnsignedLong(infile.val);
-			else if (infile.key == "engine_version") save_version.setFromString(infile.val);
-			else if (eset->misc.save_buyback && infile.key == "buyback_item") {
-				std::string npc_filename = Parse::popFirstString(infile.val, ';');
+			else if (key == "campaign") camp->setAll(val);
+			else if (key == "time_played") pc->time_played = Parse::toUnsignedLong(val);
+			else if (key == "engine_version") save_version.setFromString(val);
+			else if (eset->misc.save_buyback && key == "buyback_item") {
+				std::string npc_filename = Parse::popFirstString(val, ';');
 				if (!npc_filename.empty()) {
 					menu->vendor->buyback_stock[npc_filename].init(NPC::VENDOR_MAX_STOCK);
-					menu->vendor->buyback_stock[npc_filename].setItems(infile.val);
+					menu->vendor->buyback_stock[npc_filename].setItems(val);
 				}
 			}
-			else if (eset->misc.save_buyback && infile.key == "buyback_quantity") {
-				std::string npc_filename = Parse::popFirstString(infile.val, ';');
+			else if (eset->misc.save_buyback && key == "buyback_quantity") {
+				std::string npc_filename = Parse::popFirstString(val, ';');
 				if (!npc_filename.empty()) {
 					menu->vendor->buyback_stock[npc_filename].init(NPC::VENDOR_MAX_STOCK);
-					menu->vendor->buyback_stock[npc_filename].setQuantities(infile.val);
+					menu->vendor->buyback_stock[npc_filename].setQuantities(val);
 				}
 			}
-			else if (infile.key == "questlog_dismissed") pc->questlog_dismissed = Parse::toBool(infile.val);
+			else if (key == "questlog_dismissed") pc->questlog_dismissed = Parse::toBool(val);
 		}
 
-		infile.close();
 	}
-	else Utils::logError("SaveLoad: Unable to open %s!", ss.str().c_str());
+	else Utils::logError("SaveLoad: Unable to open %s!", slot_filenames[0].c_str());
 
 	// set starting values for primary stats based on class
 	EngineSettings::HeroClasses::HeroClass* pc_class;
@@ -475,29 +502,57 @@ void SaveLoad::loadClass(int index) {
  */
 void SaveLoad::loadStash() {
 	// Load stash
-	FileParser infile;
-	std::stringstream ss;
-	if (pc->stats.permadeath)
-		ss << settings->path_user << "saves/" << eset->misc.save_prefix << "/" << game_slot << "/stash_HC.txt";
-	else
-		ss << settings->path_user << "saves/" << eset->misc.save_prefix << "/stash.txt";
+	std::vector<SaveFile::Value> values;
+	const std::string stash_filename = getStashFilename(".dat");
 
-	if (infile.open(Filesystem::path(&ss), !FileParser::MOD_FILE, FileParser::ERROR_NONE)) {
-		while (infile.next()) {
-			if (infile.key == "item") {
-				menu->stash->stock.setItems(infile.val);
+	if (SaveFile::readValues(stash_filename, getStashFilename(".txt"), values)) {
+		for (size_t i = 0; i < values.size(); ++i) {
+			if (values[i].key == "item") {
+				menu->stash->stock.setItems(values[i].val);
 			}
-			else if (infile.key == "quantity") {
-				menu->stash->stock.setQuantities(infile.val);
+			else if (values[i].key == "quantity") {
+				menu->stash->stock.setQuantities(values[i].val);
 			}
 		}
-		infile.close();
 	}
-	else Utils::logInfo("SaveLoad: Could not open stash file '%s'. This may be because it hasn't been created yet.", ss.str().c_str());
+	else Utils::logInfo("SaveLoad: Could not open stash file '%s'. This may be because it hasn't been created yet.", stash_filename.c_str());
 
 	menu->stash->stock.clean();
 }
 
+/**
+ * Path of a file in the save directory of the current slot
+ */
+std::string SaveLoad::getSlotFilename(const std::string& filename) {
+	std::stringstream ss;
+	ss << settings->path_user << "saves/" << eset->misc.save_prefix << "/" << game_slot << "/" << filename;
+	return Filesystem::path(&ss);
+}
+
+/**
+ * The binary save files of the slot. The first one is the avatar, which decides if the save
+ * is newer than a text save (see SaveFile::readValues()).
+ */
+std::vector<std::string> SaveLoad::getSlotFilenames() {
+	std::vector<std::string> filenames;
+	filenames.push_back(getSlotFilename("avatar.dat"));
+	filenames.push_back(getSlotFilename("inventory.dat"));
+	filenames.push_back(getSlotFilename("campaign.dat"));
+	return filenames;
+}
+
+/**
+ * Path of the stash file with the given extension. Permadeath characters have their own stash.
+ */
+std::string SaveLoad::getStashFilename(const std::string& extension) {
+	std::stringstream ss;
+	if (pc->stats.permadeath)
+		ss << settings->path_user << "saves/" << eset->misc.save_prefix << "/" << game_slot << "/stash_HC" << extension;
+	else
+		ss << settings->path_user << "saves/" << eset->misc.save_prefix << "/stash" << extension;
+	return Filesystem::path(&ss);
+}
+
 /**
  * Performs final calculations after loading a save or a new class
  */
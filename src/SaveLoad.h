@@ -25,6 +25,9 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #ifndef SAVELOAD_H
 #define SAVELOAD_H
 
+#include "CommonIncludes.h"
+#include "SaveFile.h"
+
 class SaveLoad {
 public:
 	SaveLoad();
@@ -44,9 +47,21 @@ public:
 
 private:
 	void applyPlayerData();
+	void saveSummary();
 	void loadPowerTree();
+	std::string getSlotFilename(const std::string& filename);
+	std::string getStashFilename(const std::string& extension);
+	std::vector<std::string> getSlotFilenames();
 
 	int game_slot;
+
+	// the last save of the current slot and stash. The avatar changes on every save (e.g. the
+	// time played), so the inventory and the campaign are saved to their own files, which are
+	// skipped while they don't change.
+	SaveFile avatar_file;
+	SaveFile inventory_file;
+	SaveFile campaign_file;
+	SaveFile stash_file;
 };
 
 #endif
@@ -0,0 +1,226 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class SaveSummary
+ */
+
+#include "EngineSettings.h"
+#include "FileParser.h"
+#include "ModManager.h"
+#include "SaveFile.h"
+#include "SaveSummary.h"
+#include "SharedResources.h"
+#include "Utils.h"
+#include "UtilsFileSystem.h"
+#include "UtilsParsing.h"
+#include "Version.h"
+
+#include <stdlib.h>
+
+SaveSummary::SaveSummary()
+	: avatar_mtime(-1)
+	, permadeath(false)
+	, level(1)
+	, time_played(0)
+{
+}
+
+/**
+ * Returns false if the summary doesn't exist or was written by a different version
+ */
+bool SaveSummary::read(const std::string& filename) {
+	FileParser infile;
+	if (!infile.open(filename, !FileParser::MOD_FILE, FileParser::ERROR_NONE))
+		return false;
+
+	bool valid = false;
+
+	while (infile.next()) {
+		if (infile.key == "version") {
+			valid = (Parse::toInt(infile.val) == VERSION);
+			if (!valid)
+				break;
+		}
+		else if (infile.key == "avatar_mtime")
+			avatar_mtime = atol(infile.val.c_str());
+		else if (infile.key == "mods")
+			mod_list = infile.val;
+		else if (infile.key == "name")
+			name = infile.val;
+		else if (infile.key == "permadeath")
+			permadeath = Parse::toBool(infile.val);
+		else if (infile.key == "level")
+			level = Parse::toInt(infile.val);
+		else if (infile.key == "class") {
+			character_class = Parse::popFirstString(infile.val);
+			character_subclass = Parse::popFirstString(infile.val);
+		}
+		else if (infile.key == "option") {
+			gfx_base = Parse::popFirstString(infile.val);
+			gfx_head = Parse::popFirstString(infile.val);
+			gfx_portrait = Parse::popFirstString(infile.val);
+		}
+		else if (infile.key == "map")
+			map_title = infile.val;
+		else if (infile.key == "time_played")
+			time_played = Parse::toUnsignedLong(infile.val);
+		else if (infile.key == "equipped")
+			setEquipped(infile.val);
+	}
+
+	infile.close();
+	return valid;
+}
+
+/**
+ * Build the summary from the save file itself. Also looks up the title of the spawn map.
+ */
+bool SaveSummary::readFromSave(const std::string& slot_path) {
+	// the equipment is saved in inventory.dat (see SaveLoad::getSlotFilenames())
+	std::vector<std::string> filenames;
+	filenames.push_back(slot_path + "avatar.dat");
+	filenames.push_back(slot_path + "inventory.dat");
+
+	std::vector<SaveFile::Value> values;
+	if (!SaveFile::readValues(filenames, slot_path + "avatar.txt", values))
+		return false;
+
+	unsigned long xp = 0;
+
+	for (size_t i = 0; i < values.size(); ++i) {
+		const std::string& key = values[i].key;
+		std::string& val = values[i].val;
+
+		if (key == "name")
+			name = val;
+		else if (key == "class") {
+			character_class = Parse::popFirstString(val);
+			character_subclass = Parse::popFirstString(val);
+		}
+		else if (key == "xp")
+			xp = Parse::toUnsignedLong(val);
+		else if (key == "equipped")
+			setEquipped(val);
+		else if (key == "option") {
+			gfx_base = Parse::popFirstString(val);
+			gfx_head = Parse::popFirstString(val);
+			gfx_portrait = Parse::popFirstString(val);
+		}
+		else if (key == "spawn")
+			map_title = getMapTitle(Parse::popFirstString(val));
+		else if (key == "permadeath")
+			permadeath = Parse::toBool(val);
+		else if (key == "time_played")
+			time_played = Parse::toUnsignedLong(val);
+	}
+
+	level = getLevelFromXP(xp);
+	avatar_mtime = SaveFile::getModifiedTime(slot_path + "avatar.dat", slot_path + "avatar.txt");
+	mod_list = getModList();
+	return true;
+}
+
+bool SaveSummary::write(const std::string& filename) const {
+	std::ofstream outfile;
+	outfile.open(filename.c_str(), std::ios::out | std::ios::trunc);
+	if (!outfile.is_open()) {
+		Utils::logError("SaveSummary: Could not write '%s'.", filename.c_str());
+		return false;
+	}
+
+	outfile << "# Generated by Flare for the load screen. It is rebuilt from the save if needed." << "\n";
+	outfile << "version=" << VERSION << "\n";
+	outfile << "avatar_mtime=" << avatar_mtime << "\n";
+	outfile << "mods=" << mod_list << "\n";
+	outfile << "name=" << name << "\n";
+	outfile << "permadeath=" << permadeath << "\n";
+	outfile << "level=" << level << "\n";
+	outfile << "class=" << character_class << "," << character_subclass << "\n";
+	outfile << "option=" << gfx_base << "," << gfx_head << "," << gfx_portrait << "\n";
+	outfile << "map=" << map_title << "\n";
+	outfile << "time_played=" << time_played << "\n";
+
+	outfile << "equipped=";
+	for (size_t i = 0; i < equipped.size(); ++i) {
+		if (i > 0)
+			outfile << ",";
+		outfile << equipped[i];
+	}
+	outfile << "\n";
+
+	const bool success = !outfile.fail();
+	outfile.close();
+
+	if (!success)
+		Utils::logError("SaveSummary: Could not write '%s'.", filename.c_str());
+
+	return success;
+}
+
+/**
+ * Parse a list of item ids, as stored by the "equipped" key of a save
+ */
+void SaveSummary::setEquipped(std::string val) {
+	equipped.clear();
+
+	std::string repeat_val = Parse::popFirstString(val);
+	while (repeat_val != "") {
+		equipped.push_back(Parse::toInt(repeat_val));
+		repeat_val = Parse::popFirstString(val);
+	}
+}
+
+/**
+ * The same level that StatBlock::recalc() calculates for the hero
+ */
+int SaveSummary::getLevelFromXP(unsigned long xp) {
+	unsigned long xp_max = eset->xp.getLevelXP(eset->xp.getMaxLevel());
+	return std::max(eset->xp.getLevelFromXP(std::min(xp, xp_max)), 1);
+}
+
+std::string SaveSummary::getMapTitle(const std::string& map_filename) {
+	FileParser infile;
+	if (!infile.open(map_filename, FileParser::MOD_FILE, FileParser::ERROR_NONE))
+		return "";
+
+	std::string map_title = "";
+
+	while (map_title == "" && infile.next()) {
+		if (infile.key == "title")
+			map_title = infile.val;
+	}
+
+	infile.close();
+	return map_title;
+}
+
+/**
+ * The enabled mods and their versions, in load order. The class names, levels and map titles
+ * in a summary all come from mod data, so a summary written with other mods is rebuilt.
+ */
+std::string SaveSummary::getModList() {
+	std::stringstream ss;
+	for (size_t i = 0; i < mods->mod_list.size(); ++i) {
+		if (i > 0)
+			ss << ",";
+		ss << mods->mod_list[i].name;
+		if (*mods->mod_list[i].version != VersionInfo::MIN)
+			ss << ":" << mods->mod_list[i].version->getString();
+	}
+	return ss.str();
+}
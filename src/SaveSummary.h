@@ -0,0 +1,64 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class SaveSummary
+ *
+ * The parts of a save file that the load screen shows: name, level, class, map, equipment and play time.
+ * SaveLoad::saveGame() writes a summary next to each save, so GameStateLoad doesn't need to parse
+ * every save (and the maps they refer to) to list the save slots. A summary is only used while the
+ * modification time of the save and the list of enabled mods match the ones stored in the summary.
+ */
+
+#ifndef SAVE_SUMMARY_H
+#define SAVE_SUMMARY_H
+
+#include "CommonIncludes.h"
+
+class SaveSummary {
+public:
+	static const int VERSION = 1;
+
+	long avatar_mtime;
+	std::string mod_list; // see getModList()
+
+	std::string name;
+	bool permadeath;
+	int level;
+	std::string character_class;
+	std::string character_subclass;
+	std::string gfx_base;
+	std::string gfx_head;
+	std::string gfx_portrait;
+	std::string map_title; // untranslated
+	unsigned long time_played;
+	std::vector<int> equipped;
+
+	SaveSummary();
+
+	bool read(const std::string& filename);
+	bool readFromSave(const std::string& slot_path);
+	bool write(const std::string& filename) const;
+
+	void setEquipped(std::string val);
+
+	static int getLevelFromXP(unsigned long xp);
+	static std::string getMapTitle(const std::string& map_filename);
+	static std::string getModList();
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class ScriptedInputState
+ */
+
+#include "ScriptedInputState.h"
+#include "Settings.h"
+#include "SharedResources.h"
+
+ScriptedInputState::ScriptedInputState(const std::string& script_filename)
+	: SDLInputState()
+	, next_event(0)
+	, tick(0)
+{
+	settings->enable_joystick = false;
+
+	if (!script_filename.empty())
+		script.load(script_filename);
+}
+
+ScriptedInputState::~ScriptedInputState() {
+}
+
+/**
+ * Apply the events of the current logic tick. Called once per logic tick.
+ */
+void ScriptedInputState::handle() {
+	// like SDLInputState, events are applied even while lock_all is set
+	InputState::handle();
+
+	const std::vector<InputScript::Event>& events = script.getEvents();
+
+	while (next_event < events.size() && events[next_event].tick <= tick) {
+		const InputScript::Event& ev = events[next_event];
+
+		if (ev.type == InputScript::EVENT_KEY) {
+			pressing[ev.key] = ev.pressed;
+			if (!ev.pressed)
+				lock[ev.key] = false;
+		}
+		else if (ev.type == InputScript::EVENT_MOUSE) {
+			mouse = ev.mouse;
+		}
+		else if (ev.type == InputScript::EVENT_SCROLL_UP) {
+			scroll_up = true;
+		}
+		else if (ev.type == InputScript::EVENT_SCROLL_DOWN) {
+			scroll_down = true;
+		}
+		else if (ev.type == InputScript::EVENT_TEXT) {
+			inkeys = ev.text;
+		}
+		else if (ev.type == InputScript::EVENT_QUIT) {
+			done = true;
+		}
+
+		next_event++;
+	}
+
+	tick++;
+}
+
+/**
+ * Joysticks are ignored
+ */
+void ScriptedInputState::initJoystick() {
+}
+
+unsigned ScriptedInputState::getTick() const {
+	return tick;
+}
@@ -0,0 +1,48 @@
+/*
+Copyright © 2018 Justin Jacobs
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class ScriptedInputState
+ *
+ * Ignores the keyboard, mouse and joysticks, and replays an InputScript instead.
+ * Key bindings and names are the same as SDLInputState.
+ * Used when running without a window (see the --headless command line option).
+ */
+
+#ifndef SCRIPTED_INPUT_STATE_H
+#define SCRIPTED_INPUT_STATE_H
+
+#include "InputScript.h"
+#include "SDLInputState.h"
+
+class ScriptedInputState : public SDLInputState {
+public:
+	explicit ScriptedInputState(const std::string& script_filename);
+	~ScriptedInputState();
+
+	void handle();
+	void initJoystick();
+
+	unsigned getTick() const;
+
+private:
+	InputScript script;
+	size_t next_event;
+	unsigned tick;
+};
+
+#endif
@@ -59,8 +59,11 @@ Settings::Settings()
 	, show_hud(true)
 	, encounter_dist(0) // set in updateScreenVars()
 	, soft_reset(false)
+	, verify_stats(false)
+	, render_interpolation(1)
+	, headless(false)
 {
-	config.resize(35);
+	config.resize(40);
 	setConfigDefault(0,  "fullscreen",        &typeid(fullscreen),         "0",            &fullscreen,         "fullscreen mode. 1 enable, 0 disable.");
 	setConfigDefault(1,  "resolution_w",      &typeid(screen_w),           "640",          &screen_w,           "display resolution. 640x480 minimum.");
 	setConfigDefault(2,  "resolution_h",      &typeid(screen_h),           "480",          &screen_h,           "");
@@ -96,6 +99,11 @@ Settings::Settings()
 	setConfigDefault(32, "mouse_move_swap",   &typeid(mouse_move_swap),    "0",            &mouse_move_swap,    "use 'Main2' as the movement action when using mouse movement. 1 enable, 0 disable.");
 	setConfigDefault(33, "mouse_move_attack", &typeid(mouse_move_attack),  "1",            &mouse_move_attack,  "allows attacking with the mouse movement button if an enemy is targeted and in range. 1 enable, 0 disable.");
 	setConfigDefault(34, "prev_save_slot",    &typeid(prev_save_slot),     "-1",           &prev_save_slot,     "index of the last used save slot");
+	setConfigDefault(35, "map_chunk_cache",   &typeid(map_chunk_cache),    "0",            &map_chunk_cache,    "pre-render static map tiles in large chunks. 1 enable, 0 disable.");
+	setConfigDefault(36, "map_chunk_cache_mb", &typeid(map_chunk_cache_mb), "64",         &map_chunk_cache_mb,  "video memory budget for pre-rendered map chunks, in megabytes.");
+	setConfigDefault(37, "mod_index_cache",   &typeid(mod_index_cache),    "0",            &mod_index_cache,    "save the list of mod files between runs to speed up loading. 1 enable, 0 disable.");
+	setConfigDefault(38, "font_atlas",        &typeid(font_atlas),         "0",            &font_atlas,         "draw text from a cache of pre-rendered characters. Kerning is not applied. 1 enable, 0 disable.");
+	setConfigDefault(39, "max_render_fps",    &typeid(max_render_fps),     "0",            &max_render_fps,     "maximum frames drawn per second. Game speed is set by max_fps, and movement is smoothed between game frames. 0 draws one frame per game frame.");
 }
 
 void Settings::setConfigDefault(size_t index, const std::string& name, const std::type_info *type, const std::string& default_val, void *storage, const std::string& comment) {
@@ -153,6 +161,9 @@ void Settings::loadSettings() {
  * Save the current main settings (primary video and audio settings)
  */
 void Settings::saveSettings() {
+	if (headless)
+		return;
+
 	std::ofstream outfile;
 	outfile.open((settings->path_conf + "settings.txt").c_str(), std::ios::out);
 
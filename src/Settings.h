@@ -58,10 +58,15 @@ public:
 	bool texture_filter;
 	bool dpi_scaling;
 	unsigned short max_frames_per_sec;
+	unsigned short max_render_fps;
 	std::string render_device_name;
 	bool change_gamma;
 	float gamma;
 	bool parallax_layers;
+	bool map_chunk_cache;
+	unsigned short map_chunk_cache_mb;
+	bool mod_index_cache;
+	bool font_atlas;
 
 	// Audio Settings
 	unsigned short music_volume;
@@ -129,6 +134,12 @@ public:
 
 	bool soft_reset;
 
+	bool verify_stats; // compare per-frame stat updates to a full calculation (see StatBlock::checkStats())
+
+	float render_interpolation; // how far the drawn frame is between the previous and the latest logic frame (see max_render_fps)
+
+	bool headless; // no window, audio or user input, and settings and saves are not written (see --headless)
+
 private:
 	class ConfigEntry {
 	public:
@@ -52,6 +52,7 @@ IconManager *icons = NULL;
 InputState *inpt = NULL;
 MessageEngine *msg = NULL;
 ModManager *mods = NULL;
+Profiler *profiler = NULL;
 RenderDevice *render_device = NULL;
 SaveLoad *save_load = NULL;
 Settings *settings = NULL;
@@ -41,6 +41,7 @@ class IconManager;
 class InputState;
 class MessageEngine;
 class ModManager;
+class Profiler;
 class RenderDevice;
 class SaveLoad;
 class Settings;
@@ -56,6 +57,7 @@ extern IconManager *icons;
 extern InputState *inpt;
 extern MessageEngine *msg;
 extern ModManager *mods;
+extern Profiler *profiler;
 extern RenderDevice *render_device;
 extern SaveLoad *save_load;
 extern Settings *settings;
@@ -22,6 +22,8 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "CommonIncludes.h"
 #include "Utils.h"
 
+struct Mix_Chunk;
+
 /**
  * class SoundManager
  *
@@ -32,6 +34,28 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 **/
 class SoundManager {
 public:
+	/**
+	 * Counters of the sound effect voices (i.e. mixer channels) since the game was started
+	 */
+	class VoiceStats {
+	public:
+		VoiceStats()
+			: active(0)
+			, channels(0)
+			, started(0)
+			, merged(0)
+			, culled(0)
+			, culled_per_second(0) {
+		}
+
+		int active; // voices that are playing now
+		int channels; // maximum number of voices
+		unsigned long started;
+		unsigned long merged; // same sound started again during the same frame
+		unsigned long culled; // not started, or stopped to start a more important sound
+		int culled_per_second; // during the last second
+	};
+
 	static const std::string DEFAULT_CHANNEL;
 	static const FPoint NO_POS;
 	static const bool LOOP = true;
@@ -39,6 +63,7 @@ public:
 	virtual ~SoundManager() {};
 
 	virtual SoundID load(const std::string& filename, const std::string& errormessage) = 0;
+	virtual SoundID loadFromChunk(const std::string& filename, Mix_Chunk* chunk) = 0;
 	virtual void unload(SoundID) = 0;
 	virtual void play(SoundID, const std::string& channel, const FPoint& pos, bool loop) = 0;
 	virtual void pauseAll() = 0;
@@ -56,6 +81,7 @@ public:
 	virtual void reset() = 0;
 
 	virtual SoundID getLastPlayedSID() = 0;
+	virtual void getVoiceStats(VoiceStats& stats) = 0;
 };
 
 /**
@@ -69,18 +95,21 @@ class Playback {
 public:
 	Playback()
 		: sid(-1)
+		, virtual_channel(0)
 		, location(FPoint())
 		, loop(false)
 		, paused(false)
-		, finished(false) {
+		, finished(false)
+		, start_frame(0) {
 	}
 
 	SoundID sid;
-	std::string virtual_channel;
+	StringID virtual_channel; // interned channel name, 0 for DEFAULT_CHANNEL
 	FPoint location;
 	bool loop;
 	bool paused;
 	bool finished;
+	unsigned start_frame; // see SDLSoundManager::frame
 };
 
 #endif
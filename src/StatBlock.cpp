@@ -50,6 +50,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 StatBlock::StatBlock()
 	: statsLoaded(false)
+	, stats_outdated(true)
 	, alive(true)
 	, corpse(false)
 	, corpse_timer()
@@ -109,6 +110,7 @@ StatBlock::StatBlock()
 	, effects()
 	, blocking(false) // hero only
 	, pos()
+	, prev_pos()
 	, knockback_speed()
 	, knockback_srcpos()
 	, knockback_destpos()
@@ -631,30 +633,47 @@ void StatBlock::recalc() {
  * Plus an optional bonus_per_[base stat]
  */
 void StatBlock::calcBase() {
+	for (size_t i = 0; i < Stats::COUNT + eset->damage_types.count; ++i) {
+		calcBaseStat(i);
+	}
+}
+
+/**
+ * Calculate a single base stat. Maximum damage and absorb depend on the minimum,
+ * so the minimum has to be calculated first.
+ */
+void StatBlock::calcBaseStat(size_t stat) {
 	// bonuses are skipped for the default level 1 of a stat
 	int lev0 = std::max(level - 1, 0);
 
-	for (size_t i = 0; i < Stats::COUNT + eset->damage_types.count; ++i) {
-		base[i] = starting[i];
-		base[i] += lev0 * per_level[i];
-		for (size_t j = 0; j < per_primary.size(); ++j) {
-			base[i] += std::max(get_primary(j) - 1, 0) * per_primary[j][i];
-		}
+	base[stat] = starting[stat];
+	base[stat] += lev0 * per_level[stat];
+	for (size_t j = 0; j < per_primary.size(); ++j) {
+		base[stat] += std::max(get_primary(j) - 1, 0) * per_primary[j][stat];
 	}
 
 	// add damage from equipment and increase to minimum amounts
-	for (size_t i = 0; i < eset->damage_types.list.size(); ++i) {
-		base[Stats::COUNT + (i*2)] += dmg_min_add[i];
-		base[Stats::COUNT + (i*2) + 1] += dmg_max_add[i];
-		base[Stats::COUNT + (i*2)] = std::max(base[Stats::COUNT + (i*2)], 0);
-		base[Stats::COUNT + (i*2) + 1] = std::max(base[Stats::COUNT + (i*2) + 1], base[Stats::COUNT + (i*2)]);
+	if (stat >= Stats::COUNT) {
+		size_t dmg_type = (stat - Stats::COUNT) / 2;
+		if ((stat - Stats::COUNT) % 2 == 0) {
+			base[stat] += dmg_min_add[dmg_type];
+			base[stat] = std::max(base[stat], 0);
+		}
+		else {
+			base[stat] += dmg_max_add[dmg_type];
+			base[stat] = std::max(base[stat], base[stat-1]);
+		}
 	}
 
 	// add absorb from equipment and increase to minimum amounts
-	base[Stats::ABS_MIN] += absorb_min_add;
-	base[Stats::ABS_MAX] += absorb_max_add;
-	base[Stats::ABS_MIN] = std::max(base[Stats::ABS_MIN], 0);
-	base[Stats::ABS_MAX] = std::max(base[Stats::ABS_MAX], base[Stats::ABS_MIN]);
+	if (stat == Stats::ABS_MIN) {
+		base[Stats::ABS_MIN] += absorb_min_add;
+		base[Stats::ABS_MIN] = std::max(base[Stats::ABS_MIN], 0);
+	}
+	else if (stat == Stats::ABS_MAX) {
+		base[Stats::ABS_MAX] += absorb_max_add;
+		base[Stats::ABS_MAX] = std::max(base[Stats::ABS_MAX], base[Stats::ABS_MIN]);
+	}
 }
 
 /**
@@ -669,6 +688,15 @@ void StatBlock::applyEffects() {
 	prev_hp = hp;
 	prev_mp = mp;
 
+	calcStats();
+
+	if (hp > get(Stats::HP_MAX)) hp = get(Stats::HP_MAX);
+	if (mp > get(Stats::MP_MAX)) mp = get(Stats::MP_MAX);
+
+	speed = speed_default;
+}
+
+void StatBlock::calcStats() {
 	// calculate primary stats
 	// refresh the character menu if there has been a change
 	for (size_t i = 0; i < primary.size(); ++i) {
@@ -695,12 +723,137 @@ void StatBlock::applyEffects() {
 	current[Stats::HP_MAX] = std::max(get(Stats::HP_MAX), 1);
 	current[Stats::MP_MAX] = std::max(get(Stats::MP_MAX), 1);
 
+	effects.changed_bonus.clear();
+	stats_outdated = false;
+}
+
+/**
+ * Per-frame version of applyEffects().
+ * Only the stats affected by changed effect bonuses are calculated again.
+ */
+void StatBlock::updateStats() {
+	if (stats_outdated) {
+		applyEffects();
+		return;
+	}
+
+	prev_maxhp = std::max(get(Stats::HP_MAX), 1);
+	prev_maxmp = std::max(get(Stats::MP_MAX), 1);
+	prev_hp = hp;
+	prev_mp = mp;
+
+	if (!effects.changed_bonus.empty()) {
+		const size_t stat_count = Stats::COUNT + eset->damage_types.count;
+		const size_t primary_offset = stat_count + effects.bonus_resist.size();
+
+		std::vector<bool> base_changed(stat_count, false);
+		std::vector<bool> current_changed(stat_count, false);
+
+		for (size_t i = 0; i < effects.changed_bonus.size(); ++i) {
+			const size_t index = effects.changed_bonus[i];
+
+			if (index < stat_count) {
+				current_changed[index] = true;
+			}
+			else if (index < primary_offset) {
+				const size_t element = index - stat_count;
+				vulnerable[element] = vulnerable_base[element] - effects.bonus_resist[element];
+			}
+			else if (index - primary_offset < primary.size()) {
+				const size_t primary_index = index - primary_offset;
+				if (get_primary(primary_index) != primary[primary_index] + effects.bonus_primary[primary_index])
+					refresh_stats = true;
+
+				primary_additional[primary_index] = effects.bonus_primary[primary_index];
+
+				for (size_t j = 0; j < stat_count; ++j) {
+					if (per_primary[primary_index][j] != 0)
+						base_changed[j] = true;
+				}
+			}
+		}
+		effects.changed_bonus.clear();
+
+		// the maximum of a range is limited by its minimum
+		if (base_changed[Stats::ABS_MIN])
+			base_changed[Stats::ABS_MAX] = true;
+		for (size_t i = Stats::COUNT; i + 1 < stat_count; i += 2) {
+			if (base_changed[i])
+				base_changed[i+1] = true;
+		}
+
+		for (size_t i = 0; i < stat_count; ++i) {
+			if (base_changed[i]) {
+				calcBaseStat(i);
+				current_changed[i] = true;
+			}
+			if (current_changed[i])
+				current[i] = base[i] + effects.bonus[i];
+		}
+
+		if (current_changed[Stats::HP_MAX] || current_changed[Stats::HP_PERCENT]) {
+			current[Stats::HP_MAX] = base[Stats::HP_MAX] + effects.bonus[Stats::HP_MAX];
+			current[Stats::HP_MAX] += (current[Stats::HP_MAX] * current[Stats::HP_PERCENT]) / 100;
+			current[Stats::HP_MAX] = std::max(get(Stats::HP_MAX), 1);
+		}
+		if (current_changed[Stats::MP_MAX] || current_changed[Stats::MP_PERCENT]) {
+			current[Stats::MP_MAX] = base[Stats::MP_MAX] + effects.bonus[Stats::MP_MAX];
+			current[Stats::MP_MAX] += (current[Stats::MP_MAX] * current[Stats::MP_PERCENT]) / 100;
+			current[Stats::MP_MAX] = std::max(get(Stats::MP_MAX), 1);
+		}
+	}
+
+	if (settings->verify_stats)
+		checkStats();
+
 	if (hp > get(Stats::HP_MAX)) hp = get(Stats::HP_MAX);
 	if (mp > get(Stats::MP_MAX)) mp = get(Stats::MP_MAX);
 
 	speed = speed_default;
 }
 
+/**
+ * Anything that changes the level, primary stats, equipment or base values of this StatBlock
+ * without calling recalc() or applyEffects() needs to call this.
+ */
+void StatBlock::setStatsOutdated() {
+	stats_outdated = true;
+}
+
+/**
+ * Debug check for updateStats(): compare its results to a full calculation
+ */
+void StatBlock::checkStats() {
+	const std::vector<int> prev_base = base;
+	const std::vector<int> prev_current = current;
+	const std::vector<int> prev_vulnerable = vulnerable;
+	const std::vector<int> prev_primary_additional = primary_additional;
+
+	calcStats();
+
+	for (size_t i = 0; i < current.size(); ++i) {
+		if (prev_base[i] != base[i] || prev_current[i] != current[i]) {
+			std::string stat_name;
+			if (i < Stats::COUNT)
+				stat_name = Stats::KEY[i];
+			else if ((i - Stats::COUNT) % 2 == 0)
+				stat_name = eset->damage_types.list[(i - Stats::COUNT) / 2].min;
+			else
+				stat_name = eset->damage_types.list[(i - Stats::COUNT) / 2].max;
+
+			Utils::logError("StatBlock: '%s' stat '%s' is %d/%d, should be %d/%d.", name.c_str(), stat_name.c_str(), prev_base[i], prev_current[i], base[i], current[i]);
+		}
+	}
+	for (size_t i = 0; i < vulnerable.size(); ++i) {
+		if (prev_vulnerable[i] != vulnerable[i])
+			Utils::logError("StatBlock: '%s' vulnerability '%s' is %d, should be %d.", name.c_str(), eset->elements.list[i].id.c_str(), prev_vulnerable[i], vulnerable[i]);
+	}
+	for (size_t i = 0; i < primary_additional.size(); ++i) {
+		if (prev_primary_additional[i] != primary_additional[i])
+			Utils::logError("StatBlock: '%s' primary stat bonus '%s' is %d, should be %d.", name.c_str(), eset->primary_stats.list[i].id.c_str(), prev_primary_additional[i], primary_additional[i]);
+	}
+}
+
 /**
  * Process per-frame actions
  */
@@ -729,7 +882,7 @@ void StatBlock::logic() {
 	effects.logic();
 
 	// apply bonuses from items/effects to base stats
-	applyEffects();
+	updateStats();
 
 	if (hero && effects.refresh_stats) {
 		refresh_stats = true;
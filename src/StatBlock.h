@@ -40,7 +40,11 @@ private:
 	bool loadSfxStat(FileParser *infile);
 	void loadHeroStats();
 	bool checkRequiredSpawns(int req_amount) const;
+	void calcStats();
+	void calcBaseStat(size_t stat);
+	void checkStats();
 	bool statsLoaded;
+	bool stats_outdated; // a full applyEffects() is needed on the next update
 
 public:
 	enum {
@@ -105,6 +109,8 @@ public:
 	void takeDamage(int dmg);
 	void recalc();
 	void applyEffects();
+	void updateStats();
+	void setStatsOutdated();
 	void calcBase();
 	void logic();
 	void removeSummons();
@@ -224,6 +230,7 @@ public:
 	bool blocking;
 
 	FPoint pos;
+	FPoint prev_pos; // pos at the start of the latest logic frame
 	FPoint knockback_speed;
 	FPoint knockback_srcpos;
 	FPoint knockback_destpos;
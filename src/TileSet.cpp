@@ -189,6 +189,13 @@ void TileSet::logic() {
 	}
 }
 
+/**
+ * Animated tiles change their clip every few frames, so they can't be pre-rendered
+ */
+bool TileSet::isAnimated(unsigned short id) const {
+	return id < anim.size() && anim[id].frames > 0;
+}
+
 TileSet::~TileSet() {
 	for (size_t i = 0; i < sprites.size(); ++i) {
 		if (sprites[i])
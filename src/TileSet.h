@@ -76,6 +76,7 @@ public:
 	~TileSet();
 	void load(const std::string& filename);
 	void logic();
+	bool isAnimated(unsigned short id) const;
 
 	std::vector<Tile_Def> tiles;
 
@@ -36,7 +36,9 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include <ctype.h>
 #include <iomanip>
 #include <iostream>
+#include <deque>
 #include <locale>
+#include <map>
 #include <string.h>
 
 int Utils::LOCK_INDEX = 0;
@@ -292,6 +294,18 @@ float Utils::calcDist(const FPoint& p1, const FPoint& p2) {
 	return sqrtf((p2.x - p1.x) * (p2.x - p1.x) + (p2.y - p1.y) * (p2.y - p1.y));
 }
 
+/**
+ * Where to draw something that moved from prev to pos during the latest logic frame.
+ * Jumps of more than a tile (e.g. teleports) are not smoothed.
+ */
+FPoint Utils::interpolate(const FPoint& prev, const FPoint& pos) {
+	const float alpha = settings->render_interpolation;
+	if (alpha >= 1 || calcDist(prev, pos) > 1)
+		return pos;
+
+	return FPoint(prev.x + (pos.x - prev.x) * alpha, prev.y + (pos.y - prev.y) * alpha);
+}
+
 /**
  * is target within the area defined by center and radius?
  */
@@ -699,6 +713,49 @@ unsigned long Utils::hashString(const std::string& str) {
 	return coll.hash(str.data(), str.data() + str.length());
 }
 
+/**
+ * The tables of interned strings are created on first use,
+ * so that strings can be interned while static variables are initialized.
+ * A deque is used so that references to the strings stay valid when more are added.
+ */
+static std::deque<std::string>& getInternedStrings() {
+	static std::deque<std::string> strings(1); // StringID 0 is the empty string
+	return strings;
+}
+
+static std::map<std::string, StringID>& getInternedIDs() {
+	static std::map<std::string, StringID> ids;
+	return ids;
+}
+
+/**
+ * Returns a small number that is the same for every copy of str, so that identifiers
+ * (e.g. animation and effect names) can be compared as integers.
+ * The empty string is always 0. Only call this from the main thread.
+ */
+StringID Utils::internString(const std::string& str) {
+	if (str.empty())
+		return 0;
+
+	std::map<std::string, StringID>& ids = getInternedIDs();
+	std::map<std::string, StringID>::iterator it = ids.lower_bound(str);
+	if (it != ids.end() && it->first == str)
+		return it->second;
+
+	std::deque<std::string>& strings = getInternedStrings();
+	const StringID id = static_cast<StringID>(strings.size());
+	strings.push_back(str);
+	ids.insert(it, std::make_pair(str, id));
+	return id;
+}
+
+const std::string& Utils::getInternedString(StringID id) {
+	const std::deque<std::string>& strings = getInternedStrings();
+	if (id >= strings.size())
+		return strings[0];
+	return strings[id];
+}
+
 char* Utils::strdup(const std::string& str) {
 	size_t length = str.length() + 1;
 	char *x = static_cast<char*>(malloc(length));
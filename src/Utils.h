@@ -35,6 +35,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 typedef unsigned long SoundID;
 typedef unsigned long StatusID;
+typedef unsigned StringID; // see Utils::internString()
 
 class Avatar;
 class FPoint; // needed for Point -> FPoint constructor
@@ -124,6 +125,7 @@ namespace Utils {
 	unsigned char calcDirection(float x0, float y0, float x1, float y1);
 	bool isWithinRadius(const FPoint& center, float radius, const FPoint& target);
 	bool isWithinRect(const Rect& r, const Point& target);
+	FPoint interpolate(const FPoint& prev, const FPoint& pos);
 
 	std::string abbreviateKilo(int amount);
 	void alignToScreenEdge(int alignment, Rect *r);
@@ -156,6 +158,9 @@ namespace Utils {
 
 	unsigned long hashString(const std::string& str);
 
+	StringID internString(const std::string& str);
+	const std::string& getInternedString(StringID id);
+
 	char* strdup(const std::string& str);
 
 	void lockFileRead();
@@ -116,6 +116,61 @@ int Filesystem::getDirList(const std::string &dir, std::vector<std::string> &dir
 	return 0;
 }
 
+/**
+ * Returns the names of all files and all directories in a given directory, with a single pass over the directory
+ */
+int Filesystem::getDirEntries(const std::string &dir, std::vector<std::string> &files, std::vector<std::string> &dirs) {
+
+	DIR *dp;
+	struct dirent *dirp;
+	struct stat st;
+
+	if((dp  = opendir(dir.c_str())) == NULL) {
+		return errno;
+	}
+
+	while ((dirp = readdir(dp)) != NULL) {
+		std::string name = std::string(dirp->d_name);
+		if (name == "." || name == "..")
+			continue;
+
+		std::string entry_path = dir + "/" + name;
+		if (stat(entry_path.c_str(), &st) == -1)
+			continue;
+
+		if (S_ISDIR(st.st_mode))
+			dirs.push_back(name);
+		else
+			files.push_back(name);
+	}
+	closedir(dp);
+	return 0;
+}
+
+/**
+ * Returns the last modification time of a file or directory, or -1 if it doesn't exist
+ */
+long Filesystem::getModifiedTime(const std::string &path) {
+	struct stat st;
+	if (stat(path.c_str(), &st) == -1)
+		return -1;
+
+	return static_cast<long>(st.st_mtime);
+}
+
+/**
+ * Size and last modification time of a file, with a single stat() call
+ */
+bool Filesystem::getFileStamp(const std::string &path, long &size, long &mtime) {
+	struct stat st;
+	if (stat(path.c_str(), &st) == -1)
+		return false;
+
+	size = static_cast<long>(st.st_size);
+	mtime = static_cast<long>(st.st_mtime);
+	return true;
+}
+
 bool Filesystem::isDirectory(const std::string &path, bool show_error) {
 	struct stat st;
 	if (stat(path.c_str(), &st) == -1) {
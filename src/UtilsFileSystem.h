@@ -33,6 +33,9 @@ namespace Filesystem {
 	bool fileExists(const std::string &filename);
 	int getFileList(const std::string &dir, const std::string &ext, std::vector<std::string> &files);
 	int getDirList(const std::string &dir, std::vector<std::string> &dirs);
+	int getDirEntries(const std::string &dir, std::vector<std::string> &files, std::vector<std::string> &dirs);
+	long getModifiedTime(const std::string &path);
+	bool getFileStamp(const std::string &path, long &size, long &mtime);
 
 	bool isDirectory(const std::string &path, bool show_error = true);
 
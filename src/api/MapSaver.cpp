@@ -156,7 +156,7 @@ void MapSaver::writeLayers(std::ofstream& map_file)
 			std::stringstream map_row;
 			for (int tile = 0; tile < map->w; tile++)
 			{
-				map_row << map->layers[i][tile][line] << ",";
+				map_row << map->layers[i].get(tile, line) << ",";
 			}
 			layer += map_row.str();
 			layer += '\n';
@@ -30,9 +30,12 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "DeviceList.h"
 #include "EngineSettings.h"
 #include "GameSwitcher.h"
+#include "InputScript.h"
 #include "InputState.h"
+#include "MapCompiler.h"
 #include "MessageEngine.h"
 #include "ModManager.h"
+#include "Profiler.h"
 #include "RenderDevice.h"
 #include "SaveLoad.h"
 #include "SDLFontEngine.h"
@@ -52,6 +55,21 @@ class CmdLineArgs {
 public:
 	std::string render_device_name;
 	std::vector<std::string> mod_list;
+
+	bool headless;
+	unsigned headless_ticks;
+	bool fixed_seed;
+	unsigned seed;
+	std::string input_script; // replayed when headless
+	std::string record_input; // recorded when not headless
+	std::string timings_file;
+
+	CmdLineArgs()
+		: headless(false)
+		, headless_ticks(600)
+		, fixed_seed(false)
+		, seed(0) {
+	}
 };
 
 #define PLATFORM_CPP_INCLUDE
@@ -90,7 +108,16 @@ static void init(const CmdLineArgs& cmd_line_args) {
 	Utils::logInfo(VersionInfo::createVersionStringFull().c_str());
 
 	// SDL Inits
-	if ( SDL_Init (SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_JOYSTICK) < 0 ) {
+	settings->headless = cmd_line_args.headless;
+
+	Uint32 sdl_flags = SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_JOYSTICK;
+	if (settings->headless) {
+		// there is no window, but SDL still needs a video driver for key names and cursors
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		sdl_flags = SDL_INIT_VIDEO;
+	}
+
+	if ( SDL_Init (sdl_flags) < 0 ) {
 		Utils::logError("main: Could not initialize SDL: %s", SDL_GetError());
 		Utils::logErrorDialog("main: Could not initialize SDL: %s", SDL_GetError());
 		Utils::Exit(1);
@@ -113,12 +140,18 @@ static void init(const CmdLineArgs& cmd_line_args) {
 
 	settings->loadSettings();
 
+	if (settings->headless)
+		settings->audio = false;
+
 	save_load = new SaveLoad();
 	msg = new MessageEngine();
 	font = getFontEngine();
 	anim = new AnimationManager();
 	comb = new CombatText();
-	inpt = getInputManager();
+	if (settings->headless)
+		inpt = getHeadlessInputManager(cmd_line_args.input_script);
+	else
+		inpt = getInputManager();
 	icons = NULL;
 
 	// Load miscellaneous settings
@@ -130,7 +163,9 @@ static void init(const CmdLineArgs& cmd_line_args) {
 	platform.setScreenSize();
 
 	// Create render Device and Rendering Context.
-	if (platform.default_renderer != "")
+	if (settings->headless)
+		render_device = getRenderDevice("null");
+	else if (platform.default_renderer != "")
 		render_device = getRenderDevice(platform.default_renderer);
 	else if (cmd_line_args.render_device_name != "")
 		render_device = getRenderDevice(cmd_line_args.render_device_name);
@@ -148,26 +183,96 @@ static void init(const CmdLineArgs& cmd_line_args) {
 	// reset the reload_graphics flag
 	render_device->reloadGraphics();
 
-	snd = getSoundManager();
+	if (settings->headless)
+		snd = getHeadlessSoundManager();
+	else
+		snd = getSoundManager();
 
 	inpt->initJoystick();
 
 	tooltipm = new TooltipManager();
 
+	profiler = new Profiler();
+	if (!cmd_line_args.timings_file.empty()) {
+		profiler->setKeepSamples(true);
+
+		std::stringstream seed;
+		if (cmd_line_args.fixed_seed)
+			seed << cmd_line_args.seed;
+
+		profiler->setInfo("seed", seed.str());
+		profiler->setInfo("load_slot", settings->load_slot);
+		profiler->setInfo("load_script", settings->load_script);
+		profiler->setInfo("input_script", cmd_line_args.input_script);
+	}
+
 	gswitch = new GameSwitcher();
 }
 
+/**
+ * Offline tool: compile the text maps of all enabled mods (see MapCompiler)
+ */
+static void compileMaps(const CmdLineArgs& cmd_line_args) {
+	platform.setPaths();
+
+	mods = new ModManager(&(cmd_line_args.mod_list));
+
+	if (!mods->haveFallbackMod()) {
+		Utils::logError("main: Could not find the default mod. Exiting.");
+		delete mods;
+		mods = NULL;
+		return;
+	}
+
+	MapCompiler compiler;
+	std::vector<std::string> map_files = mods->list("maps", !ModManager::LIST_FULL_PATHS);
+	int compiled = 0;
+	int failed = 0;
+
+	for (size_t i = 0; i < map_files.size(); ++i) {
+		if (map_files[i].length() < 4 || map_files[i].compare(map_files[i].length() - 4, 4, ".txt") != 0)
+			continue;
+
+		if (compiler.compile(map_files[i]))
+			compiled++;
+		else
+			failed++;
+	}
+
+	printf("Compiled %d maps, %d failed.\n", compiled, failed);
+
+	delete mods;
+	mods = NULL;
+}
+
 static float getSecondsElapsed(uint64_t prev_ticks, uint64_t now_ticks) {
 	return (static_cast<float>(now_ticks - prev_ticks) / static_cast<float>(SDL_GetPerformanceFrequency()));
 }
 
-static void mainLoop () {
+static void mainLoop(const CmdLineArgs& cmd_line_args) {
 	bool done = false;
 
-	float seconds_per_frame = 1.f/static_cast<float>(settings->max_frames_per_sec);
+	InputScript* recorder = NULL;
+	if (!cmd_line_args.record_input.empty())
+		recorder = new InputScript();
+	unsigned input_tick = 0;
+
+	const size_t profile_logic_id = profiler->addSection("logic");
+	const size_t profile_render_id = profiler->addSection("render");
+	const size_t profile_commit_id = profiler->addSection("commit_frame");
+
+	const uint64_t frequency = SDL_GetPerformanceFrequency();
+	const uint64_t logic_step = frequency / settings->max_frames_per_sec;
+
+	// With max_render_fps, frames are drawn at their own rate and movement is smoothed
+	// between the two latest logic frames. The game speed still depends only on max_fps.
+	const bool interpolate = settings->max_render_fps > 0 && settings->max_render_fps != settings->max_frames_per_sec;
+	const uint64_t frame_step = interpolate ? frequency / settings->max_render_fps : logic_step;
+	const float seconds_per_frame = static_cast<float>(frame_step) / static_cast<float>(frequency);
 
 	uint64_t prev_ticks = SDL_GetPerformanceCounter();
-	uint64_t logic_ticks = SDL_GetPerformanceCounter();
+	uint64_t logic_ticks = prev_ticks;
+	uint64_t next_frame_ticks = prev_ticks;
 
 	float last_fps = -1;
 
@@ -193,14 +298,21 @@ static void mainLoop () {
 			if (inpt->window_minimized && !inpt->window_restored && !inpt->done)
 				break;
 
+			// ticks are counted the same way as in headlessLoop(), which replays them
+			if (recorder)
+				recorder->record(input_tick, inpt);
+			input_tick++;
+
+			profiler->begin(profile_logic_id);
 			gswitch->logic();
+			profiler->end(profile_logic_id);
 			inpt->resetScroll();
 
 			// Engine done means the user escapes the main game menu.
 			// Input done means the user closes the window.
 			done = gswitch->done || inpt->done;
 
-			logic_ticks += static_cast<uint64_t>(seconds_per_frame * static_cast<float>(SDL_GetPerformanceFrequency()));
+			logic_ticks += logic_step;
 			loops++;
 
 			// When the app is minimized, no logic gets processed.
@@ -212,23 +324,39 @@ static void mainLoop () {
 				break;
 			}
 
-			// don't skip frames if the game is paused
+			// don't skip frames if the game is paused, but keep the fixed logic rate
+			// (frames may be drawn more often than logic runs)
 			if (gswitch->isPaused()) {
-				logic_ticks = now_ticks;
+				logic_ticks = now_ticks + logic_step;
 				break;
 			}
 		}
 
+		// logic_ticks is when the next logic frame is due, so the latest one was due at (logic_ticks - logic_step)
+		if (interpolate) {
+			now_ticks = SDL_GetPerformanceCounter();
+			if (logic_ticks > now_ticks)
+				settings->render_interpolation = std::max(0.f, 1.f - static_cast<float>(logic_ticks - now_ticks) / static_cast<float>(logic_step));
+			else
+				settings->render_interpolation = 1.f;
+		}
+
 		if (!inpt->window_minimized) {
+			profiler->begin(profile_render_id);
 			render_device->blankScreen();
 			gswitch->render();
+			profiler->end(profile_render_id);
 
 			// display the FPS counter
 			if (last_fps != -1) {
 				gswitch->showFPS(last_fps);
 			}
+			gswitch->showProfiler();
 
+			profiler->begin(profile_commit_id);
 			render_device->commitFrame();
+			profiler->end(profile_commit_id);
+			profiler->endFrame();
 
 			// calculate the FPS
 			// if the frame completed quickly, we estimate the delay here
@@ -245,19 +373,75 @@ static void mainLoop () {
 			}
 		}
 
-		// delay quick frames
-		// thanks to David Gow: https://davidgow.net/handmadepenguin/ch18.html
-		if (getSecondsElapsed(prev_ticks, SDL_GetPerformanceCounter()) < seconds_per_frame) {
-			int32_t delay_ms = static_cast<int32_t>((seconds_per_frame - getSecondsElapsed(prev_ticks, SDL_GetPerformanceCounter())) * 1000.f) - 1;
-			if (delay_ms > 0) {
-				SDL_Delay(delay_ms);
-			}
-			while (getSecondsElapsed(prev_ticks, SDL_GetPerformanceCounter()) < seconds_per_frame) {
-				// Waiting...
-			}
+		// sleep until the next frame is due
+		// Frames are scheduled at fixed times, so oversleeping on one frame shortens the wait for the next one.
+		if (interpolate) {
+			next_frame_ticks += frame_step;
+		}
+		else {
+			// draw once per logic frame, but at most once per frame_step while logic is skipped (e.g. minimized)
+			next_frame_ticks = std::max(logic_ticks, prev_ticks + frame_step);
+		}
+
+		now_ticks = SDL_GetPerformanceCounter();
+		if (next_frame_ticks > now_ticks) {
+			// round up, so that a frame is never started before logic is due
+			uint32_t delay_ms = static_cast<uint32_t>(((next_frame_ticks - now_ticks) * 1000 + frequency - 1) / frequency);
+			SDL_Delay(delay_ms);
+		}
+		else if (now_ticks - next_frame_ticks > frame_step) {
+			// too far behind to catch up, e.g. after a loading frame
+			next_frame_ticks = now_ticks;
 		}
 		prev_ticks = SDL_GetPerformanceCounter();
 	}
+
+	if (recorder) {
+		recorder->save(cmd_line_args.record_input);
+		delete recorder;
+	}
+}
+
+/**
+ * Run a fixed number of logic ticks as fast as possible, without waiting between frames.
+ * Input comes from the script given to ScriptedInputState.
+ */
+static void headlessLoop(const CmdLineArgs& cmd_line_args) {
+	bool done = false;
+	unsigned ticks = 0;
+
+	uint64_t start_ticks = SDL_GetPerformanceCounter();
+
+	const size_t profile_logic_id = profiler->addSection("logic");
+	const size_t profile_render_id = profiler->addSection("render");
+
+	while (!done && ticks < cmd_line_args.headless_ticks) {
+		// like mainLoop(), no logic is run on loading frames
+		bool logic_frame = !gswitch->isLoadingFrame();
+		if (logic_frame) {
+			inpt->handle();
+			profiler->begin(profile_logic_id);
+			gswitch->logic();
+			profiler->end(profile_logic_id);
+			inpt->resetScroll();
+
+			done = gswitch->done || inpt->done;
+			ticks++;
+		}
+
+		// nothing is drawn, but some menus update their layout while rendering
+		profiler->begin(profile_render_id);
+		render_device->blankScreen();
+		gswitch->render();
+		render_device->commitFrame();
+		profiler->end(profile_render_id);
+
+		// one profiler frame per logic tick
+		if (logic_frame)
+			profiler->endFrame();
+	}
+
+	Utils::logInfo("main: Simulated %u logic ticks in %s seconds.", ticks, Utils::floatToString(getSecondsElapsed(start_ticks, SDL_GetPerformanceCounter()), 3).c_str());
 }
 
 static void cleanup() {
@@ -271,6 +455,7 @@ static void cleanup() {
 	delete inpt;
 	delete mods;
 	delete msg;
+	delete profiler;
 	delete snd;
 	delete save_load;
 	delete eset;
@@ -337,6 +522,7 @@ int main(int argc, char *argv[]) {
 	settings = new Settings();
 
 	bool debug_event = false;
+	bool compile_maps = false;
 	bool done = false;
 	CmdLineArgs cmd_line_args;
 
@@ -391,6 +577,29 @@ int main(int argc, char *argv[]) {
 		else if (arg == "load-script") {
 			settings->load_script = parseArgValue(arg_full);
 		}
+		else if (arg == "compile-maps") {
+			compile_maps = true;
+			done = true;
+		}
+		else if (arg == "headless") {
+			cmd_line_args.headless = true;
+		}
+		else if (arg == "ticks") {
+			cmd_line_args.headless_ticks = static_cast<unsigned>(std::max(Parse::toInt(parseArgValue(arg_full)), 0));
+		}
+		else if (arg == "seed") {
+			cmd_line_args.fixed_seed = true;
+			cmd_line_args.seed = static_cast<unsigned>(Parse::toInt(parseArgValue(arg_full)));
+		}
+		else if (arg == "input-script") {
+			cmd_line_args.input_script = parseArgValue(arg_full);
+		}
+		else if (arg == "record-input") {
+			cmd_line_args.record_input = parseArgValue(arg_full);
+		}
+		else if (arg == "timings") {
+			cmd_line_args.timings_file = parseArgValue(arg_full);
+		}
 		else if (arg == "help") {
 			printf("\
 --help                   Prints this message.\n\
@@ -403,7 +612,22 @@ int main(int argc, char *argv[]) {
 --mods=<MOD>,...         Starts the game with only these mods enabled.\n\
 --load-slot=<SLOT>       Loads a save slot by numerical index.\n\
 --load-script=<SCRIPT>   Execute's a script upon loading a saved game.\n\
-                         The script path is mod-relative.\n");
+                         The script path is mod-relative.\n\
+--compile-maps           Writes a binary copy of every map, which loads faster.\n\
+                         Use together with --mods to choose the maps.\n\
+--headless               Runs the game without a window, audio or user input.\n\
+                         Use together with --load-slot and --load-script to\n\
+                         choose the save and map. Nothing is saved.\n\
+--ticks=<COUNT>          Number of logic ticks to run with --headless.\n\
+                         The default is 600.\n\
+--seed=<SEED>            Seeds the random number generator with a fixed value.\n\
+                         --headless uses a seed of 1 unless this is given.\n\
+--input-script=<FILE>    Replays input recorded with --record-input when\n\
+                         using --headless.\n\
+--record-input=<FILE>    Writes all input to a file when the game exits.\n\
+--timings=<FILE>         Writes the time taken by each game subsystem on\n\
+                         every frame to a JSON file. With --headless, every\n\
+                         frame is one logic tick.\n");
 			done = true;
 		}
 		else {
@@ -411,9 +635,24 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
+	if (compile_maps) {
+		compileMaps(cmd_line_args);
+	}
+
+	if (cmd_line_args.headless && !cmd_line_args.fixed_seed) {
+		cmd_line_args.fixed_seed = true;
+		cmd_line_args.seed = 1;
+	}
+
 soft_reset:
 	if (!done) {
-		srand(static_cast<unsigned int>(time(NULL)));
+		if (cmd_line_args.fixed_seed) {
+			srand(cmd_line_args.seed);
+			Utils::logInfo("main: Random seed is %u", cmd_line_args.seed);
+		}
+		else {
+			srand(static_cast<unsigned int>(time(NULL)));
+		}
 #ifdef __EMSCRIPTEN__
 		platform.FSInit();
 		emscripten_set_main_loop(EmscriptenMainLoop, 0, 1);
@@ -423,10 +662,16 @@ soft_reset:
 		if (debug_event)
 			inpt->enableEventLog();
 
-		mainLoop();
+		if (cmd_line_args.headless)
+			headlessLoop(cmd_line_args);
+		else
+			mainLoop(cmd_line_args);
 #endif
 
-		if (gswitch)
+		if (!cmd_line_args.timings_file.empty())
+			profiler->writeJSON(cmd_line_args.timings_file);
+
+		if (gswitch && !settings->headless)
 			gswitch->saveUserSettings();
 
 		cleanup();